@@ -9,19 +9,27 @@ SOURCES += main.cpp \
     satellite/station/stationdialog.cpp \
     satellite/station/station.cpp \
     utils/plist.cpp \
+    utils/ptydevice.cpp \
+    utils/simclock.cpp \
     satellite/kepler/tledialog.cpp \
+    satellite/kepler/tleparser.cpp \
+    satellite/kepler/tlearchive.cpp \
     satellite/predict/Satellite.cpp \
     settings.cpp \
     utils/utils.cpp \
     satellite/satutil.cpp \
+    satellite/satcatalog.cpp \
     satellite/orbitdata/orbitdialog.cpp \
     satellite/predict/satpassdialog.cpp \
     satellite/trackthread.cpp \
     satellite/track/trackwidget.cpp \
+    satellite/track/daemontracker.cpp \
+    satellite/track/trackdaemon.cpp \
     imagewidget.cpp \
     satellite/active/activesatdialog.cpp \
     rig/rigdialog.cpp \
     rig/rig.cpp \
+    rig/antenna.cpp \
     decoder/block.cpp \
     decoder/mn1lrptblock.cpp \
     decoder/ReedSolomon.cpp \
@@ -33,16 +41,29 @@ SOURCES += main.cpp \
     decoder/mn1hrptblock.cpp \
     rig/rotorpindialog.cpp \
     rig/rotor.cpp \
+    rig/rotorplan.cpp \
+    rig/serialengine.cpp \
+    rig/rotoremulator.cpp \
+    rig/telemetry.cpp \
+    rig/telemetryreader.cpp \
+    rig/jobscheduler.cpp \
     rig/stepper.cpp \
     rig/gs232b.cpp \
     rig/alphaspid.cpp \
     rig/qextserialport/qextserialport.cpp \
     satellite/predict/satscript.cpp \
+    satellite/predict/passtable.cpp \
+    satellite/predict/passworker.cpp \
+    satellite/predict/passephem.cpp \
+    satellite/predict/passschedule.cpp \
+    satellite/predict/sgp4batch.cpp \
+    satellite/predict/groundtrack.cpp \
     decoder/fy1hrptblock.cpp \
     utils/textwindow.cpp \
     tools/gauge.cpp \
     tools/gps/gpsdialog.cpp \
     tools/gps/gps.cpp \
+    tools/gps/gpsemulator.cpp \
     rig/jrk.cpp \
     rig/jrkconfdialog.cpp \
     decoder/ahrptblock.cpp \
@@ -58,9 +79,19 @@ SOURCES += main.cpp \
     rig/usb/tusb.cpp \
     rig/jrkusb.cpp \
     decoder/fyahrptblock.cpp \
-    rig/jrklut.cpp \
+    rig/jrkcal.cpp \
     satellite/property/evi.cpp \
-    satellite/property/eviconfdialog.cpp
+    satellite/property/eviconfdialog.cpp \
+    decoder/viterbi.cpp \
+    decoder/deinterleaver.cpp \
+    decoder/synccorrelator.cpp \
+    decoder/bitsync.cpp \
+    decoder/demod/demod.cpp \
+    decoder/demod/polyphase.cpp \
+    decoder/demod/costas.cpp \
+    decoder/demod/gardner.cpp \
+    decoder/demod/fft.cpp \
+    decoder/demod/doppler.cpp
 HEADERS += mainwindow.h \
     decoder/hrptblock.h \
     version.h \
@@ -68,21 +99,30 @@ HEADERS += mainwindow.h \
     satellite/station/stationdialog.h \
     satellite/station/station.h \
     utils/plist.h \
+    utils/ptydevice.h \
+    utils/simclock.h \
     satellite/kepler/tledialog.h \
+    satellite/kepler/tleparser.h \
+    satellite/kepler/tlearchive.h \
     satellite/predict/Satellite.h \
     satellite/predict/satcalc.h \
     settings.h \
     utils/utils.h \
     config.h \
     satellite/satutil.h \
+    satellite/satcatalog.h \
     satellite/orbitdata/orbitdialog.h \
     satellite/predict/satpassdialog.h \
     satellite/trackthread.h \
     satellite/track/trackwidget.h \
+    satellite/track/daemontracker.h \
+    satellite/track/trackdaemon.h \
+    satellite/trackhost.h \
     imagewidget.h \
     satellite/active/activesatdialog.h \
     rig/rigdialog.h \
     rig/rig.h \
+    rig/antenna.h \
     decoder/block.h \
     decoder/mn1lrptblock.h \
     decoder/ReedSolomon.h \
@@ -95,16 +135,29 @@ HEADERS += mainwindow.h \
     decoder/mn1hrptblock.h \
     rig/rotorpindialog.h \
     rig/rotor.h \
+    rig/rotorplan.h \
+    rig/serialengine.h \
+    rig/rotoremulator.h \
+    rig/telemetry.h \
+    rig/telemetryreader.h \
+    rig/jobscheduler.h \
     rig/stepper.h \
     rig/gs232b.h \
     rig/alphaspid.h \
     rig/qextserialport/qextserialport.h \
     satellite/predict/satscript.h \
+    satellite/predict/passtable.h \
+    satellite/predict/passworker.h \
+    satellite/predict/passephem.h \
+    satellite/predict/passschedule.h \
+    satellite/predict/sgp4batch.h \
+    satellite/predict/groundtrack.h \
     decoder/fy1hrptblock.h \
     utils/textwindow.h \
     tools/gauge.h \
     tools/gps/gpsdialog.h \
     tools/gps/gps.h \
+    tools/gps/gpsemulator.h \
     rig/jrk.h \
     rig/jrkconfdialog.h \
     decoder/ahrptblock.h \
@@ -121,9 +174,20 @@ HEADERS += mainwindow.h \
     rig/jrkusb.h \
     rig/jrk_protocol.h \
     decoder/fyahrptblock.h \
-    rig/jrklut.h \
+    rig/jrkcal.h \
     satellite/property/evi.h \
-    satellite/property/eviconfdialog.h
+    satellite/property/eviconfdialog.h \
+    decoder/viterbi.h \
+    decoder/deinterleaver.h \
+    decoder/synccorrelator.h \
+    decoder/bitsync.h \
+    decoder/demod/dsp.h \
+    decoder/demod/demod.h \
+    decoder/demod/polyphase.h \
+    decoder/demod/costas.h \
+    decoder/demod/gardner.h \
+    decoder/demod/fft.h \
+    decoder/demod/doppler.h
 DEFINES += _CRT_SECURE_NO_WARNINGS
 FORMS += mainwindow.ui \
     satellite/station/stationdialog.ui \
@@ -158,6 +222,7 @@ INCLUDEPATH += decoder \
     rig/usb \
     rig/qextserialport \
     decoder/ljpeg \
+    decoder/demod \
     tools \
     tools/gps
 
@@ -178,6 +243,11 @@ INCLUDEPATH += decoder \
 #LIBS += libLritRice.a
 #LIBS += -L/home/patrik/prog/poes-weather/decoder/lritrice/LritRice.a
 
+# --------------------------------------------------------------------------------
+# uncomment the line below to build the Viterbi decoder, demodulator and batch SGP4 with AVX2, x86-64 defaults to SSE2
+# QMAKE_CXXFLAGS += -mavx2
+# --------------------------------------------------------------------------------
+
 #DEFINES += DEBUG_GPS
 DEFINES += DEBUG_AHRPT
 
@@ -27,6 +27,7 @@
 #define PATH_CONF           "conf"
 #define PATH_TLE            "tle"
 #define PATH_TLE_ARC        "tle/archive"
+#define PATH_TLE_CACHE      "tle/cache"
 
 // settings files
 #define FILE_SAT_INI        "satellites.ini"
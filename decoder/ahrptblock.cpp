@@ -83,6 +83,8 @@ bool TAHRPT::init(void)
 
     fp = block->getHandle();
 
+    cadu->sync_errors(block->satprop->syncErrors());
+
     if(!cadu->init(fp, AHRPT_CADU_SIZE - CADU_SYNC_SIZE)) // CCSDS size, 1020 bytes
         return false;
 
@@ -160,6 +162,7 @@ long TAHRPT::count_AVHRR_HR_frames(void)
                 if(frames == 0)
                     block->setFirstFrameSyncPos(cadu->getpacketaddress());
 
+                block->setFrameConfidence(frames, cadu->getconfidence());
                 frames++;
             }
 
@@ -0,0 +1,330 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <stdlib.h>
+#include <memory.h>
+
+#include "bitsync.h"
+#include "synccorrelator.h"
+
+//---------------------------------------------------------------------------
+/*
+  Raw bitstreams, 10 bit packed HRPT or the hard bits of the demodulator,
+  do not start on a byte boundary and the bit clock may slip a bit or two.
+
+  The stream is searched bit by bit for the sync or the inverted sync. Once
+  found the next sync is expected one period later and is searched within
+  BS_MAX_SLIP bits of it, so the frame follows the slips. Words are realigned
+  with 64 bit loads and shifts, one word per load.
+*/
+//---------------------------------------------------------------------------
+static inline quint64 load64(const quint8 *p)
+{
+    return ((quint64) p[0] << 56) | ((quint64) p[1] << 48) |
+           ((quint64) p[2] << 40) | ((quint64) p[3] << 32) |
+           ((quint64) p[4] << 24) | ((quint64) p[5] << 16) |
+           ((quint64) p[6] << 8)  |  (quint64) p[7];
+}
+
+//---------------------------------------------------------------------------
+// n bits msb first starting at bit offset of p, p must hold offset/8 + 9 bytes
+static inline quint64 extract(const quint8 *p, int offset, int n)
+{
+    quint64 v;
+    int b = offset >> 3, s = offset & 7;
+
+    v = load64(p + b) << s;
+    if(s)
+        v |= p[b + 8] >> (8 - s);
+
+    return v >> (64 - n);
+}
+
+//---------------------------------------------------------------------------
+TBitSync::TBitSync(void)
+{
+    flags = 0;
+    pattern = 0;
+    mask = 0;
+    bits = 0;
+    unit_bits = 10;
+    max_errors = 0;
+    locked_errors = 0;
+    period = 0;
+
+    buf_size = BS_READ_SIZE + 16;
+    buf = (quint8 *) malloc(buf_size);
+
+    reset();
+}
+
+//---------------------------------------------------------------------------
+TBitSync::~TBitSync(void)
+{
+    if(buf)
+        free(buf);
+}
+
+//---------------------------------------------------------------------------
+void TBitSync::reset(void)
+{
+    flags = 0;
+    errors = 0;
+    coast = 0;
+    position = -1;
+    expected = -1;
+    corrected = 0;
+    coasted = 0;
+    slips = 0;
+}
+
+//---------------------------------------------------------------------------
+void TBitSync::setflag(int flag, bool on)
+{
+    flags &= ~flag;
+    flags |= on ? flag:0;
+}
+
+//---------------------------------------------------------------------------
+void TBitSync::setSync(const quint16 *sync, int units, int unit_bits_)
+{
+    int i;
+
+    unit_bits = unit_bits_;
+    bits = units * unit_bits;
+    bits = bits > 64 ? 64:bits;
+
+    pattern = 0;
+    for(i=0; i<units; i++)
+        pattern = (pattern << unit_bits) | (sync[i] & ((1 << unit_bits) - 1));
+
+    mask = bits >= 64 ? ~((quint64) 0):(((quint64) 1) << bits) - 1;
+
+    setMaxErrors(max_errors);
+    reset();
+}
+
+//---------------------------------------------------------------------------
+void TBitSync::setMaxErrors(int search, int locked)
+{
+    max_errors = search < 0 ? 0:search;
+    locked_errors = locked < 0 ? bits / 4:locked;
+
+    if(locked_errors < max_errors)
+        locked_errors = max_errors;
+}
+
+//---------------------------------------------------------------------------
+int TBitSync::getConfidence(void)
+{
+    int half = bits / 2;
+
+    if(half <= 0 || errors >= half)
+        return 0;
+
+    return (100 * (half - errors)) / half;
+}
+
+//---------------------------------------------------------------------------
+// bit errors to the sync or to the inverted sync, whichever is lower
+int TBitSync::distance(quint64 w, bool *inverted)
+{
+    int e = TSyncCorrelator::popcount64((w ^ pattern) & mask);
+
+    *inverted = bits - e < e;
+
+    return *inverted ? bits - e:e;
+}
+
+//---------------------------------------------------------------------------
+bool TBitSync::peek(FILE *fp, qint64 pos, quint64 *w)
+{
+    quint8 b[16];
+
+    if(pos < 0 || fseek(fp, (long) (pos >> 3), SEEK_SET) != 0)
+        return false;
+
+    memset(b, 0, sizeof(b));
+    if((int) fread(b, 1, ((pos & 7) + bits + 7) >> 3, fp) != (((pos & 7) + bits + 7) >> 3))
+        return false;
+
+    *w = extract(b, (int) (pos & 7), bits);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TBitSync::next(FILE *fp)
+{
+    if(fp == NULL || buf == NULL || bits <= 0)
+        return false;
+
+    if((flags & BS_LOCKED) && period > 0)
+        return check(fp);
+
+    return scan(fp, position < 0 ? 0:position + 1);
+}
+
+//---------------------------------------------------------------------------
+// searches around the expected position, follows bit slips
+bool TBitSync::check(FILE *fp)
+{
+    quint64 w;
+    bool    inv, best_inv;
+    int     d, e, best, best_d;
+
+    best = bits;
+    best_d = 0;
+    best_inv = isInverted();
+
+    for(d=0; d<=2*BS_MAX_SLIP; d++) {
+        // 0, -1, 1, -2, 2 ...
+        if(!peek(fp, expected + (d & 1 ? -(d + 1) / 2:d / 2), &w)) {
+            if(d == 0)
+                return false; // end of file
+            continue;
+        }
+
+        e = distance(w, &inv);
+        if(e < best) {
+            best = e;
+            best_d = d & 1 ? -(d + 1) / 2:d / 2;
+            best_inv = inv;
+        }
+
+        if(best == 0)
+            break;
+    }
+
+    if(best <= locked_errors) {
+        position = expected + best_d;
+        errors = best;
+        coast = 0;
+        slips += best_d != 0 ? 1:0;
+        corrected += best > 0 ? 1:0;
+        setflag(BS_INVERTED, best_inv);
+    }
+    else if(coast < BS_FLYWHEEL) {
+        position = expected;
+        errors = best;
+        coast++;
+        coasted++;
+    }
+    else {
+        // lost, search from here
+        setflag(BS_LOCKED, false);
+        coast = 0;
+
+        return scan(fp, expected - BS_MAX_SLIP);
+    }
+
+    expected = position + period;
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TBitSync::scan(FILE *fp, qint64 from)
+{
+    quint64 w;
+    qint64  bit;
+    bool    inv;
+    int     i, k, n, e, shifted;
+
+    from = from < 0 ? 0:from;
+
+    if(fseek(fp, (long) (from >> 3), SEEK_SET) != 0)
+        return false;
+
+    bit = from & ~((qint64) 7);
+    k = (int) (from & 7);
+    w = 0;
+    shifted = 0;
+
+    while((n = (int) fread(buf, 1, BS_READ_SIZE, fp)) > 0) {
+        for(i=0; i<n; i++) {
+            for(; k<8; k++) {
+                w = (w << 1) | ((buf[i] >> (7 - k)) & 1);
+
+                if(++shifted < bits)
+                    continue;
+
+                e = distance(w, &inv);
+                if(e > max_errors)
+                    continue;
+
+                position = bit + i * 8 + k - bits + 1;
+                expected = position + period;
+                errors = e;
+                coast = 0;
+                corrected += errors > 0 ? 1:0;
+                setflag(BS_INVERTED, inv);
+                setflag(BS_LOCKED, true);
+
+                return true;
+            }
+
+            k = 0;
+        }
+
+        bit += (qint64) n * 8;
+    }
+
+    return false;
+}
+
+//---------------------------------------------------------------------------
+bool TBitSync::readWords(FILE *fp, qint64 pos, quint16 *words, int n, bool inverted)
+{
+    quint16 inv;
+    quint8  *p;
+    int     need, offset, i;
+
+    if(fp == NULL || buf == NULL || pos < 0)
+        return false;
+
+    offset = (int) (pos & 7);
+    need = (offset + n * unit_bits + 7) >> 3;
+
+    if(need + 16 > buf_size) {
+        p = (quint8 *) realloc(buf, need + 16);
+        if(p == NULL)
+            return false;
+
+        buf = p;
+        buf_size = need + 16;
+    }
+
+    if(fseek(fp, (long) (pos >> 3), SEEK_SET) != 0 ||
+       (int) fread(buf, 1, need, fp) != need)
+        return false;
+
+    memset(buf + need, 0, 16);
+
+    inv = inverted ? (1 << unit_bits) - 1:0;
+
+    for(i=0; i<n; i++)
+        words[i] = (quint16) extract(buf, offset + i * unit_bits, unit_bits) ^ inv;
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,90 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef BITSYNC_H
+#define BITSYNC_H
+
+#include <QtGlobal>
+#include <stdio.h>
+
+//---------------------------------------------------------------------------
+#define BS_LOCKED           1   // a sync was found, the next is expected one period later
+#define BS_INVERTED         2   // the bitstream is inverted, BPSK phase ambiguity
+
+#define BS_READ_SIZE        65536 // bytes per scan chunk
+#define BS_FLYWHEEL         4     // frames accepted on the period without a sync match
+#define BS_MAX_SLIP         3     // bits searched around the expected sync
+
+//---------------------------------------------------------------------------
+// frame sync of a packed msb first bitstream at any bit offset, with bit slips
+// positions are in bits from the start of the file
+class TBitSync
+{
+public:
+    TBitSync(void);
+    ~TBitSync(void);
+
+    // sync word of up to 64 bits, units of unit_bits msb first
+    void setSync(const quint16 *sync, int units, int unit_bits_);
+    // max bit errors while searching, locked is used around the expected position
+    // and defaults to a quarter of the sync bits
+    void setMaxErrors(int search, int locked=-1);
+    // bits from a sync to the next one
+    void setPeriod(qint64 bits_) { period = bits_; }
+
+    void reset(void);
+
+    // finds the sync of the next frame, the first call searches from the start of the file
+    bool next(FILE *fp);
+
+    qint64 getPosition(void) { return position; }
+    bool   isInverted(void) { return flags & BS_INVERTED ? true:false; }
+    int    getErrors(void) { return errors; }
+    int    getConfidence(void);
+    bool   isFlywheel(void) { return coast > 0; }
+
+    long getCorrected(void) { return corrected; }
+    long getCoasted(void) { return coasted; }
+    long getSlips(void) { return slips; }
+
+    // reads n words of unit_bits starting at bit pos into words, realigned
+    bool readWords(FILE *fp, qint64 pos, quint16 *words, int n, bool inverted);
+
+protected:
+    void setflag(int flag, bool on);
+    int  distance(quint64 w, bool *inverted);
+    bool peek(FILE *fp, qint64 pos, quint64 *w);
+    bool check(FILE *fp);
+    bool scan(FILE *fp, qint64 from);
+
+private:
+    int     flags;
+    quint64 pattern, mask;
+    int     bits, unit_bits;
+    int     max_errors, locked_errors, errors, coast;
+    qint64  period, position, expected;
+    long    corrected, coasted, slips;
+
+    quint8  *buf;
+    int     buf_size;
+};
+
+#endif // BITSYNC_H
@@ -20,6 +20,8 @@
 */
 //---------------------------------------------------------------------------
 #include <QString>
+#include <stdlib.h>
+#include <memory.h>
 #include "block.h"
 #include "hrptblock.h"
 #include "ahrptblock.h"
@@ -28,7 +30,11 @@
 #include "mn1hrptblock.h"
 #include "fy1hrptblock.h"
 #include "lritblock.h"
+#include "viterbi.h"
+#include "demod.h"
+#include "doppler.h"
 #include "plist.h"
+#include "Satellite.h"
 
 static const char *SUPPORTED_BLOCKS[NUM_SUPPORTED_BLOCKS] =
 {
@@ -44,6 +50,13 @@ static const char *SUPPORTED_BLOCKS[NUM_SUPPORTED_BLOCKS] =
    "JPEG LRIT/HRIT"
 };
 
+// symbols per second of the demodulator
+const double AHRPT_SYMBOL_RATE   = 2333333;
+const double FYAHRPT_SYMBOL_RATE = 2800000;
+const double MN1LRPT_SYMBOL_RATE = 72000;
+const double LRIT_SYMBOL_RATE    = 293883;
+const double HRPT_SYMBOL_RATE    = 2 * 665400; // split phase half bits
+
 //---------------------------------------------------------------------------
 TBlock::TBlock(void)
 {    
@@ -53,6 +66,9 @@ TBlock::TBlock(void)
    frames = 0;
    firstFrameSyncPos = -1;
 
+   confidence = NULL;
+   confidence_size = 0;
+
    blocktype = Undefined_BlockType;
    imagetype = Channel_ImageType;
    imageChannel = 0; // zero based
@@ -67,6 +83,9 @@ TBlock::~TBlock(void)
     close();
     freeBlock();
 
+    if(confidence)
+        free(confidence);
+
     delete cadu;
     delete satprop;
 }
@@ -126,6 +145,38 @@ void TBlock::close(void)
    fp = NULL;
 }
 
+//---------------------------------------------------------------------------
+void TBlock::setFrameConfidence(long int frame, int value)
+{
+   quint8 *p;
+   long int size;
+
+   if(frame < 0)
+      return;
+
+   if(frame >= confidence_size) {
+      size = (frame + 1024) & ~1023L;
+      p = (quint8 *) realloc(confidence, size);
+      if(p == NULL)
+         return;
+
+      memset(p + confidence_size, 100, size - confidence_size);
+      confidence = p;
+      confidence_size = size;
+   }
+
+   confidence[frame] = value < 0 ? 0:value > 100 ? 100:value;
+}
+
+//---------------------------------------------------------------------------
+int TBlock::getFrameConfidence(long int frame)
+{
+   if(frame < 0 || frame >= confidence_size)
+      return 100;
+
+   return confidence[frame];
+}
+
 //---------------------------------------------------------------------------
 void TBlock::gotoStart(void)
 {
@@ -239,6 +290,12 @@ bool TBlock::open(const char *filename)
    if(fp == NULL)
        return false;
 
+   if(satprop->demodulate() && !demodulate(filename))
+       return false;
+
+   if((satprop->viterbi() || satprop->demodulate()) && !viterbiDecode())
+       return false;
+
    switch(blocktype) {
        case HRPT_BlockType:
           return ((THRPT *) block)->init();
@@ -274,6 +331,132 @@ bool TBlock::open(const char *filename)
    }
 }
 
+//---------------------------------------------------------------------------
+// demodulates the IQ recording into a temporary soft symbol file which replaces fp
+// the Doppler profile is predicted from the passinfo file of the recording if present
+bool TBlock::demodulate(const char *filename)
+{
+   TDemod *demod;
+   TDoppler *doppler;
+   TSat *sat;
+   FILE *outfp;
+   double duration;
+   bool rc;
+
+   demod = new TDemod;
+
+   switch(blocktype) {
+       case HRPT_BlockType:
+          // hard bits, THRPT finds the bit offset of the frames
+          demod->setType(SplitPhase_DemodType);
+          demod->setSymbolRate(HRPT_SYMBOL_RATE);
+          demod->hardBits(true);
+       break;
+
+       case AHRPT_BlockType:
+          demod->setType(QPSK_DemodType);
+          demod->setSymbolRate(AHRPT_SYMBOL_RATE);
+       break;
+
+       case FYAHRPT_BlockType:
+          demod->setType(QPSK_DemodType);
+          demod->setSymbolRate(FYAHRPT_SYMBOL_RATE);
+       break;
+
+       case MN1LRPT_BlockType:
+          demod->setType(QPSK_DemodType);
+          demod->setSymbolRate(MN1LRPT_SYMBOL_RATE);
+       break;
+
+       case LRIT_GOES_BlockType:
+       case LRIT_JPEG_BlockType:
+          demod->setType(BPSK_DemodType);
+          demod->setSymbolRate(LRIT_SYMBOL_RATE);
+       break;
+
+       default:
+          delete demod;
+          qDebug("Demodulation of %s is not supported", SUPPORTED_BLOCKS[blocktype]);
+
+          return false;
+   }
+
+   outfp = tmpfile();
+   if(outfp == NULL) {
+       delete demod;
+       return false;
+   }
+
+   demod->setFormat((IQ_Format) satprop->iqFormat());
+   demod->setSampleRate(satprop->iqRate());
+
+   doppler = new TDoppler;
+   doppler->setSampleRate(satprop->iqRate());
+
+   sat = new TSat;
+   if(satprop->iqRate() > 0 && sat->ReadPassinfo(filename)) {
+       fseek(fp, 0, SEEK_END);
+       duration = ftell(fp) / demod->sampleSize() / satprop->iqRate();
+
+       doppler->predict(sat, sat->rec_aostime, duration);
+   }
+   delete sat;
+
+   demod->setDoppler(doppler);
+
+   rc = demod->demodFile(fp, outfp);
+
+   delete demod;
+   delete doppler;
+
+   fclose(fp);
+   fp = outfp;
+   gotoStart();
+
+   return rc;
+}
+
+//---------------------------------------------------------------------------
+// decodes the soft symbol file into a temporary CADU file which replaces fp
+bool TBlock::viterbiDecode(void)
+{
+   TViterbi *vit;
+   FILE *outfp;
+   bool rc;
+
+   switch(blocktype) {
+       case AHRPT_BlockType:
+       case FYAHRPT_BlockType:
+       case MN1LRPT_BlockType:
+       case LRIT_GOES_BlockType:
+       case LRIT_JPEG_BlockType:
+       break;
+
+       default:
+          return true; // not convolutionally encoded
+   }
+
+   outfp = tmpfile();
+   if(outfp == NULL)
+       return false;
+
+   vit = new TViterbi;
+
+   // CCSDS inverts G2, the METEOR interleaved stream does not
+   vit->deinterleave(satprop->deinterleave());
+   vit->invert_g2(!satprop->deinterleave());
+
+   rc = vit->decodeFile(fp, outfp);
+
+   delete vit;
+
+   fclose(fp);
+   fp = outfp;
+   gotoStart();
+
+   return rc;
+}
+
 //---------------------------------------------------------------------------
 int TBlock::getWidth(void)
 {
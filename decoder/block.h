@@ -120,6 +120,10 @@ class TBlock
 
     void setFirstFrameSyncPos(long int count=-1) { firstFrameSyncPos = count; }
     int  getFirstFrameSyncPos(void) { return firstFrameSyncPos; }
+
+    // frame sync confidence 0...100, frame is zero based
+    void setFrameConfidence(long int frame, int value);
+    int  getFrameConfidence(long int frame);
     
     //void setImageType(Block_ImageType type);
     void setImageType(int index);
@@ -148,6 +152,8 @@ class TBlock
     bool init(void);
     void freeBlock(void);
     void setMode(bool on, int flag);
+    bool demodulate(const char *filename);
+    bool viterbiDecode(void);
 
 
  private:
@@ -155,6 +161,9 @@ class TBlock
     int  imageChannel;
     long int frames, firstFrameSyncPos;
 
+    quint8   *confidence;
+    long int confidence_size;
+
     Block_Type      blocktype;
     Block_ImageType imagetype;
 
@@ -32,6 +32,7 @@ extern "C" {
 
 #include <memory.h>
 #include "cadu.h"
+#include "synccorrelator.h"
 
 //#define DEBUG_RS
 
@@ -49,6 +50,9 @@ TCADU::TCADU(void)
     payload_buf = NULL;
     derand_buf = NULL;
     rs_buf = NULL;
+
+    correlator = new TSyncCorrelator;
+    sync_word = NULL;
 }
 
 //---------------------------------------------------------------------------
@@ -62,6 +66,9 @@ bool TCADU::init(FILE *fp_, size_t payload_size_, FILE *outfp_)
 
     payload_size = payload_size_;
 
+    correlator->reset();
+    sync_word = NULL;
+
     payload_buf = (unsigned char *) malloc(payload_size); // CVCDU, 4 byte sync is NOT included
     if(payload_buf == NULL)
         return false;
@@ -88,6 +95,8 @@ bool TCADU::init(FILE *fp_, size_t payload_size_, FILE *outfp_)
 TCADU::~TCADU(void)
 {
     reset();
+
+    delete correlator;
 }
 
 //---------------------------------------------------------------------------
@@ -258,26 +267,36 @@ bool TCADU::rsdecode(void)
 }
 
 //---------------------------------------------------------------------------
+void TCADU::sync_errors(int errors)
+{
+    correlator->setMaxErrors(errors);
+}
+
+//---------------------------------------------------------------------------
+// the next sync is expected right after the payload and is
+// accepted with more bit errors there, see TSyncCorrelator
 bool TCADU::findsync(const unsigned char *sync, int sync_size)
 {
-    unsigned char ch;
-    int i = 0;
+    if(sync != sync_word) {
+        correlator->setSync(sync, sync_size);
+        sync_word = sync;
+    }
 
-    while(fread(&ch, 1, 1, fp) == 1) {
-        if(ch == sync[i])
-            i++;
-        else
-            i = 0;
+    correlator->setPeriod(sync_size + payload_size);
 
-        if(i == sync_size) {
-            packet_address = ftell(fp) - sync_size;
-            packets++;
+    if(!correlator->find(fp))
+        return false;
 
-            return true;
-        }
-    }
+    packet_address = correlator->getPosition();
+    packets++;
+
+    return true;
+}
 
-    return false;
+//---------------------------------------------------------------------------
+int TCADU::getconfidence(void)
+{
+    return correlator->getConfidence();
 }
 
 //---------------------------------------------------------------------------
@@ -41,6 +41,8 @@ static const unsigned char CADU_SYNC[CADU_SYNC_SIZE] = {
   0x1A, 0xCF, 0xFC, 0x1D,
 };
 
+class TSyncCorrelator;
+
 //---------------------------------------------------------------------------
 class TCADU
 {
@@ -76,12 +78,17 @@ public:
     bool derandomize(void) { return flags & CADU_DERANDOMIZE ? true:false; }
     void derandomize(bool enable);
 
+    // max bit errors in the sync word
+    void sync_errors(int errors);
+
     bool           findsync(const unsigned char *sync = CADU_SYNC, int sync_size = CADU_SYNC_SIZE);
     unsigned char *getpayload(void);
     unsigned char *getpayload_buffer(void) { return payload_buf; }
 
     long getpacketaddress(void) { return packet_address; }
     long getpackets(void) { return packets; }
+    int  getconfidence(void);
+    TSyncCorrelator *getcorrelator(void) { return correlator; }
 
     void writepacket(bool include_sync);
     void writeVCDU(void);
@@ -106,6 +113,9 @@ private:
 
     long packets, packet_address;
 
+    TSyncCorrelator     *correlator;
+    const unsigned char *sync_word;
+
     int flags;
 };
 
@@ -0,0 +1,125 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <stdlib.h>
+#include <memory.h>
+
+#include "deinterleaver.h"
+
+//---------------------------------------------------------------------------
+/*
+  METEOR-M LRPT (72k/80k modes)
+
+  The encoded symbol stream is interleaved with 36 branches of 2048 symbols
+  delay each. An 8 symbol marker (0x27) is inserted every 80 symbols, the
+  marker is not interleaved. Branch j is delayed j * 36 * 2048 symbols
+  in the deinterleaver.
+
+  Positions not yet written are output as 0, an erasure for the Viterbi.
+*/
+//---------------------------------------------------------------------------
+TDeinterleaver::TDeinterleaver(void)
+{
+    size = (long) DI_BRANCHES * DI_BRANCHES * DI_BRANCH_DELAY;
+    buf = (qint8 *) malloc(size);
+
+    reset();
+}
+
+//---------------------------------------------------------------------------
+TDeinterleaver::~TDeinterleaver(void)
+{
+    if(buf)
+        free(buf);
+}
+
+//---------------------------------------------------------------------------
+void TDeinterleaver::reset(void)
+{
+    if(buf)
+        memset(buf, 0, size);
+
+    pos = 0;
+    marker_pos = 0;
+}
+
+//---------------------------------------------------------------------------
+long TDeinterleaver::findMarker(const qint8 *sym, int len, int *offset)
+{
+    long score, best;
+    int  i, k, o;
+
+    best = 0;
+    *offset = 0;
+
+    for(o=0; o<DI_MARKER_STRIDE; o++) {
+        score = 0;
+
+        for(k=o; k + DI_MARKER_SIZE <= len; k += DI_MARKER_STRIDE)
+            for(i=0; i<DI_MARKER_SIZE; i++) {
+                // msb first, soft symbol > 0 is a one
+                if((DI_MARKER >> (DI_MARKER_SIZE - 1 - i)) & 1)
+                    score += sym[k + i];
+                else
+                    score -= sym[k + i];
+            }
+
+        if(score > best) {
+            best = score;
+            *offset = o;
+        }
+    }
+
+    return best;
+}
+
+//---------------------------------------------------------------------------
+int TDeinterleaver::process(const qint8 *src, int len, qint8 *dst)
+{
+    long j, w;
+    int  i, n;
+
+    if(buf == NULL)
+        return 0;
+
+    for(i=0, n=0; i<len; i++) {
+        if(marker_pos++ < DI_MARKER_SIZE)
+            continue;
+
+        if(marker_pos == DI_MARKER_STRIDE)
+            marker_pos = 0;
+
+        j = pos % DI_BRANCHES;
+        w = (pos + j * DI_BRANCHES * DI_BRANCH_DELAY) % size;
+
+        buf[w] = src[i];
+
+        w = pos % size;
+        dst[n++] = buf[w];
+        buf[w] = 0;
+
+        pos++;
+    }
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
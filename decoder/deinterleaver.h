@@ -0,0 +1,61 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef DEINTERLEAVER_H
+#define DEINTERLEAVER_H
+
+#include <QtGlobal>
+
+//---------------------------------------------------------------------------
+// METEOR LRPT convolutional interleaver, soft symbol domain
+#define DI_BRANCHES         36
+#define DI_BRANCH_DELAY     2048
+#define DI_MARKER           0x27 // inserted every DI_MARKER_STRIDE symbols
+#define DI_MARKER_SIZE      8
+#define DI_MARKER_STRIDE    80
+#define DI_DATA_SIZE        (DI_MARKER_STRIDE - DI_MARKER_SIZE)
+
+//---------------------------------------------------------------------------
+class TDeinterleaver
+{
+public:
+    TDeinterleaver(void);
+    ~TDeinterleaver(void);
+
+    void reset(void);
+
+    // finds the marker phase 0...DI_MARKER_STRIDE-1, returns the correlation score
+    static long findMarker(const qint8 *sym, int len, int *offset);
+
+    // strips the markers and deinterleaves len symbols, returns number of symbols in dst
+    // the stream must start at a marker
+    int  process(const qint8 *src, int len, qint8 *dst);
+
+    // number of output symbols before valid data is present
+    static long delay(void) { return (long) (DI_BRANCHES - 1) * DI_BRANCHES * DI_BRANCH_DELAY; }
+
+private:
+    qint8 *buf;
+    long  size, pos;
+    int   marker_pos;
+};
+
+#endif // DEINTERLEAVER_H
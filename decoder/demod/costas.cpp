@@ -0,0 +1,89 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <math.h>
+
+#include "costas.h"
+
+//---------------------------------------------------------------------------
+TCostas::TCostas(int order_)
+{
+    order = order_;
+    max_freq = 0.5; // ~ 8% of the symbol rate
+
+    setBandwidth(0.005);
+    reset();
+}
+
+//---------------------------------------------------------------------------
+void TCostas::reset(void)
+{
+    phase = 0;
+    freq = 0;
+    error = 1;
+}
+
+//---------------------------------------------------------------------------
+void TCostas::setBandwidth(double bw)
+{
+    double w = DSP_2PI * bw;
+    double damping = sqrt(2.0) / 2.0;
+    double denom = 1.0 + 2.0 * damping * w + w * w;
+
+    alpha = (4.0 * damping * w) / denom;
+    beta = (4.0 * w * w) / denom;
+}
+
+//---------------------------------------------------------------------------
+void TCostas::process(cfloat *sym, int len)
+{
+    cfloat s;
+    double e;
+    int    i;
+
+    for(i=0; i<len; i++) {
+        s = sym[i] * cfloat(cos(phase), -sin(phase));
+        sym[i] = s;
+
+        if(order == 2)
+            e = s.real() * s.imag();
+        else
+            e = (s.real() > 0 ? s.imag():-s.imag()) - (s.imag() > 0 ? s.real():-s.real());
+
+        if(e > 1)
+            e = 1;
+        else if(e < -1)
+            e = -1;
+
+        error = 0.999 * error + 0.001 * e * e;
+
+        freq += beta * e;
+        if(freq > max_freq)
+            freq = max_freq;
+        else if(freq < -max_freq)
+            freq = -max_freq;
+
+        phase += freq + alpha * e;
+        phase = fmod(phase, DSP_2PI);
+    }
+}
+
+//---------------------------------------------------------------------------
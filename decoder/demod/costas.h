@@ -0,0 +1,56 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef COSTAS_H
+#define COSTAS_H
+
+#include "dsp.h"
+
+//---------------------------------------------------------------------------
+// second order decision directed carrier loop, one sample per symbol
+class TCostas
+{
+public:
+    TCostas(int order_=4);
+
+    void reset(void);
+
+    // 2 = BPSK, 4 = QPSK
+    void setOrder(int order_) { order = order_; }
+    // loop bandwidth normalized to the symbol rate
+    void setBandwidth(double bw);
+    // frequency in radians per symbol
+    void   setFrequency(double f) { freq = f; }
+    double getFrequency(void) { return freq; }
+
+    // derotates the symbols in place
+    void process(cfloat *sym, int len);
+
+    // mean squared phase error, low when locked
+    double getError(void) { return error; }
+
+private:
+    int    order;
+    double alpha, beta, max_freq;
+    double phase, freq, error;
+};
+
+#endif // COSTAS_H
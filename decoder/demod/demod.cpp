@@ -0,0 +1,480 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <stdlib.h>
+#include <memory.h>
+#include <math.h>
+
+#include "demod.h"
+#include "polyphase.h"
+#include "costas.h"
+#include "gardner.h"
+#include "doppler.h"
+
+//---------------------------------------------------------------------------
+//#define DEBUG_DEMOD
+
+//---------------------------------------------------------------------------
+/*
+  IQ recording -> soft symbols or hard bits
+
+  The recording is read in batches of threads * DM_CHUNK_SIZE output samples.
+  Each worker converts and resamples its slice to 2 samples per symbol through
+  the polyphase matched filter, the slices are independent since output k is
+  at the absolute input time k * step and the Doppler phase is a function of
+  the absolute input sample. While the workers filter the next batch
+  the calling thread runs the AGC, Gardner and Costas loops on the current one.
+*/
+//---------------------------------------------------------------------------
+const float DM_SOFT_SCALE = 90.0;  // soft symbol scale at unity amplitude
+const float DM_AGC_RATE   = 1e-4;
+
+//---------------------------------------------------------------------------
+//
+//      TDemodWorker
+//
+//---------------------------------------------------------------------------
+TDemodWorker::TDemodWorker(TDemod *demod_) : QThread(NULL)
+{
+    demod = demod_;
+
+    raw = NULL;
+    out = NULL;
+    tmp = NULL;
+    tmp_size = 0;
+    k0 = k1 = 0;
+}
+
+//---------------------------------------------------------------------------
+TDemodWorker::~TDemodWorker(void)
+{
+    wait();
+
+    if(tmp)
+        free(tmp);
+}
+
+//---------------------------------------------------------------------------
+// raw holds samples_ input samples starting at input sample index base_
+void TDemodWorker::setup(const char *raw_, long base_, long samples_, long k0_, long k1_, cfloat *out_)
+{
+    raw = raw_;
+    base = base_;
+    samples = samples_;
+    k0 = k0_;
+    k1 = k1_;
+    out = out_;
+}
+
+//---------------------------------------------------------------------------
+void TDemodWorker::run(void)
+{
+    TPolyphase *filter = demod->getFilter();
+    long first, n;
+
+    if(k1 <= k0)
+        return;
+
+    first = filter->firstInput(k0);
+    n = filter->lastInput(k1 - 1) - first + 1;
+
+    if(n > tmp_size) {
+        if(tmp)
+            free(tmp);
+
+        tmp_size = n;
+        tmp = (cfloat *) malloc(tmp_size * sizeof(cfloat));
+        if(tmp == NULL) {
+            tmp_size = 0;
+            return;
+        }
+    }
+
+    demod->toComplex(raw + (first - base) * demod->sampleSize(), n, tmp);
+
+    if(demod->getDoppler())
+        demod->getDoppler()->mix(tmp, first, n);
+
+    filter->filter(tmp, first, k0, k1, out);
+}
+
+//---------------------------------------------------------------------------
+//
+//      TDemod
+//
+//---------------------------------------------------------------------------
+TDemod::TDemod(void)
+{
+    int i, j;
+
+    flags = 0;
+    format = IQ_Int16;
+    type = QPSK_DemodType;
+    sample_rate = 0;
+    symbol_rate = 0;
+    costas_bw = 0.005;
+    gardner_bw = 0.01;
+
+    filter = new TPolyphase;
+    costas = new TCostas;
+    gardner = new TGardner;
+    doppler = NULL;
+
+    for(i=0; i<2; i++) {
+        raw[i] = NULL;
+        out[i] = NULL;
+
+        for(j=0; j<DM_MAX_THREADS; j++)
+            workers[i][j] = new TDemodWorker(this);
+    }
+
+    raw_size = 0;
+    sym_buf = NULL;
+    symbols = 0;
+
+    setThreads(QThread::idealThreadCount());
+}
+
+//---------------------------------------------------------------------------
+TDemod::~TDemod(void)
+{
+    int i, j;
+
+    for(i=0; i<2; i++) {
+        for(j=0; j<DM_MAX_THREADS; j++)
+            delete workers[i][j];
+
+        if(raw[i])
+            free(raw[i]);
+        if(out[i])
+            free(out[i]);
+    }
+
+    if(sym_buf)
+        free(sym_buf);
+
+    delete filter;
+    delete costas;
+    delete gardner;
+}
+
+//---------------------------------------------------------------------------
+void TDemod::setThreads(int n)
+{
+    threads = n < 1 ? 1:n > DM_MAX_THREADS ? DM_MAX_THREADS:n;
+}
+
+//---------------------------------------------------------------------------
+void TDemod::setLoopBandwidth(double costas_bw_, double gardner_bw_)
+{
+    costas_bw = costas_bw_;
+    gardner_bw = gardner_bw_;
+}
+
+//---------------------------------------------------------------------------
+void TDemod::hardBits(bool enable)
+{
+    flags &= ~DM_HARD;
+    flags |= enable ? DM_HARD:0;
+}
+
+//---------------------------------------------------------------------------
+int TDemod::sampleSize(void)
+{
+    return format == IQ_Float ? 2 * sizeof(float):2 * sizeof(qint16);
+}
+
+//---------------------------------------------------------------------------
+void TDemod::toComplex(const char *raw, long n, cfloat *out)
+{
+    const qint16 *s16;
+    const float  *f32;
+    long i;
+
+    if(format == IQ_Float) {
+        f32 = (const float *) raw;
+        for(i=0; i<n; i++)
+            out[i] = cfloat(f32[2*i], f32[2*i + 1]);
+    }
+    else {
+        s16 = (const qint16 *) raw;
+        for(i=0; i<n; i++)
+            out[i] = cfloat(s16[2*i] / 32768.0f, s16[2*i + 1] / 32768.0f);
+    }
+}
+
+//---------------------------------------------------------------------------
+bool TDemod::init(void)
+{
+    double sps;
+    int i;
+
+    if(sample_rate <= 0 || symbol_rate <= 0)
+        return false;
+
+    sps = sample_rate / symbol_rate; // input samples per symbol
+
+    if(type == SplitPhase_DemodType) {
+        // no pulse shaping, keep the main lobe of the half bits
+        if(!filter->design_lowpass(qMin(0.75 / sps, 0.45), (int) ceil(8 * sps) + 1))
+            return false;
+    }
+    else if(!filter->design_rrc(sps, 0.6, 8))
+        return false;
+
+    filter->setStep(sps / 2.0); // 2 samples per symbol
+
+    costas->setOrder(type == QPSK_DemodType ? 4:2);
+    costas->setBandwidth(costas_bw);
+    costas->reset();
+
+    gardner->setSps(2.0);
+    gardner->setBandwidth(gardner_bw);
+    gardner->reset();
+
+    gain = 0;
+    sp_pending = false;
+    sp_sym = sp_in = sp_cross = 0;
+    obyte = 0;
+    obits = 0;
+    symbols = 0;
+
+    raw_size = ((long) ceil(threads * DM_CHUNK_SIZE * filter->getStep()) + filter->getTaps() + 2) * sampleSize();
+
+    for(i=0; i<2; i++) {
+        if(raw[i])
+            free(raw[i]);
+        if(out[i])
+            free(out[i]);
+
+        raw[i] = (char *) malloc(raw_size);
+        out[i] = (cfloat *) malloc(threads * DM_CHUNK_SIZE * sizeof(cfloat));
+
+        if(raw[i] == NULL || out[i] == NULL)
+            return false;
+    }
+
+    if(sym_buf)
+        free(sym_buf);
+
+    sym_buf = (cfloat *) malloc(gardner->maxSymbols(DM_CHUNK_SIZE) * sizeof(cfloat));
+
+    return sym_buf != NULL ? true:false;
+}
+
+//---------------------------------------------------------------------------
+// reads the input of the outputs k0... and starts the workers of set
+// returns number of outputs in the batch
+long TDemod::startBatch(FILE *infp, int set, long k0)
+{
+    long k1, first, last, pos, n, ks, ke;
+    int  i, ss;
+
+    ss = sampleSize();
+
+    k1 = k0 + threads * DM_CHUNK_SIZE;
+    while(k1 > k0 && filter->lastInput(k1 - 1) >= in_samples)
+        k1 -= k1 - k0 > 1024 ? 1024:1;
+
+    if(k1 <= k0)
+        return 0;
+
+    first = filter->firstInput(k0);
+    last = filter->lastInput(k1 - 1);
+
+    // zero pad before the first sample
+    pos = first < 0 ? 0:first;
+    if(pos > first)
+        memset(raw[set], 0, (pos - first) * ss);
+
+    n = last - pos + 1;
+    if(fseek(infp, pos * ss, SEEK_SET) != 0 ||
+       (long) fread(raw[set] + (pos - first) * ss, ss, n, infp) != n)
+        return 0;
+
+    for(i=0; i<threads; i++) {
+        ks = k0 + i * DM_CHUNK_SIZE;
+        ke = qMin(ks + DM_CHUNK_SIZE, k1);
+
+        workers[set][i]->setup(raw[set], first, last - first + 1, ks, ke, out[set] + (ks - k0));
+
+        if(ks < ke)
+            workers[set][i]->start();
+    }
+
+    return k1 - k0;
+}
+
+//---------------------------------------------------------------------------
+bool TDemod::demodFile(FILE *infp, FILE *outfp)
+{
+    long k, n[2];
+    int  cur, i;
+
+    if(infp == NULL || outfp == NULL)
+        return false;
+
+    if(!init())
+        return false;
+
+    fseek(infp, 0, SEEK_END);
+    in_samples = ftell(infp) / sampleSize();
+
+    // start the loops locked, the Costas only tracks the residual
+    if(doppler) {
+        doppler->setSampleRate(sample_rate);
+
+        if(doppler->acquire(infp, this, type == QPSK_DemodType ? 4:2))
+            costas->setBandwidth(costas_bw * DM_LOCKED_BW);
+    }
+
+    k = 0;
+    cur = 0;
+    n[cur] = startBatch(infp, cur, k);
+
+    while(n[cur] > 0) {
+        for(i=0; i<threads; i++)
+            workers[cur][i]->wait();
+
+        k += n[cur];
+        n[cur ^ 1] = startBatch(infp, cur ^ 1, k);
+
+        symbolStage(out[cur], n[cur], outfp);
+
+        cur ^= 1;
+    }
+
+    // the last hard bits, padded with zeros
+    if(obits > 0) {
+        fputc(obyte << (8 - obits), outfp);
+        obyte = 0;
+        obits = 0;
+    }
+
+    fflush(outfp);
+
+#ifdef DEBUG_DEMOD
+    qDebug("Demodulated %ld symbols, %ld samples", symbols, in_samples);
+#endif
+
+    return symbols > 0 ? true:false;
+}
+
+//---------------------------------------------------------------------------
+void TDemod::symbolStage(cfloat *in, int len, FILE *outfp)
+{
+    double sum;
+    float  mag;
+    int    i, k, n, m;
+
+    if(gain <= 0) {
+        // start the AGC at the rms of the first batch
+        sum = 0;
+        for(i=0; i<len; i++)
+            sum += std::norm(in[i]);
+
+        gain = sum > 0 ? 1.0 / sqrt(sum / len):1.0;
+    }
+
+    for(i=0; i<len; i++) {
+        in[i] *= gain;
+
+        mag = std::abs(in[i]);
+        gain += DM_AGC_RATE * (1.0f - mag) * gain;
+    }
+
+    for(k=0; k<len; k+=DM_CHUNK_SIZE) {
+        m = qMin(DM_CHUNK_SIZE, len - k);
+
+        n = gardner->process(in + k, m, sym_buf);
+        costas->process(sym_buf, n);
+
+        writeSymbols(sym_buf, n, outfp);
+        symbols += n;
+    }
+}
+
+//---------------------------------------------------------------------------
+void TDemod::writeSymbols(const cfloat *sym, int len, FILE *outfp)
+{
+    float v, d;
+    int   i;
+
+    for(i=0; i<len; i++) {
+        switch(type) {
+        case QPSK_DemodType:
+            writeSoft(sym[i].real(), outfp);
+            writeSoft(sym[i].imag(), outfp);
+            break;
+
+        case BPSK_DemodType:
+            writeSoft(sym[i].real(), outfp);
+            break;
+
+        case SplitPhase_DemodType:
+            // a bit is the difference of two half bits, track which
+            // pairing has the larger transitions and slip if it is wrong
+            v = sym[i].real();
+            d = fabs(sp_sym - v);
+
+            if(sp_pending) {
+                sp_in = 0.999f * sp_in + d;
+                writeSoft((sp_sym - v) / 2.0f, outfp);
+            }
+            else
+                sp_cross = 0.999f * sp_cross + d;
+
+            sp_pending = !sp_pending;
+            sp_sym = v;
+
+            if(sp_cross > 1.5f * sp_in && sp_cross > 100) {
+                sp_pending = !sp_pending;
+                sp_in = sp_cross;
+                sp_cross = 0;
+            }
+            break;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+void TDemod::writeSoft(float v, FILE *outfp)
+{
+    int x;
+
+    if(hardBits()) {
+        obyte = (obyte << 1) | (v > 0 ? 1:0);
+        if(++obits == 8) {
+            fputc(obyte, outfp);
+            obyte = 0;
+            obits = 0;
+        }
+
+        return;
+    }
+
+    x = (int) floor(v * DM_SOFT_SCALE + 0.5f);
+    x = x < -128 ? -128:x > 127 ? 127:x;
+
+    fputc((qint8) x, outfp);
+}
+
+//---------------------------------------------------------------------------
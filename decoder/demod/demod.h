@@ -0,0 +1,146 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef DEMOD_H
+#define DEMOD_H
+
+#include <QtGlobal>
+#include <QThread>
+#include <stdio.h>
+
+#include "dsp.h"
+
+//---------------------------------------------------------------------------
+#define DM_HARD             1   // output packed hard bits, else 8 bit soft symbols
+
+#define DM_CHUNK_SIZE       65536 // output samples per worker and batch
+#define DM_MAX_THREADS      16
+#define DM_LOCKED_BW        0.25  // Costas bandwidth scale once the carrier is acquired
+
+typedef enum IQ_Format_t
+{
+    IQ_Int16 = 0,   // complex signed 16 bit, USRP default
+    IQ_Float        // complex 32 bit float
+} IQ_Format;
+#define NUM_IQ_FORMATS (IQ_Float + 1)
+
+typedef enum Demod_Type_t
+{
+    QPSK_DemodType = 0,
+    BPSK_DemodType,
+    SplitPhase_DemodType   // BPSK Manchester coded, HRPT
+} Demod_Type;
+
+class TPolyphase;
+class TCostas;
+class TGardner;
+class TDoppler;
+class TDemod;
+
+//---------------------------------------------------------------------------
+// converts and filters one slice of a batch
+class TDemodWorker : public QThread
+{
+public:
+    TDemodWorker(TDemod *demod_);
+    ~TDemodWorker(void);
+
+    void setup(const char *raw_, long base_, long samples_, long k0_, long k1_, cfloat *out_);
+    void run(void);
+
+private:
+    TDemod *demod;
+    const char *raw;
+    long   base, samples, k0, k1;
+    cfloat *out, *tmp;
+    long   tmp_size;
+};
+
+//---------------------------------------------------------------------------
+class TDemod
+{
+public:
+    TDemod(void);
+    ~TDemod(void);
+
+    void setFormat(IQ_Format format_) { format = format_; }
+    void setSampleRate(double rate) { sample_rate = rate; }
+    void setSymbolRate(double rate) { symbol_rate = rate; }
+    void setType(Demod_Type type_) { type = type_; }
+    void setThreads(int n);
+    void setLoopBandwidth(double costas_bw_, double gardner_bw_);
+
+    // carrier profile to remove before filtering, owned by the caller
+    void setDoppler(TDoppler *doppler_) { doppler = doppler_; }
+    TDoppler *getDoppler(void) { return doppler; }
+
+    void hardBits(bool enable);
+    bool hardBits(void) { return flags & DM_HARD ? true:false; }
+
+    int  sampleSize(void);
+    void toComplex(const char *raw, long n, cfloat *out);
+
+    bool demodFile(FILE *infp, FILE *outfp);
+
+    TPolyphase *getFilter(void) { return filter; }
+    long getSymbols(void) { return symbols; }
+
+protected:
+    bool init(void);
+    long startBatch(FILE *infp, int set, long k0);
+    void symbolStage(cfloat *in, int len, FILE *outfp);
+    void writeSymbols(const cfloat *sym, int len, FILE *outfp);
+    void writeSoft(float v, FILE *outfp);
+
+private:
+    int        flags, threads;
+    IQ_Format  format;
+    Demod_Type type;
+    double     sample_rate, symbol_rate;
+    double     costas_bw, gardner_bw;
+
+    TPolyphase *filter;
+    TCostas    *costas;
+    TGardner   *gardner;
+    TDoppler   *doppler;
+
+    // automatic gain control
+    float  gain;
+
+    // split phase, half bit pairing
+    bool   sp_pending;
+    float  sp_sym, sp_in, sp_cross;
+
+    // hard bit packing
+    quint8 obyte;
+    int    obits;
+
+    // double buffered batches
+    TDemodWorker *workers[2][DM_MAX_THREADS];
+    char   *raw[2];
+    cfloat *out[2];
+    long   raw_size, in_samples;
+
+    cfloat *sym_buf;
+    long   symbols;
+};
+
+#endif // DEMOD_H
@@ -0,0 +1,393 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <stdlib.h>
+#include <memory.h>
+#include <math.h>
+
+#include "doppler.h"
+#include "demod.h"
+#include "fft.h"
+#include "Satellite.h"
+#include "passephem.h"
+
+//---------------------------------------------------------------------------
+//#define DEBUG_DOPPLER
+
+//---------------------------------------------------------------------------
+/*
+  Carrier acquisition
+
+  The profile starts from the pass prediction, the range rate of the
+  satellite at the recording time gives the Doppler shift of the downlink.
+  The prediction is refined by measuring the residual carrier in blocks
+  spread over the recording, the modulation is removed by raising the
+  samples to the power of the PSK order and the FFT peak is at order times
+  the residual. The median residual is the local oscillator offset, blocks
+  far from it are rejected and the rest are interpolated over the profile.
+
+  The frequency is linear between the profile points so the phase is an
+  exact quadratic and any sample range can be mixed independently.
+*/
+//---------------------------------------------------------------------------
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+
+    return x < y ? -1:x > y ? 1:0;
+}
+
+//---------------------------------------------------------------------------
+TDoppler::TDoppler(void)
+{
+    freq = NULL;
+    cycles = NULL;
+    points = 0;
+    sample_rate = 0;
+
+    reset();
+}
+
+//---------------------------------------------------------------------------
+TDoppler::~TDoppler(void)
+{
+    if(freq)
+        free(freq);
+    if(cycles)
+        free(cycles);
+}
+
+//---------------------------------------------------------------------------
+void TDoppler::reset(void)
+{
+    flags = 0;
+    offset = 0;
+
+    if(freq)
+        memset(freq, 0, points * sizeof(double));
+    if(cycles)
+        memset(cycles, 0, points * sizeof(double));
+}
+
+//---------------------------------------------------------------------------
+void TDoppler::setflag(int flag, bool on)
+{
+    flags &= ~flag;
+    flags |= on ? flag:0;
+}
+
+//---------------------------------------------------------------------------
+bool TDoppler::alloc(double duration)
+{
+    int n;
+
+    n = (int) ceil(duration / DP_STEP) + 2;
+
+    if(n != points) {
+        if(freq)
+            free(freq);
+        if(cycles)
+            free(cycles);
+
+        points = n;
+        freq = (double *) malloc(points * sizeof(double));
+        cycles = (double *) malloc(points * sizeof(double));
+
+        if(freq == NULL || cycles == NULL) {
+            points = 0;
+            return false;
+        }
+    }
+
+    reset();
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TDoppler::predict(TSat *sat, double start, double duration)
+{
+    TPassEphem  ephem;
+    TPassSample s;
+    double      dn, dl, t;
+    int         i;
+
+    // Doppler is at the RF downlink, not at a down converted frequency
+    dl = sat->getDownlinkFreq(NULL);
+
+    if(sample_rate <= 0 || dl <= 0 || duration <= 0 || start <= 0)
+        return false;
+
+    if(!alloc(duration))
+        return false;
+
+    dn = sat->daynum;
+
+    // interpolated from a few second ephemeris instead of SGP4 per point
+    ephem.build(sat, start, start + ((points - 1) * DP_STEP) / 86400.0);
+
+    for(i=0; i<points; i++) {
+        t = start + (i * DP_STEP) / 86400.0;
+
+        if(ephem.interpolate(t, &s))
+            sat->sat_range_rate = s.range_rate;
+        else {
+            sat->daynum = t;
+            sat->Calc();
+        }
+
+        freq[i] = sat->getDoppler(dl * 1e6);
+    }
+
+    sat->daynum = dn;
+    sat->Calc();
+
+    integrate();
+    setflag(DP_PREDICTED, true);
+
+#ifdef DEBUG_DOPPLER
+    qDebug("Predicted Doppler %.0f Hz ... %.0f Hz @ %g MHz", freq[0], freq[points - 1], dl);
+#endif
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void TDoppler::integrate(void)
+{
+    int i;
+
+    cycles[0] = 0;
+    for(i=1; i<points; i++)
+        cycles[i] = cycles[i - 1] + 0.5 * (freq[i - 1] + freq[i]) * DP_STEP;
+}
+
+//---------------------------------------------------------------------------
+double TDoppler::frequency(double t) const
+{
+    double x;
+    int    i;
+
+    if(points < 2)
+        return 0;
+
+    x = t / DP_STEP;
+    i = x < 0 ? 0:x >= points - 1 ? points - 2:(int) x;
+    x -= i;
+
+    return freq[i] + (freq[i + 1] - freq[i]) * x;
+}
+
+//---------------------------------------------------------------------------
+double TDoppler::phase(long sample) const
+{
+    double t;
+    int    i;
+
+    if(points < 2)
+        return 0;
+
+    t = sample / sample_rate;
+    i = t < 0 ? 0:t >= (points - 1) * DP_STEP ? points - 2:(int) (t / DP_STEP);
+    t -= i * DP_STEP;
+
+    return cycles[i] + freq[i] * t + 0.5 * (freq[i + 1] - freq[i]) / DP_STEP * t * t;
+}
+
+//---------------------------------------------------------------------------
+void TDoppler::mix(cfloat *data, long first, long n) const
+{
+    std::complex<double> ph, rot;
+    double p0, p1;
+    long   i, j, m;
+
+    if(points < 2 || !(flags & (DP_PREDICTED | DP_ACQUIRED)))
+        return;
+
+    for(i=0; i<n; i+=DP_MIX_BLOCK) {
+        m = qMin((long) DP_MIX_BLOCK, n - i);
+
+        p0 = phase(first + i);
+        p1 = phase(first + i + m);
+
+        ph = std::polar(1.0, -DSP_2PI * (p0 - floor(p0)));
+        rot = std::polar(1.0, -DSP_2PI * (p1 - p0) / m);
+
+        for(j=0; j<m; j++) {
+            data[i + j] *= cfloat(ph.real(), ph.imag());
+            ph *= rot;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+bool TDoppler::acquire(FILE *infp, TDemod *demod, int order)
+{
+    TFFT   *fft;
+    cfloat *buf, x, y;
+    char   *raw;
+    double *bt, *br, *sorted, *p, peak, mean, delta, snr;
+    long   samples, pos, spacing;
+    int    i, k, n, ss, blocks, good, best, b;
+
+    if(infp == NULL || sample_rate <= 0 || order < 1)
+        return false;
+
+    ss = demod->sampleSize();
+
+    fseek(infp, 0, SEEK_END);
+    samples = ftell(infp) / ss;
+
+    fft = new TFFT(DP_FFT_LOG2);
+    n = fft->size();
+
+    if(n == 0 || samples < n) {
+        delete fft;
+        return false;
+    }
+
+    if(points < 2 && !alloc(samples / sample_rate)) {
+        delete fft;
+        return false;
+    }
+
+    blocks = (int) ((samples - n) / (sample_rate * DP_STEP)) + 1;
+    blocks = blocks > DP_MAX_BLOCKS ? DP_MAX_BLOCKS:blocks;
+    spacing = blocks > 1 ? (samples - n) / (blocks - 1):0;
+
+    raw = (char *) malloc(n * ss);
+    buf = (cfloat *) malloc(n * sizeof(cfloat));
+    p = (double *) malloc(n * sizeof(double));
+    bt = (double *) malloc(blocks * sizeof(double));
+    br = (double *) malloc(blocks * sizeof(double));
+    sorted = (double *) malloc(blocks * sizeof(double));
+
+    good = 0;
+
+    if(raw && buf && p && bt && br && sorted)
+        for(b=0; b<blocks; b++) {
+            pos = b * spacing;
+
+            if(fseek(infp, pos * ss, SEEK_SET) != 0 || (int) fread(raw, ss, n, infp) != n)
+                break;
+
+            demod->toComplex(raw, n, buf);
+            mix(buf, pos, n);
+
+            // strip the modulation
+            for(i=0; i<n; i++) {
+                x = y = buf[i];
+                for(k=1; k<order; k++)
+                    y *= x;
+
+                buf[i] = y;
+            }
+
+            fft->forward(buf);
+
+            best = 0;
+            mean = 0;
+            for(i=0; i<n; i++) {
+                p[i] = std::norm(buf[i]);
+                mean += p[i];
+
+                if(p[i] > p[best])
+                    best = i;
+            }
+
+            mean = (mean - p[best]) / (n - 1);
+            snr = mean > 0 ? p[best] / mean:0;
+
+            if(snr < DP_MIN_SNR)
+                continue;
+
+            // parabolic interpolation of the peak
+            peak = p[best];
+            delta = p[(best + n - 1) % n] - 2 * peak + p[(best + 1) % n];
+            delta = delta != 0 ? 0.5 * (p[(best + n - 1) % n] - p[(best + 1) % n]) / delta:0;
+
+            bt[good] = (pos + n / 2) / sample_rate;
+            br[good] = ((best > n / 2 ? best - n:best) + delta) * sample_rate / n / order;
+            good++;
+        }
+
+    if(good > 0) {
+        memcpy(sorted, br, good * sizeof(double));
+        qsort(sorted, good, sizeof(double), compare_double);
+        offset = sorted[good / 2];
+
+        // the prediction only leaves a nearly constant offset, reject
+        // blocks which locked to a spur
+        if(isPredicted()) {
+            for(b=0, k=0; b<good; b++)
+                if(fabs(br[b] - offset) <= DP_OUTLIER) {
+                    bt[k] = bt[b];
+                    br[k] = br[b];
+                    k++;
+                }
+        }
+        else
+            k = good;
+
+        // interpolate the residuals over the profile, hold at the ends
+        for(i=0, b=0; i<points && k > 0; i++) {
+            while(b < k - 1 && bt[b + 1] < i * DP_STEP)
+                b++;
+
+            if(i * DP_STEP <= bt[0] || k == 1)
+                freq[i] += br[0];
+            else if(b == k - 1)
+                freq[i] += br[k - 1];
+            else
+                freq[i] += br[b] + (br[b + 1] - br[b]) * (i * DP_STEP - bt[b]) / (bt[b + 1] - bt[b]);
+        }
+
+        integrate();
+        setflag(DP_ACQUIRED, k > 0);
+
+#ifdef DEBUG_DOPPLER
+        qDebug("Carrier acquired in %d of %d blocks, offset %.1f Hz", k, blocks, offset);
+#endif
+    }
+#ifdef DEBUG_DOPPLER
+    else
+        qDebug("Carrier acquisition failed, %d blocks", blocks);
+#endif
+
+    if(raw)
+        free(raw);
+    if(buf)
+        free(buf);
+    if(p)
+        free(p);
+    if(bt)
+        free(bt);
+    if(br)
+        free(br);
+    if(sorted)
+        free(sorted);
+
+    delete fft;
+
+    return isAcquired();
+}
+
+//---------------------------------------------------------------------------
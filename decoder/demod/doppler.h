@@ -0,0 +1,92 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef DOPPLER_H
+#define DOPPLER_H
+
+#include <QtGlobal>
+#include <stdio.h>
+
+#include "dsp.h"
+
+//---------------------------------------------------------------------------
+#define DP_PREDICTED        1   // profile is from the pass prediction
+#define DP_ACQUIRED         2   // profile is refined by the FFT search
+
+#define DP_STEP             1.0   // seconds between profile points
+#define DP_FFT_LOG2         16    // 65536 samples per acquisition block
+#define DP_MAX_BLOCKS       128   // acquisition blocks per recording
+#define DP_MIN_SNR          20.0  // peak to mean bin power of a valid block
+#define DP_OUTLIER          500.0 // Hz, max deviation from the median residual
+#define DP_MIX_BLOCK        1024  // samples per exact phase evaluation
+
+class TSat;
+class TDemod;
+
+//---------------------------------------------------------------------------
+// carrier frequency profile of an IQ recording, used to remove the Doppler
+// shift before the demodulator loops
+class TDoppler
+{
+public:
+    TDoppler(void);
+    ~TDoppler(void);
+
+    void reset(void);
+
+    void   setSampleRate(double rate) { sample_rate = rate; }
+    double getSampleRate(void) { return sample_rate; }
+
+    // predicts the profile of duration seconds starting at daynum start
+    bool predict(TSat *sat, double start, double duration);
+
+    // refines the profile by block wise FFT peak search of the signal
+    // raised to the power of order (2 = BPSK, 4 = QPSK)
+    bool acquire(FILE *infp, TDemod *demod, int order);
+
+    bool isPredicted(void) { return flags & DP_PREDICTED ? true:false; }
+    bool isAcquired(void) { return flags & DP_ACQUIRED ? true:false; }
+
+    // carrier offset in Hz at t seconds from the start of the recording
+    double frequency(double t) const;
+    // carrier phase in cycles at sample index
+    double phase(long sample) const;
+    // mean offset between the prediction and the signal, Hz
+    double getOffset(void) { return offset; }
+
+    // removes the carrier offset from n samples starting at sample index first
+    void mix(cfloat *data, long first, long n) const;
+
+protected:
+    bool alloc(double duration);
+    void integrate(void);
+    void setflag(int flag, bool on);
+
+private:
+    int    flags;
+    double sample_rate, offset;
+
+    // frequency (Hz) and accumulated phase (cycles) every DP_STEP seconds
+    double *freq, *cycles;
+    int    points;
+};
+
+#endif // DOPPLER_H
@@ -0,0 +1,85 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <stdlib.h>
+#include <math.h>
+
+#include "fft.h"
+
+//---------------------------------------------------------------------------
+TFFT::TFFT(int log2n_)
+{
+    int i, j, k;
+
+    log2n = log2n_;
+    n = 1 << log2n;
+
+    rev = (int *) malloc(n * sizeof(int));
+    twiddle = (cfloat *) malloc((n / 2) * sizeof(cfloat));
+
+    if(rev == NULL || twiddle == NULL) {
+        n = 0;
+        return;
+    }
+
+    for(i=0; i<n; i++) {
+        for(j=0, k=0; k<log2n; k++)
+            j |= ((i >> k) & 1) << (log2n - 1 - k);
+
+        rev[i] = j;
+    }
+
+    for(i=0; i<n/2; i++)
+        twiddle[i] = cfloat(cos(DSP_2PI * i / n), -sin(DSP_2PI * i / n));
+}
+
+//---------------------------------------------------------------------------
+TFFT::~TFFT(void)
+{
+    if(rev)
+        free(rev);
+    if(twiddle)
+        free(twiddle);
+}
+
+//---------------------------------------------------------------------------
+void TFFT::forward(cfloat *data)
+{
+    cfloat t;
+    int    i, j, k, half, stride;
+
+    for(i=0; i<n; i++)
+        if(rev[i] > i) {
+            t = data[i];
+            data[i] = data[rev[i]];
+            data[rev[i]] = t;
+        }
+
+    for(half=1, stride=n/2; half<n; half<<=1, stride>>=1)
+        for(i=0; i<n; i+=2*half)
+            for(j=0, k=0; j<half; j++, k+=stride) {
+                t = data[i + j + half] * twiddle[k];
+                data[i + j + half] = data[i + j] - t;
+                data[i + j] += t;
+            }
+}
+
+//---------------------------------------------------------------------------
@@ -1,6 +1,6 @@
 /*
     POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
-    Copyright (C) 2009-2011 Free Software Foundation, Inc.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -19,25 +19,26 @@
     Web: <http://www.poes-weather.com>
 */
 //---------------------------------------------------------------------------
-#ifndef JRKLUT_H
-#define JRKLUT_H
+#ifndef FFT_H
+#define FFT_H
 
-class JrkLUT
+#include "dsp.h"
+
+//---------------------------------------------------------------------------
+// in place radix-2 complex FFT, size is a power of two
+class TFFT
 {
 public:
-    JrkLUT(void);
-    JrkLUT(unsigned short _target, double _degrees);
-    ~JrkLUT();
-
-    unsigned short target(void) { return target_; }
-    void target(unsigned short _target);
+    TFFT(int log2n_);
+    ~TFFT(void);
 
-    double degrees(void) { return degrees_; }
-    void degrees(double _degrees);
+    int  size(void) { return n; }
+    void forward(cfloat *data);
 
-protected:
-    unsigned short target_;
-    double degrees_;
+private:
+    int    log2n, n;
+    int    *rev;
+    cfloat *twiddle;
 };
 
-#endif // JRKLUT_H
+#endif // FFT_H
@@ -0,0 +1,153 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <stdlib.h>
+#include <memory.h>
+#include <math.h>
+
+#include "gardner.h"
+
+//---------------------------------------------------------------------------
+TGardner::TGardner(void)
+{
+    buf = NULL;
+    buf_size = 0;
+    sps = 2;
+
+    setBandwidth(0.01);
+    reset();
+}
+
+//---------------------------------------------------------------------------
+TGardner::~TGardner(void)
+{
+    if(buf)
+        free(buf);
+}
+
+//---------------------------------------------------------------------------
+void TGardner::reset(void)
+{
+    buf_len = 0;
+    omega = sps;
+    pos = sps + 2; // room for the mid sample and the interpolator
+    prev = cfloat(0, 0);
+}
+
+//---------------------------------------------------------------------------
+void TGardner::setSps(double sps_)
+{
+    sps = sps_ < 2 ? 2:sps_;
+    omega = sps;
+}
+
+//---------------------------------------------------------------------------
+void TGardner::setBandwidth(double bw)
+{
+    double w = DSP_2PI * bw;
+    double damping = sqrt(2.0) / 2.0;
+    double denom = 1.0 + 2.0 * damping * w + w * w;
+
+    gain_mu = (4.0 * damping * w) / denom;
+    gain_omega = (4.0 * w * w) / denom;
+}
+
+//---------------------------------------------------------------------------
+// cubic (Catmull-Rom) interpolation at buffer time t
+cfloat TGardner::interp(double t)
+{
+    int    n = (int) floor(t);
+    float  mu = (float) (t - n);
+    cfloat y0 = buf[n - 1], y1 = buf[n], y2 = buf[n + 1], y3 = buf[n + 2];
+
+    return y1 + 0.5f * mu * ((y2 - y0) +
+                             mu * ((2.0f * y0 - 5.0f * y1 + 4.0f * y2 - y3) +
+                                   mu * (3.0f * (y1 - y2) + y3 - y0)));
+}
+
+//---------------------------------------------------------------------------
+// the shortest step is the lowest omega less the largest phase correction,
+// less than 3 samples are carried over from the previous call
+int TGardner::maxSymbols(int len)
+{
+    double step = sps * 0.995 - gain_mu;
+
+    if(step < 1)
+        step = 1;
+
+    return (int) ceil((len + 3) / step) + 1;
+}
+
+//---------------------------------------------------------------------------
+int TGardner::process(const cfloat *in, int len, cfloat *out)
+{
+    cfloat sym, mid;
+    double e;
+    int    n, k;
+
+    if(buf_len + len > buf_size) {
+        buf_size = buf_len + len + 64;
+        buf = (cfloat *) realloc(buf, buf_size * sizeof(cfloat));
+        if(buf == NULL) {
+            buf_size = 0;
+            buf_len = 0;
+            return 0;
+        }
+    }
+
+    memcpy(buf + buf_len, in, len * sizeof(cfloat));
+    buf_len += len;
+
+    n = 0;
+    while(pos + 3 < buf_len) {
+        sym = interp(pos);
+        mid = interp(pos - omega / 2.0);
+
+        e = (prev.real() - sym.real()) * mid.real() + (prev.imag() - sym.imag()) * mid.imag();
+        if(e > 1)
+            e = 1;
+        else if(e < -1)
+            e = -1;
+
+        out[n++] = sym;
+        prev = sym;
+
+        omega += gain_omega * e;
+        if(omega > sps * 1.005)
+            omega = sps * 1.005;
+        else if(omega < sps * 0.995)
+            omega = sps * 0.995;
+
+        pos += omega + gain_mu * e;
+    }
+
+    // keep the samples still needed for interpolation
+    k = (int) floor(pos - omega) - 2;
+    if(k > 0) {
+        memmove(buf, buf + k, (buf_len - k) * sizeof(cfloat));
+        buf_len -= k;
+        pos -= k;
+    }
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,58 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef GARDNER_H
+#define GARDNER_H
+
+#include "dsp.h"
+
+//---------------------------------------------------------------------------
+// Gardner symbol timing recovery with cubic interpolation
+class TGardner
+{
+public:
+    TGardner(void);
+    ~TGardner(void);
+
+    void reset(void);
+
+    // nominal input samples per symbol, >= 2
+    void setSps(double sps_);
+    // loop bandwidth normalized to the symbol rate
+    void setBandwidth(double bw);
+
+    // most symbols process() can write for len input samples
+    int  maxSymbols(int len);
+
+    // returns number of symbols written to out, out must hold maxSymbols(len) symbols
+    int  process(const cfloat *in, int len, cfloat *out);
+
+protected:
+    cfloat interp(double t);
+
+private:
+    cfloat *buf, prev;
+    int    buf_len, buf_size;
+    double sps, omega, pos;
+    double gain_mu, gain_omega;
+};
+
+#endif // GARDNER_H
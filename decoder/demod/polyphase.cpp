@@ -0,0 +1,250 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QtGlobal>
+
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+#include <stdlib.h>
+#include <memory.h>
+#include <math.h>
+
+#include "polyphase.h"
+
+//---------------------------------------------------------------------------
+/*
+  Output k is at input time t = k * step, n = floor(t) and phase p = frac(t) * PP_PHASES.
+  Tap i of phase p multiplies input n - taps/2 + 1 + i.
+
+  The taps are stored twice, [h0 h0 h1 h1 ...], to multiply the
+  interleaved re/im input directly in the SIMD dot product.
+*/
+//---------------------------------------------------------------------------
+TPolyphase::TPolyphase(void)
+{
+    bank = NULL;
+    taps = 0;
+    step = 1.0;
+}
+
+//---------------------------------------------------------------------------
+TPolyphase::~TPolyphase(void)
+{
+    if(bank)
+        free(bank);
+}
+
+//---------------------------------------------------------------------------
+bool TPolyphase::alloc(int ntaps)
+{
+    if(bank)
+        free(bank);
+
+    taps = (ntaps + 3) & ~3; // multiple of 4 complex
+    bank = (float *) calloc(PP_PHASES * 2 * taps, sizeof(float));
+
+    return bank != NULL ? true:false;
+}
+
+//---------------------------------------------------------------------------
+static double blackman(double t, double half)
+{
+    if(fabs(t) >= half)
+        return 0;
+
+    return 0.42 + 0.5 * cos(M_PI * t / half) + 0.08 * cos(DSP_2PI * t / half);
+}
+
+//---------------------------------------------------------------------------
+bool TPolyphase::design_rrc(double sps, double alpha, int span)
+{
+    double t, ts, h, x;
+    int    p, i;
+
+    if(sps <= 0 || alpha <= 0 || alpha > 1 || span <= 0)
+        return false;
+
+    if(!alloc((int) ceil(sps * span) + 1))
+        return false;
+
+    for(p=0; p<PP_PHASES; p++)
+        for(i=0; i<taps; i++) {
+            t = (double) p / PP_PHASES + taps/2 - 1 - i;
+            ts = t / sps;
+
+            if(fabs(ts) < 1e-8)
+                h = 1.0 - alpha + 4.0 * alpha / M_PI;
+            else if(fabs(fabs(ts) - 1.0 / (4.0 * alpha)) < 1e-8)
+                h = alpha / sqrt(2.0) * ((1.0 + 2.0 / M_PI) * sin(M_PI / (4.0 * alpha)) +
+                                         (1.0 - 2.0 / M_PI) * cos(M_PI / (4.0 * alpha)));
+            else {
+                x = 4.0 * alpha * ts;
+                h = (sin(M_PI * ts * (1.0 - alpha)) + x * cos(M_PI * ts * (1.0 + alpha))) /
+                    (M_PI * ts * (1.0 - x * x));
+            }
+
+            h *= blackman(t, taps / 2.0);
+
+            bank[p*2*taps + 2*i] = h;
+            bank[p*2*taps + 2*i + 1] = h;
+        }
+
+    normalize();
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TPolyphase::design_lowpass(double cutoff, int ntaps)
+{
+    double t, h;
+    int    p, i;
+
+    if(cutoff <= 0 || cutoff > 0.5 || ntaps <= 0)
+        return false;
+
+    if(!alloc(ntaps))
+        return false;
+
+    for(p=0; p<PP_PHASES; p++)
+        for(i=0; i<taps; i++) {
+            t = (double) p / PP_PHASES + taps/2 - 1 - i;
+
+            if(fabs(t) < 1e-8)
+                h = 2.0 * cutoff;
+            else
+                h = sin(DSP_2PI * cutoff * t) / (M_PI * t);
+
+            h *= blackman(t, taps / 2.0);
+
+            bank[p*2*taps + 2*i] = h;
+            bank[p*2*taps + 2*i + 1] = h;
+        }
+
+    normalize();
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// unity DC gain for every phase
+void TPolyphase::normalize(void)
+{
+    double sum;
+    float  *h;
+    int    p, i;
+
+    for(p=0; p<PP_PHASES; p++) {
+        h = bank + p*2*taps;
+
+        sum = 0;
+        for(i=0; i<taps; i++)
+            sum += h[2*i];
+
+        if(fabs(sum) < 1e-12)
+            continue;
+
+        for(i=0; i<2*taps; i++)
+            h[i] /= sum;
+    }
+}
+
+//---------------------------------------------------------------------------
+long TPolyphase::firstInput(long k)
+{
+    return (long) floor(k * step) - taps/2 + 1;
+}
+
+//---------------------------------------------------------------------------
+long TPolyphase::lastInput(long k)
+{
+    return (long) floor(k * step) + taps/2;
+}
+
+//---------------------------------------------------------------------------
+void TPolyphase::filter(const cfloat *in, long base, long k0, long k1, cfloat *out)
+{
+    const float *x, *h;
+    double t, n;
+    long   k;
+    int    p, i;
+
+    if(bank == NULL)
+        return;
+
+    for(k=k0; k<k1; k++) {
+        t = k * step;
+        n = floor(t);
+        p = (int) ((t - n) * PP_PHASES);
+        if(p >= PP_PHASES)
+            p = PP_PHASES - 1;
+
+        x = (const float *) (in + ((long) n - taps/2 + 1 - base));
+        h = bank + p*2*taps;
+
+#if defined(__AVX2__)
+
+        __m256 acc = _mm256_setzero_ps();
+        __m128 lo;
+
+        for(i=0; i<2*taps; i+=8)
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(h + i)));
+
+        lo = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo)); // re im re im -> re im
+
+        out[k - k0] = cfloat(_mm_cvtss_f32(lo), _mm_cvtss_f32(_mm_shuffle_ps(lo, lo, 1)));
+
+#elif defined(__SSE2__)
+
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+
+        for(i=0; i<2*taps; i+=8) {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(h + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(h + i + 4)));
+        }
+
+        acc0 = _mm_add_ps(acc0, acc1);
+        acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+
+        out[k - k0] = cfloat(_mm_cvtss_f32(acc0), _mm_cvtss_f32(_mm_shuffle_ps(acc0, acc0, 1)));
+
+#else
+
+        float re = 0, im = 0;
+
+        for(i=0; i<2*taps; i+=2) {
+            re += x[i] * h[i];
+            im += x[i + 1] * h[i + 1];
+        }
+
+        out[k - k0] = cfloat(re, im);
+
+#endif
+    }
+}
+
+//---------------------------------------------------------------------------
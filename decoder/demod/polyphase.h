@@ -0,0 +1,66 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef POLYPHASE_H
+#define POLYPHASE_H
+
+#include "dsp.h"
+
+//---------------------------------------------------------------------------
+#define PP_PHASES   128 // filter bank phases
+
+//---------------------------------------------------------------------------
+// fractional resampler, complex input with a real filter bank
+class TPolyphase
+{
+public:
+    TPolyphase(void);
+    ~TPolyphase(void);
+
+    // sps is input samples per symbol, span in symbols
+    bool design_rrc(double sps, double alpha, int span);
+    // cutoff is normalized to the input sample rate, 0...0.5
+    bool design_lowpass(double cutoff, int ntaps);
+
+    // input samples per output sample
+    void   setStep(double step_) { step = step_; }
+    double getStep(void) { return step; }
+
+    int  getTaps(void) { return taps; }
+
+    // first and last input sample index needed by output k
+    long firstInput(long k);
+    long lastInput(long k);
+
+    // computes the outputs k0...k1-1, in[0] is input sample index base
+    void filter(const cfloat *in, long base, long k0, long k1, cfloat *out);
+
+protected:
+    bool alloc(int ntaps);
+    void normalize(void);
+
+private:
+    float  *bank; // PP_PHASES * 2 * taps, each tap is duplicated for re and im
+    int    taps;
+    double step;
+};
+
+#endif // POLYPHASE_H
@@ -24,6 +24,10 @@
 #include <stdlib.h>
 #include "fy1hrptblock.h"
 #include "block.h"
+#include "synccorrelator.h"
+
+//---------------------------------------------------------------------------
+//#define DEBUG_HRPT
 
 //---------------------------------------------------------------------------
 /*
@@ -73,6 +77,11 @@ TFY1HRPT::TFY1HRPT(TBlock *_block)
 
   scanLine = NULL;
   fp = NULL;
+
+  // 60 bit sync of six 10 bit words
+  correlator = new TSyncCorrelator;
+  correlator->setSync(FY1_HRPT_SYNC, FY1_HRPT_SYNC_SIZE, 10);
+  correlator->setPeriod(FY1_HRPT_BLOCK_SIZE << 1);
 }
 
 //---------------------------------------------------------------------------
@@ -80,6 +89,8 @@ TFY1HRPT::~TFY1HRPT(void)
 {
   if(scanLine)
      free(scanLine);
+
+  delete correlator;
 }
 
 //---------------------------------------------------------------------------
@@ -141,11 +152,16 @@ int TFY1HRPT::countFrames(void)
   frames = 0;
   sync_found = false;
 
+  correlator->reset();
+  correlator->setLittleEndian(block->isLittleEndian());
+  correlator->setMaxErrors(block->satprop->syncErrors());
+
   while(findFrameSync()) {
      // we just read 6 words, FY1_HRPT_SYNC_SIZE
      if(frames == 0)
         firstFrameSyncPos = ftell(fp) - syncSize;
 
+     block->setFrameConfidence(frames, correlator->getConfidence());
      ++frames;
 
      // hop to next frame
@@ -158,51 +174,19 @@ int TFY1HRPT::countFrames(void)
   block->setFrames(frames);
   block->setFirstFrameSyncPos(firstFrameSyncPos);
 
+#ifdef DEBUG_HRPT
+  if(frames > 0)
+     qDebug("FY-1 HRPT frames: %d, corrected syncs: %ld, flywheel: %ld",
+            frames, correlator->getCorrected(), correlator->getCoasted());
+#endif
+
  return frames;
 }
 
 //---------------------------------------------------------------------------
 bool TFY1HRPT::findFrameSync(void)
 {
- quint8  ch[2];
- quint16 w;
- int i;
-
-#if 0
-
- // flush the sync and continue
- if(sync_found) {
-     i = 0;
-     while(fread(ch, sizeof(ch), 1, fp) == 1) {
-         i++;
-
-         if(i == FY1_HRPT_SYNC_SIZE)
-            return true;
-     }
-
-     return false;
-
- }
-
-#endif
-
-  i = 0;
-  while(fread(ch, sizeof(ch), 1, fp) == 1) {
-     if(block->isLittleEndian())
-        w = (ch[1] << 8) | ch[0];
-     else
-        w = (ch[0] << 8) | ch[1];
-        
-     if(w == FY1_HRPT_SYNC[i])
-        i++;
-     else
-        i = 0;
-
-     if(i == FY1_HRPT_SYNC_SIZE)
-        return true;
-  }
-
- return false;
+  return correlator->find(fp);
 }
 
 //---------------------------------------------------------------------------
@@ -41,6 +41,7 @@
 
 class QImage;
 class TBlock;
+class TSyncCorrelator;
 
 //---------------------------------------------------------------------------
 class TFY1HRPT
@@ -75,6 +76,8 @@ class TFY1HRPT
     FILE    *fp;
 
     quint16 *scanLine;
+
+    TSyncCorrelator *correlator;
 };
 
 //---------------------------------------------------------------------------
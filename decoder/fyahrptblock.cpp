@@ -108,6 +108,8 @@ bool TFYAHRPT::init(void)
 
     fp = block->getHandle();
 
+    cadu->sync_errors(block->satprop->syncErrors());
+
     if(!cadu->init(fp, FY_AHRPT_CADU_SIZE - CADU_SYNC_SIZE)) // CCSDS size, 1020 bytes
         return false;
 
@@ -187,6 +189,7 @@ long TFYAHRPT::count_AVHRR_HR_frames(void)
         if(frames == 0)
             block->setFirstFrameSyncPos(cadu->getpacketaddress());
 
+        block->setFrameConfidence(frames, cadu->getconfidence());
         frames++;
     }
 
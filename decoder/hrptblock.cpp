@@ -24,6 +24,11 @@
 #include <stdlib.h>
 #include "hrptblock.h"
 #include "block.h"
+#include "synccorrelator.h"
+#include "bitsync.h"
+
+//---------------------------------------------------------------------------
+//#define DEBUG_HRPT
 
 //---------------------------------------------------------------------------
 /*
@@ -66,6 +71,18 @@ THRPT::THRPT(TBlock *_block)
   datatype = UNPACKED16BIT;
   scanLine = NULL;
   fp = NULL;
+
+  // 60 bit sync of six 10 bit words
+  correlator = new TSyncCorrelator;
+  correlator->setSync(HRPT_SYNC, HRPT_SYNC_SIZE, 10);
+  correlator->setPeriod(HRPT_BLOCK_SIZE << 1);
+
+  bitsync = new TBitSync;
+  bitsync->setSync(HRPT_SYNC, HRPT_SYNC_SIZE, 10);
+  bitsync->setPeriod(HRPT_BLOCK_SIZE * 10);
+
+  frameTable = NULL;
+  frameTableSize = 0;
 }
 
 //---------------------------------------------------------------------------
@@ -73,6 +90,12 @@ THRPT::~THRPT(void)
 {
   if(scanLine)
      free(scanLine);
+
+  if(frameTable)
+     free(frameTable);
+
+  delete correlator;
+  delete bitsync;
 }
 
 //---------------------------------------------------------------------------
@@ -89,12 +112,21 @@ bool THRPT::init(void)
      scanLine = (quint16 *) malloc(HRPT_SCAN_SIZE << 1); // 20480 bytes
 
   fp = block->getHandle();
+  datatype = UNPACKED16BIT;
+
   if(countFrames() <= 0) {
      // retry using different endian
      block->setLittleEndian(!block->isLittleEndian());
      countFrames();
   }
 
+  if(!check(1)) {
+     // not 16 bit words, try a packed bitstream
+     block->setLittleEndian(true);
+     datatype = PACKED10BIT;
+     countFrames();
+  }
+
   return check(1);
 }
 
@@ -127,6 +159,9 @@ int THRPT::countFrames(void)
   if(check(1)) // already done
      return block->getFrames();
 
+  if(datatype == PACKED10BIT)
+     return countBitFrames();
+
   block->gotoStart();
 
   syncSize = HRPT_SYNC_SIZE << 1; // 12 bytes
@@ -134,11 +169,16 @@ int THRPT::countFrames(void)
   block->syncFound(false);
   frames = 0;
 
+  correlator->reset();
+  correlator->setLittleEndian(block->isLittleEndian());
+  correlator->setMaxErrors(block->satprop->syncErrors());
+
   while(findFrameSync()) {
      // we just read 6 words, HRPT_SYNC_SIZE
      if(frames == 0)
         firstFrameSyncPos = ftell(fp) - syncSize;
 
+     block->setFrameConfidence(frames, block->satprop->syncCheck() ? correlator->getConfidence():100);
      ++frames;
 
      // hop to next frame
@@ -151,42 +191,88 @@ int THRPT::countFrames(void)
   block->setFrames(frames);
   block->setFirstFrameSyncPos(firstFrameSyncPos);
 
+#ifdef DEBUG_HRPT
+  if(frames > 0 && block->satprop->syncCheck())
+     qDebug("HRPT frames: %d, corrected syncs: %ld, flywheel: %ld",
+            frames, correlator->getCorrected(), correlator->getCoasted());
+#endif
+
+ return frames;
+}
+
+//---------------------------------------------------------------------------
+int THRPT::countBitFrames(void)
+{
+ int frames;
+
+  frames = 0;
+  block->syncFound(false);
+
+  bitsync->reset();
+  bitsync->setMaxErrors(block->satprop->syncErrors());
+
+  while(bitsync->next(fp)) {
+     if(!addFrame(frames, bitsync->getPosition(), bitsync->isInverted()))
+        break;
+
+     block->setFrameConfidence(frames, bitsync->getConfidence());
+     ++frames;
+
+     block->syncFound(true);
+  }
+
+  // the frames are read from the frame table
+  block->setFrames(frames);
+  block->setFirstFrameSyncPos(frames > 0 ? (long int) (frameTable[0].pos >> 3):-1);
+
+#ifdef DEBUG_HRPT
+  if(frames > 0)
+     qDebug("HRPT bitstream frames: %d, first sync @ bit %lld%s, corrected syncs: %ld, flywheel: %ld, bit slips: %ld",
+            frames, (long long) frameTable[0].pos, frameTable[0].inverted ? " (inverted)":"",
+            bitsync->getCorrected(), bitsync->getCoasted(), bitsync->getSlips());
+#endif
+
  return frames;
 }
 
+//---------------------------------------------------------------------------
+bool THRPT::addFrame(int frame_nr, qint64 pos, bool inverted)
+{
+ HRPT_Frame *p;
+ int size;
+
+  if(frame_nr >= frameTableSize) {
+     size = frameTableSize + 1024;
+     p = (HRPT_Frame *) realloc(frameTable, size * sizeof(HRPT_Frame));
+     if(p == NULL)
+        return false;
+
+     frameTable = p;
+     frameTableSize = size;
+  }
+
+  frameTable[frame_nr].pos = pos;
+  frameTable[frame_nr].inverted = inverted;
+
+ return true;
+}
+
 //---------------------------------------------------------------------------
 bool THRPT::findFrameSync(void)
 {
-    quint8  ch[2];
-    quint16 w;
+    quint8 ch[2];
     int i;
 
-    if(block->satprop->syncCheck()) {
-        i = 0;
-        while(fread(ch, sizeof(ch), 1, fp) == 1) {
-           if(block->isLittleEndian())
-              w = (ch[1] << 8) | ch[0];
-           else
-              w = (ch[0] << 8) | ch[1];
-
-           if(w == HRPT_SYNC[i])
-              i++;
-           else
-              i = 0;
-
-           if(i == HRPT_SYNC_SIZE)
-              return true;
-        }
-    }
-    else {
-        // no sync check, flush the sync
-        i = 0;
-        while(fread(ch, sizeof(ch), 1, fp) == 1) {
-            i++;
-
-            if(i == HRPT_SYNC_SIZE)
-               return true;
-        }
+    if(block->satprop->syncCheck())
+        return correlator->find(fp);
+
+    // no sync check, flush the sync
+    i = 0;
+    while(fread(ch, sizeof(ch), 1, fp) == 1) {
+        i++;
+
+        if(i == HRPT_SYNC_SIZE)
+           return true;
     }
 
  return false;
@@ -214,6 +300,14 @@ bool THRPT::readFrameScanLine(int frame_nr)
   if(!check(1))
      return false;
 
+  if(datatype == PACKED10BIT) {
+     if(frame_nr < 0 || frame_nr >= block->getFrames())
+        return false;
+
+     return bitsync->readWords(fp, frameTable[frame_nr].pos + HRPT_IMAGE_START * 10,
+                               scanLine, HRPT_SCAN_SIZE, frameTable[frame_nr].inverted);
+  }
+
   pos = ftell(fp);
   if(pos < 0)
      return false;
@@ -227,7 +321,6 @@ bool THRPT::readFrameScanLine(int frame_nr)
         fseek(fp, scanPos - pos, SEEK_CUR);
   }
 
-  // todo: implement different packing features
   if(fread(scanLine, HRPT_SCAN_SIZE << 1, 1, fp) != 1)
      return false;
 
@@ -40,13 +40,21 @@ typedef enum HRPT_DataType_t
 {
   UNPACKED16BIT,
   UNPACKED8BIT,
-  PACKED10BIT
+  PACKED10BIT    // msb first bitstream at any bit offset, also the demodulator hard bits
 } HRPT_DataType;
 
+typedef struct HRPT_Frame_t
+{
+  qint64 pos;    // bit position of the frame sync
+  bool inverted;
+} HRPT_Frame;
+
 //---------------------------------------------------------------------------
 
 class QImage;
 class TBlock;
+class TSyncCorrelator;
+class TBitSync;
 
 //---------------------------------------------------------------------------
 class THRPT
@@ -74,12 +82,21 @@ class THRPT
  protected:
     bool check(int flags=0);
     bool findFrameSync(void);
+    int  countBitFrames(void);
+    bool addFrame(int frame_nr, qint64 pos, bool inverted);
 
  private:
     TBlock  *block;
     FILE    *fp;
 
     quint16 *scanLine;
+
+    TSyncCorrelator *correlator;
+    TBitSync        *bitsync;
+
+    // frame positions of a bitstream
+    HRPT_Frame *frameTable;
+    int        frameTableSize;
 };
 
 //---------------------------------------------------------------------------
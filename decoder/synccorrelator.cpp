@@ -0,0 +1,273 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <stdlib.h>
+#include <memory.h>
+
+#include "synccorrelator.h"
+
+//---------------------------------------------------------------------------
+/*
+  The units are shifted into a 64 bit window and the Hamming distance to the
+  sync is the popcount of the masked xor, one compare per unit regardless of
+  the sync length.
+
+  Once a sync is found the next one is expected one frame period later, it is
+  checked there with the more tolerant locked threshold. If it still does not
+  match the frame is accepted on the period (flywheel) for SC_FLYWHEEL frames
+  before the correlator falls back to searching.
+*/
+//---------------------------------------------------------------------------
+TSyncCorrelator::TSyncCorrelator(void)
+{
+    flags = SC_LITTLE_ENDIAN;
+    pattern = 0;
+    mask = 0;
+    units = 0;
+    unit_bits = 8;
+    unit_size = 1;
+    bits = 0;
+    max_errors = 0;
+    locked_errors = 0;
+    period = 0;
+
+    buf = (quint8 *) malloc(SC_READ_SIZE);
+
+    reset();
+}
+
+//---------------------------------------------------------------------------
+TSyncCorrelator::~TSyncCorrelator(void)
+{
+    if(buf)
+        free(buf);
+}
+
+//---------------------------------------------------------------------------
+void TSyncCorrelator::reset(void)
+{
+    setflag(SC_LOCKED, false);
+
+    errors = 0;
+    coast = 0;
+    position = -1;
+    expected = -1;
+    syncs = 0;
+    corrected = 0;
+    coasted = 0;
+}
+
+//---------------------------------------------------------------------------
+void TSyncCorrelator::setflag(int flag, bool on)
+{
+    flags &= ~flag;
+    flags |= on ? flag:0;
+}
+
+//---------------------------------------------------------------------------
+void TSyncCorrelator::setLittleEndian(bool on)
+{
+    setflag(SC_LITTLE_ENDIAN, on);
+}
+
+//---------------------------------------------------------------------------
+void TSyncCorrelator::setSync(const quint16 *sync, int units_, int unit_bits_)
+{
+    int i;
+
+    units = units_;
+    unit_bits = unit_bits_;
+    unit_size = 2;
+    bits = units * unit_bits;
+
+    pattern = 0;
+    for(i=0; i<units; i++)
+        pattern = (pattern << unit_bits) | (sync[i] & ((1 << unit_bits) - 1));
+
+    mask = bits >= 64 ? ~((quint64) 0):(((quint64) 1) << bits) - 1;
+
+    setMaxErrors(max_errors);
+    reset();
+}
+
+//---------------------------------------------------------------------------
+void TSyncCorrelator::setSync(const quint8 *sync, int units_)
+{
+    int i;
+
+    units = units_;
+    unit_bits = 8;
+    unit_size = 1;
+    bits = units * unit_bits;
+
+    pattern = 0;
+    for(i=0; i<units; i++)
+        pattern = (pattern << 8) | sync[i];
+
+    mask = bits >= 64 ? ~((quint64) 0):(((quint64) 1) << bits) - 1;
+
+    setMaxErrors(max_errors);
+    reset();
+}
+
+//---------------------------------------------------------------------------
+void TSyncCorrelator::setMaxErrors(int search, int locked)
+{
+    max_errors = search < 0 ? 0:search;
+    locked_errors = locked < 0 ? bits / 4:locked;
+
+    if(locked_errors < max_errors)
+        locked_errors = max_errors;
+}
+
+//---------------------------------------------------------------------------
+int TSyncCorrelator::popcount64(quint64 x)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+
+    return (int) ((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+//---------------------------------------------------------------------------
+int TSyncCorrelator::getConfidence(void)
+{
+    int half = bits / 2;
+
+    if(half <= 0 || errors >= half)
+        return 0;
+
+    return (100 * (half - errors)) / half;
+}
+
+//---------------------------------------------------------------------------
+quint64 TSyncCorrelator::unit(const quint8 *p)
+{
+    if(unit_size == 1)
+        return p[0];
+    else if(flags & SC_LITTLE_ENDIAN)
+        return ((p[1] << 8) | p[0]) & ((1 << unit_bits) - 1);
+    else
+        return ((p[0] << 8) | p[1]) & ((1 << unit_bits) - 1);
+}
+
+//---------------------------------------------------------------------------
+bool TSyncCorrelator::find(FILE *fp)
+{
+    if(fp == NULL || buf == NULL || units <= 0)
+        return false;
+
+    if((flags & SC_LOCKED) && period > 0 && ftell(fp) == expected)
+        return check(fp);
+
+    return scan(fp);
+}
+
+//---------------------------------------------------------------------------
+// checks the sync at the expected position, the file is positioned there
+bool TSyncCorrelator::check(FILE *fp)
+{
+    quint64 w;
+    int i;
+
+    if((int) fread(buf, unit_size, units, fp) != units)
+        return false;
+
+    for(i=0, w=0; i<units; i++)
+        w = (w << unit_bits) | unit(buf + i * unit_size);
+
+    errors = popcount64((w ^ pattern) & mask);
+
+    if(errors <= locked_errors)
+        coast = 0;
+    else if(coast < SC_FLYWHEEL) {
+        coast++;
+        coasted++;
+    }
+    else {
+        // lost, search from here
+        setflag(SC_LOCKED, false);
+        coast = 0;
+        fseek(fp, expected, SEEK_SET);
+
+        return scan(fp);
+    }
+
+    position = expected;
+    expected = position + period;
+    syncs++;
+    corrected += errors > 0 && coast == 0 ? 1:0;
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TSyncCorrelator::scan(FILE *fp)
+{
+    quint64 w;
+    long    start, end;
+    int     i, n, shifted, e;
+
+    start = ftell(fp);
+    if(start < 0)
+        return false;
+
+    w = 0;
+    shifted = 0;
+
+    while((n = (int) fread(buf, unit_size, SC_READ_SIZE / unit_size, fp)) > 0) {
+        for(i=0; i<n; i++) {
+            w = (w << unit_bits) | unit(buf + i * unit_size);
+
+            if(++shifted < units)
+                continue;
+
+            e = popcount64((w ^ pattern) & mask);
+            if(e > max_errors)
+                continue;
+
+            end = start + (long) (i + 1) * unit_size;
+            if(fseek(fp, end, SEEK_SET) != 0)
+                return false;
+
+            errors = e;
+            coast = 0;
+            position = end - units * unit_size;
+            expected = position + period;
+            syncs++;
+            corrected += errors > 0 ? 1:0;
+            setflag(SC_LOCKED, true);
+
+            return true;
+        }
+
+        start += (long) n * unit_size;
+    }
+
+    return false;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,90 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef SYNCCORRELATOR_H
+#define SYNCCORRELATOR_H
+
+#include <QtGlobal>
+#include <stdio.h>
+
+//---------------------------------------------------------------------------
+#define SC_LITTLE_ENDIAN    1
+#define SC_LOCKED           2   // a sync was found, the next is expected one period later
+
+#define SC_READ_SIZE        65536 // bytes per scan chunk
+#define SC_FLYWHEEL         4     // frames accepted on the period without a sync match
+
+//---------------------------------------------------------------------------
+// frame sync correlator which accepts bit errors in the sync word
+// the sync word is up to 64 bits of units, a 10 bit HRPT word in 16 bits or a CADU byte
+class TSyncCorrelator
+{
+public:
+    TSyncCorrelator(void);
+    ~TSyncCorrelator(void);
+
+    void setSync(const quint16 *sync, int units_, int unit_bits_);
+    void setSync(const quint8 *sync, int units_);
+
+    void setLittleEndian(bool on);
+    bool isLittleEndian(void) { return flags & SC_LITTLE_ENDIAN ? true:false; }
+
+    // max bit errors while searching, locked is used at the expected position
+    // and defaults to a quarter of the sync bits
+    void setMaxErrors(int search, int locked=-1);
+    // bytes from a sync to the next one, 0 disables the flywheel
+    void setPeriod(long bytes) { period = bytes; }
+
+    void reset(void);
+
+    // finds the next sync, the file is positioned after the sync on return
+    bool find(FILE *fp);
+
+    long getPosition(void) { return position; }
+    int  getErrors(void) { return errors; }
+    // 100 is an exact match, 0 is no better than random data
+    int  getConfidence(void);
+    bool isFlywheel(void) { return coast > 0; }
+
+    long getSyncs(void) { return syncs; }
+    long getCorrected(void) { return corrected; }
+    long getCoasted(void) { return coasted; }
+
+    static int popcount64(quint64 x);
+
+protected:
+    void setflag(int flag, bool on);
+    quint64 unit(const quint8 *p);
+    bool check(FILE *fp);
+    bool scan(FILE *fp);
+
+private:
+    int     flags;
+    quint64 pattern, mask;
+    int     units, unit_bits, unit_size, bits;
+    int     max_errors, locked_errors, errors, coast;
+    long    period, position, expected;
+    long    syncs, corrected, coasted;
+
+    quint8  *buf;
+};
+
+#endif // SYNCCORRELATOR_H
@@ -0,0 +1,774 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QtGlobal>
+
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+#include <stdlib.h>
+#include <memory.h>
+
+#include "viterbi.h"
+#include "deinterleaver.h"
+#include "cadu.h"
+
+//---------------------------------------------------------------------------
+//#define DEBUG_VITERBI
+
+//---------------------------------------------------------------------------
+/*
+  Trellis
+
+  The state is the last 6 input bits, newest bit in the lsb.
+  State j and j+32 are the predecessors of state 2j (input 0) and 2j+1 (input 1).
+  Both polynomials have bit 0 and bit 6 set, thus the branch metric of
+  (j, 0) equals (j+32, 1) and (j, 1) equals (j+32, 0), the complement.
+
+  Path metrics are 16 bit and normalized to state 0 every step, the
+  spread of a k=7 code is less than 6 * 510.
+  Decisions are stored as two 32 bit words per step, bit j of word b
+  is the decision of state 2j+b.
+*/
+//---------------------------------------------------------------------------
+static int parity(int x)
+{
+    x ^= x >> 4;
+    x ^= x >> 2;
+    x ^= x >> 1;
+
+    return x & 1;
+}
+
+//---------------------------------------------------------------------------
+static int popcount32(quint32 x)
+{
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    x = (x + (x >> 4)) & 0x0f0f0f0f;
+
+    return (x * 0x01010101) >> 24;
+}
+
+//---------------------------------------------------------------------------
+static qint8 negate(qint8 s)
+{
+    return s == -128 ? 127:-s;
+}
+
+//---------------------------------------------------------------------------
+// rotation&3 is the QPSK phase, rotation&4 swaps I and Q
+static void rotate(qint8 *sym, int len, int rotation)
+{
+    qint8 i, q;
+    int   k;
+
+    if(rotation == 0)
+        return;
+
+    for(k=0; k+1<len; k+=2) {
+        i = sym[k];
+        q = sym[k + 1];
+
+        if(rotation & 4) {
+            sym[k] = q;
+            sym[k + 1] = i;
+            i = sym[k];
+            q = sym[k + 1];
+        }
+
+        switch(rotation & 3) {
+        case 1:
+            sym[k] = negate(q);
+            sym[k + 1] = i;
+            break;
+
+        case 2:
+            sym[k] = negate(i);
+            sym[k + 1] = negate(q);
+            break;
+
+        case 3:
+            sym[k] = q;
+            sym[k + 1] = negate(i);
+            break;
+
+        default:
+            sym[k] = i;
+            sym[k + 1] = q;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+TViterbi::TViterbi(int flags_)
+{
+    flags = flags_;
+
+    fp = NULL;
+    rotation = 0;
+    sym_offset = 0;
+    warmup = 0;
+    sync_count = 0;
+    skip_bits = 0;
+    invert_out = false;
+
+    rbuf = (qint8 *) malloc(VIT_READ_SIZE);
+    dbuf = (qint8 *) malloc(VIT_READ_SIZE);
+    deint = new TDeinterleaver;
+
+    init_tables();
+    reset();
+}
+
+//---------------------------------------------------------------------------
+TViterbi::~TViterbi(void)
+{
+    if(rbuf)
+        free(rbuf);
+    if(dbuf)
+        free(dbuf);
+
+    delete deint;
+}
+
+//---------------------------------------------------------------------------
+void TViterbi::setflag(int flag, bool on)
+{
+    flags &= ~flag;
+    flags |= on ? flag:0;
+}
+
+//---------------------------------------------------------------------------
+void TViterbi::invert_g2(bool enable)
+{
+    setflag(VIT_INVERT_G2, enable);
+    init_tables();
+}
+
+//---------------------------------------------------------------------------
+void TViterbi::deinterleave(bool enable)
+{
+    setflag(VIT_DEINTERLEAVE, enable);
+}
+
+//---------------------------------------------------------------------------
+void TViterbi::init_tables(void)
+{
+    int j, sr;
+
+    for(j=0; j<VIT_NUM_STATES/2; j++) {
+        sr = j << 1;
+
+        exp0[j] = parity(sr & VIT_POLYA) ? 255:0;
+        exp1[j] = (parity(sr & VIT_POLYB) ^ (invert_g2() ? 1:0)) ? 255:0;
+    }
+}
+
+//---------------------------------------------------------------------------
+void TViterbi::reset(void)
+{
+    memset(metrics, 0, sizeof(metrics));
+    memset(decisions, 0, sizeof(decisions));
+
+    ring_pos = 0;
+    pending = 0;
+
+    obyte = 0;
+    obits = 0;
+}
+
+//---------------------------------------------------------------------------
+// add-compare-select, one trellis step
+// u0 and u1 are the soft symbols as unsigned 0...255
+void TViterbi::acs(int u0, int u1)
+{
+    quint32 *d = decisions[ring_pos];
+
+#if defined(__AVX2__)
+
+    __m256i u0v, u1v, maxv, a, b, bm, bmc, m0, m1, lo, hi, base;
+    __m256i n0[2], n1[2], c0[2], c1[2];
+    int k;
+
+    u0v = _mm256_set1_epi16(u0);
+    u1v = _mm256_set1_epi16(u1);
+    maxv = _mm256_set1_epi16(510);
+
+    for(k=0; k<2; k++) {
+        a = _mm256_loadu_si256((const __m256i *) (metrics + 16*k));
+        b = _mm256_loadu_si256((const __m256i *) (metrics + 32 + 16*k));
+
+        bm = _mm256_add_epi16(_mm256_xor_si256(u0v, _mm256_loadu_si256((const __m256i *) (exp0 + 16*k))),
+                              _mm256_xor_si256(u1v, _mm256_loadu_si256((const __m256i *) (exp1 + 16*k))));
+        bmc = _mm256_sub_epi16(maxv, bm);
+
+        m0 = _mm256_adds_epi16(a, bm);
+        m1 = _mm256_adds_epi16(b, bmc);
+        n0[k] = _mm256_min_epi16(m0, m1);
+        c0[k] = _mm256_cmpgt_epi16(m0, m1);
+
+        m0 = _mm256_adds_epi16(a, bmc);
+        m1 = _mm256_adds_epi16(b, bm);
+        n1[k] = _mm256_min_epi16(m0, m1);
+        c1[k] = _mm256_cmpgt_epi16(m0, m1);
+    }
+
+    // packs works per 128 bit lane, restore the order of the 64 bit words
+    d[0] = (quint32) _mm256_movemask_epi8(_mm256_permute4x64_epi64(_mm256_packs_epi16(c0[0], c0[1]), 0xd8));
+    d[1] = (quint32) _mm256_movemask_epi8(_mm256_permute4x64_epi64(_mm256_packs_epi16(c1[0], c1[1]), 0xd8));
+
+    base = _mm256_set1_epi16((short) _mm_extract_epi16(_mm256_castsi256_si128(n0[0]), 0));
+
+    for(k=0; k<2; k++) {
+        lo = _mm256_unpacklo_epi16(n0[k], n1[k]);
+        hi = _mm256_unpackhi_epi16(n0[k], n1[k]);
+
+        _mm256_storeu_si256((__m256i *) (metrics + 32*k),
+                            _mm256_sub_epi16(_mm256_permute2x128_si256(lo, hi, 0x20), base));
+        _mm256_storeu_si256((__m256i *) (metrics + 32*k + 16),
+                            _mm256_sub_epi16(_mm256_permute2x128_si256(lo, hi, 0x31), base));
+    }
+
+#elif defined(__SSE2__)
+
+    __m128i u0v, u1v, maxv, a, b, bm, bmc, m0, m1, base;
+    __m128i n0[4], n1[4], c0[4], c1[4];
+    int k;
+
+    u0v = _mm_set1_epi16(u0);
+    u1v = _mm_set1_epi16(u1);
+    maxv = _mm_set1_epi16(510);
+
+    for(k=0; k<4; k++) {
+        a = _mm_loadu_si128((const __m128i *) (metrics + 8*k));
+        b = _mm_loadu_si128((const __m128i *) (metrics + 32 + 8*k));
+
+        bm = _mm_add_epi16(_mm_xor_si128(u0v, _mm_loadu_si128((const __m128i *) (exp0 + 8*k))),
+                           _mm_xor_si128(u1v, _mm_loadu_si128((const __m128i *) (exp1 + 8*k))));
+        bmc = _mm_sub_epi16(maxv, bm);
+
+        m0 = _mm_adds_epi16(a, bm);
+        m1 = _mm_adds_epi16(b, bmc);
+        n0[k] = _mm_min_epi16(m0, m1);
+        c0[k] = _mm_cmpgt_epi16(m0, m1);
+
+        m0 = _mm_adds_epi16(a, bmc);
+        m1 = _mm_adds_epi16(b, bm);
+        n1[k] = _mm_min_epi16(m0, m1);
+        c1[k] = _mm_cmpgt_epi16(m0, m1);
+    }
+
+    d[0] = (quint32) _mm_movemask_epi8(_mm_packs_epi16(c0[0], c0[1])) |
+           ((quint32) _mm_movemask_epi8(_mm_packs_epi16(c0[2], c0[3])) << 16);
+    d[1] = (quint32) _mm_movemask_epi8(_mm_packs_epi16(c1[0], c1[1])) |
+           ((quint32) _mm_movemask_epi8(_mm_packs_epi16(c1[2], c1[3])) << 16);
+
+    base = _mm_set1_epi16((short) _mm_extract_epi16(n0[0], 0));
+
+    for(k=0; k<4; k++) {
+        _mm_storeu_si128((__m128i *) (metrics + 16*k),
+                         _mm_sub_epi16(_mm_unpacklo_epi16(n0[k], n1[k]), base));
+        _mm_storeu_si128((__m128i *) (metrics + 16*k + 8),
+                         _mm_sub_epi16(_mm_unpackhi_epi16(n0[k], n1[k]), base));
+    }
+
+#else
+
+    qint16 nm[VIT_NUM_STATES];
+    int j, bm, bmc, m0, m1, base;
+
+    d[0] = 0;
+    d[1] = 0;
+
+    for(j=0; j<VIT_NUM_STATES/2; j++) {
+        bm = (u0 ^ exp0[j]) + (u1 ^ exp1[j]);
+        bmc = 510 - bm;
+
+        m0 = metrics[j] + bm;
+        m1 = metrics[j + 32] + bmc;
+        nm[2*j] = m1 < m0 ? m1:m0;
+        d[0] |= (m1 < m0 ? 1:0) << j;
+
+        m0 = metrics[j] + bmc;
+        m1 = metrics[j + 32] + bm;
+        nm[2*j + 1] = m1 < m0 ? m1:m0;
+        d[1] |= (m1 < m0 ? 1:0) << j;
+    }
+
+    base = nm[0];
+    for(j=0; j<VIT_NUM_STATES; j++)
+        metrics[j] = nm[j] - base;
+
+#endif
+}
+
+//---------------------------------------------------------------------------
+int TViterbi::put_bit(int bit, quint8 *out)
+{
+    if(skip_bits > 0) {
+        skip_bits--;
+        return 0;
+    }
+
+    obyte = (obyte << 1) | (bit & 1);
+    if(++obits < 8)
+        return 0;
+
+    *out = invert_out ? ~obyte:obyte;
+    obyte = 0;
+    obits = 0;
+
+    return 1;
+}
+
+//---------------------------------------------------------------------------
+// traces back steps decisions from the best state, the newest skip bits are
+// only used to settle the path
+int TViterbi::traceback(int steps, int skip, quint8 *out)
+{
+    quint8 bits[VIT_RING_SIZE];
+    int    i, n, idx, state, j, b;
+
+    state = 0;
+    for(i=1; i<VIT_NUM_STATES; i++)
+        if(metrics[i] < metrics[state])
+            state = i;
+
+    idx = ring_pos;
+    for(i=0; i<steps; i++) {
+        idx = idx == 0 ? VIT_RING_SIZE - 1:idx - 1;
+
+        b = state & 1;
+        j = state >> 1;
+
+        if(i >= skip)
+            bits[steps - 1 - i] = b;
+
+        state = j | (((decisions[idx][b] >> j) & 1) << 5);
+    }
+
+    for(i=0, n=0; i<steps - skip; i++)
+        n += put_bit(bits[i], out + n);
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
+int TViterbi::decode(const qint8 *sym, int pairs, quint8 *out)
+{
+    int i, n;
+
+    for(i=0, n=0; i<pairs; i++) {
+        acs(sym[2*i] + 128, sym[2*i + 1] + 128);
+
+        if(++ring_pos == VIT_RING_SIZE)
+            ring_pos = 0;
+
+        if(++pending == VIT_RING_SIZE) {
+            n += traceback(pending, VIT_TB_DEPTH, out + n);
+            pending -= VIT_TB_CHUNK;
+        }
+    }
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
+int TViterbi::flush(quint8 *out)
+{
+    int n = traceback(pending, 0, out);
+
+    pending = 0;
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
+//
+//      Stream, rotation -> symbol offset -> deinterleave
+//
+//---------------------------------------------------------------------------
+// pos is the file offset of the first symbol, the symbol offset is relative to it
+void TViterbi::begin_stream(FILE *infp, long pos)
+{
+    qint8 *sym;
+    long  n;
+    int   k;
+
+    fp = infp;
+    fseek(fp, pos, SEEK_SET);
+
+    deint->reset();
+    rlen = 0;
+    rpos = 0;
+    skip_syms = sym_offset;
+
+    if(warmup <= 0)
+        return;
+
+    sym = (qint8 *) malloc(VIT_READ_SIZE);
+    if(sym == NULL)
+        return;
+
+    for(n=0; n<warmup; n+=k) {
+        k = (int) (warmup - n > VIT_READ_SIZE ? VIT_READ_SIZE:warmup - n);
+        if(read_stream(sym, k) != k)
+            break;
+    }
+
+    free(sym);
+}
+
+//---------------------------------------------------------------------------
+bool TViterbi::fill(void)
+{
+    int len, start;
+
+    rlen = 0;
+    rpos = 0;
+
+    while(rlen == 0) {
+        len = (int) fread(rbuf, 1, VIT_READ_SIZE, fp);
+        if(len <= 0)
+            return false;
+
+        rotate(rbuf, len, rotation);
+
+        start = skip_syms < len ? skip_syms:len;
+        skip_syms -= start;
+
+        if(deinterleave())
+            rlen = deint->process(rbuf + start, len - start, dbuf);
+        else {
+            rlen = len - start;
+            memcpy(dbuf, rbuf + start, rlen);
+        }
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+int TViterbi::read_stream(qint8 *sym, int len)
+{
+    int n, k;
+
+    for(n=0; n<len; n+=k) {
+        if(rpos >= rlen && !fill())
+            break;
+
+        k = rlen - rpos < len - n ? rlen - rpos:len - n;
+        memcpy(sym + n, dbuf + rpos, k);
+        rpos += k;
+    }
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
+//
+//      Phase ambiguity
+//
+//---------------------------------------------------------------------------
+// counts the CADU sync words in the decoded data
+// returns the count, bit offset of the sync and if the data is inverted
+long TViterbi::probe(const quint8 *data, int len, int *bitoffs, bool *inverted)
+{
+    quint32 asm_word, w;
+    long    count[2][8], best;
+    int     i, b, bit;
+
+    asm_word = ((quint32) CADU_SYNC[0] << 24) | (CADU_SYNC[1] << 16) | (CADU_SYNC[2] << 8) | CADU_SYNC[3];
+
+    memset(count, 0, sizeof(count));
+    w = 0;
+
+    for(i=0; i<len; i++)
+        for(b=7; b>=0; b--) {
+            w = (w << 1) | ((data[i] >> b) & 1);
+            bit = i*8 + 7 - b;
+
+            if(bit < 31)
+                continue;
+
+            if(popcount32(w ^ asm_word) <= VIT_SYNC_ERRORS)
+                count[0][(bit - 31) & 7]++;
+            else if(popcount32(w ^ ~asm_word) <= VIT_SYNC_ERRORS)
+                count[1][(bit - 31) & 7]++;
+        }
+
+    best = 0;
+    *bitoffs = 0;
+    *inverted = false;
+
+    for(i=0; i<2; i++)
+        for(b=0; b<8; b++)
+            if(count[i][b] > best) {
+                best = count[i][b];
+                *bitoffs = b;
+                *inverted = i ? true:false;
+            }
+
+    return best;
+}
+
+//---------------------------------------------------------------------------
+// resolves the rotation and offsets from the window of symbols at pos
+bool TViterbi::resolve(FILE *infp, long pos)
+{
+    qint8  *sym, *raw;
+    quint8 *out;
+    long   score, best, mscore, mbest, mag;
+    int    r, o, n, i, bitoffs, best_rot, best_offs, best_bits;
+    bool   inverted, best_inv;
+
+    sym = (qint8 *) malloc(VIT_PROBE_PAIRS * 2);
+    out = (quint8 *) malloc(VIT_PROBE_PAIRS / 8 + VIT_RING_SIZE);
+    if(sym == NULL || out == NULL) {
+        if(sym)
+            free(sym);
+        if(out)
+            free(out);
+
+        return false;
+    }
+
+    best = 0;
+    best_rot = 0;
+    best_offs = 0;
+    best_bits = 0;
+    best_inv = false;
+
+    warmup = 0;
+
+    if(deinterleave()) {
+        // the markers are outside of the interleaver, use them to find the phase
+        raw = (qint8 *) malloc(VIT_PROBE_PAIRS * 2);
+
+        fseek(infp, pos, SEEK_SET);
+        n = raw ? (int) fread(raw, 1, VIT_PROBE_PAIRS * 2, infp):0;
+
+        // the ideal marker correlation is the magnitude of the marker symbols
+        for(i=0, mag=0; i<n; i++)
+            mag += raw[i] < 0 ? -raw[i]:raw[i];
+
+        mbest = 0;
+        for(r=0; r<VIT_NUM_ROTATIONS && n > 0; r++) {
+            memcpy(sym, raw, n);
+            rotate(sym, n, r);
+
+            mscore = TDeinterleaver::findMarker(sym, n, &o);
+            if(mscore > mbest) {
+                mbest = mscore;
+                best_rot = r;
+                best_offs = o;
+            }
+        }
+
+        if(raw)
+            free(raw);
+
+        rotation = best_rot;
+        sym_offset = best_offs;
+        warmup = TDeinterleaver::delay();
+
+        // below that the window is noise, do not wait for the deinterleaver
+        if(mbest * VIT_MARKER_MIN * DI_MARKER_STRIDE >= mag * DI_MARKER_SIZE && mbest > 0) {
+            begin_stream(infp, pos);
+            n = read_stream(sym, VIT_PROBE_PAIRS * 2);
+
+            skip_bits = 0;
+            invert_out = false;
+            reset();
+
+            n = decode(sym, n / 2, out);
+            n += flush(out + n);
+
+            best = probe(out, n, &best_bits, &best_inv);
+        }
+    }
+    else {
+        for(r=0; r<VIT_NUM_ROTATIONS; r++)
+            for(o=0; o<2; o++) {
+                rotation = r;
+                sym_offset = o;
+
+                begin_stream(infp, pos);
+                n = read_stream(sym, VIT_PROBE_PAIRS * 2);
+                if(n < 2)
+                    continue;
+
+                skip_bits = 0;
+                invert_out = false;
+                reset();
+
+                n = decode(sym, n / 2, out);
+                n += flush(out + n);
+
+                score = probe(out, n, &bitoffs, &inverted);
+                if(score > best) {
+                    best = score;
+                    best_rot = r;
+                    best_offs = o;
+                    best_bits = bitoffs;
+                    best_inv = inverted;
+                }
+            }
+
+        rotation = best_rot;
+        sym_offset = best_offs;
+    }
+
+    free(sym);
+    free(out);
+
+    skip_bits = best_bits;
+    invert_out = best_inv;
+
+    if(best < VIT_PROBE_MIN)
+        return false;
+
+#ifdef DEBUG_VITERBI
+    qDebug("Viterbi: @%ld rotation %d, symbol offset %d, bit offset %d%s, %d sync words in probe",
+           pos, rotation, sym_offset, skip_bits, invert_out ? " (inverted)":"", (int) best);
+#endif
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TViterbi::decodeFile(FILE *infp, FILE *outfp)
+{
+    long pos, size;
+    int  segments;
+
+    if(infp == NULL || outfp == NULL || rbuf == NULL || dbuf == NULL)
+        return false;
+
+    fseek(infp, 0, SEEK_END);
+    size = ftell(infp);
+
+    sync_count = 0;
+    segments = 0;
+
+    // noise before AOS and phase slips, probe window by window until in sync
+    for(pos=0; pos<size; ) {
+        if(!resolve(infp, pos)) {
+            pos += VIT_PROBE_STEP;
+            continue;
+        }
+
+        segments++;
+        pos = decode_segment(outfp, pos, size);
+    }
+
+    fflush(outfp);
+
+    if(segments == 0) {
+        qDebug("Viterbi: no CADU sync found in the soft symbols %s:%d", __FILE__, __LINE__);
+        return false;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// decodes from pos until the end of file or until the sync words fade
+// returns the file offset to resolve again from
+long TViterbi::decode_segment(FILE *outfp, long pos, long size)
+{
+    qint8   *sym;
+    quint8  *out;
+    quint32 asm_word, w;
+    long    count, bytes;
+    int     i, n;
+
+    sym = (qint8 *) malloc(VIT_READ_SIZE);
+    out = (quint8 *) malloc(VIT_READ_SIZE / 16 + VIT_RING_SIZE);
+    if(sym == NULL || out == NULL) {
+        if(sym)
+            free(sym);
+        if(out)
+            free(out);
+
+        return size;
+    }
+
+    asm_word = ((quint32) CADU_SYNC[0] << 24) | (CADU_SYNC[1] << 16) | (CADU_SYNC[2] << 8) | CADU_SYNC[3];
+    w = 0;
+    count = 0;
+    bytes = 0;
+
+    begin_stream(fp, pos);
+    reset();
+
+    while((n = read_stream(sym, VIT_READ_SIZE)) >= 2) {
+        n = decode(sym, n / 2, out);
+        if(n > 0)
+            fwrite(out, 1, n, outfp);
+
+        // the output is byte aligned to the sync
+        for(i=0; i<n; i++) {
+            w = (w << 8) | out[i];
+            if(popcount32(w ^ asm_word) <= VIT_SYNC_ERRORS)
+                count++;
+        }
+
+        bytes += n;
+        if(bytes < VIT_MONITOR_BYTES)
+            continue;
+
+        sync_count += count;
+
+        if(count * VIT_MIN_SYNC_RATE * (CADU_SYNC_SIZE + CADU_PACKET_SIZE) < bytes) {
+            pos = ftell(fp);
+
+#ifdef DEBUG_VITERBI
+            qDebug("Viterbi: sync lost @%ld, %ld sync words in %ld bytes", pos, count, bytes);
+#endif
+
+            free(sym);
+            free(out);
+
+            return pos > size ? size:pos;
+        }
+
+        count = 0;
+        bytes = 0;
+    }
+
+    n = flush(out);
+    if(n > 0)
+        fwrite(out, 1, n, outfp);
+
+    sync_count += count;
+
+    free(sym);
+    free(out);
+
+    return size;
+}
+
+//---------------------------------------------------------------------------
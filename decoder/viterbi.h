@@ -0,0 +1,116 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef VITERBI_H
+#define VITERBI_H
+
+#include <QtGlobal>
+#include <stdio.h>
+
+//---------------------------------------------------------------------------
+#define VIT_INVERT_G2       1   // CCSDS, second symbol is inverted
+#define VIT_DEINTERLEAVE    2   // METEOR LRPT interleaved symbols
+
+#define VIT_NUM_STATES      64  // k = 7
+#define VIT_POLYA           0x4f
+#define VIT_POLYB           0x6d
+#define VIT_TB_DEPTH        96    // bits traced back before output
+#define VIT_TB_CHUNK        4096  // bits output per traceback
+#define VIT_RING_SIZE       (VIT_TB_DEPTH + VIT_TB_CHUNK)
+
+#define VIT_READ_SIZE       65536 // soft symbols read per file chunk
+#define VIT_PROBE_PAIRS     32768 // symbol pairs used per ambiguity hypothesis
+#define VIT_NUM_ROTATIONS   8     // 4 QPSK phases * I/Q swap
+#define VIT_SYNC_ERRORS     3     // max bit errors in a probed ASM
+#define VIT_PROBE_MIN       2     // sync words a probe must find, a random match is possible
+#define VIT_PROBE_STEP      (4 * VIT_PROBE_PAIRS * 2) // symbols skipped after a window without sync
+#define VIT_MARKER_MIN      4     // METEOR markers must reach 1/4 of the ideal correlation
+#define VIT_MONITOR_BYTES   16384 // decoded bytes per sync rate check, 16 CADU's
+#define VIT_MIN_SYNC_RATE   4     // resolve again below 1/4 of the expected sync words
+
+class TDeinterleaver;
+
+//---------------------------------------------------------------------------
+// CCSDS r=1/2 k=7 soft decision Viterbi decoder
+// input is signed 8 bit soft symbols, -128 is a strong 0 and 127 a strong 1
+class TViterbi
+{
+public:
+    TViterbi(int flags_=0);
+    ~TViterbi(void);
+
+    void reset(void);
+
+    void invert_g2(bool enable);
+    bool invert_g2(void) { return flags & VIT_INVERT_G2 ? true:false; }
+    void deinterleave(bool enable);
+    bool deinterleave(void) { return flags & VIT_DEINTERLEAVE ? true:false; }
+
+    // decodes pairs of soft symbols, out must hold (pairs + VIT_RING_SIZE) / 8 bytes
+    // returns number of bytes written to out
+    int  decode(const qint8 *sym, int pairs, quint8 *out);
+    int  flush(quint8 *out);
+
+    // decodes the whole file into CADU's, the phase ambiguity is resolved
+    // at the first window with sync and again whenever the sync is lost
+    bool decodeFile(FILE *infp, FILE *outfp);
+
+    int  getRotation(void) { return rotation; }
+    long getSyncCount(void) { return sync_count; }
+
+protected:
+    void init_tables(void);
+    void setflag(int flag, bool on);
+    void acs(int u0, int u1);
+    int  traceback(int steps, int skip, quint8 *out);
+    int  put_bit(int bit, quint8 *out);
+
+    bool resolve(FILE *infp, long pos);
+    long decode_segment(FILE *outfp, long pos, long size);
+    void begin_stream(FILE *infp, long pos);
+    bool fill(void);
+    int  read_stream(qint8 *sym, int len);
+    long probe(const quint8 *data, int len, int *bitoffs, bool *inverted);
+
+private:
+    int    flags;
+
+    // trellis
+    qint16 metrics[VIT_NUM_STATES];
+    qint16 exp0[VIT_NUM_STATES / 2], exp1[VIT_NUM_STATES / 2];
+    quint32 decisions[VIT_RING_SIZE][2];
+    int    ring_pos, pending;
+
+    // output
+    quint8 obyte;
+    int    obits, skip_bits;
+    bool   invert_out;
+
+    // stream
+    FILE   *fp;
+    TDeinterleaver *deint;
+    int    rotation, sym_offset, skip_syms;
+    long   warmup, sync_count;
+    qint8  *rbuf, *dbuf;
+    int    rlen, rpos;
+};
+
+#endif // VITERBI_H
@@ -21,6 +21,7 @@
 //---------------------------------------------------------------------------
 
 #include <QtGui/QApplication>
+#include <QtCore/QCoreApplication>
 
 #if defined(HAVE_IMAGE_PLUGINS)
 # include <QtPlugin>
@@ -31,10 +32,34 @@
   Q_IMPORT_PLUGIN(qmng)
 #endif
 
+#include <string.h>
+#include <stdio.h>
+
 #include "mainwindow.h"
+#include "telemetryreader.h"
+#include "trackdaemon.h"
 
 int main(int argc, char *argv[])
 {    
+    // poes-decoder --telemetry file.ptl > file.csv
+    if(argc == 3 && strcmp(argv[1], "--telemetry") == 0)
+        return TTelemetryReader::dump(QString(argv[2]), stdout) ? 0:1;
+
+    // poes-decoder --daemon, tracks and records without the GUI
+    if(argc == 2 && strcmp(argv[1], "--daemon") == 0) {
+        QCoreApplication app(argc, argv);
+        TTrackDaemon daemon;
+        int rc;
+
+        if(!daemon.open())
+            return 1;
+
+        rc = app.exec();
+        daemon.close();
+
+        return rc;
+    }
+
     Q_INIT_RESOURCE(application);
 
     QApplication a(argc, argv);
@@ -46,8 +46,10 @@
 #include "gpsdialog.h"
 
 #include "Satellite.h"
+#include "passtable.h"
 #include "satutil.h"
 #include "utils.h"
+#include "simclock.h"
 #include "settings.h"
 #include "rig.h"
 
@@ -72,6 +74,7 @@ MainWindow::MainWindow(QWidget *parent)
   rig       = new TRig;
   gps       = NULL;
   opensat   = new TSat;
+  passTable = new TPassTable(this);
 
   QCoreApplication::setOrganizationName("poes-weather");
   QCoreApplication::setOrganizationDomain("poes-weather.com");
@@ -105,6 +108,7 @@ MainWindow::MainWindow(QWidget *parent)
 
   trackWidget = new TrackWidget(this);
   ui->menuView->addAction(trackWidget->toggleViewAction());  
+  antennaWidgets = new PList;
 
   readSettings();
 }
@@ -112,6 +116,16 @@ MainWindow::MainWindow(QWidget *parent)
 //---------------------------------------------------------------------------
 MainWindow::~MainWindow()
 {
+    TrackWidget *w;
+
+    // the trackers use the rig and the pass table
+    while((w = (TrackWidget *) antennaWidgets->Last())) {
+        antennaWidgets->Delete(w);
+        delete w;
+    }
+
+    delete trackWidget;
+
     delete ui;
 
     delete block;
@@ -128,6 +142,8 @@ MainWindow::~MainWindow()
         delete gps;
 
     delete opensat;
+    delete passTable;
+    delete antennaWidgets;
 
     clearSatList(satList, 1);
 }
@@ -152,6 +168,7 @@ void MainWindow::createPaths(void)
    mkpath(getConfPath());
    mkpath(getTLEPath());
    mkpath(getTLEPath(1));
+   mkpath(getTLEPath(2));
 }
 
 //---------------------------------------------------------------------------
@@ -175,6 +192,8 @@ QString MainWindow::getTLEPath(int type)
 {
     if(type == 1)
         return qApp->applicationDirPath() + "/" + PATH_TLE_ARC;
+    else if(type == 2)
+        return qApp->applicationDirPath() + "/" + PATH_TLE_CACHE;
     else
         return qApp->applicationDirPath() + "/" + PATH_TLE;
 }
@@ -313,6 +332,10 @@ bool MainWindow::processData(const char *filename, int blockType)
       // TODO: if passinfo file is not present exec a dialog where user can select a satellite
   }
   else {
+      // a later element set closer to the recording is more accurate
+      if(ReadArchivedTLE(opensat, opensat->rec_aostime, getTLEPath(1)))
+          opensat->CalcAll(opensat->rec_aostime);
+
       sat = getSat(satList, opensat->name);
 
       if(sat == NULL) {
@@ -462,7 +485,7 @@ void MainWindow::readSettings(void)
 
     QPoint    pos;
     QSize     size;
-    bool      bval;
+    QString   str;
     uint      i, state;
 
 
@@ -474,6 +497,10 @@ void MainWindow::readSettings(void)
     readSatelliteSettings();
     rig->readSettings(&reg);
 
+    reg.beginGroup("PassTable");
+      passTable->setHorizon(reg.value("Horizon", PT_HORIZON).toDouble());
+    reg.endGroup();
+
     // window settings
     QDesktopWidget *desktop = QApplication::desktop();
 
@@ -501,24 +528,13 @@ void MainWindow::readSettings(void)
       }
     reg.endGroup();
 
-    reg.beginGroup("TrackWidget");
-      pos  = reg.value("pos",  QPoint(x, y)).toPoint();
-      size = reg.value("size", QSize(width, 120)).toSize();
-      i    = reg.value("dock", Qt::TopDockWidgetArea).toUInt();
-      addDockWidget((Qt::DockWidgetArea) i, trackWidget);
+    readTrackSettings(&reg, trackWidget, "TrackWidget", x, y, width);
 
-      trackWidget->setFloating(reg.value("floating", false).toBool());
-      if(trackWidget->isFloating()) {
-         trackWidget->resize(size);
-         trackWidget->move(pos);
-      }
-
-      bval = reg.value("visible", false).toBool();
-      if(bval)
-          bval = countSats(1|2);
-
-      trackWidget->setVisible(bval);
-    reg.endGroup();
+    createTrackWidgets();
+    for(i=0; i<(uint) antennaWidgets->Count; i++) {
+      str.sprintf("TrackWidget%d", i + 2);
+      readTrackSettings(&reg, (TrackWidget *) antennaWidgets->ItemAt(i), str, x, y, width);
+    }
 
     reg.beginGroup("ImageWidget");
       pos =  reg.value("pos", QPoint(x, y)).toPoint();
@@ -537,15 +553,96 @@ void MainWindow::readSettings(void)
 
     // finally...
     setCaption();
-    trackWidget->updateSatCb();
+    updateTracking();
+
+    passTable->update(satList, rig);
+    passTable->start(QThread::LowestPriority);
 
     countSats(2);
 }
 
+//---------------------------------------------------------------------------
+void MainWindow::readTrackSettings(QSettings *reg, TrackWidget *w, const QString &group, int x, int y, int width)
+{
+    QPoint pos;
+    QSize  size;
+    bool   bval;
+    uint   i;
+
+    reg->beginGroup(group);
+      pos  = reg->value("pos",  QPoint(x, y)).toPoint();
+      size = reg->value("size", QSize(width, 120)).toSize();
+      i    = reg->value("dock", Qt::TopDockWidgetArea).toUInt();
+      addDockWidget((Qt::DockWidgetArea) i, w);
+
+      w->setFloating(reg->value("floating", false).toBool());
+      if(w->isFloating()) {
+         w->resize(size);
+         w->move(pos);
+      }
+
+      bval = reg->value("visible", false).toBool();
+      if(bval)
+          bval = countSats(1|2);
+
+      w->setVisible(bval);
+    reg->endGroup();
+}
+
+//---------------------------------------------------------------------------
+void MainWindow::writeTrackSettings(QSettings *reg, TrackWidget *w, const QString &group)
+{
+    reg->beginGroup(group);
+      reg->setValue("pos", w->pos());
+      reg->setValue("size", w->size());
+      reg->setValue("visible", w->isVisible());
+      reg->setValue("floating", w->isFloating());
+      reg->setValue("dock", dockWidgetArea(w));
+    reg->endGroup();
+}
+
+//---------------------------------------------------------------------------
+// one tracker per antenna, the first one is created with the window
+void MainWindow::createTrackWidgets(void)
+{
+    TrackWidget *w;
+    int i;
+
+    for(i=antennaWidgets->Count + 1; i<rig->antennas; i++) {
+        w = new TrackWidget(this, i);
+        ui->menuView->addAction(w->toggleViewAction());
+
+        antennaWidgets->Add(w);
+    }
+}
+
+//---------------------------------------------------------------------------
+void MainWindow::restartTracking(void)
+{
+    int i;
+
+    trackWidget->restartThread();
+
+    for(i=0; i<antennaWidgets->Count; i++)
+        ((TrackWidget *) antennaWidgets->ItemAt(i))->restartThread();
+}
+
+//---------------------------------------------------------------------------
+void MainWindow::updateTracking(void)
+{
+    int i;
+
+    trackWidget->updateSatCb();
+
+    for(i=0; i<antennaWidgets->Count; i++)
+        ((TrackWidget *) antennaWidgets->ItemAt(i))->updateSatCb();
+}
+
 //---------------------------------------------------------------------------
 void MainWindow::writeSettings(void)
 {
     QSettings reg(VER_COMPANYNAME_STR, VER_SWNAME_STR);
+    QString   str;
 
     reg.beginGroup("MainWindow");
       reg.setValue("pos", pos());
@@ -554,13 +651,12 @@ void MainWindow::writeSettings(void)
       reg.setValue("state", i);
     reg.endGroup();
 
-    reg.beginGroup("TrackWidget");
-      reg.setValue("pos", trackWidget->pos());
-      reg.setValue("size", trackWidget->size());
-      reg.setValue("visible", trackWidget->isVisible());
-      reg.setValue("floating", trackWidget->isFloating());
-      reg.setValue("dock", dockWidgetArea(trackWidget));
-    reg.endGroup();
+    writeTrackSettings(&reg, trackWidget, "TrackWidget");
+
+    for(i=0; i<(uint) antennaWidgets->Count; i++) {
+      str.sprintf("TrackWidget%d", i + 2);
+      writeTrackSettings(&reg, (TrackWidget *) antennaWidgets->ItemAt(i), str);
+    }
 
     reg.beginGroup("ImageWidget");
       reg.setValue("pos", imageWidget->pos());
@@ -570,6 +666,10 @@ void MainWindow::writeSettings(void)
       reg.setValue("dock", dockWidgetArea(imageWidget));
     reg.endGroup();
 
+    reg.beginGroup("PassTable");
+      reg.setValue("Horizon", passTable->getHorizon());
+    reg.endGroup();
+
     qth->writeSettings(&reg);
     writeSatelliteSettings();
     rig->writeSettings(&reg);
@@ -588,7 +688,7 @@ void MainWindow::on_actionRig_triggered()
 
 
   if(dlg.exec()) {
-      trackWidget->restartThread();
+      restartTracking();
   }
   else
       rig->rotor->flags |= enbRotor ? R_ROTOR_ENABLE:0;
@@ -616,7 +716,7 @@ void MainWindow::updateQTH(void)
     }
 
     if(satList->Count)
-       trackWidget->restartThread();
+       restartTracking();
 
     setCaption(blockImage != NULL ? FileName:"");
 }
@@ -681,9 +781,7 @@ void MainWindow::writeSatelliteSettings(void)
 //---------------------------------------------------------------------------
 void MainWindow::readSatelliteSettings(void)
 {
- QString   ini, str, name, line1, line2;
- int       i;
- TSat      *sat;
+ QString   ini;
 
    ini = getConfPath() + "/" + FILE_SAT_INI;
    QFile file(ini);
@@ -693,51 +791,7 @@ void MainWindow::readSatelliteSettings(void)
            return;
    }
 
-   QSettings reg(ini, QSettings::IniFormat);
-   sat = new TSat;
-
-   i = 1;
-   while(true) {
-      sat->Zero();
-      str.sprintf("Spacecraft_%d", i++);
-
-      reg.beginGroup(str);
-         name  = reg.value("Name",  "").toString();
-         line1 = reg.value("TLE_1", "").toString();
-         line2 = reg.value("TLE_2", "").toString();
-
-         if(name.isEmpty() || line1.isEmpty() || line2.isEmpty()) {
-             reg.endGroup();
-             break;
-         }
-
-      if(getSat(satList, name)) {
-          reg.endGroup();
-          continue;
-      }
-
-      if(sat->TLEKepCheck((char *)name.toStdString().c_str(),
-                          (char *)line1.toStdString().c_str(),
-                          (char *)line2.toStdString().c_str()))
-      {
-          sat->AssignObsInfo(qth);
-          sat->sat_scripts->readSettings(&reg);
-          sat->sat_props->readSettings(&reg);
-          satList->Add(new TSat(sat));
-
-#if 0
-          TSat *sat2 = (TSat *) satList->Last();
-          TNDVI *vi;
-          for(int ii=0; ii<sat2->sat_props->ndvilist->Count; ii++) {
-              vi = (TNDVI *) sat2->sat_props->ndvilist->ItemAt(ii);
-          }
-#endif
-      }
-
-      reg.endGroup();      
-   }
-
- delete sat;
+   ReadSatelliteIni(ini, satList, qth);
 }
 
 //---------------------------------------------------------------------------
@@ -775,7 +829,7 @@ void MainWindow::on_actionKeplerian_elements_triggered()
   tledialog dlg(satList, qth, this);
 
   if(dlg.exec())
-      trackWidget->updateSatCb();
+      updateTracking();
 }
 
 //---------------------------------------------------------------------------
@@ -802,7 +856,7 @@ void MainWindow::on_actionActive_satellites_triggered()
     ActiveSatDialog dlg(this);
 
     if(dlg.exec())
-        trackWidget->updateSatCb();
+        updateTracking();
 }
 
 //---------------------------------------------------------------------------
@@ -836,191 +890,21 @@ PList *MainWindow::getSatList(void)
 }
 
 //---------------------------------------------------------------------------
-TSat *MainWindow::getNextSat(double daynum_)
+TSat *MainWindow::getNextSat(double daynum_, int antenna)
 {
- TSat   *sat;
- PList  *list;
- double utc_daynum, now_utc_daynum, daynum;
- TSat   *nextsat = NULL;
- int    i, flags, ii, max_ii;
-
-    if(!countSats(1))
-        return NULL;
-
-    QDateTime utc(QDateTime::currentDateTime().toUTC());
-    now_utc_daynum = GetStartTime(utc);
-
-    if(daynum_ != 0)
-        utc_daynum = daynum_;
-    else
-        utc_daynum = now_utc_daynum;
-
-    list = new PList;
-    ii = 0;
-    max_ii = 144; // search 24 x 6 hours (6 days) forward
-
-    while(ii < max_ii) {
-        // get one satellite pass from each active satellite
-        for(i=0; i<satList->Count; i++) {
-            sat = (TSat *)satList->ItemAt(i);
-            if(!sat->isActive() || !sat->CalcAll(utc_daynum))
-                continue;
-
-#if 1
-            flags = 0;
-            // is it currently above qth?
-            if(sat->aostime < utc_daynum && sat->lostime > utc_daynum) {
-                sat->daynum = now_utc_daynum;
-                sat->Calc();
-
-                // is it approaching?
-                if(sat->get_range_rate() < 0)
-                    list->Add(sat);
-                else
-                    flags |= 1;
-            }
-            else if(sat->aostime >= utc_daynum)
-                list->Add(sat);
-
-
-            if(flags & 1) {
-                // find next orbit pass
-                while(sat->GetNextRiseTime(utc, 1) > 0) {
-                    if(!sat->CalcAll(sat->aostime))
-                        break;
-                    if(sat->aostime >= utc_daynum) {
-                        list->Add(sat);
-                        break;
-                    }
-                }
-            }
-#else
-            // is it currently above qth?
-            if(sat->aostime < utc_daynum && sat->lostime > utc_daynum)
-                list->Add(sat);
-            else if(sat->aostime >= utc_daynum)
-                list->Add(sat);
-            else {
-                // find next orbit pass
-                while(sat->GetNextRiseTime(utc, 1) > 0) {
-                    if(!sat->CalcAll(sat->aostime))
-                        break;
-                    if(sat->aostime >= utc_daynum) {
-                        list->Add(sat);
-                        break;
-                    }
-                }
-            }
-#endif
-        }
-
-        if(list->Count)
-            break;
-        else {
-            utc = utc.addSecs(60);
-            utc_daynum = GetStartTime(utc);
-            ii++;
-        }
-    }
-
-    // find the satellite that is closest to qth
-    daynum = 1e20;
-    nextsat = NULL;
-    for(i=0; i<list->Count; i++) {
-        sat = (TSat *) list->ItemAt(i);
-        if(sat->aostime < daynum) {
-            nextsat = sat;
-            daynum = sat->aostime;
-        }
-    }
-
-    // check if there is an overlap.
-    // if so select the satellite with higher elevation
-    if(nextsat) {
-        for(i=0; i<list->Count; i++) {
-            sat = (TSat *) list->ItemAt(i);
-            if(sat == nextsat)
-                continue;
-
-            if(sat->sat_max_ele > nextsat->sat_max_ele) {
-                // overlap check
-                flags = 0;
-                if(sat->aostime < nextsat->aostime) {
-                    // partial (happens before) || full overlap
-                    if(sat->lostime > nextsat->aostime || sat->lostime > nextsat->lostime)
-                        flags |= 1;
-                }
-                else if(sat->aostime < nextsat->lostime && sat->lostime > nextsat->lostime) {
-                    // partial overlap happens after
-                    flags |= 1;
-                }
-
-                if(flags & 1)
-                    nextsat = sat;
-            }
-        }
-
-        nextsat->CheckThresholds(rig);
-    }
-
-    delete list;
+    return findNextSat(satList, passTable, rig, daynum_, antenna);
+}
 
-    return nextsat;
+//---------------------------------------------------------------------------
+void MainWindow::releasePass(int antenna)
+{
+    passTable->release(antenna);
 }
 
 //---------------------------------------------------------------------------
-// no need to check pass thresholds here, this toggled by the user
 TSat *MainWindow::getNextSatByName(const QString &name, double daynum_)
 {
- TSat   *sat;
- double utc_daynum, now_utc_daynum;
- int    flags;
-
-    if(!countSats(1) || name.isEmpty())
-        return NULL;
-
-    sat = getSat(satList, name);
-    if(sat == NULL)
-        return NULL;
-
-    QDateTime utc(QDateTime::currentDateTime().toUTC());
-    now_utc_daynum = GetStartTime(utc);
-
-    if(daynum_ != 0)
-        utc_daynum = daynum_;
-    else
-        utc_daynum = now_utc_daynum;
-
-    if(!sat->CalcAll(utc_daynum))
-       return NULL;
-
-    flags = 0;
-    if(sat->aostime >= utc_daynum)
-        return sat;
-    // is it currently above my horizon?
-    if(sat->aostime <= utc_daynum && sat->lostime > utc_daynum) {
-        sat->daynum = now_utc_daynum;
-        sat->Calc();
-
-        // is it approaching?
-        if(sat->get_range_rate() < 0)
-            return sat;
-        else
-            flags |= 1;
-    }
-    else
-        flags |= 1;
-
-    if(flags & 1) {
-        while(sat->GetNextRiseTime(utc, 1) > 0) {
-           if(!sat->CalcAll(sat->aostime))
-              return NULL;
-           if(sat->aostime >= utc_daynum)
-              return sat;
-        }
-    }
-
- return NULL;
+    return findNextSatByName(satList, name, daynum_);
 }
 
 //---------------------------------------------------------------------------
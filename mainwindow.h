@@ -45,6 +45,7 @@ class TStation;
 class TSat;
 class TSettings;
 class TRig;
+class TPassTable;
 
 class ImageWidget;
 class TrackWidget;
@@ -70,7 +71,8 @@ public:
 
     bool renderImage(void);
 
-    TSat      *getNextSat(double daynum_ = 0);
+    TSat      *getNextSat(double daynum_ = 0, int antenna = 0);
+    void      releasePass(int antenna);
     TSat      *getNextSatByName(const QString &name, double daynum_ = 0);
     TSettings *getSettings(void);
     TRig      *getRig(void);
@@ -109,6 +111,11 @@ protected:
      bool mkpath(const QString &path, int flags=0);
 
      QString   getImageFormats(void);
+     void      createTrackWidgets(void);
+     void      readTrackSettings(QSettings *reg, TrackWidget *w, const QString &group, int x, int y, int width);
+     void      writeTrackSettings(QSettings *reg, TrackWidget *w, const QString &group);
+     void      restartTracking(void);
+     void      updateTracking(void);
 
 private:
     Ui::MainWindow *ui;
@@ -126,8 +133,10 @@ private:
     TRig      *rig;
     GPSDialog *gps;
     TSat      *opensat;
+    TPassTable *passTable;
 
     TrackWidget *trackWidget;
+    PList       *antennaWidgets; // trackers of the other antennas
     ImageWidget  *imageWidget;
 
 };
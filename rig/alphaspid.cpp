@@ -20,7 +20,6 @@
 */
 //---------------------------------------------------------------------------
 #include <QtGlobal>
-#include <QDateTime>
 #include <QString>
 #include <QSettings>
 #include <stdio.h>
@@ -29,6 +28,7 @@
 #include "alphaspid.h"
 #include "rotor.h"
 #include "qextserialport.h"
+#include "serialengine.h"
 #include "utils.h"
 
 
@@ -53,6 +53,9 @@ TAlphaSpid::TAlphaSpid(TRotor *_rotor)
     PH         = 0x02; // pulses per azimuth (horizontal)
 
     flags      = 0;
+
+    engine = new TSerialEngine(serialPort, SE_PROTO_SPID);
+    engine->setTelemetry(rotor->telemetry);
 }
 
 //---------------------------------------------------------------------------
@@ -111,10 +114,14 @@ bool TAlphaSpid::openCOM(void)
     }
 
     if(rc) {
-        rc = readPosition();
+        TPositionEvent ev;
+
+        engine->start();
 
-        rotate_next = QDateTime::currentDateTime();
-        rotate_next.addMSecs(100);
+        if((rc = engine->waitPosition(SE_OPEN_TIMEOUT, &ev))) {
+            current_az = ev.az;
+            current_el = ev.el;
+        }
     }
 
     return rc;
@@ -124,6 +131,8 @@ bool TAlphaSpid::openCOM(void)
 TAlphaSpid::~TAlphaSpid(void)
 {
     closeCOM();
+
+    delete engine;
 }
 
 //---------------------------------------------------------------------------
@@ -135,6 +144,8 @@ bool TAlphaSpid::isCOMOpen(void)
 //---------------------------------------------------------------------------
 void TAlphaSpid::closeCOM(void)
 {
+    engine->stop();
+
     if(serialPort->isOpen())
         serialPort->close();
 
@@ -156,49 +167,6 @@ QString TAlphaSpid::errorString(void)
     return str;
 }
 
-//---------------------------------------------------------------------------
-bool TAlphaSpid::write_buffer(void)
-{
- unsigned int i;
-
-    // serialPort->flush();
-
-    // send always 13 bytes
-    for(i=0; i<13; i++)
-    {
-        // qDebug("AlphaSpid write 0x%.2x", (unsigned char) iobuff[i]);
-        if(!serialPort->putChar(iobuff[i])) {
-            qDebug("AlphaSpid Error: Failed to send character");
-            return false;
-        }
-    }
-
-    return true;
-}
-
-//---------------------------------------------------------------------------
-bool TAlphaSpid::read_buffer(void)
-{
- unsigned long wait_ms, bytes;
- int retry;
-
-    wait_ms = 100;
-
-    retry = 0;
-    bytes = 12; // wait for 12 bytes
-    while(serialPort->bytesAvailable() < bytes) {
-        if(retry > 20) {
-            qDebug("AlphaSpid Error: Too many read attempts %d, available %d bytes", retry, (int)serialPort->bytesAvailable());
-            return false;
-        }
-
-        delay(wait_ms);
-        retry++;
-    }
-
-  return serialPort->read(iobuff, bytes) == bytes ? true:false;
-}
-
 //---------------------------------------------------------------------------
 void TAlphaSpid::stop(void)
 {
@@ -220,50 +188,25 @@ void TAlphaSpid::stop(void)
     iobuff[11] = 0x0F;
     iobuff[12] = 0x20;
 
-    write_buffer();
+    engine->send(iobuff, 13);
 }
 
 //---------------------------------------------------------------------------
+// newest position reported by the rotor, a new one is requested
 bool TAlphaSpid::readPosition(void)
 {
-    if(!isCOMOpen())
-        return false;
+ TPositionEvent ev;
 
-    // query its status
-
-    iobuff[ 0] = 0x57;
-    iobuff[ 1] = 0x00;
-    iobuff[ 2] = 0x00;
-    iobuff[ 3] = 0x00;
-    iobuff[ 4] = 0x00;
-    iobuff[ 5] = 0x00;
-    iobuff[ 6] = 0x00;
-    iobuff[ 7] = 0x00;
-    iobuff[ 8] = 0x00;
-    iobuff[ 9] = 0x00;
-    iobuff[10] = 0x00;
-    iobuff[11] = 0x1F;
-    iobuff[12] = 0x20;
-
-    if(!write_buffer())
+    if(!isCOMOpen())
         return false;
 
-    delay(300);
+    engine->query();
 
-    if(!read_buffer())
+    if(!engine->position(&ev))
         return false;
 
-    current_az  = ((double) iobuff[1]) * 100.0;
-    current_az += ((double) iobuff[2]) * 10.0;
-    current_az += ((double) iobuff[3]);
-    current_az += ((double) iobuff[4]) / 10.0;
-    current_az -= 360.0;
-
-    current_el  = ((double) iobuff[6]) * 100.0;
-    current_el += ((double) iobuff[7]) * 10.0;
-    current_el += ((double) iobuff[8]);
-    current_el += ((double) iobuff[9]) / 10.0;
-    current_el -= 360.0;
+    current_az = ev.az;
+    current_el = ev.el;
 
     qDebug("AlphaSpid current Azimuth: %g Elevation: %g", current_az, current_el);
 
@@ -275,15 +218,11 @@ bool TAlphaSpid::moveTo(double az, double el)
 {
  double d_az, d_el;
  int modes;
- unsigned long wait_ms;
  unsigned int u_az, u_el;
 
     if(!isCOMOpen() || PV <= 0 || PH <= 0)
         return false;
 
-    if(rotate_next > QDateTime::currentDateTime())
-        return false;
-
     // check if satellite moved enough
     d_az = fabs(current_az - az);
     d_el = fabs(current_el - el);
@@ -341,19 +280,13 @@ bool TAlphaSpid::moveTo(double az, double el)
     iobuff[11] = 0x2F;                       // K
     iobuff[12] = 0x20;                       // END
 
-    wait_ms = getRotationTime(az, el);
-
-    if(write_buffer()) {
-       current_az = d_az;
-       current_el = d_el;
+    // a target that has not been written yet is replaced
+    engine->move(iobuff, 13);
 
-       rotate_next = QDateTime::currentDateTime();
-       rotate_next.addMSecs(wait_ms);
+    current_az = d_az;
+    current_el = d_el;
 
-       return true;
-    }
-    else
-        return false;
+    return true;
 }
 
 //---------------------------------------------------------------------------
@@ -25,8 +25,8 @@
 #include "rig.h"
 
 class QextSerialPort;
-class QDateTime;
 class QSettings;
+class TSerialEngine;
 
 class TAlphaSpid
 {
@@ -57,16 +57,12 @@ public:
 
     int flags;
 
-protected:
-    bool write_buffer(void);
-    bool read_buffer(void);
+    TSerialEngine *engine;
 
 private:
     TRotor *rotor;
     QextSerialPort *serialPort;
     char *iobuff;
-
-    QDateTime rotate_next;
 };
 
 #endif // ALPHASPID_H
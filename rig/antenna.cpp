@@ -0,0 +1,97 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QSettings>
+
+#include "antenna.h"
+#include "rig.h"
+#include "rotor.h"
+
+//---------------------------------------------------------------------------
+TAntenna::TAntenna(TRig *rig_, int index_)
+{
+    rig   = rig_;
+    index = index_;
+    flags = AN_ENABLE;
+
+    name.sprintf("Antenna %d", index + 1);
+
+    rotor = new TRotor(rig);
+}
+
+//---------------------------------------------------------------------------
+TAntenna::~TAntenna(void)
+{
+    delete rotor;
+}
+
+//---------------------------------------------------------------------------
+void TAntenna::enable(bool on)
+{
+    flags &= ~AN_ENABLE;
+    flags |= on ? AN_ENABLE:0;
+}
+
+//---------------------------------------------------------------------------
+// the rotor of the first antenna stays in Rig/Rotor
+void TAntenna::writeSettings(QSettings *reg)
+{
+    QString group;
+
+    group.sprintf("Antenna%d", index + 1);
+
+    reg->beginGroup(group);
+      reg->setValue("Flags", flags);
+      reg->setValue("Name", name);
+      reg->setValue("Receiver", receiver);
+
+      if(index > 0)
+          rotor->writeSettings(reg);
+    reg->endGroup();
+
+    if(index == 0)
+        rotor->writeSettings(reg);
+}
+
+//---------------------------------------------------------------------------
+void TAntenna::readSettings(QSettings *reg)
+{
+    QString group, str;
+
+    group.sprintf("Antenna%d", index + 1);
+    str.sprintf("Antenna %d", index + 1);
+
+    reg->beginGroup(group);
+      flags    = reg->value("Flags", AN_ENABLE).toInt();
+      name     = reg->value("Name", str).toString();
+      receiver = reg->value("Receiver", QString("")).toString();
+
+      if(index > 0)
+          rotor->readSettings(reg);
+    reg->endGroup();
+
+    if(index == 0)
+        rotor->readSettings(reg);
+    else if(rotor->telemetry_file == "telemetry.ptl")
+        rotor->telemetry_file.sprintf("telemetry-%d.ptl", index + 1);
+}
+
+//---------------------------------------------------------------------------
@@ -1,6 +1,6 @@
 /*
     POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
-    Copyright (C) 2009-2011 Free Software Foundation, Inc.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -19,45 +19,44 @@
     Web: <http://www.poes-weather.com>
 */
 //---------------------------------------------------------------------------
-#include "jrklut.h"
+#ifndef ANTENNA_H
+#define ANTENNA_H
 
-//---------------------------------------------------------------------------
-JrkLUT::JrkLUT(void)
-{
-    target_ = 0;
-    degrees_ = 0;
-}
+#include <QString>
 
 //---------------------------------------------------------------------------
-JrkLUT::JrkLUT(unsigned short _target, double _degrees)
-{
-    target(_target);
-    degrees(_degrees);
-}
+#define AN_ENABLE           1       // antenna takes part in tracking
 
-//---------------------------------------------------------------------------
-JrkLUT::~JrkLUT()
-{
-    // nop
-}
+#define AN_MAX              4       // antennas of one station
 
-//---------------------------------------------------------------------------
-// 12 bit max ie 4095 counts
-void JrkLUT::target(unsigned short _target)
-{
-    target_ = _target & 0x0fff;
-}
+class QSettings;
+class TRig;
+class TRotor;
 
 //---------------------------------------------------------------------------
-// 0...360 (min...max) degrees
-void JrkLUT::degrees(double _degrees)
+// One antenna of the station, a rotor and the receiver its rx script
+// records with, see {RECEIVER} in TSatScript. The first antenna is the
+// rotor of TRig and always enabled.
+class TAntenna
 {
-    if(_degrees < 0)
-        _degrees = 0;
-    else if(_degrees > 360)
-        _degrees = 360;
+public:
+    TAntenna(TRig *rig_, int index_);
+    ~TAntenna(void);
+
+    void writeSettings(QSettings *reg);
+    void readSettings(QSettings *reg);
+
+    bool enable(void) { return (index == 0 || (flags & AN_ENABLE)) ? true:false; }
+    void enable(bool on);
+
+    TRig    *rig;
+    TRotor  *rotor;
 
-    degrees_ = _degrees;
-}
+    QString name;
+    QString receiver;
 
+    int     index;
+    int     flags;
+};
 
+#endif // ANTENNA_H
@@ -20,15 +20,16 @@
 */
 //---------------------------------------------------------------------------
 #include <QtGlobal>
-#include <QDateTime>
 #include <QString>
 #include <QSettings>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "gs232b.h"
 #include "rotor.h"
 #include "qextserialport.h"
+#include "serialengine.h"
 #include "utils.h"
 
 
@@ -50,12 +51,17 @@ TGS232B::TGS232B(TRotor *_rotor)
     current_el = 0;
     speed      = Speed_Middle_1;
     flags      = 0;
+
+    engine = new TSerialEngine(serialPort, SE_PROTO_GS232B);
+    engine->setTelemetry(rotor->telemetry);
 }
 
 //---------------------------------------------------------------------------
 TGS232B::~TGS232B(void)
 {
     closeCOM();
+
+    delete engine;
 }
 
 //---------------------------------------------------------------------------
@@ -112,18 +118,18 @@ bool TGS232B::openCOM(void)
     }
 
     if(rc) {
-#if 1
+        TPositionEvent ev;
+
+        engine->start();
+
         // set speed
-        delay(100);
         sprintf(iobuff, "X%d\r\n", (int) speed);
-        write_buffer(iobuff);
-        delay(100);
-#endif
-
-        rc = readPosition();
+        engine->send(iobuff, strlen(iobuff));
 
-        rotate_next = QDateTime::currentDateTime();
-        rotate_next.addMSecs(100);
+        if((rc = engine->waitPosition(SE_OPEN_TIMEOUT, &ev))) {
+            current_az = ev.az;
+            current_el = ev.el;
+        }
     }
 
     return rc;
@@ -138,6 +144,8 @@ bool TGS232B::isCOMOpen(void)
 //---------------------------------------------------------------------------
 void TGS232B::closeCOM(void)
 {
+    engine->stop();
+
     if(serialPort->isOpen())
         serialPort->close();
 
@@ -159,53 +167,6 @@ QString TGS232B::errorString(void)
     return str;
 }
 
-//---------------------------------------------------------------------------
-bool TGS232B::write_buffer(const char *buf)
-{
- unsigned int i;
- char ch;
-
-    // serialPort->flush();
-
-    for(i=0; i<strlen(buf); i++)
-    {
-        ch = buf[i];
-        if(!serialPort->putChar(ch)) {
-            qDebug("Error: Failed to send character");
-            return false;
-        }
-    }
-
-    return true;
-}
-
-//---------------------------------------------------------------------------
-bool TGS232B::read_buffer(char *buf, unsigned long bytes)
-{
- unsigned long wait_ms;
- int retry;
-
-    // 9600 bps => bytes * 8 / 9600 * 1000 = X ms
-
-    wait_ms = 100; // (unsigned long) rint((bytes * 8 / 9600) * 1000);
-
-    *buf = '\0';
-    retry = 0;
-    while(serialPort->bytesAvailable() < bytes) {
-        if(retry > 9) {
-            qDebug("Error: Too many read attempts %d, available %d ", retry, (int)serialPort->bytesAvailable());
-            return false;
-        }
-
-        delay(wait_ms);
-        retry++;
-    }
-
-    buf[bytes] = '\0';
-
-  return serialPort->read(buf, bytes) == bytes ? true:false;
-}
-
 //---------------------------------------------------------------------------
 void TGS232B::stop(void)
 {
@@ -213,42 +174,25 @@ void TGS232B::stop(void)
         return;
 
     sprintf(iobuff, "S\r\n");
-    write_buffer(iobuff);
+    engine->send(iobuff, strlen(iobuff));
 }
 
 //---------------------------------------------------------------------------
+// newest position reported by the rotor, a new one is requested
 bool TGS232B::readPosition(void)
 {
- int angle;
+ TPositionEvent ev;
 
     if(!isCOMOpen())
         return false;
 
-    // C2 will return 16 bytes on success
-    // AZ=000  EL=000 + carriage return 0x0D + line feed 0x0A
-
-    sprintf(iobuff, "C2\r\n");
-    if(!write_buffer(iobuff))
-        return false;
-
-    delay(300);
-
-    if(!read_buffer(iobuff, 16))
-        return false;
-
-    qDebug("%s", iobuff);
+    engine->query();
 
-    if(sscanf(iobuff+3, "%d", &angle) != 1) {
-        qDebug("wrong AZ/X reply %s", iobuff);
+    if(!engine->position(&ev))
         return false;
-    }
-    current_az = angle;
 
-    if (sscanf(iobuff+11, "%d", &angle) != 1) {
-        qDebug("wrong EL/Y reply %s", iobuff);
-        return false;
-    }
-    current_el = angle;
+    current_az = ev.az;
+    current_el = ev.el;
 
  return true;
 }
@@ -257,16 +201,10 @@ bool TGS232B::readPosition(void)
 bool TGS232B::moveTo(double az, double el)
 {
     double i_az, i_el, x, y;
-    unsigned long wait_ms;
 
     if(!isCOMOpen())
         return false;
 
-    if(rotate_next > QDateTime::currentDateTime())
-        return false;
-
-    qDebug("GS232 Move to Az/X: %.2f El/Y: %.2f", az, el);
-
     if(rotor->isXY()) {
         rotor->AzEltoXY(az, el, &x, &y);
         az = x;
@@ -279,23 +217,14 @@ bool TGS232B::moveTo(double az, double el)
     if(i_az == current_az && i_el == current_el)
         return true;
 
-    if(!rotor->isXY())
-        wait_ms = getRotationTime(i_az, i_el);
-
+    // a target that has not been written yet is replaced
     sprintf(iobuff, "W%03d %03d\r\n", (int) i_az, (int) i_el);
-    if(write_buffer(iobuff)) {
-       current_az = i_az;
-       current_el = i_el;
-
-       rotate_next = QDateTime::currentDateTime();
-       rotate_next.addMSecs(wait_ms + 100);
+    engine->move(iobuff, strlen(iobuff));
 
-       qDebug("GS232 Move to Az/X: %.2f El/Y: %.2f", current_az, current_el);
+    current_az = i_az;
+    current_el = i_el;
 
-       return true;
-    }
-    else
-        return false;
+    return true;
 }
 
 //---------------------------------------------------------------------------
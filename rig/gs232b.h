@@ -25,8 +25,8 @@
 #include "rig.h"
 
 class QextSerialPort;
-class QDateTime;
 class QSettings;
+class TSerialEngine;
 
 // ranges from 1 = slow to 4 fast
 typedef enum TGS232B_Speed_t
@@ -68,16 +68,12 @@ public:
 
     int flags;
 
-protected:
-    bool write_buffer(const char *buf);
-    bool read_buffer(char *buf, unsigned long bytes);
+    TSerialEngine *engine;
 
 private:
     TRotor *rotor;
     QextSerialPort *serialPort;
     char *iobuff;
-
-    QDateTime rotate_next;
 };
 
 #endif // GS232B_H
@@ -0,0 +1,709 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QProcess>
+#include <QSettings>
+#include <QFile>
+#include <QCoreApplication>
+#include <QStringList>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(Q_OS_UNIX)
+#  include <unistd.h>
+#  include <sys/time.h>
+#  include <sys/resource.h>
+#endif
+
+#include "jobscheduler.h"
+#include "simclock.h"
+#include "plist.h"
+
+#if defined(Q_OS_WIN32)
+#  define JS_NULL_DEVICE    "NUL"
+#else
+#  define JS_NULL_DEVICE    "/dev/null"
+#endif
+
+#define JS_LINE             4096
+
+//---------------------------------------------------------------------------
+TJobScheduler::TJobScheduler(void)
+{
+    pending = new PList;
+    active  = new PList;
+
+    max_jobs   = 0;
+    rx_jobs    = JS_RX_JOBS;
+    minutes    = JS_MINUTES;
+    nice       = JS_NICE;
+    rx_nice    = JS_RX_NICE;
+    queue_file = QCoreApplication::applicationDirPath() + "/jobs.queue";
+    log_file   = QCoreApplication::applicationDirPath() + "/jobs.log";
+
+    next_id     = 1;
+    sim_seconds = 0;
+    flags       = 0;
+}
+
+//---------------------------------------------------------------------------
+TJobScheduler::~TJobScheduler(void)
+{
+    stop();
+
+    clear(pending);
+    clear(active);
+
+    delete pending;
+    delete active;
+}
+
+//---------------------------------------------------------------------------
+void TJobScheduler::writeSettings(QSettings *reg)
+{
+    reg->beginGroup("Jobs");
+      reg->setValue("MaxJobs",   max_jobs);
+      reg->setValue("RxJobs",    rx_jobs);
+      reg->setValue("Minutes",   minutes);
+      reg->setValue("Nice",      nice);
+      reg->setValue("RxNice",    rx_nice);
+      reg->setValue("Queue",     queue_file);
+      reg->setValue("Log",       log_file);
+    reg->endGroup();
+}
+
+//---------------------------------------------------------------------------
+void TJobScheduler::readSettings(QSettings *reg)
+{
+    reg->beginGroup("Jobs");
+      max_jobs   = reg->value("MaxJobs",   0).toInt();
+      rx_jobs    = reg->value("RxJobs",    JS_RX_JOBS).toInt();
+      minutes    = reg->value("Minutes",   JS_MINUTES).toInt();
+      nice       = reg->value("Nice",      JS_NICE).toInt();
+      rx_nice    = reg->value("RxNice",    JS_RX_NICE).toInt();
+      queue_file = reg->value("Queue",     queue_file).toString();
+      log_file   = reg->value("Log",       log_file).toString();
+    reg->endGroup();
+
+    // the queue left by the previous run is loaded by the thread
+    if(!isRunning()) {
+        mutex.lock();
+        flags &= ~JS_STOP;
+        mutex.unlock();
+
+        start(QThread::LowPriority);
+    }
+}
+
+//---------------------------------------------------------------------------
+void TJobScheduler::stop(void)
+{
+    if(isRunning()) {
+        mutex.lock();
+        flags |= JS_STOP;
+        mutex.unlock();
+
+        wait();
+    }
+}
+
+//---------------------------------------------------------------------------
+bool TJobScheduler::submit(const QString &name, const QString &command, double priority)
+{
+    TJob *job;
+
+    if(command.trimmed().isEmpty())
+        return false;
+
+    job = new TJob;
+
+    // one line per job in the queue file
+    job->name     = QString(name).replace('\t', ' ').trimmed();
+    job->command  = QString(command).replace('\t', ' ').replace('\n', ' ').replace('\r', ' ');
+    job->priority = priority;
+    job->flags    = 0;
+    job->queued   = TSimClock::msecs();
+    job->started  = 0;
+    job->proc     = NULL;
+    job->cpu      = 0;
+    job->rss      = 0;
+
+    mutex.lock();
+
+    job->id = next_id++;
+    if(flags & JS_SIMULATE)
+        job->flags |= JOB_SIMULATED;
+    else
+        flags |= JS_CHANGED;
+
+    pending->Add(job);
+
+    mutex.unlock();
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// the tracker threads call it when their rx script starts and stops
+void TJobScheduler::reception(bool on)
+{
+    if(on)
+        receivers.ref();
+    else
+        receivers.deref();
+}
+
+//---------------------------------------------------------------------------
+int TJobScheduler::queued(void)
+{
+    int n;
+
+    mutex.lock();
+    n = pending->Count;
+    mutex.unlock();
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
+int TJobScheduler::running(void)
+{
+    int n;
+
+    mutex.lock();
+    n = active->Count;
+    mutex.unlock();
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
+int TJobScheduler::queued(bool simulated)
+{
+    int n;
+
+    mutex.lock();
+    n = count(pending, simulated);
+    mutex.unlock();
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
+int TJobScheduler::running(bool simulated)
+{
+    int n;
+
+    mutex.lock();
+    n = count(active, simulated);
+    mutex.unlock();
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
+// call with mutex locked
+int TJobScheduler::count(PList *list, bool simulated)
+{
+    TJob *job;
+    int  i, n;
+
+    n = 0;
+    for(i=0; i<list->Count; i++) {
+        job = (TJob *) list->ItemAt(i);
+        if(((job->flags & JOB_SIMULATED) ? true:false) == simulated)
+            n++;
+    }
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
+// simulated jobs only hold a slot for the given simulated seconds, the
+// real jobs wait until the simulation ends
+void TJobScheduler::simulate(bool on, int seconds)
+{
+    TJob *job;
+    int  i;
+
+    mutex.lock();
+
+    if(on) {
+        flags |= JS_SIMULATE;
+        sim_seconds = seconds;
+    }
+    else {
+        flags &= ~JS_SIMULATE;
+
+        for(i=pending->Count-1; i>=0; i--) {
+            job = (TJob *) pending->ItemAt(i);
+            if(job->flags & JOB_SIMULATED) {
+                pending->Delete(i);
+                delete job;
+            }
+        }
+
+        for(i=active->Count-1; i>=0; i--) {
+            job = (TJob *) active->ItemAt(i);
+            if(job->flags & JOB_SIMULATED) {
+                active->Delete(i);
+                delete job;
+            }
+        }
+    }
+
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+void TJobScheduler::run()
+{
+    TJob          *job;
+    unsigned long ms;
+    int           i;
+
+    mutex.lock();
+    load();
+
+    // flags are only read and written with mutex locked
+    while(!(flags & JS_STOP)) {
+        poll();
+        throttle();
+        schedule();
+
+        if(flags & JS_CHANGED)
+            save();
+
+        // follow the simulated clock
+        ms = JS_POLL_MS;
+        if(flags & JS_SIMULATE)
+            ms = (unsigned long) qMax(10.0, JS_POLL_MS / TSimClock::speed());
+
+        mutex.unlock();
+        msleep(ms);
+        mutex.lock();
+    }
+
+    // the jobs still running are stopped and queued, they run again at the next start
+    for(i=active->Count-1; i>=0; i--) {
+        job = (TJob *) active->ItemAt(i);
+        active->Delete(i);
+
+        if(job->proc) {
+            qDebug("Stopping post rx job %s, it is queued for the next start", job->name.toStdString().c_str());
+
+            job->proc->kill();
+            job->proc->waitForFinished();
+
+            delete job->proc;
+            job->proc = NULL;
+        }
+
+        if(job->flags & JOB_SIMULATED)
+            delete job;
+        else
+            pending->Add(job);
+    }
+
+    save();
+
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+int TJobScheduler::limit(void)
+{
+    int n;
+
+    n = max_jobs > 0 ? max_jobs:QThread::idealThreadCount();
+    if(n < 1)
+        n = 1;
+
+    if(receivers.fetchAndAddAcquire(0) > 0)
+        n = qMin(n, qMax(rx_jobs, 0));
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
+// starts the highest priority jobs, the oldest first on a tie
+void TJobScheduler::schedule(void)
+{
+    TJob *job, *best;
+    int  i, n, sim;
+
+    n   = limit();
+    sim = (flags & JS_SIMULATE) ? JOB_SIMULATED:0;
+
+    while(active->Count < n) {
+        best = NULL;
+
+        for(i=0; i<pending->Count; i++) {
+            job = (TJob *) pending->ItemAt(i);
+            if((job->flags & JOB_SIMULATED) != sim)
+                continue;
+
+            if(best == NULL || job->priority > best->priority ||
+               (job->priority == best->priority && job->id < best->id))
+                best = job;
+        }
+
+        if(best == NULL)
+            break;
+
+        pending->Delete(best);
+        startJob(best);
+    }
+}
+
+//---------------------------------------------------------------------------
+void TJobScheduler::startJob(TJob *job)
+{
+    job->started = TSimClock::msecs();
+    active->Add(job);
+
+    if(job->flags & JOB_SIMULATED)
+        return;
+
+    qDebug("Starting post rx job %s: %s", job->name.toStdString().c_str(), job->command.toStdString().c_str());
+
+    // nobody reads the output, a full pipe would block the script
+    job->proc = new QProcess;
+    job->proc->setStandardOutputFile(JS_NULL_DEVICE);
+    job->proc->setStandardErrorFile(JS_NULL_DEVICE);
+    job->proc->start(job->command);
+
+    if(!job->proc->waitForStarted()) {
+        qDebug("Error: post rx job %s failed to start [%s:%d]",
+               job->command.toStdString().c_str(), __FILE__, __LINE__);
+
+        finishJob(job, "failed", -1);
+        return;
+    }
+
+    renice(job, (flags & JS_THROTTLED) ? rx_nice:nice);
+}
+
+//---------------------------------------------------------------------------
+void TJobScheduler::poll(void)
+{
+    TJob   *job;
+    qint64 now;
+    int    i;
+
+    now = TSimClock::msecs();
+
+    for(i=active->Count-1; i>=0; i--) {
+        job = (TJob *) active->ItemAt(i);
+
+        if(job->flags & JOB_SIMULATED) {
+            if(now - job->started >= (qint64) sim_seconds * 1000)
+                finishJob(job, "ok", 0);
+
+            continue;
+        }
+
+        // there is no event loop in this thread, let the process notice its exit
+        job->proc->waitForFinished(0);
+
+        if(job->proc->state() == QProcess::NotRunning) {
+            if(job->proc->exitStatus() == QProcess::CrashExit)
+                finishJob(job, "crashed", -1);
+            else
+                finishJob(job, job->proc->exitCode() ? "failed":"ok", job->proc->exitCode());
+
+            continue;
+        }
+
+        sample(job);
+
+        if(minutes > 0 && now - job->started > (qint64) minutes * 60000) {
+            qDebug("Post rx job %s has been running over %d minutes, stopping it", job->name.toStdString().c_str(), minutes);
+
+            job->proc->kill();
+            job->proc->waitForFinished();
+
+            finishJob(job, "timeout", -1);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+void TJobScheduler::finishJob(TJob *job, const char *status, int code)
+{
+    active->Delete(job);
+
+    if(!(job->flags & JOB_SIMULATED)) {
+        account(job, status, code);
+        flags |= JS_CHANGED;
+    }
+
+    if(job->proc)
+        delete job->proc;
+
+    delete job;
+}
+
+//---------------------------------------------------------------------------
+// cpu time of the script and the children it has waited for, and the peak
+// resident size of the script
+void TJobScheduler::sample(TJob *job)
+{
+#if defined(Q_OS_LINUX)
+    char          path[64], buf[1024], *p;
+    FILE          *fp;
+    unsigned long utime, stime;
+    long          cutime, cstime, rss;
+    size_t        n;
+
+    sprintf(path, "/proc/%ld/stat", (long) job->proc->pid());
+    if((fp = fopen(path, "r")) == NULL)
+        return;
+
+    n = fread(buf, 1, sizeof(buf) - 1, fp);
+    buf[n] = '\0';
+    fclose(fp);
+
+    // the command name in parentheses may contain spaces
+    p = strrchr(buf, ')');
+    if(p && sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu %ld %ld",
+                   &utime, &stime, &cutime, &cstime) == 4)
+        job->cpu = (double) (utime + stime + cutime + cstime) / sysconf(_SC_CLK_TCK);
+
+    sprintf(path, "/proc/%ld/status", (long) job->proc->pid());
+    if((fp = fopen(path, "r")) == NULL)
+        return;
+
+    while(fgets(buf, sizeof(buf), fp))
+        if(strncmp(buf, "VmHWM:", 6) == 0) {
+            if(sscanf(buf + 6, "%ld", &rss) == 1 && rss > job->rss)
+                job->rss = rss;
+            break;
+        }
+
+    fclose(fp);
+#else
+    Q_UNUSED(job);
+#endif
+}
+
+//---------------------------------------------------------------------------
+// only the script itself, the children it starts later inherit the level
+void TJobScheduler::renice(TJob *job, int level)
+{
+#if defined(Q_OS_UNIX)
+    if(job->proc == NULL || job->proc->pid() <= 0)
+        return;
+
+    // an unprivileged user can not lower it back, the job then stays at the reception level
+    if(setpriority(PRIO_PROCESS, job->proc->pid(), level) < 0)
+        qDebug("Warning: failed to set the nice level %d of post rx job %s [%s:%d]",
+               level, job->name.toStdString().c_str(), __FILE__, __LINE__);
+#else
+    Q_UNUSED(job);
+    Q_UNUSED(level);
+#endif
+}
+
+//---------------------------------------------------------------------------
+void TJobScheduler::throttle(void)
+{
+    TJob *job;
+    bool rx;
+    int  i;
+
+    rx = receivers.fetchAndAddAcquire(0) > 0;
+    if(rx == ((flags & JS_THROTTLED) ? true:false))
+        return;
+
+    if(rx)
+        flags |= JS_THROTTLED;
+    else
+        flags &= ~JS_THROTTLED;
+
+    for(i=0; i<active->Count; i++) {
+        job = (TJob *) active->ItemAt(i);
+        renice(job, rx ? rx_nice:nice);
+    }
+}
+
+//---------------------------------------------------------------------------
+// id <tab> priority <tab> queued msecs <tab> satellite <tab> command
+bool TJobScheduler::load(void)
+{
+    QStringList list;
+    QString     str, filename;
+    TJob        *job;
+    FILE        *fp;
+    char        *buf;
+
+    filename = queue_file;
+
+    // the previous run stopped while saving
+    if(!QFile::exists(filename))
+        filename = queue_file + ".tmp";
+
+    fp = fopen(filename.toStdString().c_str(), "r");
+    if(fp == NULL)
+        return false;
+
+    buf = (char *) malloc(JS_LINE);
+
+    while(fgets(buf, JS_LINE, fp)) {
+        str = QString::fromUtf8(buf).trimmed();
+        if(str.isEmpty() || str.startsWith("#"))
+            continue;
+
+        list = str.split('\t');
+        if(list.count() < 5) {
+            qDebug("Error: invalid job in %s: %s [%s:%d]",
+                   filename.toStdString().c_str(), buf, __FILE__, __LINE__);
+            continue;
+        }
+
+        job = new TJob;
+
+        job->id       = list.at(0).toLongLong();
+        job->priority = list.at(1).toDouble();
+        job->queued   = list.at(2).toLongLong();
+        job->name     = list.at(3);
+        job->command  = QStringList(list.mid(4)).join(" ");
+        job->flags    = 0;
+        job->started  = 0;
+        job->proc     = NULL;
+        job->cpu      = 0;
+        job->rss      = 0;
+
+        next_id = qMax(next_id, job->id + 1);
+
+        pending->Add(job);
+    }
+
+    free(buf);
+    fclose(fp);
+
+    if(pending->Count)
+        qDebug("%d post rx jobs queued from %s", pending->Count, filename.toStdString().c_str());
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// running jobs are saved too, they did not finish if this process dies
+bool TJobScheduler::save(void)
+{
+    PList   *list[2] = { active, pending };
+    QString tmp;
+    TJob    *job;
+    FILE    *fp;
+    int     i, j;
+
+    flags &= ~JS_CHANGED;
+
+    tmp = queue_file + ".tmp";
+
+    fp = fopen(tmp.toStdString().c_str(), "w");
+    if(fp == NULL) {
+        qDebug("Error: failed to write the job queue %s [%s:%d]",
+               tmp.toStdString().c_str(), __FILE__, __LINE__);
+        return false;
+    }
+
+    fprintf(fp, "# post rx jobs: id, priority, queued, satellite, command\n");
+
+    for(j=0; j<2; j++)
+        for(i=0; i<list[j]->Count; i++) {
+            job = (TJob *) list[j]->ItemAt(i);
+            if(job->flags & JOB_SIMULATED)
+                continue;
+
+            fprintf(fp, "%lld\t%.2f\t%lld\t%s\t%s\n",
+                    (long long) job->id, job->priority, (long long) job->queued,
+                    job->name.toUtf8().constData(), job->command.toUtf8().constData());
+        }
+
+    fclose(fp);
+
+    QFile::remove(queue_file);
+    if(!QFile::rename(tmp, queue_file)) {
+        qDebug("Error: failed to rename %s [%s:%d]", tmp.toStdString().c_str(), __FILE__, __LINE__);
+        return false;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void TJobScheduler::account(TJob *job, const char *status, int code)
+{
+    QDateTime end;
+    qint64    now;
+    FILE      *fp;
+    bool      header;
+
+    now = TSimClock::msecs();
+    end = TSimClock::utc();
+
+    qDebug("Post rx job %s %s, %.0f s, cpu %.1f s", job->name.toStdString().c_str(), status,
+           (now - job->started) / 1000.0, job->cpu);
+
+    header = !QFile::exists(log_file);
+
+    fp = fopen(log_file.toStdString().c_str(), "a");
+    if(fp == NULL) {
+        qDebug("Error: failed to open the job log %s [%s:%d]",
+               log_file.toStdString().c_str(), __FILE__, __LINE__);
+        return;
+    }
+
+    if(header)
+        fprintf(fp, "end,satellite,priority,wait_s,run_s,cpu_s,max_rss_kb,status,exit_code\n");
+
+    fprintf(fp, "%s,%s,%.2f,%.0f,%.0f,%.2f,%ld,%s,%d\n",
+            end.toString(Qt::ISODate).toStdString().c_str(),
+            job->name.toUtf8().constData(),
+            job->priority,
+            (job->started - job->queued) / 1000.0,
+            (now - job->started) / 1000.0,
+            job->cpu,
+            job->rss,
+            status,
+            code);
+
+    fclose(fp);
+}
+
+//---------------------------------------------------------------------------
+void TJobScheduler::clear(PList *list)
+{
+    TJob *job;
+
+    while((job = (TJob *) list->Last())) {
+        list->Delete(job);
+
+        if(job->proc)
+            delete job->proc;
+        delete job;
+    }
+}
+
+//---------------------------------------------------------------------------
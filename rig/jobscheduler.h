@@ -0,0 +1,125 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <QtGlobal>
+#include <QThread>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QString>
+
+//---------------------------------------------------------------------------
+#define JS_STOP             1
+#define JS_SIMULATE         2       // jobs are stubs running on the simulated clock
+#define JS_CHANGED          4       // the queue file is out of date
+#define JS_THROTTLED        8       // jobs run at the reception nice level
+
+#define JS_POLL_MS          500
+#define JS_MINUTES          20      // default time limit of a job
+#define JS_NICE             10      // nice level of the jobs
+#define JS_RX_NICE          19      // during a reception
+#define JS_RX_JOBS          1       // concurrent jobs during a reception
+
+// job flags
+#define JOB_SIMULATED       1
+
+class QProcess;
+class QSettings;
+class PList;
+
+//---------------------------------------------------------------------------
+struct TJob
+{
+    qint64   id;
+    QString  name;                  // satellite
+    QString  command;
+    double   priority;              // max elevation of the pass, higher runs first
+    int      flags;
+
+    qint64   queued, started;       // TSimClock msecs
+    QProcess *proc;
+    double   cpu;                   // seconds, sampled while running
+    long     rss;                   // peak resident KB
+};
+
+//---------------------------------------------------------------------------
+// Post rx scripts of all antennas. Jobs are started highest priority first
+// up to a limit sized to the cores, while any antenna is receiving only
+// JS_RX_JOBS run and at a lower CPU priority. The queue is kept on disk so
+// jobs left at exit run at the next start, finished jobs are accounted in
+// a CSV log.
+class TJobScheduler : public QThread
+{
+public:
+    TJobScheduler(void);
+    ~TJobScheduler(void);
+
+    void writeSettings(QSettings *reg);
+    void readSettings(QSettings *reg);
+
+    // any thread
+    bool submit(const QString &name, const QString &command, double priority);
+    void reception(bool on);
+    int  queued(void);
+    int  running(void);
+    int  queued(bool simulated);    // only the simulated or only the real jobs
+    int  running(bool simulated);
+
+    void simulate(bool on, int seconds);
+    void stop(void);
+
+    int     max_jobs;               // 0 = one per core
+    int     rx_jobs;
+    int     minutes;                // 0 = no time limit
+    int     nice, rx_nice;
+    QString queue_file, log_file;
+
+protected:
+    void run();
+
+    int  limit(void);
+    void schedule(void);
+    void poll(void);
+    void startJob(TJob *job);
+    void finishJob(TJob *job, const char *status, int code);
+    void sample(TJob *job);
+    void renice(TJob *job, int level);
+    void throttle(void);
+
+    bool load(void);
+    bool save(void);
+    void account(TJob *job, const char *status, int code);
+
+    void clear(PList *list);
+    int  count(PList *list, bool simulated);
+
+private:
+    PList      *pending, *active;
+    QMutex     mutex;
+    QAtomicInt receivers;
+    qint64     next_id;
+    int        sim_seconds;
+    int        flags;
+};
+
+#endif // JOBSCHEDULER_H
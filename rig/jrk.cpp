@@ -411,6 +411,48 @@ void TJRK::loadLUT(bool az)
     }
 }
 
+//---------------------------------------------------------------------------
+void TJRK::beginSunScan(void)
+{
+    az_jrk->beginSunScan();
+    el_jrk->beginSunScan();
+}
+
+//---------------------------------------------------------------------------
+void TJRK::sunSample(double sun_az, double sun_el, double power)
+{
+    if(!isOpen())
+        return;
+
+    if(az_jrk->isFlagOn(JRK_USE_LUT))
+        az_jrk->sunSample(sun_az, power);
+
+    if(el_jrk->isFlagOn(JRK_USE_LUT))
+        el_jrk->sunSample(sun_el, power);
+}
+
+//---------------------------------------------------------------------------
+// an axis that was not swept has no peak and is left as is
+bool TJRK::endSunScan(void)
+{
+    bool az, el;
+
+    az = az_jrk->endSunScan();
+    el = el_jrk->endSunScan();
+
+    if(az) {
+        rotor->az_min = az_jrk->minPos();
+        rotor->az_max = az_jrk->maxPos();
+    }
+
+    if(el) {
+        rotor->el_min = el_jrk->minPos();
+        rotor->el_max = el_jrk->maxPos();
+    }
+
+    return az || el;
+}
+
 //---------------------------------------------------------------------------
 bool TJRK::readPosition(void)
 {
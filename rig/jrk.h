@@ -84,6 +84,11 @@ public:
     void    lutFile(bool az, QString lut);
     void    loadLUT(bool az);
 
+    // sweep the antenna over the sun, power is the received sun noise
+    void    beginSunScan(void);
+    void    sunSample(double sun_az, double sun_el, double power);
+    bool    endSunScan(void);
+
     double  current_az();
     double  current_el();
 
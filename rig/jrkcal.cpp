@@ -0,0 +1,608 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2011 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "jrkcal.h"
+
+//---------------------------------------------------------------------------
+typedef struct TJrkPoint
+{
+    double t, d;
+} TJrkPoint;
+
+//---------------------------------------------------------------------------
+static int comparePoint(const void *a, const void *b)
+{
+    double d = ((const TJrkPoint *) a)->t - ((const TJrkPoint *) b)->t;
+
+    return d < 0 ? -1:(d > 0 ? 1:0);
+}
+
+//---------------------------------------------------------------------------
+static int compareSample(const void *a, const void *b)
+{
+    double d = ((const TJrkScanSample *) a)->target - ((const TJrkScanSample *) b)->target;
+
+    return d < 0 ? -1:(d > 0 ? 1:0);
+}
+
+//---------------------------------------------------------------------------
+TJrkCalibration::TJrkCalibration(void)
+{
+    kt = kd = km = NULL;
+    num_points = 0;
+
+    scan = NULL;
+    scan_count = 0;
+
+    clear();
+}
+
+//---------------------------------------------------------------------------
+TJrkCalibration::~TJrkCalibration(void)
+{
+    clear();
+
+    if(scan)
+        free(scan);
+}
+
+//---------------------------------------------------------------------------
+void TJrkCalibration::clear(void)
+{
+    int i;
+
+    if(kt)
+        free(kt);
+    kt = kd = km = NULL;
+
+    num_points = 0;
+    num_peaks = 0;
+
+    deg_min = deg_max = 0;
+    deg_scale = 0;
+
+    for(i=0; i<JC_SIZE; i++) {
+        to_deg[i] = 0;
+        to_target[i] = 0;
+    }
+}
+
+//---------------------------------------------------------------------------
+// sorts and merges the points, pool adjacent violators then flattens any
+// noise against the overall direction so the fit is monotone
+bool TJrkCalibration::fit(const unsigned short *target, const double *degrees, int n)
+{
+    TJrkPoint *p;
+    double    *w, dir;
+    int       *len, i, j, k, m, l;
+
+    clear();
+
+    if(n < 1)
+        return false;
+
+    p   = (TJrkPoint *) malloc(n * sizeof(TJrkPoint));
+    w   = (double *) malloc(n * sizeof(double));
+    len = (int *) malloc(n * sizeof(int));
+    kt  = (double *) malloc(3 * n * sizeof(double));
+
+    if(!p || !w || !len || !kt) {
+        qDebug("Error: out of memory [%s:%d]", __FILE__, __LINE__);
+
+        if(p) free(p);
+        if(w) free(w);
+        if(len) free(len);
+        clear();
+
+        return false;
+    }
+
+    kd = kt + n;
+    km = kd + n;
+
+    for(i=0; i<n; i++) {
+        p[i].t = target[i] & 0x0fff;
+        p[i].d = degrees[i];
+    }
+
+    qsort(p, n, sizeof(TJrkPoint), comparePoint);
+
+    // average equal targets
+    for(i=0, m=0; i<n; m++) {
+        for(j=i+1; j<n && p[j].t == p[i].t; j++)
+            p[i].d += p[j].d;
+
+        p[m].t = p[i].t;
+        p[m].d = p[i].d / (j - i);
+        i = j;
+    }
+
+    dir = p[m-1].d >= p[0].d ? 1:-1;
+
+    // blocks of pooled points, value, weight and number of points
+    for(i=0, k=0; i<m; i++) {
+        kd[k]  = dir * p[i].d;
+        w[k]   = 1;
+        len[k] = 1;
+
+        while(k > 0 && kd[k-1] > kd[k]) {
+            kd[k-1] = (kd[k-1] * w[k-1] + kd[k] * w[k]) / (w[k-1] + w[k]);
+            w[k-1] += w[k];
+            len[k-1] += len[k];
+            k--;
+        }
+
+        k++;
+    }
+
+    // expand the blocks from the back, kd is overwritten in place
+    for(i=m, j=k-1; j>=0; j--)
+        for(l=0; l<len[j]; l++)
+            w[--i] = dir * kd[j];
+
+    for(i=0; i<m; i++) {
+        kt[i] = p[i].t;
+        kd[i] = w[i];
+    }
+
+    num_points = m;
+
+    free(p);
+    free(w);
+    free(len);
+
+    tangents();
+
+    if(!build()) {
+        qDebug("Jrk calibration: the fit is not monotone [%s:%d]", __FILE__, __LINE__);
+        clear();
+
+        return false;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// Fritsch-Butland tangents, zero at a local extreme, keeps the cubic monotone
+void TJrkCalibration::tangents(void)
+{
+    double h0, h1, d0, d1;
+    int    k, n = num_points;
+
+    if(n < 2) {
+        if(n == 1)
+            km[0] = 0;
+
+        return;
+    }
+
+    km[0]   = (kd[1] - kd[0]) / (kt[1] - kt[0]);
+    km[n-1] = (kd[n-1] - kd[n-2]) / (kt[n-1] - kt[n-2]);
+
+    for(k=1; k<n-1; k++) {
+        h0 = kt[k] - kt[k-1];
+        h1 = kt[k+1] - kt[k];
+        d0 = (kd[k] - kd[k-1]) / h0;
+        d1 = (kd[k+1] - kd[k]) / h1;
+
+        if(d0 * d1 <= 0)
+            km[k] = 0;
+        else
+            km[k] = 3.0 * (h0 + h1) / ((2.0 * h1 + h0) / d0 + (h1 + 2.0 * h0) / d1);
+    }
+}
+
+//---------------------------------------------------------------------------
+// flat outside the points
+double TJrkCalibration::spline(double t)
+{
+    double h, s, s2, s3;
+    int    lo, hi, k;
+
+    if(num_points < 1)
+        return 0;
+    if(t <= kt[0])
+        return kd[0];
+    if(t >= kt[num_points-1])
+        return kd[num_points-1];
+
+    lo = 0;
+    hi = num_points - 1;
+    while(hi - lo > 1) {
+        k = (lo + hi) / 2;
+        if(kt[k] <= t)
+            lo = k;
+        else
+            hi = k;
+    }
+
+    h  = kt[hi] - kt[lo];
+    s  = (t - kt[lo]) / h;
+    s2 = s * s;
+    s3 = s2 * s;
+
+    return (2*s3 - 3*s2 + 1) * kd[lo] + (s3 - 2*s2 + s) * h * km[lo] +
+           (3*s2 - 2*s3) * kd[hi] + (s3 - s2) * h * km[hi];
+}
+
+//---------------------------------------------------------------------------
+double TJrkCalibration::correction(double t)
+{
+    int i;
+
+    if(num_peaks < 1)
+        return 0;
+    if(t <= peak_t[0])
+        return peak_r[0];
+    if(t >= peak_t[num_peaks-1])
+        return peak_r[num_peaks-1];
+
+    for(i=1; peak_t[i] < t; i++)
+        ;
+
+    return peak_r[i-1] + (t - peak_t[i-1]) * (peak_r[i] - peak_r[i-1]) / (peak_t[i] - peak_t[i-1]);
+}
+
+//---------------------------------------------------------------------------
+// samples the corrected cubic for every target and inverts it over the
+// degree range of the points, targets outside the points are never returned.
+// false if the correction made it non monotone
+bool TJrkCalibration::build(void)
+{
+    double deg;
+    int    i, t, lo, hi, t0, t1, up;
+
+    for(t=0; t<JC_SIZE; t++)
+        to_deg[t] = spline(t) + correction(t);
+
+    limits();
+
+    t0 = (int) ceil(kt[0]);
+    t1 = (int) floor(kt[num_points-1]);
+
+    if(deg_scale <= 0) {
+        for(i=0; i<JC_SIZE; i++)
+            to_target[i] = kt[0];
+
+        return true;
+    }
+
+    up = to_deg[t1] >= to_deg[t0];
+
+    // rounding of a flat segment is not a reversal
+    for(t=t0+1; t<=t1; t++)
+        if((up ? to_deg[t-1] - to_deg[t]:to_deg[t] - to_deg[t-1]) > 1e-9)
+            return false;
+
+    for(i=0; i<JC_SIZE; i++) {
+        deg = deg_min + i / deg_scale;
+
+        // first target at or past deg
+        lo = t0;
+        hi = t1;
+        while(lo < hi) {
+            t = (lo + hi) / 2;
+            if(up ? to_deg[t] >= deg:to_deg[t] <= deg)
+                hi = t;
+            else
+                lo = t + 1;
+        }
+
+        if(lo > t0 && to_deg[lo] != to_deg[lo-1])
+            to_target[i] = (lo - 1) + (deg - to_deg[lo-1]) / (to_deg[lo] - to_deg[lo-1]);
+        else
+            to_target[i] = lo;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void TJrkCalibration::limits(void)
+{
+    double d0 = to_deg[(int) ceil(kt[0])];
+    double d1 = to_deg[(int) floor(kt[num_points-1])];
+
+    deg_min = d0 < d1 ? d0:d1;
+    deg_max = d0 < d1 ? d1:d0;
+
+    deg_scale = deg_max - deg_min > 1e-9 ? (JC_SIZE - 1) / (deg_max - deg_min):0;
+}
+
+//---------------------------------------------------------------------------
+unsigned short TJrkCalibration::toTarget(double deg)
+{
+    double u, v;
+    int    i;
+
+    if(num_points < 1)
+        return 0;
+
+    u = (deg - deg_min) * deg_scale;
+    if(u <= 0)
+        v = to_target[0];
+    else if(u >= JC_SIZE - 1)
+        v = to_target[JC_SIZE - 1];
+    else {
+        i = (int) u;
+        v = to_target[i] + (u - i) * (to_target[i+1] - to_target[i]);
+    }
+
+    return ((unsigned short) rint(v)) & 0x0fff;
+}
+
+//---------------------------------------------------------------------------
+// FNV-1a
+quint64 TJrkCalibration::hash(const char *data, qint64 size)
+{
+    quint64 h = Q_UINT64_C(14695981039346656037);
+    qint64  i;
+
+    for(i=0; i<size; i++) {
+        h ^= (unsigned char) data[i];
+        h *= Q_UINT64_C(1099511628211);
+    }
+
+    return h;
+}
+
+//---------------------------------------------------------------------------
+bool TJrkCalibration::load(const QString &file, quint64 hash_, qint64 size)
+{
+    TJrkCalHeader hdr;
+    FILE *fp;
+    bool rc;
+    int  n;
+
+    clear();
+
+    if(!(fp = fopen(file.toStdString().c_str(), "rb")))
+        return false;
+
+    if(fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+       hdr.magic != JC_CACHE_MAGIC || hdr.version != JC_CACHE_VERSION ||
+       hdr.hash != hash_ || hdr.size != size ||
+       hdr.points == 0 || hdr.points > JC_SIZE || hdr.peaks > JC_MAX_PEAKS)
+    {
+        fclose(fp);
+        return false;
+    }
+
+    n  = hdr.points;
+    kt = (double *) malloc(3 * n * sizeof(double));
+
+    rc = kt != NULL;
+    if(rc) {
+        kd = kt + n;
+        km = kd + n;
+
+        rc = fread(kt, sizeof(double), n, fp) == (size_t) n &&
+             fread(kd, sizeof(double), n, fp) == (size_t) n &&
+             fread(peak_t, sizeof(double), hdr.peaks, fp) == hdr.peaks &&
+             fread(peak_r, sizeof(double), hdr.peaks, fp) == hdr.peaks &&
+             fread(to_deg, sizeof(double), JC_SIZE, fp) == JC_SIZE &&
+             fread(to_target, sizeof(float), JC_SIZE, fp) == JC_SIZE;
+    }
+
+    fclose(fp);
+
+    if(!rc) {
+        qDebug("Failed to read %s [%s:%d]", file.toStdString().c_str(), __FILE__, __LINE__);
+        clear();
+
+        return false;
+    }
+
+    num_points = n;
+    num_peaks  = hdr.peaks;
+
+    tangents();
+    limits();
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TJrkCalibration::save(const QString &file, quint64 hash_, qint64 size)
+{
+    TJrkCalHeader hdr;
+    FILE *fp;
+    bool rc;
+
+    if(num_points < 1)
+        return false;
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic   = JC_CACHE_MAGIC;
+    hdr.version = JC_CACHE_VERSION;
+    hdr.points  = num_points;
+    hdr.peaks   = num_peaks;
+    hdr.hash    = hash_;
+    hdr.size    = size;
+
+    if(!(fp = fopen(file.toStdString().c_str(), "wb"))) {
+        qDebug("Failed to create %s [%s:%d]", file.toStdString().c_str(), __FILE__, __LINE__);
+        return false;
+    }
+
+    rc = fwrite(&hdr, sizeof(hdr), 1, fp) == 1 &&
+         fwrite(kt, sizeof(double), num_points, fp) == (size_t) num_points &&
+         fwrite(kd, sizeof(double), num_points, fp) == (size_t) num_points &&
+         fwrite(peak_t, sizeof(double), num_peaks, fp) == (size_t) num_peaks &&
+         fwrite(peak_r, sizeof(double), num_peaks, fp) == (size_t) num_peaks &&
+         fwrite(to_deg, sizeof(double), JC_SIZE, fp) == JC_SIZE &&
+         fwrite(to_target, sizeof(float), JC_SIZE, fp) == JC_SIZE;
+
+    fclose(fp);
+
+    if(!rc) {
+        qDebug("Failed to write %s [%s:%d]", file.toStdString().c_str(), __FILE__, __LINE__);
+        remove(file.toStdString().c_str());
+    }
+
+    return rc;
+}
+
+//---------------------------------------------------------------------------
+void TJrkCalibration::beginScan(void)
+{
+    scan_count = 0;
+}
+
+//---------------------------------------------------------------------------
+void TJrkCalibration::addScanSample(unsigned short t, double sun_deg, double power)
+{
+    TJrkScanSample *tmp;
+
+    if(scan_count >= JC_MAX_SCAN)
+        return;
+
+    if(scan == NULL) {
+        tmp = (TJrkScanSample *) malloc(JC_MAX_SCAN * sizeof(TJrkScanSample));
+        if(tmp == NULL)
+            return;
+
+        scan = tmp;
+    }
+
+    scan[scan_count].target  = t & 0x0fff;
+    scan[scan_count].degrees = sun_deg;
+    scan[scan_count].power   = power;
+    scan_count++;
+}
+
+//---------------------------------------------------------------------------
+// the peak is the vertex of a parabola through the strongest sample and its
+// neighbours, the sun position is interpolated at the peak target
+bool TJrkCalibration::endScan(void)
+{
+    TJrkScanSample *s;
+    double a, b, den, x0, x1, x2, t, deg;
+    int    i, m, n;
+
+    n = scan_count;
+    scan_count = 0;
+
+    if(n < JC_MIN_SCAN || num_points < 1)
+        return false;
+
+    qsort(scan, n, sizeof(TJrkScanSample), compareSample);
+
+    for(i=1, m=0; i<n; i++)
+        if(scan[i].power > scan[m].power)
+            m = i;
+
+    if(m == 0 || m == n - 1) {
+        qDebug("Jrk sun scan: the peak is at the end of the scan [%s:%d]", __FILE__, __LINE__);
+        return false;
+    }
+
+    s  = scan + m - 1;
+    x0 = s[0].target;
+    x1 = s[1].target;
+    x2 = s[2].target;
+
+    den = (x0 - x1) * (x0 - x2) * (x1 - x2);
+    if(den == 0)
+        t = x1;
+    else {
+        a = (x2 * (s[1].power - s[0].power) + x1 * (s[0].power - s[2].power) + x0 * (s[2].power - s[1].power)) / den;
+        b = (x2 * x2 * (s[0].power - s[1].power) + x1 * x1 * (s[2].power - s[0].power) + x0 * x0 * (s[1].power - s[2].power)) / den;
+
+        if(a >= 0) {
+            qDebug("Jrk sun scan: no peak found [%s:%d]", __FILE__, __LINE__);
+            return false;
+        }
+
+        t = -b / (2.0 * a);
+        t = t < x0 ? x0:(t > x2 ? x2:t);
+    }
+
+    i = t < x1 ? 0:1;
+    deg = s[i+1].target > s[i].target ?
+          s[i].degrees + (t - s[i].target) * (s[i+1].degrees - s[i].degrees) / (s[i+1].target - s[i].target):
+          s[i].degrees;
+
+    return refine(t, deg);
+}
+
+//---------------------------------------------------------------------------
+// the difference to the fitted cubic replaces an earlier peak closer than
+// JC_MERGE targets or is added, it is rejected if it breaks the monotony
+bool TJrkCalibration::refine(double t, double deg)
+{
+    double old_t[JC_MAX_PEAKS], old_r[JC_MAX_PEAKS], r;
+    int    i, k, old_n;
+
+    old_n = num_peaks;
+    memcpy(old_t, peak_t, sizeof(old_t));
+    memcpy(old_r, peak_r, sizeof(old_r));
+
+    r = deg - spline(t);
+
+    for(i=0, k=-1; i<num_peaks; i++)
+        if(fabs(peak_t[i] - t) <= JC_MERGE && (k < 0 || fabs(peak_t[i] - t) < fabs(peak_t[k] - t)))
+            k = i;
+
+    if(k >= 0) {
+        // removed and inserted again, it may have moved past a neighbour
+        memmove(peak_t + k, peak_t + k + 1, (num_peaks - k - 1) * sizeof(double));
+        memmove(peak_r + k, peak_r + k + 1, (num_peaks - k - 1) * sizeof(double));
+        num_peaks--;
+    }
+    else if(num_peaks >= JC_MAX_PEAKS) {
+        qDebug("Jrk sun scan: too many peaks [%s:%d]", __FILE__, __LINE__);
+        return false;
+    }
+
+    for(i=num_peaks; i>0 && peak_t[i-1] > t; i--) {
+        peak_t[i] = peak_t[i-1];
+        peak_r[i] = peak_r[i-1];
+    }
+
+    peak_t[i] = t;
+    peak_r[i] = r;
+    num_peaks++;
+
+    if(!build()) {
+        qDebug("Jrk sun scan: %.2f degrees at target %.1f is not monotone, rejected [%s:%d]",
+               deg, t, __FILE__, __LINE__);
+
+        num_peaks = old_n;
+        memcpy(peak_t, old_t, sizeof(old_t));
+        memcpy(peak_r, old_r, sizeof(old_r));
+        build();
+
+        return false;
+    }
+
+    qDebug("Jrk sun scan: %.2f degrees at target %.1f, correction %.2f degrees", deg, t, r);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
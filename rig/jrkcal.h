@@ -0,0 +1,115 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2011 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef JRKCAL_H
+#define JRKCAL_H
+
+#include <QtGlobal>
+#include <QString>
+
+//---------------------------------------------------------------------------
+#define JC_SIZE             4096       // 12 bit target, entries per table
+#define JC_CACHE_MAGIC      0x4c41434a // "JCAL"
+#define JC_CACHE_VERSION    1
+#define JC_CACHE_EXT        ".cal"
+#define JC_MERGE            16         // a sun peak this close to an earlier one replaces it
+#define JC_MAX_PEAKS        64
+#define JC_MIN_SCAN         5          // samples needed to find a sun peak
+#define JC_MAX_SCAN         4096
+
+//---------------------------------------------------------------------------
+struct TJrkCalHeader
+{
+    quint32 magic, version, points, peaks;
+    quint64 hash;
+    qint64  size;
+};
+
+//---------------------------------------------------------------------------
+struct TJrkScanSample
+{
+    double target, degrees, power;
+};
+
+//---------------------------------------------------------------------------
+// Jrk target <-> degrees calibration. A monotone cubic (Fritsch-Butland) is
+// fitted to the lookup table points and sampled into a table for every
+// target and an inverse table over the degree range, both conversions are
+// then a table lookup.
+// The tables are cached in <lut file>.cal as long as the hash and size of
+// the lookup table file match. Sun peaks found by scanning the antenna over
+// the sun correct the fit, the correction is linear between the peaks and
+// constant outside them, one peak is an offset.
+class TJrkCalibration
+{
+public:
+    TJrkCalibration(void);
+    ~TJrkCalibration(void);
+
+    void clear(void);
+    bool isValid(void) { return num_points > 0; }
+
+    // the points can be in any order, noise is flattened to keep it monotone
+    bool fit(const unsigned short *target, const double *degrees, int n);
+
+    double toDegrees(unsigned short t) { return to_deg[t & 0x0fff]; }
+    unsigned short toTarget(double deg);
+
+    double minDegrees(void) { return deg_min; }
+    double maxDegrees(void) { return deg_max; }
+    int    points(void) { return num_points; }
+    int    refinements(void) { return num_peaks; }
+
+    bool load(const QString &file, quint64 hash_, qint64 size);
+    bool save(const QString &file, quint64 hash_, qint64 size);
+
+    static quint64 hash(const char *data, qint64 size);
+
+    // sweep the antenna over the sun, power is any received signal level,
+    // endScan() fits the peak and adds it to the points
+    void beginScan(void);
+    void addScanSample(unsigned short t, double sun_deg, double power);
+    bool endScan(void);
+
+protected:
+    void   tangents(void);
+    double spline(double t);
+    double correction(double t);
+    bool   build(void);
+    void   limits(void);
+    bool   refine(double t, double deg);
+
+private:
+    double *kt, *kd, *km; // points and tangents, increasing target
+    int    num_points;
+
+    double peak_t[JC_MAX_PEAKS], peak_r[JC_MAX_PEAKS]; // target, degrees - spline
+    int    num_peaks;
+
+    double deg_min, deg_max, deg_scale;
+    double to_deg[JC_SIZE];
+    float  to_target[JC_SIZE];
+
+    TJrkScanSample *scan;
+    int    scan_count;
+};
+
+#endif // JRKCAL_H
@@ -26,7 +26,7 @@
 
 #include "jrkusb.h"
 #include "usbdevice.h"
-#include "jrklut.h"
+#include "jrkcal.h"
 #include "utils.h"
 
 //---------------------------------------------------------------------------
@@ -41,6 +41,10 @@ TJrkUSB::TJrkUSB(void)
     current_deg = 0;
     counter = 0;
 
+    cal = new TJrkCalibration;
+    lut_hash = 0;
+    lut_size = 0;
+
     iobuff = (unsigned char *) malloc(JRK_IO_BUF_SIZE + 1);
     memset(&vars, 0, sizeof(jrk_variables_t));
 }
@@ -49,7 +53,7 @@ TJrkUSB::TJrkUSB(void)
 TJrkUSB::~TJrkUSB(void)
 {
     free(iobuff);
-    flushLUT();
+    delete cal;
 }
 
 //---------------------------------------------------------------------------
@@ -224,11 +228,11 @@ unsigned short TJrkUSB::toValue(double deg, int mode)
 
     // check
     if(mode & 1)
-        if(!isFlagOn(JRK_USE_LUT) || jrklut.size() == 0)
+        if(!isFlagOn(JRK_USE_LUT) || !cal->isValid())
             mode &= ~1;
 
     if(mode & 1)
-        t = lutToTarget(deg);
+        t = cal->toTarget(deg);
     else {
         delta = max_deg - min_deg;
 
@@ -282,11 +286,11 @@ double TJrkUSB::toDegrees(unsigned short t, int mode)
 
     // check
     if(mode & 8)
-        if(!isFlagOn(JRK_USE_LUT) || jrklut.size() == 0)
+        if(!isFlagOn(JRK_USE_LUT) || !cal->isValid())
             mode &= ~8;
 
     if(mode & 8)
-        deg = lutToDegrees(t);
+        deg = cal->toDegrees(t);
 
     return deg;
 }
@@ -329,115 +333,14 @@ bool TJrkUSB::moveTo(double deg, int mode)
     return true;
 }
 
-//---------------------------------------------------------------------------
-double TJrkUSB::lutToDegrees(unsigned short t)
-{
-    JrkLUT *l, *l_min = NULL, *l_max = NULL;
-    double d_min = min_deg, d_max = max_deg;
-    double t_min = 0, t_max = 4095;
-    double deg, delta_t, delta_d;
-    size_t i;
-
-    t &= 0x0fff;
-    for(i=0; i<jrklut.size(); i++) {
-        l = (JrkLUT *) jrklut.at(i);
-
-        if(l->target() <= t)
-            l_min = l;
-
-        if(l->target() >= t)
-            l_max = l;
-
-        if(l_min && l_max)
-            break;
-    }
-
-    if(l_min) {
-        d_min = l_min->degrees();
-        t_min = l_min->target();
-    }
-
-    if(l_max) {
-        d_max = l_max->degrees();
-        t_max = l_max->target();
-    }
-
-    delta_t = t_max - t_min;
-    delta_d = d_max - d_min;
-
-    if(delta_t <= 0)
-        deg = d_min;
-    else
-        deg = d_min + ((((double) t) - t_min) * delta_d) / delta_t;
-
-    return deg;
-}
-
-//---------------------------------------------------------------------------
-unsigned short TJrkUSB::lutToTarget(double deg)
-{
-    JrkLUT *l, *l_min = NULL, *l_max = NULL;
-    double d_min = min_deg, d_max = max_deg;
-    double t_min = 0, t_max = 4095;
-    double v, delta_t, delta_d;
-    unsigned short t;
-    size_t i;
-
-    deg = deg < min_deg ? min_deg:(deg > max_deg ? max_deg:deg);
-
-    for(i=0; i<jrklut.size(); i++) {
-        l = (JrkLUT *) jrklut.at(i);
-
-        if(l->degrees() <= deg)
-            l_min = l;
-
-        if(l->degrees() >= deg)
-            l_max = l;
-
-        if(l_min && l_max)
-            break;
-    }
-
-    if(l_min) {
-        d_min = l_min->degrees();
-        t_min = l_min->target();
-    }
-
-    if(l_max) {
-        d_max = l_max->degrees();
-        t_max = l_max->target();
-    }
-
-    delta_t = t_max - t_min;
-    delta_d = d_max - d_min;
-
-    if(delta_d <= 0)
-        v = t_min;
-    else
-        v = t_min + (deg - d_min) * delta_t / delta_d;
-
-    t = ((unsigned short) rint(v)) & 0x0fff;
-
-    return t;
-}
-
-//---------------------------------------------------------------------------
-void TJrkUSB::flushLUT(void)
-{
-    vector<JrkLUT *>::iterator i = jrklut.begin();
-
-    for(; i < jrklut.end(); i++)
-        delete *i;
-
-    jrklut.clear();
-}
-
 //---------------------------------------------------------------------------
 void TJrkUSB::loadLUT(void)
 {
     bool error = true;
 
-    flushLUT();
+    cal->clear();
+    lut_hash = 0;
+    lut_size = 0;
 
     if(isFlagOn(JRK_USE_LUT)) {
         if(!lutFile_.isEmpty()) {
@@ -455,52 +358,111 @@ void TJrkUSB::loadLUT(void)
         return;
     }
 
+    QFile file(lutFile_);
+    QByteArray data;
+
+    if(file.open(QIODevice::ReadOnly)) {
+        data = file.readAll();
+        file.close();
+
+        lut_hash = TJrkCalibration::hash(data.constData(), data.size());
+        lut_size = data.size();
+    }
+
     //
-    // load the lookup table ini file
+    // the fitted tables are cached, the ini file is only parsed when it has changed
     //
 
-    QSettings reg(lutFile_, QSettings::IniFormat);
+    if(!cal->load(lutFile_ + JC_CACHE_EXT, lut_hash, lut_size)) {
+        QSettings reg(lutFile_, QSettings::IniFormat);
 
-    QString d_str, t_str, str;
-    double  d, min_d = 1e12, max_d = -1e12;
-    int     t, i = 0;
+        QString d_str, t_str, str;
+        unsigned short *targets;
+        double  *degrees, d;
+        int     t, i, n;
 
-    reg.beginGroup("JrkTargetToDegrees");
+        targets = (unsigned short *) malloc(JC_SIZE * sizeof(unsigned short));
+        degrees = (double *) malloc(JC_SIZE * sizeof(double));
 
-    for(i=0; i <= 4095; i++) {
-        t_str.sprintf("Target-%04d", i);
-        str = reg.value(t_str, "").toString();
-        if(str.isEmpty())
-            continue;
+        n = 0;
 
-        t = str.toInt();
+        reg.beginGroup("JrkTargetToDegrees");
 
-        d_str.sprintf("Degrees-%04d", i);
-        str = reg.value(d_str, "").toString();
+        for(i=0; i <= 4095 && targets && degrees; i++) {
+            t_str.sprintf("Target-%04d", i);
+            str = reg.value(t_str, "").toString();
+            if(str.isEmpty())
+                continue;
 
-        if(str.isEmpty())
-            break;
+            t = str.toInt();
 
-        d = str.toDouble();
+            d_str.sprintf("Degrees-%04d", i);
+            str = reg.value(d_str, "").toString();
 
-        if(t < 0 || t > 4095 || d < 0 || d > 360)
-            break;
+            if(str.isEmpty())
+                break;
 
-        if(d < min_d)
-            min_d = d;
-        if(d > max_d)
-            max_d = d;
+            d = str.toDouble();
 
-        jrklut.push_back(new JrkLUT(t, d));
-    }
+            if(t < 0 || t > 4095 || d < 0 || d > 360)
+                break;
+
+            targets[n] = t;
+            degrees[n] = d;
+            n++;
+        }
+
+        reg.endGroup();
 
-    reg.endGroup();
+        if(cal->fit(targets, degrees, n) && lut_size > 0)
+            cal->save(lutFile_ + JC_CACHE_EXT, lut_hash, lut_size);
 
-    if(jrklut.size() < 1)
+        if(targets)
+            free(targets);
+        if(degrees)
+            free(degrees);
+    }
+
+    if(!cal->isValid())
         setFlag(JRK_USE_LUT, false);
     else {
-        min_deg = min_d;
-        max_deg = max_d;
+        min_deg = cal->minDegrees();
+        max_deg = cal->maxDegrees();
     }
+}
 
+//---------------------------------------------------------------------------
+void TJrkUSB::beginSunScan(void)
+{
+    cal->beginScan();
 }
+
+//---------------------------------------------------------------------------
+// samples the sun at the current feedback position
+bool TJrkUSB::sunSample(double sun_deg, double power)
+{
+    if(!isOpen() || !cal->isValid() || !readVariables())
+        return false;
+
+    cal->addScanSample(vars.scaledFeedback, sun_deg, power);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// the refined tables replace the cached ones
+bool TJrkUSB::endSunScan(void)
+{
+    if(!cal->endScan())
+        return false;
+
+    if(lut_size > 0)
+        cal->save(lutFile_ + JC_CACHE_EXT, lut_hash, lut_size);
+
+    min_deg = cal->minDegrees();
+    max_deg = cal->maxDegrees();
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
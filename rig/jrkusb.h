@@ -35,7 +35,7 @@
 //---------------------------------------------------------------------------
 class TUSBDevice;
 class QSettings;
-class JrkLUT;
+class TJrkCalibration;
 
 using namespace std;
 
@@ -64,6 +64,11 @@ public:
     void    lutFile(QString lut) { lutFile_ = lut; }
     void    loadLUT(void);
 
+    // refines the lookup table from a sweep over the sun, see TJrkCalibration
+    void    beginSunScan(void);
+    bool    sunSample(double sun_deg, double power);
+    bool    endSunScan(void);
+
     void    stop(void);
     void    clearErrors(void);
     void    errorStr(QStringList *sl);
@@ -81,12 +86,6 @@ public:
     TUSBDevice *udev(void) { return jrk; }
     jrk_variables vars;
 
-protected:
-    double lutToDegrees(unsigned short t);
-    unsigned short lutToTarget(double deg);
-
-    void flushLUT(void);
-
 private:
     TUSBDevice    *jrk;
     unsigned char *iobuff;
@@ -96,7 +95,9 @@ private:
     double     max_deg, min_deg, current_deg;
     int counter;
 
-    vector<JrkLUT *> jrklut;
+    TJrkCalibration *cal;
+    quint64 lut_hash;
+    qint64  lut_size;
 };
 
 #endif // JRKUSB_H
@@ -20,7 +20,6 @@
 */
 //---------------------------------------------------------------------------
 #include <QtGlobal>
-#include <QDateTime>
 #include <QString>
 #include <QSettings>
 #include <stdio.h>
@@ -29,6 +28,7 @@
 #include "monstrum.h"
 #include "rotor.h"
 #include "qextserialport.h"
+#include "serialengine.h"
 #include "utils.h"
 
 #define MONSTER_DEBUG 1 // level, 0 = off, 1...ON
@@ -51,6 +51,9 @@ TMonstrum::TMonstrum(TRotor *_rotor)
     current_el = current_y = 0;
 
     flags = 0;
+
+    engine = new TSerialEngine(serialPort, SE_PROTO_MONSTRUM);
+    engine->setTelemetry(rotor->telemetry);
 }
 
 //---------------------------------------------------------------------------
@@ -108,12 +111,17 @@ bool TMonstrum::openCOM(void)
     }
 
     if(rc) {
+        TPositionEvent ev;
+
+        engine->start();
         enable();
 
-        rc = readPosition();
+        if((rc = engine->waitPosition(SE_OPEN_TIMEOUT, &ev))) {
+            current_x = ev.az;
+            current_y = ev.el;
 
-        rotate_next = QDateTime::currentDateTime();
-        rotate_next.addMSecs(100);
+            rotor->XYtoAzEl(current_x, current_y, &current_az, &current_el);
+        }
     }
 
     return rc;
@@ -123,6 +131,8 @@ bool TMonstrum::openCOM(void)
 TMonstrum::~TMonstrum(void)
 {
     closeCOM();
+
+    delete engine;
 }
 
 //---------------------------------------------------------------------------
@@ -173,6 +183,8 @@ void TMonstrum::test(void)
 //---------------------------------------------------------------------------
 void TMonstrum::closeCOM(void)
 {
+    engine->stop();
+
     if(serialPort->isOpen())
         serialPort->close();
 
@@ -205,16 +217,11 @@ QString TMonstrum::statusString(void)
     iobuff[2] = 0x08; // command
     iobuff[3] = 0x50; // P
 
-    if(!write_buffer(4))
-        return "Monstrum: Failed to write status!";
-
-    delay(100);
-
     QString str, str2;
 
     str = "Monstrum " + deviceId + "\n\n";
 
-    if(!read_buffer(11))
+    if(engine->transact(iobuff, 4, iobuff, 11, 1000) < 10)
         str2 = "Error: Failed to read Monstrum status!";
     else {
         str2.sprintf("\
@@ -240,44 +247,6 @@ Rotor state: %s\n",
     return str;
 }
 
-//---------------------------------------------------------------------------
-bool TMonstrum::write_buffer(unsigned long bytes)
-{
-    unsigned long i;
-    for(i=0; i<bytes; i++)
-    {
-        // qDebug("Monstrum write 0x%.2x", (unsigned char) iobuff[i]);
-        if(!serialPort->putChar(iobuff[i])) {
-            qDebug("Monstrum Error: Failed to send character!");
-            return false;
-        }
-    }
-
-    return true;
-}
-
-//---------------------------------------------------------------------------
-bool TMonstrum::read_buffer(unsigned long bytes)
-{
-    unsigned long wait_ms;
-    int retry;
-
-    wait_ms = 100;
-
-    retry = 0;
-    while(serialPort->bytesAvailable() < bytes) {
-        if(retry > 20) {
-            qDebug("Monstrum Error: Too many read attempts %d, available %d bytes", retry, (int)serialPort->bytesAvailable());
-            return false;
-        }
-
-        delay(wait_ms);
-        retry++;
-    }
-
-  return serialPort->read(iobuff, bytes) == bytes ? true:false;
-}
-
 //---------------------------------------------------------------------------
 void TMonstrum::enable(void)
 {
@@ -289,9 +258,7 @@ void TMonstrum::enable(void)
     iobuff[2] = 0x06; // command
     iobuff[3] = 0x50; // P
 
-    write_buffer(4);
-
-    delay(200);
+    engine->send(iobuff, 4);
 }
 
 //---------------------------------------------------------------------------
@@ -305,37 +272,25 @@ void TMonstrum::stop(void)
     iobuff[2] = 0x02; // command
     iobuff[3] = 0x50; // P
 
-    write_buffer(4);
+    engine->send(iobuff, 4);
 }
 
 //---------------------------------------------------------------------------
+// newest position reported by the rotor, a new one is requested
 bool TMonstrum::readPosition(void)
 {
-    if(!isCOMOpen())
-        return false;
+    TPositionEvent ev;
 
-    iobuff[0] = 0x53; // S
-    iobuff[1] = 0x04; // length
-    iobuff[2] = 0x03; // command
-    iobuff[3] = 0x50; // P
-
-    if(!write_buffer(4))
+    if(!isCOMOpen())
         return false;
 
-    delay(100);
+    engine->query();
 
-    if(!read_buffer(16))
+    if(!engine->position(&ev))
         return false;
 
-    char tmp[10];
-
-    // X position
-    memcpy(&tmp, iobuff + 4, 5); tmp[6] = '\0';
-    current_x = atof(tmp) / 100.0;
-
-    // Y position
-    memcpy(&tmp, iobuff + 10, 5); tmp[6] = '\0';
-    current_y = atof(tmp) / 100.0;
+    current_x = ev.az;
+    current_y = ev.el;
 
     rotor->XYtoAzEl(current_x, current_y, &current_az, &current_el);
 
@@ -372,7 +327,7 @@ bool TMonstrum::moveTo(double az, double el)
 //---------------------------------------------------------------------------
 bool TMonstrum::moveToXY(double x, double y)
 {
-    if(rotate_next > QDateTime::currentDateTime())
+    if(!isCOMOpen())
         return false;
 
     // check if satellite moved enough
@@ -395,17 +350,13 @@ bool TMonstrum::moveToXY(double x, double y)
 
     iobuff[15] = 0x50; // P
 
-    if(write_buffer(16)) {
-       current_x = x;
-       current_y = y;
+    // a target that has not been written yet is replaced
+    engine->move(iobuff, 16);
 
-       rotate_next = QDateTime::currentDateTime();
-       rotate_next.addMSecs(getRotationTime(x, y));
+    current_x = x;
+    current_y = y;
 
-       return true;
-    }
-    else
-        return false;
+    return true;
 }
 
 //---------------------------------------------------------------------------
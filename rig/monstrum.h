@@ -25,8 +25,8 @@
 #include "rig.h"
 
 class QextSerialPort;
-class QDateTime;
 class QSettings;
+class TSerialEngine;
 
 class TMonstrum
 {
@@ -60,10 +60,10 @@ public:
 
     int flags;
 
+    TSerialEngine *engine;
+
 protected:
     void enable(void);
-    bool write_buffer(unsigned long bytes);
-    bool read_buffer(unsigned long bytes);
 
     void test(void);
 
@@ -72,8 +72,6 @@ private:
     QextSerialPort *serialPort;
     char *iobuff;
 
-    QDateTime rotate_next;
-
 };
 
 #endif // MONSTRUM_H
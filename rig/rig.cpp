@@ -52,6 +52,8 @@
 //---------------------------------------------------------------------------
 TRig::TRig(void)
 {
+ int i;
+
   flags = 0;
 
   // downconverter local oscillator fequency
@@ -68,7 +70,19 @@ TRig::TRig(void)
 
   oak_device = "/dev/hiddev0";
 
-  rotor = new TRotor(this);
+  sim_speed    = 1000;
+  sim_days     = 1;
+  sim_post_rx  = 300;
+  sim_timeline = "timeline.txt";
+
+  antenna[0] = new TAntenna(this, 0);
+  for(i=1; i<AN_MAX; i++)
+      antenna[i] = NULL;
+
+  antennas = 1;
+  rotor    = antenna[0]->rotor;
+
+  jobs = new TJobScheduler;
 
 #if 0
 #if defined(Q_OS_UNIX)
@@ -85,7 +99,13 @@ TRig::TRig(void)
 //---------------------------------------------------------------------------
 TRig::~TRig(void)
 {
-    delete rotor;
+    int i;
+
+    delete jobs;
+
+    for(i=0; i<AN_MAX; i++)
+        if(antenna[i])
+            delete antenna[i];
 
 #if 0
 #if defined(Q_OS_UNIX)
@@ -99,6 +119,8 @@ TRig::~TRig(void)
 //---------------------------------------------------------------------------
 void TRig::writeSettings(QSettings *reg)
 {
+    int i;
+
     reg->beginGroup("Rig");
 
       reg->setValue("Flags", flags);
@@ -118,7 +140,20 @@ void TRig::writeSettings(QSettings *reg)
         reg->setValue("LOSElev",    los_elev);
       reg->endGroup();
 
-      rotor->writeSettings(reg);
+      reg->beginGroup("Simulation");
+        reg->setValue("Start",    sim_start.isValid() ? sim_start.toString(Qt::ISODate):QString(""));
+        reg->setValue("Speed",    sim_speed);
+        reg->setValue("Days",     sim_days);
+        reg->setValue("PostRx",   sim_post_rx);
+        reg->setValue("Timeline", sim_timeline);
+      reg->endGroup();
+
+      reg->setValue("Antennas", antennas);
+
+      for(i=0; i<antennas; i++)
+          antenna[i]->writeSettings(reg);
+
+      jobs->writeSettings(reg);
 
     reg->endGroup();
 }
@@ -126,6 +161,8 @@ void TRig::writeSettings(QSettings *reg)
 //---------------------------------------------------------------------------
 void TRig::readSettings(QSettings *reg)
 {
+    int i;
+
     reg->beginGroup("Rig");
 
       flags      = reg->value("Flags", 0).toInt();
@@ -145,7 +182,27 @@ void TRig::readSettings(QSettings *reg)
         los_elev  = reg->value("LOSElev",   5).toInt();
       reg->endGroup();
 
-      rotor->readSettings(reg);
+      reg->beginGroup("Simulation");
+        sim_start = QDateTime::fromString(reg->value("Start", QString("")).toString(), Qt::ISODate);
+        sim_start.setTimeSpec(Qt::UTC);
+        sim_speed    = reg->value("Speed",  1000).toDouble();
+        sim_days     = reg->value("Days",      1).toDouble();
+        sim_post_rx  = reg->value("PostRx",  300).toInt();
+        sim_timeline = reg->value("Timeline", QString("timeline.txt")).toString();
+      reg->endGroup();
+
+      // antennas are only added, the trackers hold on to them
+      antennas = reg->value("Antennas", 1).toInt();
+      antennas = antennas < 1 ? 1:(antennas > AN_MAX ? AN_MAX:antennas);
+
+      for(i=0; i<antennas; i++) {
+          if(antenna[i] == NULL)
+              antenna[i] = new TAntenna(this, i);
+
+          antenna[i]->readSettings(reg);
+      }
+
+      jobs->readSettings(reg);
 
     reg->endGroup();
 }
@@ -186,6 +243,13 @@ void TRig::passthresholds(bool on)
     flags |= on ? R_THRESHOLD_ENABLE:0;
 }
 
+//---------------------------------------------------------------------------
+void TRig::simulate(bool on)
+{
+    flags &= ~R_SIMULATE;
+    flags |= on ? R_SIMULATE:0;
+}
+
 //---------------------------------------------------------------------------
 //
 //  Toradex Oak USB azimuth/elevation sensor
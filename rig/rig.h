@@ -32,6 +32,8 @@
 #include "alphaspid.h"
 #include "jrk.h"
 #include "monstrum.h"
+#include "antenna.h"
+#include "jobscheduler.h"
 
 //---------------------------------------------------------------------------
 typedef enum PassThresholdType_t
@@ -43,6 +45,7 @@ typedef enum PassThresholdType_t
 #define R_USRP_REC_ENABLE             1       // execute usrp and record automatically
 #define R_THRESHOLD_ENABLE            2       // pass thresholds are enabled
 #define R_OAK_ENABLE               4096       // use Oak USB to read Az/El
+#define R_SIMULATE                 8192       // track on the simulated clock, see TSimClock
 
 
 #define DC_LO_L_BAND               0       // frequency band index in array
@@ -88,13 +91,29 @@ public:
     // Oak USB
     QString oak_device;
 
+    // tracker simulation, an invalid start time is the current time
+    bool simulate(void) { return (flags & R_SIMULATE) ? true:false; }
+    void simulate(bool on);
+
+    QDateTime sim_start;
+    double    sim_speed, sim_days;
+    int       sim_post_rx;           // seconds a stub post rx script runs
+    QString   sim_timeline;
+
     // satellite recording thresholds
     PassThresholdType_t threshold;
     int pass_elev, aos_elev, los_elev;
 
-    // rotor
+    // rotor of the first antenna
     TRotor *rotor;
 
+    // antennas tracking concurrently, the first antennas of the array are in use
+    TAntenna *antenna[AN_MAX];
+    int      antennas;
+
+    // post rx scripts of all antennas
+    TJobScheduler *jobs;
+
 #if 0
 #if defined(Q_OS_UNIX)
 
@@ -27,6 +27,9 @@
 #include "rotor.h"
 #include "utils.h"
 #include "qextserialport.h"
+#include "rotoremulator.h"
+#include "serialengine.h"
+#include "telemetry.h"
 
 #define SER_IO_BUFF_SIZE 128
 
@@ -41,12 +44,18 @@ TRotor::TRotor(TRig *_rig)
     serialPort_2 = new QextSerialPort(QextSerialPort::Polling);
     iobuff       = (char *) malloc(SER_IO_BUFF_SIZE);
 
+    // before the controllers, their serial engines record to it
+    telemetry      = new TTelemetry;
+    telemetry_file = "telemetry.ptl";
+
     stepper = new TStepper(this);
     gs232b  = new TGS232B(this);
     spid    = new TAlphaSpid(this);
     jrk     = new TJRK(this);
     monster = new TMonstrum(this);
 
+    emulator = new TRotorEmulator(this);
+
     parkAz = 0;
     parkEl = 90;
 
@@ -55,6 +64,12 @@ TRotor::TRotor(TRig *_rig)
     az_speed = 20;
     el_speed = 20;
 
+    az_rate = 6;
+    el_rate = 3;
+    az_accel = 0;
+    el_accel = 0;
+    lookahead = 1;
+
     wobble_radius = 1;
 
     commtype = Comm_Default;
@@ -71,6 +86,8 @@ TRotor::~TRotor(void)
     delete spid;
     delete jrk;
     delete monster;
+    delete emulator;
+    delete telemetry;
 
     delete serialPort;
     delete serialPort_2;
@@ -105,6 +122,23 @@ void TRotor::writeSettings(QSettings *reg)
       reg->setValue("AzSpeed", az_speed);
       reg->setValue("ElSpeed", el_speed);
 
+      reg->setValue("AzRate", az_rate);
+      reg->setValue("ElRate", el_rate);
+      reg->setValue("AzAccel", az_accel);
+      reg->setValue("ElAccel", el_accel);
+      reg->setValue("LookAhead", lookahead);
+
+      reg->beginGroup("Emulator");
+        reg->setValue("AzRate", emulator->az_rate);
+        reg->setValue("ElRate", emulator->el_rate);
+        reg->setValue("ReplyDelay", emulator->reply_ms);
+        reg->setValue("DropRate", emulator->drop_rate);
+      reg->endGroup();
+
+      reg->beginGroup("Telemetry");
+        reg->setValue("File", telemetry_file);
+      reg->endGroup();
+
       reg->setValue("WobbleRadius", wobble_radius);
 
 
@@ -141,6 +175,23 @@ void TRotor::readSettings(QSettings *reg)
       az_speed = reg->value("AzSpeed", 1).toInt();
       el_speed = reg->value("ElSpeed", 1).toInt();
 
+      az_rate = reg->value("AzRate", 6).toDouble();
+      el_rate = reg->value("ElRate", 3).toDouble();
+      az_accel = reg->value("AzAccel", 0).toDouble();
+      el_accel = reg->value("ElAccel", 0).toDouble();
+      lookahead = reg->value("LookAhead", 1).toDouble();
+
+      reg->beginGroup("Emulator");
+        emulator->az_rate = reg->value("AzRate", 6).toDouble();
+        emulator->el_rate = reg->value("ElRate", 3).toDouble();
+        emulator->reply_ms = reg->value("ReplyDelay", 30).toInt();
+        emulator->drop_rate = reg->value("DropRate", 0).toDouble();
+      reg->endGroup();
+
+      reg->beginGroup("Telemetry");
+        telemetry_file = reg->value("File", QString("telemetry.ptl")).toString();
+      reg->endGroup();
+
       wobble_radius = reg->value("WobbleRadius", 1).toDouble();
 
       stepper->readSettings(reg);
@@ -210,6 +261,9 @@ void TRotor::parkingEnabled(bool park)
 //---------------------------------------------------------------------------
 bool TRotor::openPort(void)
 {
+    if(emulate())
+        return openEmulator();
+
     switch(rotor_type)
     {
     case RotorType_Stepper:  return stepper->openLPT();
@@ -231,6 +285,62 @@ void TRotor::closePort(void)
     spid->closeCOM();
     jrk->close();
     monster->closeCOM();
+
+    emulator->close();
+}
+
+//---------------------------------------------------------------------------
+void TRotor::emulate(bool enable)
+{
+    flags &= ~R_ROTOR_EMULATE;
+    flags |= enable ? R_ROTOR_EMULATE:0;
+}
+
+//---------------------------------------------------------------------------
+void TRotor::recordTelemetry(bool enable)
+{
+    flags &= ~R_ROTOR_TELEMETRY;
+    flags |= enable ? R_ROTOR_TELEMETRY:0;
+}
+
+//---------------------------------------------------------------------------
+// opens the controller on the pseudo-terminal of the emulator,
+// the configured device is kept
+bool TRotor::openEmulator(void)
+{
+    QString *dev, id;
+    int     protocol;
+    bool    rc;
+
+    switch(rotor_type)
+    {
+    case RotorType_GS232B:   dev = &gs232b->deviceId;  protocol = SE_PROTO_GS232B; break;
+    case RotorType_SPID:     dev = &spid->deviceId;    protocol = SE_PROTO_SPID; break;
+    case RotorType_Monstrum: dev = &monster->deviceId; protocol = SE_PROTO_MONSTRUM; break;
+
+    default:
+        qDebug("Error: %s can not be emulated [%s:%d]",
+               getRotorName().toStdString().c_str(),
+               __FILE__, __LINE__);
+        return false;
+    }
+
+    if(!emulator->open(protocol))
+        return false;
+
+    id = *dev;
+    *dev = emulator->deviceName();
+
+    switch(rotor_type)
+    {
+    case RotorType_GS232B:   rc = gs232b->openCOM(); break;
+    case RotorType_SPID:     rc = spid->openCOM(); break;
+    default:                 rc = monster->openCOM(); break;
+    }
+
+    *dev = id;
+
+    return rc;
 }
 
 //---------------------------------------------------------------------------
@@ -391,6 +501,28 @@ bool TRotor::moveTo(double az, double el)
     }
 }
 
+//---------------------------------------------------------------------------
+// position planned by TRotorPlan, the axes are only limited
+bool TRotor::moveToAxis(double az, double el)
+{
+    double raz, rel;
+
+    raz = ClipValue(az, az_max, az_min);
+    rel = ClipValue(el, el_max, el_min);
+
+    switch(rotor_type)
+    {
+    case RotorType_Stepper:  return stepper->moveTo(raz, rel);
+    case RotorType_GS232B:   return gs232b->moveTo(raz, rel);
+    case RotorType_SPID:     return spid->moveTo(raz, rel);
+    case RotorType_JRK:      return jrk->moveTo(raz, rel);
+    case RotorType_Monstrum: return monster->moveTo(raz, rel);
+
+    default:
+        return false;
+    }
+}
+
 //---------------------------------------------------------------------------
 bool TRotor::moveToAz(double az)
 {
@@ -460,6 +592,58 @@ bool TRotor::readPosition(void)
     }
 }
 
+//---------------------------------------------------------------------------
+// the serial controllers poll the position on their own, no query is sent,
+// Stepper and Jrk only know their own step counts and feedback
+bool TRotor::getReportedAzEl(double *az, double *el)
+{
+    TSerialEngine  *engine;
+    TPositionEvent ev;
+    double         a, e;
+
+    switch(rotor_type)
+    {
+    case RotorType_GS232B:   engine = gs232b->engine; break;
+    case RotorType_SPID:     engine = spid->engine; break;
+    case RotorType_Monstrum: engine = monster->engine; break;
+
+    default:
+        engine = NULL;
+    }
+
+    if(engine) {
+        if(!engine->position(&ev))
+            return false;
+
+        a = ev.az;
+        e = ev.el;
+    }
+    else {
+        a = getAzimuth();
+        e = getElevation();
+    }
+
+    if(isXY()) {
+        XYtoAzEl(a, e, az, el);
+        return true;
+    }
+
+    // elevation over 90 degrees, az + 180 on a flipped pass
+    if(e > 90) {
+        e = 180.0 - e;
+        a += 180.0;
+    }
+
+    a = fmod(a, 360.0);
+    if(a < 0)
+        a += 360.0;
+
+    *az = a;
+    *el = e;
+
+    return true;
+}
+
 //---------------------------------------------------------------------------
 double TRotor::getAzimuth(void)
 {
@@ -546,18 +730,13 @@ void TRotor::wobble(void)
 //---------------------------------------------------------------------------
 unsigned long TRotor::getRotationTime(double toAz, double toEl)
 {
-    unsigned long ms;
-
 #if 1
 
-    double az_time = fabs(getAzimuth() - toAz) * ((double) az_speed);
-    double el_time = fabs(getElevation() - toEl) * ((double) el_speed);
-
-    ms = rint(MAX(az_time, el_time));
-
-    return ms;
+    return getRotationTime(getAzimuth(), getElevation(), toAz, toEl);
 
 #else
+    unsigned long ms;
+
     switch(rotor_type)
     {
     case RotorType_GS232B:
@@ -583,6 +762,16 @@ unsigned long TRotor::getRotationTime(double toAz, double toEl)
 
 }
 
+//---------------------------------------------------------------------------
+// estimated time between two antenna positions, used by the pass scheduler
+unsigned long TRotor::getRotationTime(double fromAz, double fromEl, double toAz, double toEl)
+{
+    double az_time = fabs(fromAz - toAz) * ((double) az_speed);
+    double el_time = fabs(fromEl - toEl) * ((double) el_speed);
+
+    return rint(MAX(az_time, el_time));
+}
+
 //---------------------------------------------------------------------------
 void TRotor::AzEltoXY(double az, double el, double *x, double *y)
 {
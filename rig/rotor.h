@@ -34,6 +34,8 @@
 #define R_ROTOR_XY_TYPE          512
 #define R_ROTOR_TURN_EL_ONLY_WHEN_ZENITH     1024       // turn elevation axis only on zenith pass
 #define R_ROTOR_ZENITH_PASS                  2048       // tracking a zenith pass
+#define R_ROTOR_EMULATE                      4096       // controller is emulated on a pseudo-terminal
+#define R_ROTOR_TELEMETRY                    8192       // pointing telemetry is recorded while tracking
 
 //---------------------------------------------------------------------------
 
@@ -46,6 +48,8 @@ class TGS232B;
 class TAlphaSpid;
 class TJRK;
 class TMonstrum;
+class TRotorEmulator;
+class TTelemetry;
 
 class QextSerialPort;
 
@@ -86,9 +90,17 @@ public:
     TJRK       *jrk;
     TMonstrum  *monster;
 
+    TRotorEmulator *emulator;
+    TTelemetry     *telemetry;
+    QString        telemetry_file;
+
     double      az_max, az_min, el_max, el_min;
     int         az_speed, el_speed;
 
+    // pass planning, deg/s, deg/s^2 (0 = not limited) and seconds
+    double      az_rate, el_rate, az_accel, el_accel;
+    double      lookahead;
+
     TCommType  commtype;
     QString    host;
     int        port;
@@ -110,6 +122,12 @@ public:
     void closePort(void);
     bool isPortOpen(void); 
 
+    void emulate(bool enable);
+    bool emulate(void) { return ((flags & R_ROTOR_EMULATE) ? true:false); }
+
+    void recordTelemetry(bool enable);
+    bool recordTelemetry(void) { return ((flags & R_ROTOR_TELEMETRY) ? true:false); }
+
     QString getErrorString(void);
     QString getStatusString(void);
 
@@ -128,6 +146,7 @@ public:
     bool moveToAz(double az);
     bool moveToEl(double el);
     bool moveToXY(double x, double y);
+    bool moveToAxis(double az, double el); // rotor axis position, no CCW mapping
 
     void isXY(bool yes);
     bool isXY(void);
@@ -149,12 +168,16 @@ public:
     bool isZenithPass(void) { return ((flags & R_ROTOR_ZENITH_PASS) ? true:false); }
 
     bool readPosition(void);
+    // last position the controller reported, converted to az 0-360 el 0-90
+    bool getReportedAzEl(double *az, double *el);
     unsigned long getRotationTime(double toAz, double toEl);
+    unsigned long getRotationTime(double fromAz, double fromEl, double toAz, double toEl);
 
     int  flags;
     char *iobuff;
 
 private:
+    bool openEmulator(void);
 
 };
 
@@ -0,0 +1,445 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QDateTime>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "rotoremulator.h"
+#include "serialengine.h"
+#include "rotor.h"
+#include "utils.h"
+#include "simclock.h"
+
+//---------------------------------------------------------------------------
+TRotorEmulator::TRotorEmulator(TRotor *rotor_)
+{
+    rotor = rotor_;
+
+    protocol = SE_PROTO_GS232B;
+    flags    = 0;
+    rx_len   = 0;
+
+    az_rate   = 6;
+    el_rate   = 3;
+    reply_ms  = 30;
+    drop_rate = 0;
+
+    cur_az = cur_el = target_az = target_el = 0;
+    move_ms = 0;
+
+    resetStats();
+}
+
+//---------------------------------------------------------------------------
+TRotorEmulator::~TRotorEmulator(void)
+{
+    close();
+}
+
+//---------------------------------------------------------------------------
+bool TRotorEmulator::open(int protocol_)
+{
+    if(isOpen())
+        return true;
+
+    if(!pty.open())
+        return false;
+
+    protocol = protocol_;
+    flags    = 0;
+    rx_len   = 0;
+
+    // Monstrum X/Y 90/90 is zenith
+    cur_az = target_az = protocol == SE_PROTO_MONSTRUM ? 90:0;
+    cur_el = target_el = protocol == SE_PROTO_MONSTRUM ? 90:0;
+
+    resetStats();
+
+    qDebug("rotor emulator on %s", pty.slaveName().toStdString().c_str());
+
+    start();
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void TRotorEmulator::close(void)
+{
+    if(isRunning()) {
+        flags |= RE_STOP;
+        wait();
+    }
+
+    pty.close();
+}
+
+//---------------------------------------------------------------------------
+void TRotorEmulator::run()
+{
+    qint64 now, last;
+    int    n;
+
+    last = TSimClock::msecs();
+
+    while(!(flags & RE_STOP)) {
+        n = pty.read(rx + rx_len, sizeof(rx) - rx_len, RE_TICK_MS);
+        if(n > 0) {
+            rx_len += n;
+            parse();
+        }
+
+        now = TSimClock::msecs();
+        step((now - last) / 1000.0);
+        last = now;
+    }
+}
+
+//---------------------------------------------------------------------------
+// moves both axes towards the target at their slew rates
+void TRotorEmulator::step(double secs)
+{
+    double d, v;
+
+    mutex.lock();
+
+    d = target_az - cur_az;
+    v = az_rate * secs;
+    cur_az = fabs(d) <= v ? target_az:(cur_az + (d < 0 ? -v:v));
+
+    d = target_el - cur_el;
+    v = el_rate * secs;
+    cur_el = fabs(d) <= v ? target_el:(cur_el + (d < 0 ? -v:v));
+
+    if((flags & RE_BUSY) &&
+       fabs(target_az - cur_az) < RE_SETTLE && fabs(target_el - cur_el) < RE_SETTLE)
+    {
+        d = (double) (TSimClock::msecs() - move_ms);
+
+        st.settled++;
+        st.settle_sum += d;
+        st.settle_max = MAX(st.settle_max, d);
+
+        flags &= ~RE_BUSY;
+    }
+
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+void TRotorEmulator::moveTo(double az, double el)
+{
+    mutex.lock();
+
+    target_az = az;
+    target_el = el;
+    move_ms   = TSimClock::msecs();
+    flags    |= RE_BUSY;
+
+    st.moves++;
+
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+void TRotorEmulator::position(double *az, double *el)
+{
+    mutex.lock();
+    *az = cur_az;
+    *el = cur_el;
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+void TRotorEmulator::reply(const char *buf, int len)
+{
+    if(drop_rate > 0 && rand() < drop_rate * RAND_MAX) {
+        st.dropped++;
+        return;
+    }
+
+    if(reply_ms > 0)
+        msleep(reply_ms);
+
+    if(pty.write(buf, len))
+        st.replies++;
+}
+
+//---------------------------------------------------------------------------
+void TRotorEmulator::parse(void)
+{
+    int k;
+
+    while(rx_len > 0) {
+        k = command(rx, rx_len);
+        if(k == 0)
+            break;
+
+        rx_len -= k;
+        memmove(rx, rx + k, rx_len);
+    }
+
+    // a command never gets this long
+    if(rx_len == (int) sizeof(rx)) {
+        st.errors += rx_len;
+        rx_len = 0;
+    }
+}
+
+//---------------------------------------------------------------------------
+// handles the command at the start of buf, returns the bytes used,
+// 0 if the command is not complete yet
+int TRotorEmulator::command(const char *buf, int len)
+{
+    char   out[64], tmp[8];
+    double az, el;
+    int    i, k, a, e;
+
+    switch(protocol)
+    {
+    case SE_PROTO_GS232B:
+        for(k=0; k<len; k++)
+            if(buf[k] == '\r' || buf[k] == '\n')
+                break;
+
+        if(k == len)
+            return 0;
+        if(k == 0)
+            return 1; // line feed after a carriage return
+
+        st.commands++;
+
+        if(buf[0] == 'W' && sscanf(buf + 1, "%d %d", &a, &e) == 2)
+            moveTo(a, e);
+        else if(buf[0] == 'C' && buf[1] == '2') {
+            st.queries++;
+            position(&az, &el);
+            i = sprintf(out, "AZ=%03d  EL=%03d\r\n", (int) rint(az), (int) rint(el));
+            reply(out, i);
+        }
+        else if(buf[0] == 'S') {
+            position(&az, &el);
+            moveTo(az, el);
+        }
+        else if(buf[0] != 'X')
+            st.errors++;
+
+        return k + 1;
+
+    case SE_PROTO_SPID:
+        if(buf[0] != 0x57) {
+            st.errors++;
+            return 1;
+        }
+        if(len < 13)
+            return 0;
+        if(buf[12] != 0x20) {
+            st.errors++;
+            return 1;
+        }
+
+        st.commands++;
+
+        if(buf[11] == 0x2F) {
+            // H1..H4 and V1..V4 are ascii digits of (360 + angle) * pulses
+            a = (buf[1] - 0x30) * 1000 + (buf[2] - 0x30) * 100 + (buf[3] - 0x30) * 10 + (buf[4] - 0x30);
+            e = (buf[6] - 0x30) * 1000 + (buf[7] - 0x30) * 100 + (buf[8] - 0x30) * 10 + (buf[9] - 0x30);
+
+            if(buf[5] > 0 && buf[10] > 0)
+                moveTo((double) a / buf[5] - 360.0, (double) e / buf[10] - 360.0);
+            else
+                st.errors++;
+        }
+        else if(buf[11] == 0x1F || buf[11] == 0x0F) {
+            if(buf[11] == 0x0F) {
+                position(&az, &el);
+                moveTo(az, el);
+            }
+            else
+                st.queries++;
+
+            position(&az, &el);
+
+            // binary digits of 360 + angle with one decimal
+            a = (int) rint((az + 360.0) * 10.0);
+            e = (int) rint((el + 360.0) * 10.0);
+
+            out[ 0] = 0x57;
+            out[ 1] = a / 1000;
+            out[ 2] = (a / 100) % 10;
+            out[ 3] = (a / 10) % 10;
+            out[ 4] = a % 10;
+            out[ 5] = 0x02;
+            out[ 6] = e / 1000;
+            out[ 7] = (e / 100) % 10;
+            out[ 8] = (e / 10) % 10;
+            out[ 9] = e % 10;
+            out[10] = 0x02;
+            out[11] = 0x20;
+
+            reply(out, 12);
+        }
+        else
+            st.errors++;
+
+        return 13;
+
+    case SE_PROTO_MONSTRUM:
+        if(buf[0] != 0x53) {
+            st.errors++;
+            return 1;
+        }
+        if(len < 2)
+            return 0;
+
+        k = (unsigned char) buf[1];
+        if(k < 4 || k > 64) {
+            st.errors++;
+            return 1;
+        }
+        if(len < k)
+            return 0;
+
+        st.commands++;
+
+        switch(buf[2])
+        {
+        case 0x01: // move to X/Y
+            if(k < 16 || buf[3] != 0x58 || buf[9] != 0x59) {
+                st.errors++;
+                break;
+            }
+
+            memcpy(tmp, buf + 4, 5); tmp[5] = '\0';
+            az = atof(tmp) / 100.0;
+            memcpy(tmp, buf + 10, 5); tmp[5] = '\0';
+            el = atof(tmp) / 100.0;
+
+            moveTo(az, el);
+            break;
+
+        case 0x02: // stop
+            position(&az, &el);
+            moveTo(az, el);
+            break;
+
+        case 0x03: // position
+            st.queries++;
+            position(&az, &el);
+
+            out[0] = 0x53; out[1] = 0x10; out[2] = 0x03;
+            out[3] = 0x58;
+            sprintf(tmp, "%05.0f", az * 100.0);
+            memcpy(out + 4, tmp, 5);
+            out[9] = 0x59;
+            sprintf(tmp, "%05.0f", el * 100.0);
+            memcpy(out + 10, tmp, 5);
+            out[15] = 0x50;
+
+            reply(out, 16);
+            break;
+
+        case 0x08: // status, limit switches off, no errors
+            out[0] = 0x53; out[1] = 0x0B; out[2] = 0x08;
+            out[3] = out[4] = out[5] = out[6] = '0';
+            out[7] = out[8] = 0;
+            out[9] = (flags & RE_BUSY) ? '0':'1';
+            out[10] = 0x50;
+
+            reply(out, 11);
+            break;
+
+        case 0x06: // enable
+            break;
+
+        default:
+            st.errors++;
+        }
+
+        return k;
+
+    default:
+        return len;
+    }
+}
+
+//---------------------------------------------------------------------------
+// angle between the antenna and the satellite above the horizon
+void TRotorEmulator::track(double sat_az, double sat_el)
+{
+    double az, el, d;
+
+    if(sat_el < 0)
+        return;
+
+    position(&az, &el);
+
+    if(protocol == SE_PROTO_MONSTRUM)
+        rotor->XYtoAzEl(az, el, &az, &el);
+
+    // elevations over 90 need no remapping, the direction is the same
+    d = cos(el * DTR) * cos(sat_el * DTR) * cos((az - sat_az) * DTR) +
+        sin(el * DTR) * sin(sat_el * DTR);
+    d = acos(ClipValue(d, 1.0, -1.0)) * RTD;
+
+    mutex.lock();
+
+    st.samples++;
+    st.err_sum2 += d * d;
+    st.err_max = MAX(st.err_max, d);
+
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+void TRotorEmulator::stats(TEmulatorStats *s)
+{
+    mutex.lock();
+    *s = st;
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+void TRotorEmulator::resetStats(void)
+{
+    mutex.lock();
+    memset(&st, 0, sizeof(TEmulatorStats));
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+void TRotorEmulator::report(const char *title)
+{
+    TEmulatorStats s;
+
+    stats(&s);
+
+    qDebug("rotor emulator %s: %d commands, %d moves, %d queries, %d replies, %d dropped, %d errors",
+           title, s.commands, s.moves, s.queries, s.replies, s.dropped, s.errors);
+    qDebug("rotor emulator %s: settle time mean %.0f ms max %.0f ms, pointing error rms %.2f max %.2f deg over %d samples",
+           title,
+           s.settled ? s.settle_sum / s.settled:0, s.settle_max,
+           s.samples ? sqrt(s.err_sum2 / s.samples):0, s.err_max, s.samples);
+}
+
+//---------------------------------------------------------------------------
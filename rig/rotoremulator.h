@@ -0,0 +1,108 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef ROTOREMULATOR_H
+#define ROTOREMULATOR_H
+
+#include <QThread>
+#include <QMutex>
+
+#include "ptydevice.h"
+
+//---------------------------------------------------------------------------
+#define RE_STOP             1
+#define RE_BUSY             2   // an axis is still moving
+
+#define RE_TICK_MS          10  // motion model step
+#define RE_SETTLE           0.5 // degrees, target reached
+
+class TRotor;
+
+//---------------------------------------------------------------------------
+typedef struct TEmulatorStats_t
+{
+    int    commands;        // complete commands received
+    int    moves, queries;
+    int    replies, dropped;
+    int    errors;          // bytes that did not parse
+
+    int    settled;         // moves that reached their target
+    double settle_sum, settle_max;  // ms from the move command to the target
+
+    int    samples;         // pointing samples from track()
+    double err_sum2, err_max;       // degrees
+} TEmulatorStats;
+
+//---------------------------------------------------------------------------
+// Rotor controller on a pseudo-terminal, speaks the GS-232B, Alfa-SPID or
+// Monstrum protocol (SE_PROTO_*) and moves both axes towards the last
+// target at a constant slew rate. The tracking thread feeds the satellite
+// position with track() so the pass can be reported as pointing error.
+class TRotorEmulator : public QThread
+{
+public:
+    TRotorEmulator(TRotor *rotor_);
+    ~TRotorEmulator(void);
+
+    bool open(int protocol_);
+    void close(void);
+    bool isOpen(void) { return pty.isOpen(); }
+    QString deviceName(void) const { return pty.slaveName(); }
+
+    void run();
+
+    // axis position, X/Y for Monstrum
+    void position(double *az, double *el);
+
+    // compares the antenna with the satellite direction
+    void track(double sat_az, double sat_el);
+
+    void stats(TEmulatorStats *s);
+    void report(const char *title);
+    void resetStats(void);
+
+    double az_rate, el_rate;    // deg/s
+    int    reply_ms;            // reply latency
+    double drop_rate;           // probability of a lost reply, 0...1
+
+protected:
+    void   parse(void);
+    int    command(const char *buf, int len);
+    void   moveTo(double az, double el);
+    void   reply(const char *buf, int len);
+    void   step(double secs);
+
+private:
+    QMutex     mutex;
+    TPtyDevice pty;
+    TRotor     *rotor;
+    int        protocol, flags;
+
+    char       rx[256];
+    int        rx_len;
+
+    double     cur_az, cur_el, target_az, target_el;
+    qint64     move_ms;
+
+    TEmulatorStats st;
+};
+
+#endif // ROTOREMULATOR_H
@@ -0,0 +1,400 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <stdlib.h>
+#include <math.h>
+#include <QString>
+
+#include "rotorplan.h"
+#include "rotor.h"
+#include "passephem.h"
+#include "utils.h"
+
+//---------------------------------------------------------------------------
+/*
+  The target of each axis is a tube around the satellite position, its
+  half width is the allowed axis error for a pointing error e. Azimuth
+  errors are scaled down by cos(elevation) so near zenith the azimuth axis
+  may cut the corner instead of chasing the keyhole.
+
+  For a given e the positions reachable under the velocity limit are
+  propagated forward through the tube, if the reachable interval never
+  becomes empty e is feasible. The smallest feasible e is found by
+  bisection and the trajectory is traced back through the intervals.
+*/
+//---------------------------------------------------------------------------
+TRotorPlan::TRotorPlan(void)
+{
+    saz = sel = NULL;
+    taz = tel = NULL;
+    waz = wel = NULL;
+    lo = hi = tmp = NULL;
+    paz = pel = NULL;
+    az = el = NULL;
+
+    size = 0;
+
+    clear();
+}
+
+//---------------------------------------------------------------------------
+TRotorPlan::~TRotorPlan(void)
+{
+    double **p[] = { &saz, &sel, &taz, &tel, &waz, &wel, &lo, &hi, &tmp, &paz, &pel, &az, &el };
+    unsigned int i;
+
+    for(i=0; i<sizeof(p) / sizeof(p[0]); i++)
+        if(*p[i])
+            free(*p[i]);
+}
+
+//---------------------------------------------------------------------------
+void TRotorPlan::clear(void)
+{
+    t0 = 0;
+    count = 0;
+    tca = 0;
+    visible = 0;
+
+    pass_mode = RP_MODE_DIRECT;
+    wrap_offset = 0;
+    max_error = 0;
+    los_el = 0;
+}
+
+//---------------------------------------------------------------------------
+bool TRotorPlan::alloc(int n)
+{
+    double **p[] = { &saz, &sel, &taz, &tel, &waz, &wel, &lo, &hi, &tmp, &paz, &pel, &az, &el };
+    double *d;
+    unsigned int i;
+
+    if(n <= size)
+        return true;
+
+    for(i=0; i<sizeof(p) / sizeof(p[0]); i++) {
+        d = (double *) realloc(*p[i], n * sizeof(double));
+        if(d == NULL) {
+            qDebug("Error: out of memory, rotor plan of %d positions [%s:%d]", n, __FILE__, __LINE__);
+            return false;
+        }
+
+        *p[i] = d;
+    }
+
+    size = n;
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TRotorPlan::build(TRotor *rotor, TPassEphem *ephem, double aos, double los)
+{
+    TPassSample s;
+    double dt, e, best_e, travel, best_travel, offset, horizon;
+    int    i, n, m, k, modes;
+
+    clear();
+
+    // X-Y mounts have no keyhole at zenith
+    if(rotor->isXY() || los <= aos || los - aos > RP_MAX_LENGTH)
+        return false;
+
+    n = (int) ((los - aos) / RP_STEP) + 1;
+    if(n < 2 || !alloc(n))
+        return false;
+
+    az_min = rotor->az_min;
+    az_max = rotor->az_max;
+    el_min = rotor->el_min;
+    el_max = rotor->el_max;
+
+    horizon = MAX(el_min, 0.0);
+
+    for(i=0; i<n; i++) {
+        if(!ephem->interpolate(aos + i * RP_STEP, &s))
+            return false;
+
+        // unwrap azimuth so the targets are continuous
+        if(i > 0)
+            s.az += 360.0 * rint((saz[i - 1] - s.az) / 360.0);
+
+        saz[i] = s.az;
+        sel[i] = s.el;
+
+        if(s.el > sel[tca])
+            tca = i;
+        if(s.el >= horizon)
+            visible++;
+    }
+
+    if(visible == 0)
+        return false;
+
+    t0 = aos;
+    count = n;
+
+    // per step limits
+    dt = RP_STEP * 86400.0;
+
+    modes = el_max > 90 ? RP_MODES:1;
+    best_e = best_travel = 0;
+    pass_mode = -1;
+
+    for(m=0; m<modes; m++)
+        for(k=-1; k<=1; k++) {
+            offset = k * 360.0;
+
+            // other wraps fold back to the same positions
+            if(k != 0 && az_max - az_min <= 360)
+                continue;
+
+            target(m, offset);
+
+            minimax(tel, wel, rotor->el_rate * dt, pel);
+            minimax(taz, waz, rotor->az_rate * dt, paz);
+
+            if(rotor->el_accel > 0) {
+                for(i=0; i<n; i++)
+                    tmp[i] = pel[i];
+                accelerate(tmp, rotor->el_rate * dt, rotor->el_accel * dt * dt, pel);
+            }
+
+            if(rotor->az_accel > 0) {
+                for(i=0; i<n; i++)
+                    tmp[i] = paz[i];
+                accelerate(tmp, rotor->az_rate * dt, rotor->az_accel * dt * dt, paz);
+            }
+
+            e = pointingError(paz, pel);
+
+            travel = 0;
+            for(i=1; i<n; i++)
+                travel += fabs(paz[i] - paz[i - 1]) + fabs(pel[i] - pel[i - 1]);
+
+            // prefer less travel when the errors are about the same
+            if(pass_mode < 0 || e < best_e - 0.01 || (e <= best_e + 0.01 && travel < best_travel)) {
+                double *d;
+
+                d = az; az = paz; paz = d;
+                d = el; el = pel; pel = d;
+
+                best_e = e;
+                best_travel = travel;
+                pass_mode = m;
+                wrap_offset = offset;
+            }
+        }
+
+    max_error = best_e;
+    los_el = (pass_mode == RP_MODE_FLIP || pass_mode == RP_MODE_FLIP_LOS) ? (180.0 - el_max):el_min;
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// axis targets and tube widths of a flip mode and cable wrap
+void TRotorPlan::target(int mode_, double offset)
+{
+    double a, b, e, horizon;
+    bool   flip;
+    int    i;
+
+    horizon = MAX(el_min, 0.0);
+
+    for(i=0; i<count; i++) {
+        flip = mode_ == RP_MODE_FLIP ||
+               (mode_ == RP_MODE_FLIP_LOS && i > tca) ||
+               (mode_ == RP_MODE_FLIP_AOS && i < tca);
+
+        a = saz[i] + offset + (flip ? 180.0:0.0);
+        e = flip ? (180.0 - sel[i]):sel[i];
+
+        // fold into the azimuth range, nearest to the previous target
+        if(a < az_min || a > az_max) {
+            b = a - 360.0 * floor((a - az_min) / 360.0);
+
+            if(b > az_max)
+                a = (b - az_max) < (az_min + 360.0 - b) ? az_max:az_min;
+            else {
+                a = b;
+                if(i > 0)
+                    for(b += 360.0; b <= az_max; b += 360.0)
+                        if(fabs(b - taz[i - 1]) < fabs(a - taz[i - 1]))
+                            a = b;
+            }
+        }
+
+        taz[i] = a;
+        tel[i] = ClipValue(e, el_max, el_min);
+
+        if(sel[i] >= horizon) {
+            wel[i] = 1;
+            waz[i] = 1.0 / MAX(fabs(cos(tel[i] * DTR)), RP_MIN_COS);
+        }
+        else
+            wel[i] = waz[i] = RP_FREE;
+    }
+}
+
+//---------------------------------------------------------------------------
+// forward reachable intervals inside the tube of half width e * scale
+bool TRotorPlan::tube(const double *ref, const double *scale, double e, double vmax)
+{
+    double l, h, w;
+    int    i;
+
+    l = h = 0;
+
+    for(i=0; i<count; i++) {
+        w = scale[i] < RP_FREE ? e * scale[i]:RP_FREE;
+
+        if(i == 0) {
+            l = ref[0] - w;
+            h = ref[0] + w;
+        }
+        else {
+            l = MAX(l - vmax, ref[i] - w);
+            h = MIN(h + vmax, ref[i] + w);
+        }
+
+        if(l > h)
+            return false;
+
+        lo[i] = l;
+        hi[i] = h;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// velocity limited trajectory with the smallest maximum error to ref
+void TRotorPlan::minimax(const double *ref, const double *scale, double vmax, double *out)
+{
+    double e0, e1, e, l, h;
+    int    i;
+
+    e0 = e1 = 0;
+    for(i=1; i<count; i++)
+        e1 = MAX(e1, fabs(ref[i] - ref[0]));
+    e1 += 1;
+
+    if(tube(ref, scale, 0, vmax))
+        e1 = 0;
+    else
+        for(i=0; i<RP_ITERATIONS; i++) {
+            e = 0.5 * (e0 + e1);
+            if(tube(ref, scale, e, vmax))
+                e1 = e;
+            else
+                e0 = e;
+        }
+
+    tube(ref, scale, e1, vmax);
+
+    // trace back, stay as close to the target as the intervals allow
+    i = count - 1;
+    out[i] = ClipValue(ref[i], hi[i], lo[i]);
+
+    for(i=count-2; i>=0; i--) {
+        l = MAX(lo[i], out[i + 1] - vmax);
+        h = MIN(hi[i], out[i + 1] + vmax);
+
+        out[i] = ClipValue(ref[i], h, l);
+    }
+}
+
+//---------------------------------------------------------------------------
+// follows ref with limited acceleration, reference velocity is fed forward
+// and the error is removed with the braking distance in mind
+void TRotorPlan::accelerate(const double *ref, double vmax, double amax, double *out)
+{
+    double p, v, vd, err, c;
+    int    i;
+
+    p = ref[0];
+    v = ref[1] - ref[0];
+    out[0] = p;
+
+    for(i=1; i<count; i++) {
+        err = ref[i - 1] - p;
+        c   = MIN(fabs(err), sqrt(2.0 * amax * fabs(err)));
+
+        vd = (ref[i] - ref[i - 1]) + (err < 0 ? -c:c);
+        vd = ClipValue(vd, vmax, -vmax);
+        v  = ClipValue(vd, v + amax, v - amax);
+
+        p += v;
+        out[i] = p;
+    }
+}
+
+//---------------------------------------------------------------------------
+// largest angle between the antenna and the satellite above the horizon,
+// elevations over 90 need no remapping, the direction vector is the same
+double TRotorPlan::pointingError(const double *paz_, const double *pel_)
+{
+    double d, e, horizon;
+    int    i;
+
+    horizon = MAX(el_min, 0.0);
+    e = -1;
+
+    for(i=0; i<count; i++) {
+        if(sel[i] < horizon)
+            continue;
+
+        d = cos(pel_[i] * DTR) * cos(sel[i] * DTR) * cos((paz_[i] - saz[i]) * DTR) +
+            sin(pel_[i] * DTR) * sin(sel[i] * DTR);
+
+        d = acos(ClipValue(d, 1.0, -1.0)) * RTD;
+
+        e = MAX(e, d);
+    }
+
+    return e;
+}
+
+//---------------------------------------------------------------------------
+bool TRotorPlan::position(double daynum, double *az_, double *el_)
+{
+    double u;
+    int    i;
+
+    if(!isValid())
+        return false;
+
+    u = (daynum - t0) / RP_STEP;
+    u = ClipValue(u, count - 1, 0);
+
+    i = (int) u;
+    if(i >= count - 1)
+        i = count - 2;
+    u -= i;
+
+    *az_ = az[i] + u * (az[i + 1] - az[i]);
+    *el_ = el[i] + u * (el[i + 1] - el[i]);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
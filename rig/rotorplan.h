@@ -0,0 +1,97 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef ROTORPLAN_H
+#define ROTORPLAN_H
+
+#include <QtGlobal>
+
+//---------------------------------------------------------------------------
+#define RP_STEP         (1.0 / 86400.0) // days between planned positions
+#define RP_MAX_LENGTH   (1.0 / 24.0)    // days, longest planned pass
+#define RP_MIN_COS      0.02            // azimuth error weight is capped at ~89 degrees elevation
+#define RP_ITERATIONS   24              // bisection steps of the error bound
+#define RP_FREE         1e6             // width scale of samples below the horizon, any position will do
+
+// how the elevation axis is used during the pass
+#define RP_MODE_DIRECT      0   // az, el
+#define RP_MODE_FLIP        1   // az + 180, 180 - el for the whole pass
+#define RP_MODE_FLIP_LOS    2   // direct until TCA, flipped after it (zenith pass)
+#define RP_MODE_FLIP_AOS    3   // flipped until TCA, direct after it
+#define RP_MODES            4
+
+class TRotor;
+class TPassEphem;
+
+//---------------------------------------------------------------------------
+// Pointing trajectory of a whole pass in rotor axis coordinates.
+// Every flip mode and cable wrap the rotor limits allow is planned with the
+// per axis velocity and acceleration limits, the one with the smallest
+// pointing error is kept. Because the whole pass is known in advance the
+// axes start to move before the satellite gets there, the tracking loop
+// then commands position(now + look-ahead).
+class TRotorPlan
+{
+public:
+    TRotorPlan(void);
+    ~TRotorPlan(void);
+
+    void clear(void);
+
+    // plans the pass from aos to los, ephem must contain the span
+    bool build(TRotor *rotor, TPassEphem *ephem, double aos, double los);
+
+    bool isValid(void) { return count > 1; }
+    bool contains(double daynum) { return count > 1 && daynum >= t0 && daynum <= t0 + (count - 1) * RP_STEP; }
+
+    // axis position at daynum, clamped to the planned span
+    bool position(double daynum, double *az, double *el);
+
+    int    mode(void) { return pass_mode; }
+    double wrap(void) { return wrap_offset; }
+    double maxError(void) { return max_error; }   // degrees
+    double losElevation(void) { return los_el; }  // lowest satellite elevation tracked after TCA
+
+protected:
+    bool   alloc(int n);
+    void   target(int mode_, double offset);
+    bool   tube(const double *ref, const double *scale, double e, double vmax);
+    void   minimax(const double *ref, const double *scale, double vmax, double *out);
+    void   accelerate(const double *ref, double vmax, double amax, double *out);
+    double pointingError(const double *paz, const double *pel);
+
+private:
+    double *saz, *sel;      // satellite, az is unwrapped
+    double *taz, *tel;      // target axis positions of the mode being planned
+    double *waz, *wel;      // allowed axis error per degree of pointing error
+    double *lo, *hi, *tmp;  // scratch
+    double *paz, *pel;      // planned axis positions of the mode being planned
+    double *az, *el;        // best plan
+
+    double t0;
+    int    count, size, tca, visible;
+    int    pass_mode;
+    double wrap_offset, max_error, los_el;
+
+    double az_min, az_max, el_min, el_max;
+};
+
+#endif // ROTORPLAN_H
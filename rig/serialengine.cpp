@@ -0,0 +1,635 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QDateTime>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "serialengine.h"
+#include "qextserialport.h"
+#include "telemetry.h"
+
+//---------------------------------------------------------------------------
+TSerialEngine::TSerialEngine(QextSerialPort *port_, int protocol_)
+{
+    port     = port_;
+    protocol = protocol_;
+    flags    = 0;
+
+    telemetry = NULL;
+
+    has_move   = false;
+    q_head     = 0;
+    q_count    = 0;
+    want_query = false;
+    poll_ms    = SE_POLL_MS;
+
+    rx_len     = 0;
+    query_ms   = 0;
+    deadline   = 0;
+    next_write = 0;
+    last_poll  = 0;
+    retries    = 0;
+    awaiting   = false;
+    moved      = false;
+
+    raw      = NULL;
+    raw_max  = 0;
+    raw_len  = 0;
+    raw_wait = false;
+    raw_armed = false;
+
+    ev_seq  = 0;
+    ev_read = 0;
+
+    written = coalesced = timeouts = errors = 0;
+}
+
+//---------------------------------------------------------------------------
+TSerialEngine::~TSerialEngine(void)
+{
+    stop();
+}
+
+//---------------------------------------------------------------------------
+void TSerialEngine::stop(void)
+{
+    if(!isRunning())
+        return;
+
+    mutex.lock();
+    flags |= SE_STOP;
+    wake.wakeAll();
+    mutex.unlock();
+
+    wait();
+
+    mutex.lock();
+    flags &= ~SE_STOP;
+    has_move = false;
+    q_count = 0;
+    want_query = false;
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+void TSerialEngine::setPollInterval(int msecs)
+{
+    mutex.lock();
+    poll_ms = msecs < 0 ? 0:msecs;
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+void TSerialEngine::move(const char *buf, int len)
+{
+    if(len <= 0 || len > SE_MAX_COMMAND)
+        return;
+
+    mutex.lock();
+
+    if(has_move)
+        coalesced++;
+
+    memcpy(pending_move.data, buf, len);
+    pending_move.len   = len;
+    pending_move.reply = false;
+    has_move = true;
+
+    wake.wakeAll();
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+bool TSerialEngine::send(const char *buf, int len)
+{
+    return enqueue(buf, len, false);
+}
+
+//---------------------------------------------------------------------------
+bool TSerialEngine::enqueue(const char *buf, int len, bool reply)
+{
+    TSerialCommand *cmd;
+    bool rc = false;
+
+    if(len <= 0 || len > SE_MAX_COMMAND)
+        return false;
+
+    mutex.lock();
+
+    // the pending move was requested first, keep the order
+    if(has_move && q_count < SE_QUEUE_SIZE) {
+        queue[(q_head + q_count) % SE_QUEUE_SIZE] = pending_move;
+        q_count++;
+        has_move = false;
+    }
+
+    if(q_count < SE_QUEUE_SIZE) {
+        cmd = &queue[(q_head + q_count) % SE_QUEUE_SIZE];
+        memcpy(cmd->data, buf, len);
+        cmd->len   = len;
+        cmd->reply = reply;
+        q_count++;
+
+        rc = true;
+    }
+    else
+        qDebug("Error: serial command queue is full [%s:%d]", __FILE__, __LINE__);
+
+    wake.wakeAll();
+    mutex.unlock();
+
+    return rc;
+}
+
+//---------------------------------------------------------------------------
+void TSerialEngine::query(void)
+{
+    mutex.lock();
+    want_query = true;
+    wake.wakeAll();
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+bool TSerialEngine::position(TPositionEvent *ev)
+{
+    bool rc = false;
+
+    mutex.lock();
+
+    if(ev_seq > 0) {
+        *ev = ring[(ev_seq - 1) % SE_EVENTS];
+        rc = true;
+    }
+
+    mutex.unlock();
+
+    return rc;
+}
+
+//---------------------------------------------------------------------------
+int TSerialEngine::events(TPositionEvent *ev, int max)
+{
+    int n = 0;
+
+    mutex.lock();
+
+    if(ev_seq - ev_read > SE_EVENTS)
+        ev_read = ev_seq - SE_EVENTS;
+
+    while(ev_read < ev_seq && n < max)
+        ev[n++] = ring[ev_read++ % SE_EVENTS];
+
+    mutex.unlock();
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
+bool TSerialEngine::waitPosition(int timeout_ms, TPositionEvent *ev)
+{
+    qint64 end, now;
+    int    seq;
+    bool   rc;
+
+    end = QDateTime::currentMSecsSinceEpoch() + timeout_ms;
+
+    mutex.lock();
+
+    seq = ev_seq;
+    want_query = true;
+    wake.wakeAll();
+
+    while(ev_seq == seq && isRunning()) {
+        now = QDateTime::currentMSecsSinceEpoch();
+        if(now >= end)
+            break;
+
+        replied.wait(&mutex, (unsigned long) (end - now));
+    }
+
+    rc = ev_seq != seq;
+    if(rc)
+        *ev = ring[(ev_seq - 1) % SE_EVENTS];
+
+    mutex.unlock();
+
+    return rc;
+}
+
+//---------------------------------------------------------------------------
+// writes buf and returns the length of the next reply frame, 0 on timeout
+int TSerialEngine::transact(const char *buf, int len, char *reply, int max, int timeout_ms)
+{
+    qint64 end, now;
+    int    n;
+
+    if(!isRunning())
+        return 0;
+
+    end = QDateTime::currentMSecsSinceEpoch() + timeout_ms;
+
+    mutex.lock();
+
+    // wait for an earlier transaction
+    while(raw_wait) {
+        now = QDateTime::currentMSecsSinceEpoch();
+        if(now >= end) {
+            mutex.unlock();
+            return 0;
+        }
+
+        replied.wait(&mutex, (unsigned long) (end - now));
+    }
+
+    raw      = reply;
+    raw_max  = max;
+    raw_len  = 0;
+    raw_wait = true;
+
+    mutex.unlock();
+
+    if(!enqueue(buf, len, true)) {
+        mutex.lock();
+        raw_wait = false;
+        raw = NULL;
+        replied.wakeAll();
+        mutex.unlock();
+
+        return 0;
+    }
+
+    mutex.lock();
+
+    while(raw_wait) {
+        now = QDateTime::currentMSecsSinceEpoch();
+        if(now >= end)
+            break;
+
+        replied.wait(&mutex, (unsigned long) (end - now));
+    }
+
+    n = raw_wait ? 0:raw_len;
+
+    raw_wait = false;
+    raw_armed = false;
+    raw = NULL;
+    replied.wakeAll();
+
+    mutex.unlock();
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
+void TSerialEngine::run()
+{
+    TSerialCommand cmd;
+    qint64 now;
+    bool   have, poll;
+
+    rx_len   = 0;
+    awaiting = false;
+    last_poll = next_write = 0;
+
+    while(!(flags & SE_STOP)) {
+        readReplies();
+
+        now = QDateTime::currentMSecsSinceEpoch();
+
+        // unanswered query, resend it or give up
+        if(awaiting && now > deadline) {
+            if(retries < SE_RETRIES && last_query.len > 0) {
+                retries++;
+                writeCommand(&last_query);
+
+                deadline = now + replyTimeout();
+            }
+            else {
+                awaiting = false;
+                rx_len = 0;
+                timeouts++;
+
+                qDebug("Serial rotor: no reply after %d retries", retries);
+            }
+        }
+
+        mutex.lock();
+
+        have = false;
+
+        if(now >= next_write) {
+            // commands in order, a pending move is always the newest
+            // a due query takes turns with the moves so feedback keeps coming
+            poll = !awaiting && (want_query || (poll_ms > 0 && now - last_poll >= poll_ms));
+
+            if(q_count && !(queue[q_head].reply && awaiting)) {
+                cmd = queue[q_head];
+                q_head = (q_head + 1) % SE_QUEUE_SIZE;
+                q_count--;
+                have = true;
+
+                // the next frame is the reply of transact()
+                if(cmd.reply)
+                    raw_armed = true;
+            }
+            else if(has_move && !(poll && moved)) {
+                cmd = pending_move;
+                has_move = false;
+                have = true;
+            }
+            else if(poll) {
+                queryCommand(&cmd);
+                want_query = false;
+                have = true;
+            }
+        }
+
+        if(!have)
+            wake.wait(&mutex, SE_IDLE_MS);
+
+        mutex.unlock();
+
+        if(!have)
+            continue;
+
+        writeCommand(&cmd);
+
+        moved = !cmd.reply;
+
+        if(cmd.reply) {
+            awaiting = true;
+            retries  = 0;
+            query_ms = now;
+            deadline = now + replyTimeout();
+            last_poll = now;
+            last_query = cmd;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+void TSerialEngine::writeCommand(const TSerialCommand *cmd)
+{
+    if(port->write(cmd->data, cmd->len) != cmd->len) {
+        errors++;
+        qDebug("Error: failed to write %d bytes to %s [%s:%d]",
+               cmd->len, port->portName().toStdString().c_str(),
+               __FILE__, __LINE__);
+    }
+
+    written++;
+    next_write = QDateTime::currentMSecsSinceEpoch() + SE_GAP_MS;
+}
+
+//---------------------------------------------------------------------------
+// reads what has arrived without waiting and splits it into frames
+void TSerialEngine::readReplies(void)
+{
+    qint64 n;
+    int    k;
+
+    if(!port->isOpen())
+        return;
+
+    while((n = port->bytesAvailable()) > 0) {
+        if(n > SE_MAX_FRAME - rx_len)
+            n = SE_MAX_FRAME - rx_len;
+
+        n = port->read(rx + rx_len, n);
+        if(n <= 0)
+            break;
+
+        rx_len += (int) n;
+
+        while((k = frameLength()) > 0) {
+            frame(rx, k);
+
+            rx_len -= k;
+            memmove(rx, rx + k, rx_len);
+        }
+
+        // no frame fits, drop the garbage
+        if(rx_len >= SE_MAX_FRAME) {
+            errors++;
+            rx_len = 0;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+// length of the complete frame at the start of rx, 0 if it is not complete yet,
+// bytes that can not start a frame are dropped
+int TSerialEngine::frameLength(void)
+{
+    int i, k, skip;
+
+    for(;;) {
+        skip = 0;
+
+        switch(protocol)
+        {
+        case SE_PROTO_GS232B:
+            for(i=0; i<rx_len; i++)
+                if(rx[i] == '\n')
+                    return i + 1;
+            return 0;
+
+        case SE_PROTO_SPID:
+            while(skip < rx_len && rx[skip] != 0x57)
+                skip++;
+
+            if(skip == 0) {
+                if(rx_len < 12)
+                    return 0;
+                if(rx[11] == 0x20)
+                    return 12;
+
+                skip = 1; // not a frame, resync
+            }
+            break;
+
+        case SE_PROTO_MONSTRUM:
+            while(skip < rx_len && rx[skip] != 0x53)
+                skip++;
+
+            if(skip == 0) {
+                if(rx_len < 2)
+                    return 0;
+
+                k = (unsigned char) rx[1];
+                if(k >= 4 && k <= SE_MAX_FRAME)
+                    return rx_len >= k ? k:0;
+
+                skip = 1;
+            }
+            break;
+
+        default:
+            rx_len = 0;
+            return 0;
+        }
+
+        errors++;
+        rx_len -= skip;
+        memmove(rx, rx + skip, rx_len);
+    }
+}
+
+//---------------------------------------------------------------------------
+void TSerialEngine::frame(const char *buf, int len)
+{
+    TPositionEvent *ev;
+    double az, el;
+    qint64 now, latency;
+    bool   pos;
+
+    now = QDateTime::currentMSecsSinceEpoch();
+    pos = decodePosition(buf, len, &az, &el);
+
+    latency = awaiting ? now - query_ms:0;
+
+    if(pos && telemetry)
+        telemetry->position(az, el, latency);
+
+    mutex.lock();
+
+    if(pos) {
+        ev = &ring[ev_seq % SE_EVENTS];
+
+        ev->msecs   = now;
+        ev->latency = latency;
+        ev->az      = az;
+        ev->el      = el;
+        ev->seq     = ev_seq;
+
+        ev_seq++;
+    }
+
+    if(raw_wait && raw_armed && raw) {
+        raw_len = len < raw_max ? len:raw_max;
+        memcpy(raw, buf, raw_len);
+        raw_wait = false;
+        raw_armed = false;
+        pos = true;
+    }
+
+    replied.wakeAll();
+    mutex.unlock();
+
+    // anything else is noise, keep waiting for the reply
+    if(pos)
+        awaiting = false;
+}
+
+//---------------------------------------------------------------------------
+bool TSerialEngine::decodePosition(const char *buf, int len, double *az, double *el)
+{
+    char tmp[SE_MAX_FRAME + 1], *a, *e;
+
+    switch(protocol)
+    {
+    case SE_PROTO_GS232B:
+        // AZ=000  EL=000
+        memcpy(tmp, buf, len);
+        tmp[len] = '\0';
+
+        if(!(a = strstr(tmp, "AZ=")) || !(e = strstr(tmp, "EL=")))
+            return false;
+
+        *az = atoi(a + 3);
+        *el = atoi(e + 3);
+        return true;
+
+    case SE_PROTO_SPID:
+        *az  = ((double) buf[1]) * 100.0;
+        *az += ((double) buf[2]) * 10.0;
+        *az += ((double) buf[3]);
+        *az += ((double) buf[4]) / 10.0;
+        *az -= 360.0;
+
+        *el  = ((double) buf[6]) * 100.0;
+        *el += ((double) buf[7]) * 10.0;
+        *el += ((double) buf[8]);
+        *el += ((double) buf[9]) / 10.0;
+        *el -= 360.0;
+        return true;
+
+    case SE_PROTO_MONSTRUM:
+        // S, length, command, X, 5 digits, Y, 5 digits, P
+        if(len < 16 || buf[3] != 0x58 || buf[9] != 0x59)
+            return false;
+
+        memcpy(tmp, buf + 4, 5); tmp[5] = '\0';
+        *az = atof(tmp) / 100.0;
+
+        memcpy(tmp, buf + 10, 5); tmp[5] = '\0';
+        *el = atof(tmp) / 100.0;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+//---------------------------------------------------------------------------
+void TSerialEngine::queryCommand(TSerialCommand *cmd)
+{
+    memset(cmd, 0, sizeof(TSerialCommand));
+    cmd->reply = true;
+
+    switch(protocol)
+    {
+    case SE_PROTO_GS232B:
+        strcpy(cmd->data, "C2\r\n");
+        cmd->len = 4;
+        break;
+
+    case SE_PROTO_SPID:
+        cmd->data[ 0] = 0x57;
+        cmd->data[11] = 0x1F;
+        cmd->data[12] = 0x20;
+        cmd->len = 13;
+        break;
+
+    case SE_PROTO_MONSTRUM:
+        cmd->data[0] = 0x53; // S
+        cmd->data[1] = 0x04; // length
+        cmd->data[2] = 0x03; // command
+        cmd->data[3] = 0x50; // P
+        cmd->len = 4;
+        break;
+
+    default:
+        cmd->reply = false;
+    }
+}
+
+//---------------------------------------------------------------------------
+// ms to wait for a reply, SPID runs at 600 bps
+int TSerialEngine::replyTimeout(void)
+{
+    return protocol == SE_PROTO_SPID ? 1000:500;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,157 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef SERIALENGINE_H
+#define SERIALENGINE_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+
+//---------------------------------------------------------------------------
+#define SE_STOP             1
+
+// controller protocols
+#define SE_PROTO_GS232B     0       // "AZ=aaa  EL=eee\r\n" replies
+#define SE_PROTO_SPID       1       // 12 byte 0x57 ... 0x20 frames
+#define SE_PROTO_MONSTRUM   2       // 'S', length, command ... frames
+
+#define SE_MAX_COMMAND      32      // bytes in one command
+#define SE_MAX_FRAME        64      // bytes in one reply
+#define SE_QUEUE_SIZE       16      // commands other than moves
+#define SE_EVENTS           64      // position events kept
+#define SE_IDLE_MS          20      // I/O thread poll period
+#define SE_POLL_MS          1000    // default position query interval, 0 = only on request
+#define SE_RETRIES          2       // resends of an unanswered query
+#define SE_GAP_MS           100     // quiet time after each command
+#define SE_OPEN_TIMEOUT     2000    // ms to wait for the first position
+
+class QextSerialPort;
+class TTelemetry;
+
+//---------------------------------------------------------------------------
+typedef struct TSerialCommand_t
+{
+    char data[SE_MAX_COMMAND];
+    int  len;
+    bool reply;             // a reply frame is expected
+} TSerialCommand;
+
+// position reported by the controller, raw axis values of the protocol
+typedef struct TPositionEvent_t
+{
+    qint64 msecs;           // received, milliseconds since 1970-01-01 UTC
+    qint64 latency;         // milliseconds since the query was written
+    double az, el;          // degrees, X/Y for Monstrum
+    int    seq;
+} TPositionEvent;
+
+//---------------------------------------------------------------------------
+// Serial I/O of one rotor controller in its own thread. Moves are
+// coalesced so only the newest target is written, replies are parsed by
+// a per protocol state machine as the bytes arrive and positions are
+// queued as timestamped events. Nothing here blocks the caller, except
+// waitPosition() and transact() which are meant for opening and dialogs.
+class TSerialEngine : public QThread
+{
+public:
+    TSerialEngine(QextSerialPort *port_, int protocol_);
+    ~TSerialEngine(void);
+
+    void run();
+    void stop(void);
+
+    // every position event is also recorded here, NULL = none
+    void setTelemetry(TTelemetry *telemetry_) { telemetry = telemetry_; }
+
+    // interval of the automatic position queries in ms, 0 = disabled
+    void setPollInterval(int msecs);
+
+    // replaces a move that has not been written yet
+    void move(const char *buf, int len);
+    // queued in order after the pending move
+    bool send(const char *buf, int len);
+    // position query, a pending query is not repeated
+    void query(void);
+
+    // newest position event, false if none has arrived
+    bool position(TPositionEvent *ev);
+    // copies up to max unread events, returns the number copied
+    int  events(TPositionEvent *ev, int max);
+
+    // blocking, for use outside the tracking loop
+    bool waitPosition(int timeout_ms, TPositionEvent *ev);
+    int  transact(const char *buf, int len, char *reply, int max, int timeout_ms);
+
+    int  getWritten(void) { return written; }
+    int  getCoalesced(void) { return coalesced; }
+    int  getTimeouts(void) { return timeouts; }
+    int  getErrors(void) { return errors; }
+
+protected:
+    bool enqueue(const char *buf, int len, bool reply);
+    void writeCommand(const TSerialCommand *cmd);
+    void readReplies(void);
+    int  frameLength(void);
+    void frame(const char *buf, int len);
+    bool decodePosition(const char *buf, int len, double *az, double *el);
+    void queryCommand(TSerialCommand *cmd);
+    int  replyTimeout(void);
+
+private:
+    QMutex         mutex;
+    QWaitCondition wake, replied;
+
+    QextSerialPort *port;
+    TTelemetry     *telemetry;
+    int            protocol;
+    int            flags;
+
+    // write side, guarded by mutex
+    TSerialCommand pending_move;
+    bool           has_move;
+    TSerialCommand queue[SE_QUEUE_SIZE];
+    int            q_head, q_count;
+    bool           want_query;
+    int            poll_ms;
+
+    // reply state, owned by the I/O thread
+    TSerialCommand last_query;
+    char           rx[SE_MAX_FRAME];
+    int            rx_len;
+    qint64         query_ms, deadline, next_write, last_poll;
+    int            retries;
+    bool           awaiting;   // a query is waiting for its reply
+    bool           moved;      // the last command written was a move
+
+    // raw reply of transact(), guarded by mutex
+    char           *raw;
+    int            raw_max, raw_len;
+    bool           raw_wait, raw_armed;
+
+    // position events, guarded by mutex
+    TPositionEvent ring[SE_EVENTS];
+    int            ev_seq, ev_read;
+
+    int            written, coalesced, timeouts, errors;
+};
+
+#endif // SERIALENGINE_H
@@ -0,0 +1,240 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QString>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "telemetry.h"
+#include "simclock.h"
+
+//---------------------------------------------------------------------------
+TTelemetry::TTelemetry(void)
+{
+    ring  = (TTelemetrySlot *) calloc(TM_RING, sizeof(TTelemetrySlot));
+    batch = (TTelemetryRecord *) malloc(TM_BATCH * sizeof(TTelemetryRecord));
+
+    fp = NULL;
+    tail = 0;
+    written = 0;
+    flags = 0;
+}
+
+//---------------------------------------------------------------------------
+TTelemetry::~TTelemetry(void)
+{
+    close();
+
+    if(ring)
+        free(ring);
+    if(batch)
+        free(batch);
+}
+
+//---------------------------------------------------------------------------
+bool TTelemetry::open(const QString &filename)
+{
+    TTelemetryHeader hdr;
+    int i;
+
+    if(isOpen())
+        return true;
+
+    if(ring == NULL || batch == NULL)
+        return false;
+
+    if(!(fp = fopen(filename.toStdString().c_str(), "wb"))) {
+        qDebug("Failed to create %s [%s:%d]", filename.toStdString().c_str(), __FILE__, __LINE__);
+        return false;
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic   = TM_MAGIC;
+    hdr.version = TM_VERSION;
+    hdr.recsize = sizeof(TTelemetryRecord);
+    hdr.start   = TSimClock::msecs();
+
+    if(fwrite(&hdr, sizeof(hdr), 1, fp) != 1) {
+        qDebug("Failed to write %s [%s:%d]", filename.toStdString().c_str(), __FILE__, __LINE__);
+        fclose(fp);
+        fp = NULL;
+
+        return false;
+    }
+
+    // slot i is free for the write at position i
+    for(i=0; i<TM_RING; i++)
+        ring[i].seq = i;
+
+    head = 0;
+    tail = 0;
+    dropped = 0;
+    written = 0;
+    flags = 0;
+
+    start(QThread::LowPriority);
+
+    active.fetchAndStoreRelease(1);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void TTelemetry::close(void)
+{
+    active.fetchAndStoreRelease(0);
+
+    if(isRunning()) {
+        flags |= TM_STOP;
+        wait();
+    }
+
+    if(fp) {
+        fclose(fp);
+        fp = NULL;
+
+        qDebug("Telemetry: %d records written, %d dropped", written, (int) dropped);
+    }
+}
+
+//---------------------------------------------------------------------------
+// claims the slot of the head position, the slot sequence tells whether
+// the writer thread has released it
+void TTelemetry::write(TTelemetryRecord *rec)
+{
+    TTelemetrySlot *slot;
+    int pos, seq, dif;
+
+    if(active.fetchAndAddAcquire(0) == 0)
+        return;
+
+    pos = head.fetchAndAddAcquire(0);
+
+    for(;;) {
+        slot = &ring[pos & (TM_RING - 1)];
+        seq  = slot->seq.fetchAndAddAcquire(0);
+        dif  = (int) ((unsigned int) seq - (unsigned int) pos);
+
+        if(dif == 0) {
+            if(head.testAndSetOrdered(pos, pos + 1))
+                break;
+        }
+        else if(dif < 0) {
+            dropped.fetchAndAddOrdered(1);
+            return;
+        }
+
+        pos = head.fetchAndAddAcquire(0);
+    }
+
+    rec->seq = (quint32) pos;
+    memcpy(&slot->rec, rec, sizeof(TTelemetryRecord));
+
+    slot->seq.fetchAndStoreRelease(pos + 1);
+}
+
+//---------------------------------------------------------------------------
+void TTelemetry::track(double cmd_az, double cmd_el, double rep_az, double rep_el,
+                       double sat_az, double sat_el, double range_rate)
+{
+    TTelemetryRecord rec;
+
+    rec.msecs      = TSimClock::msecs();
+    rec.type       = TM_TRACK;
+    rec.reserved   = 0;
+    rec.cmd_az     = cmd_az;
+    rec.cmd_el     = cmd_el;
+    rec.rep_az     = rep_az;
+    rec.rep_el     = rep_el;
+    rec.sat_az     = sat_az;
+    rec.sat_el     = sat_el;
+    rec.range_rate = range_rate;
+    rec.latency    = NAN;
+
+    write(&rec);
+}
+
+//---------------------------------------------------------------------------
+void TTelemetry::position(double rep_az, double rep_el, double latency)
+{
+    TTelemetryRecord rec;
+
+    rec.msecs      = TSimClock::msecs();
+    rec.type       = TM_POSITION;
+    rec.reserved   = 0;
+    rec.cmd_az     = NAN;
+    rec.cmd_el     = NAN;
+    rec.rep_az     = rep_az;
+    rec.rep_el     = rep_el;
+    rec.sat_az     = NAN;
+    rec.sat_el     = NAN;
+    rec.range_rate = NAN;
+    rec.latency    = latency;
+
+    write(&rec);
+}
+
+//---------------------------------------------------------------------------
+// single reader, moves the published records to the file
+int TTelemetry::drain(void)
+{
+    TTelemetrySlot *slot;
+    int n, total = 0;
+
+    do {
+        for(n=0; n<TM_BATCH; n++) {
+            slot = &ring[tail & (TM_RING - 1)];
+
+            if(slot->seq.fetchAndAddAcquire(0) != tail + 1)
+                break;
+
+            memcpy(&batch[n], &slot->rec, sizeof(TTelemetryRecord));
+            slot->seq.fetchAndStoreRelease(tail + TM_RING);
+            tail++;
+        }
+
+        if(n > 0 && fwrite(batch, sizeof(TTelemetryRecord), n, fp) != (size_t) n)
+            qDebug("Telemetry write failed [%s:%d]", __FILE__, __LINE__);
+
+        total += n;
+    } while(n == TM_BATCH);
+
+    written += total;
+
+    return total;
+}
+
+//---------------------------------------------------------------------------
+void TTelemetry::run()
+{
+    while(!(flags & TM_STOP)) {
+        if(drain() > 0)
+            fflush(fp);
+
+        msleep(TM_FLUSH_MS);
+    }
+
+    drain();
+    fflush(fp);
+}
+
+//---------------------------------------------------------------------------
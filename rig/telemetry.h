@@ -0,0 +1,108 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <QtGlobal>
+#include <QThread>
+#include <QAtomicInt>
+#include <QString>
+#include <stdio.h>
+
+//---------------------------------------------------------------------------
+#define TM_MAGIC            0x4d4c5450 // "PTLM"
+#define TM_VERSION          1
+#define TM_RING             4096       // records, power of 2
+#define TM_BATCH            256        // records per fwrite
+#define TM_FLUSH_MS         250
+
+#define TM_STOP             1
+
+// record types
+#define TM_TRACK            1          // tracking loop, commanded axis, satellite and last reported az/el
+#define TM_POSITION         2          // reported by the controller, raw axis values and latency
+
+//---------------------------------------------------------------------------
+// fixed size, unused fields are NaN
+struct TTelemetryRecord
+{
+    qint64  msecs;                     // TSimClock time
+    quint16 type, reserved;
+    quint32 seq;
+    float   cmd_az, cmd_el;            // commanded axis position
+    float   rep_az, rep_el;            // reported, az/el in TM_TRACK and axis values in TM_POSITION
+    float   sat_az, sat_el;
+    float   range_rate;                // km/s
+    float   latency;                   // ms from query to reply
+};
+
+//---------------------------------------------------------------------------
+struct TTelemetryHeader
+{
+    quint32 magic, version, recsize, reserved;
+    qint64  start;                     // msecs of the first record
+};
+
+//---------------------------------------------------------------------------
+struct TTelemetrySlot
+{
+    QAtomicInt       seq;
+    TTelemetryRecord rec;
+};
+
+//---------------------------------------------------------------------------
+// Pointing telemetry log. The tracking loop and the rotor drivers put
+// records into a bounded lock-free ring (one sequence number per slot), a
+// full ring drops the record instead of blocking. The thread writes the
+// ring to a binary file, see TTelemetryReader.
+class TTelemetry : public QThread
+{
+public:
+    TTelemetry(void);
+    ~TTelemetry(void);
+
+    bool open(const QString &filename);
+    void close(void);
+    bool isOpen(void) { return active != 0; }
+
+    // any thread, never blocks
+    void write(TTelemetryRecord *rec);
+    void track(double cmd_az, double cmd_el, double rep_az, double rep_el,
+               double sat_az, double sat_el, double range_rate);
+    void position(double rep_az, double rep_el, double latency);
+
+    int  getWritten(void) { return written; }
+    int  getDropped(void) { return dropped; }
+
+protected:
+    void run();
+    int  drain(void);
+
+private:
+    TTelemetrySlot   *ring;
+    TTelemetryRecord *batch;
+    QAtomicInt       head, active, dropped;
+    int              tail, written, flags;
+    FILE             *fp;
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,143 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QString>
+#include <string.h>
+#include <math.h>
+
+#include "telemetryreader.h"
+#include "utils.h"
+
+//---------------------------------------------------------------------------
+TTelemetryReader::TTelemetryReader(void)
+{
+    memset(&hdr, 0, sizeof(hdr));
+    fp = NULL;
+}
+
+//---------------------------------------------------------------------------
+TTelemetryReader::~TTelemetryReader(void)
+{
+    close();
+}
+
+//---------------------------------------------------------------------------
+bool TTelemetryReader::open(const QString &filename)
+{
+    close();
+
+    if(!(fp = fopen(filename.toStdString().c_str(), "rb"))) {
+        qDebug("Failed to open %s [%s:%d]", filename.toStdString().c_str(), __FILE__, __LINE__);
+        return false;
+    }
+
+    if(fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+       hdr.magic != TM_MAGIC || hdr.version != TM_VERSION || hdr.recsize != sizeof(TTelemetryRecord)) {
+        qDebug("%s is not a telemetry log [%s:%d]", filename.toStdString().c_str(), __FILE__, __LINE__);
+        close();
+
+        return false;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void TTelemetryReader::close(void)
+{
+    if(fp)
+        fclose(fp);
+
+    fp = NULL;
+}
+
+//---------------------------------------------------------------------------
+bool TTelemetryReader::next(TTelemetryRecord *rec)
+{
+    if(fp == NULL)
+        return false;
+
+    return fread(rec, sizeof(TTelemetryRecord), 1, fp) == 1;
+}
+
+//---------------------------------------------------------------------------
+bool TTelemetryReader::dump(const QString &filename, FILE *out)
+{
+    TTelemetryReader reader;
+    TTelemetryRecord rec;
+    qint64 first, last;
+    double err, sum_err, sum_lat;
+    long   n, n_track, n_pos, n_lat, n_err;
+
+    if(!reader.open(filename))
+        return false;
+
+    n = n_track = n_pos = n_lat = n_err = 0;
+    sum_err = sum_lat = 0;
+    first = last = reader.getStart();
+
+    fprintf(out, "seq,type,msecs,cmd_az,cmd_el,rep_az,rep_el,sat_az,sat_el,range_rate,latency\n");
+
+    while(reader.next(&rec)) {
+        fprintf(out, "%u,%s,%lld,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.4f,%.0f\n",
+                rec.seq, rec.type == TM_TRACK ? "track":"position",
+                (long long) (rec.msecs - reader.getStart()),
+                rec.cmd_az, rec.cmd_el, rec.rep_az, rec.rep_el,
+                rec.sat_az, rec.sat_el, rec.range_rate, rec.latency);
+
+        if(n++ == 0)
+            first = rec.msecs;
+        last = rec.msecs;
+
+        if(rec.type == TM_TRACK) {
+            // angle between the satellite and the last reported position
+            if(!isnan(rec.rep_az) && !isnan(rec.rep_el)) {
+                err = cos(rec.rep_el * DTR) * cos(rec.sat_el * DTR) * cos((rec.rep_az - rec.sat_az) * DTR) +
+                      sin(rec.rep_el * DTR) * sin(rec.sat_el * DTR);
+
+                err = acos(ClipValue(err, 1.0, -1.0)) * RTD;
+                sum_err += err * err;
+                n_err++;
+            }
+
+            n_track++;
+        }
+        else if(rec.type == TM_POSITION) {
+            n_pos++;
+
+            if(rec.latency > 0) {
+                sum_lat += rec.latency;
+                n_lat++;
+            }
+        }
+    }
+
+    fprintf(out, "# records %ld, track %ld, position %ld, %.1f s, %.1f Hz\n",
+            n, n_track, n_pos, (last - first) / 1000.0,
+            last > first ? n * 1000.0 / (last - first):0.0);
+    fprintf(out, "# rms pointing error %.3f deg, mean controller latency %.1f ms\n",
+            n_err > 0 ? sqrt(sum_err / n_err):0.0,
+            n_lat > 0 ? sum_lat / n_lat:0.0);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,55 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef TELEMETRYREADER_H
+#define TELEMETRYREADER_H
+
+#include <QtGlobal>
+#include <QString>
+#include <stdio.h>
+
+#include "telemetry.h"
+
+//---------------------------------------------------------------------------
+// reads a log written by TTelemetry
+class TTelemetryReader
+{
+public:
+    TTelemetryReader(void);
+    ~TTelemetryReader(void);
+
+    bool open(const QString &filename);
+    void close(void);
+
+    // false at the end of the file
+    bool next(TTelemetryRecord *rec);
+
+    qint64 getStart(void) { return hdr.start; }
+
+    // prints the records as CSV and a summary, returns false if the file is not a telemetry log
+    static bool dump(const QString &filename, FILE *out);
+
+private:
+    TTelemetryHeader hdr;
+    FILE             *fp;
+};
+
+#endif // TELEMETRYREADER_H
@@ -0,0 +1,278 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QFile>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tlearchive.h"
+#include "tleparser.h"
+
+//---------------------------------------------------------------------------
+#define TA_OFFSET(pos)  ((long) sizeof(TTLEArchiveHeader) + (long) (pos) * (long) sizeof(TTLERecord))
+
+//---------------------------------------------------------------------------
+TTLEArchive::TTLEArchive(const QString &path_)
+{
+    path      = path_;
+    fp        = NULL;
+    items     = NULL;
+    num_items = 0;
+    capacity  = 0;
+}
+
+//---------------------------------------------------------------------------
+TTLEArchive::~TTLEArchive(void)
+{
+    close();
+}
+
+//---------------------------------------------------------------------------
+void TTLEArchive::close(void)
+{
+    if(fp)
+        fclose(fp);
+    if(items)
+        free(items);
+
+    fp        = NULL;
+    items     = NULL;
+    num_items = 0;
+    capacity  = 0;
+}
+
+//---------------------------------------------------------------------------
+bool TTLEArchive::open(const QString &satname)
+{
+ TTLEArchiveHeader hdr;
+ QString str, file;
+ bool    exists;
+
+    close();
+
+    str = satname;
+    str.replace(" ", "-");
+    file = path + "/" + str + TA_EXT;
+
+    exists = QFile::exists(file);
+
+    fp = fopen(file.toStdString().c_str(), exists ? "r+b":"w+b");
+    if(fp == NULL) {
+        qDebug("Failed to open %s [%s:%d]", file.toStdString().c_str(), __FILE__, __LINE__);
+        return false;
+    }
+
+    if(exists)
+        return readIndex();
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic   = TA_MAGIC;
+    hdr.version = TA_VERSION;
+    hdr.recsize = sizeof(TTLERecord);
+
+    if(fwrite(&hdr, sizeof(hdr), 1, fp) != 1 || fflush(fp)) {
+        qDebug("Failed to write %s [%s:%d]", file.toStdString().c_str(), __FILE__, __LINE__);
+        close();
+        return false;
+    }
+
+    file = path + "/" + str + TA_LEGACY_EXT;
+    if(QFile::exists(file))
+        importLegacy(file);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TTLEArchive::readIndex(void)
+{
+ TTLEArchiveHeader hdr;
+ TTLERecord *buf;
+ size_t     i, n;
+
+    if(fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+       hdr.magic != TA_MAGIC || hdr.version != TA_VERSION || hdr.recsize != sizeof(TTLERecord))
+    {
+        qDebug("Invalid TLE archive [%s:%d]", __FILE__, __LINE__);
+        close();
+        return false;
+    }
+
+    buf = (TTLERecord *) malloc(TA_READ_RECORDS * sizeof(TTLERecord));
+    if(buf == NULL) {
+        close();
+        return false;
+    }
+
+    // a partly written record at the end is overwritten by the next add
+    while((n = fread(buf, sizeof(TTLERecord), TA_READ_RECORDS, fp)) > 0)
+        for(i=0; i<n; i++)
+            if(!insert(TTLEParser::epoch(buf[i].year, buf[i].refepoch), epochHash(&buf[i]), num_items)) {
+                free(buf);
+                close();
+                return false;
+            }
+
+    free(buf);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TTLEArchive::importLegacy(const QString &file)
+{
+ TTLEParser parser;
+ int i, n;
+
+    n = parser.read(file);
+    for(i=0; i<n; i++)
+        add(parser.record(i));
+
+    return n > 0;
+}
+
+//---------------------------------------------------------------------------
+quint64 TTLEArchive::epochHash(const TTLERecord *rec)
+{
+    // columns 18...31, YYDDD.DDDDDDDD
+    return TTLEParser::hash(rec->line1 + 18, 14);
+}
+
+//---------------------------------------------------------------------------
+// index of the first item with epoch >= epoch
+int TTLEArchive::lowerBound(double epoch)
+{
+ int lo = 0, hi = num_items, mid;
+
+    while(lo < hi) {
+        mid = (lo + hi) / 2;
+        if(items[mid].epoch < epoch)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+//---------------------------------------------------------------------------
+int TTLEArchive::find(double epoch, quint64 hash)
+{
+ int i;
+
+    for(i=lowerBound(epoch); i<num_items && items[i].epoch == epoch; i++)
+        if(items[i].hash == hash)
+            return i;
+
+    return -1;
+}
+
+//---------------------------------------------------------------------------
+bool TTLEArchive::insert(double epoch, quint64 hash, qint32 pos)
+{
+ TTLEArchiveItem *tmp;
+ int i;
+
+    if(num_items == capacity) {
+        capacity = capacity ? capacity * 2 : 64;
+        tmp = (TTLEArchiveItem *) realloc(items, capacity * sizeof(TTLEArchiveItem));
+        if(tmp == NULL) {
+            qDebug("Out of memory [%s:%d]", __FILE__, __LINE__);
+            return false;
+        }
+        items = tmp;
+    }
+
+    // mostly appended in epoch order
+    if(num_items == 0 || items[num_items - 1].epoch <= epoch)
+        i = num_items;
+    else {
+        i = lowerBound(epoch);
+        memmove(&items[i + 1], &items[i], (num_items - i) * sizeof(TTLEArchiveItem));
+    }
+
+    items[i].epoch = epoch;
+    items[i].hash  = hash;
+    items[i].pos   = pos;
+    num_items++;
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TTLEArchive::add(const TTLERecord *rec)
+{
+ double  epoch;
+ quint64 hash;
+
+    if(fp == NULL || rec == NULL)
+        return false;
+
+    epoch = TTLEParser::epoch(rec->year, rec->refepoch);
+    hash  = epochHash(rec);
+
+    if(find(epoch, hash) >= 0)
+        return false;
+
+    if(fseek(fp, TA_OFFSET(num_items), SEEK_SET) ||
+       fwrite(rec, sizeof(TTLERecord), 1, fp) != 1 || fflush(fp))
+    {
+        qDebug("Failed to append the TLE archive [%s:%d]", __FILE__, __LINE__);
+        return false;
+    }
+
+    return insert(epoch, hash, num_items);
+}
+
+//---------------------------------------------------------------------------
+bool TTLEArchive::at(int index, TTLERecord *rec)
+{
+    if(fp == NULL || index < 0 || index >= num_items)
+        return false;
+
+    if(fseek(fp, TA_OFFSET(items[index].pos), SEEK_SET) ||
+       fread(rec, sizeof(TTLERecord), 1, fp) != 1)
+    {
+        qDebug("Failed to read the TLE archive [%s:%d]", __FILE__, __LINE__);
+        return false;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TTLEArchive::nearest(double daynum, TTLERecord *rec)
+{
+ int i;
+
+    if(num_items == 0)
+        return false;
+
+    i = lowerBound(daynum);
+    if(i == num_items)
+        i--;
+    else if(i > 0 && daynum - items[i - 1].epoch <= items[i].epoch - daynum)
+        i--;
+
+    return at(i, rec);
+}
+
+//---------------------------------------------------------------------------
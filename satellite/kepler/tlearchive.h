@@ -0,0 +1,92 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef TLEARCHIVE_H
+#define TLEARCHIVE_H
+
+#include <QtGlobal>
+#include <QString>
+#include <stdio.h>
+
+//---------------------------------------------------------------------------
+#define TA_MAGIC            0x48454c54 // "TLEH"
+#define TA_VERSION          1
+#define TA_EXT              ".tlh"
+#define TA_LEGACY_EXT       ".tle"      // text archive, imported once
+#define TA_READ_RECORDS     256         // records read per chunk when indexing
+
+struct TTLERecord;
+
+//---------------------------------------------------------------------------
+struct TTLEArchiveHeader
+{
+    quint32 magic, version, recsize, reserved;
+};
+
+//---------------------------------------------------------------------------
+// one element set in the archive, sorted by epoch
+struct TTLEArchiveItem
+{
+    double  epoch;  // PREDICT day number
+    quint64 hash;   // of the epoch field in line 1
+    qint32  pos;    // record number in the file
+};
+
+//---------------------------------------------------------------------------
+// append-only element set history of one satellite in
+// path/<name>.tlh, the file is a header followed by TTLERecord's in the
+// order they were added, the epoch index is built when opened
+class TTLEArchive
+{
+public:
+    TTLEArchive(const QString &path_);
+    ~TTLEArchive(void);
+
+    bool open(const QString &satname);
+    void close(void);
+    bool isOpen(void) { return fp != NULL; }
+
+    // false if rec is already archived or on error
+    bool add(const TTLERecord *rec);
+
+    // the element set with the epoch nearest to daynum
+    bool nearest(double daynum, TTLERecord *rec);
+    bool at(int index, TTLERecord *rec);
+
+    int  count(void) { return num_items; }
+    int  find(double epoch, quint64 hash);
+
+    static quint64 epochHash(const TTLERecord *rec);
+
+protected:
+    int  lowerBound(double epoch);
+    bool insert(double epoch, quint64 hash, qint32 pos);
+    bool readIndex(void);
+    bool importLegacy(const QString &file);
+
+private:
+    QString         path;
+    FILE            *fp;
+    TTLEArchiveItem *items;
+    int             num_items, capacity;
+};
+
+#endif // TLEARCHIVE_H
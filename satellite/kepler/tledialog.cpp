@@ -32,6 +32,8 @@
 #include "mainwindow.h"
 #include "Satellite.h"
 #include "satutil.h"
+#include "tleparser.h"
+#include "tlearchive.h"
 #include "plist.h"
 #include "station.h"
 
@@ -54,6 +56,7 @@ tledialog::tledialog(PList *list, TStation *_qth, QWidget *parent) :
 
     tlepath = ((MainWindow *) parent)->getTLEPath();
     tlearcpath = ((MainWindow *) parent)->getTLEPath(1);
+    tlecachepath = ((MainWindow *) parent)->getTLEPath(2);
 }
 
 //---------------------------------------------------------------------------
@@ -155,18 +158,14 @@ void tledialog::saveTLE()
 //---------------------------------------------------------------------------
 int tledialog::readTLE(const QString &filename)
 {
- FILE *fp;
  int count;
 
-    fp = fopen(filename.toStdString().c_str(), "r");
-    if(!fp) {
+    if(!QFile::exists(filename)) {
        QMessageBox::critical(this, "Failed to open TLE file!", filename);
        return 0;
     }
 
-    count = ReadTLE(fp, satList);
-
-    fclose(fp);
+    count = ReadTLE(filename, satList, tlecachepath);
 
     if(count <= 0) {
        QMessageBox::critical(this, "No valid satellites found in TLE file!", filename);
@@ -287,11 +286,13 @@ void tledialog::updateSatTLE()
         else {
             // archivate previous TLE
             if(strcmp(newsat->line1, sat->line1))
-                archivate(newsat);
+                archivate(sat);
 
             sat->TLEKepCheck(newsat->name, newsat->line1, newsat->line2);
         }
 
+        archivate(newsat);
+
         sat->AssignObsInfo(qth);
 
         if(sat->IsGeostationary() || sat->Decayed(0))
@@ -304,32 +305,15 @@ void tledialog::updateSatTLE()
 //---------------------------------------------------------------------------
 void tledialog::archivate(TSat *sat)
 {
-    QString str, file;
-    FILE    *fp;
-
-    str = sat->name;
-    str.replace(" ", "-");
-    file = tlearcpath + "/" + str + ".tle";
+    TTLEArchive arc(tlearcpath);
+    TTLERecord  rec;
 
-    if((fp = fopen(file.toStdString().c_str(), "r"))) {
-        while(fgets(sat->tmpstr, TLE_LINELEN, fp)) {
-            // check if line 1 is found
-            if(*sat->tmpstr == '1' && !strcmp(sat->tmpstr, sat->line1)) {
-                fclose(fp);
-
-                return;
-            }
-        }
-        fclose(fp);
-    }
-
-    if((fp = fopen(file.toStdString().c_str(), "a"))) {
-        fprintf(fp, "%s\n", sat->name);
-        fprintf(fp, "%s\n", sat->line1);
-        fprintf(fp, "%s\n", sat->line2);
+    if(!TTLEParser::parse(sat->name, -1, sat->line1, sat->line2, &rec))
+        return;
 
-        fclose(fp);
-    }
+    // duplicates are skipped by the archive
+    if(arc.open(sat->name))
+        arc.add(&rec);
 }
 
 //---------------------------------------------------------------------------
@@ -59,7 +59,7 @@ private:
     QHttp *http;
     PList *satList, *satListptr;
     TStation *qth;
-    QString tlepath, tlearcpath;
+    QString tlepath, tlearcpath, tlecachepath;
 
 private slots:
     void on_delButton_clicked();
@@ -0,0 +1,491 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "tleparser.h"
+
+//---------------------------------------------------------------------------
+#define TP_ISDIGIT(c)   ((c) >= '0' && (c) <= '9')
+#define TP_CHKSUM(c)    (TP_ISDIGIT(c) ? (c) - '0' : ((c) == '-' ? 1:0))
+
+static const double tp_pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+                                   1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+
+// 10^(c - '0') of an exponent column
+#define TP_EXP10(c)     (TP_ISDIGIT(c) ? tp_pow10[(c) - '0'] : pow(10.0, (c) - '0'))
+
+//---------------------------------------------------------------------------
+// one element set in the source file, the lines are not null terminated
+struct TTLEText
+{
+    const char *name, *line1, *line2;
+    int        namelen;
+};
+
+//---------------------------------------------------------------------------
+class TTLEParseWorker : public QThread
+{
+public:
+    TTLEParseWorker(const TTLEText *text_, TTLERecord *records_, quint8 *ok_, int first_, int last_)
+    {
+        text    = text_;
+        records = records_;
+        ok      = ok_;
+        first   = first_;
+        last    = last_;
+    }
+
+    void run()
+    {
+        for(int i=first; i<last; i++)
+            ok[i] = TTLEParser::parse(text[i].name, text[i].namelen, text[i].line1, text[i].line2, &records[i]);
+    }
+
+private:
+    const TTLEText *text;
+    TTLERecord     *records;
+    quint8         *ok;
+    int            first, last;
+};
+
+//---------------------------------------------------------------------------
+// same as atof on the field with the blanks removed, the fields have at most
+// 12 digits so the mantissa is exact and the result correctly rounded
+static double tp_number(const char *s, int start, int end)
+{
+ qint64 mant = 0;
+ int    i, frac = -1;
+ bool   neg = false, started = false;
+ double value;
+
+    for(i=start; i<=end; i++) {
+        if(s[i] == ' ')
+            continue;
+
+        if(!started && (s[i] == '-' || s[i] == '+')) {
+            neg = s[i] == '-';
+            started = true;
+            continue;
+        }
+
+        started = true;
+
+        if(s[i] == '.') {
+            if(frac >= 0)
+                break;
+            frac = 0;
+            continue;
+        }
+
+        if(!TP_ISDIGIT(s[i]))
+            break;
+
+        mant = mant * 10 + s[i] - '0';
+        if(frac >= 0)
+            frac++;
+    }
+
+    value = frac > 0 ? (double) mant / tp_pow10[frac] : (double) mant;
+
+    return neg ? -value : value;
+}
+
+//---------------------------------------------------------------------------
+TTLEParser::TTLEParser(void)
+{
+    records   = NULL;
+    rec_count = 0;
+    cached    = false;
+}
+
+//---------------------------------------------------------------------------
+TTLEParser::~TTLEParser(void)
+{
+    clear();
+}
+
+//---------------------------------------------------------------------------
+void TTLEParser::clear(void)
+{
+    if(records)
+        free(records);
+
+    records   = NULL;
+    rec_count = 0;
+    cached    = false;
+}
+
+//---------------------------------------------------------------------------
+double TTLEParser::epoch(int year, double refepoch)
+{
+ double yy = year - 1; // january, see TSat::DayNum
+
+    if(yy <= 50)
+        yy += 100;
+
+    return floor(365.25*(yy-80.0)) - floor(19.0+yy/100.0) + floor(4.75+yy/400.0) - 16.0 +
+           30*13 + floor(0.6*13.0-0.3) + refepoch;
+}
+
+//---------------------------------------------------------------------------
+// FNV-1a over 64 bit words, the tail byte by byte
+quint64 TTLEParser::hash(const char *data, qint64 size)
+{
+ quint64 h = 14695981039346656037ULL, w;
+ qint64  i;
+
+    for(i=0; i + 8 <= size; i += 8) {
+        memcpy(&w, data + i, 8);
+        h = (h ^ w) * 1099511628211ULL;
+    }
+
+    for(; i<size; i++)
+        h = (h ^ (quint8) data[i]) * 1099511628211ULL;
+
+    return h;
+}
+
+//---------------------------------------------------------------------------
+// namelen < 0 = name is null terminated
+bool TTLEParser::parse(const char *name, int namelen, const char *l1, const char *l2, TTLERecord *rec)
+{
+ double   tempnum;
+ unsigned sum1, sum2;
+ int      i, x;
+
+    if(!name || !l1 || !l2 || !rec)
+        return false;
+
+    for(i=0; i<TLE_LINELEN; i++)
+        if(l1[i] == '\0' || l2[i] == '\0')
+            return false;
+
+    for(i=0, sum1=0, sum2=0; i<=67; i++) {
+        sum1 += TP_CHKSUM(l1[i]);
+        sum2 += TP_CHKSUM(l2[i]);
+    }
+
+    // the same torture test as TSat::TLEKepCheck always did
+    x = (TP_CHKSUM(l1[68])^(sum1%10)) | (TP_CHKSUM(l2[68])^(sum2%10)) |
+        (l1[0]^'1')  | (l1[1]^' ')  | (l1[7]^'U')  |
+        (l1[8]^' ')  | (l1[17]^' ') | (l1[23]^'.') |
+        (l1[32]^' ') | (l1[34]^'.') | (l1[43]^' ') |
+        (l1[52]^' ') | (l1[61]^' ') | (l1[62]^'0') |
+        (l1[63]^' ') | (l2[0]^'2')  | (l2[1]^' ')  |
+        (l2[7]^' ')  | (l2[11]^'.') | (l2[16]^' ') |
+        (l2[20]^'.') | (l2[25]^' ') | (l2[33]^' ') |
+        (l2[37]^'.') | (l2[42]^' ') | (l2[46]^'.') |
+        (l2[51]^' ') | (l2[54]^'.') | (l1[2]^l2[2]) |
+        (l1[3]^l2[3]) | (l1[4]^l2[4]) |
+        (l1[5]^l2[5]) | (l1[6]^l2[6]) |
+        (TP_ISDIGIT(l1[68]) ? 0 : 1) | (TP_ISDIGIT(l2[68]) ? 0 : 1) |
+        (TP_ISDIGIT(l1[18]) ? 0 : 1) | (TP_ISDIGIT(l1[19]) ? 0 : 1) |
+        (TP_ISDIGIT(l2[31]) ? 0 : 1) | (TP_ISDIGIT(l2[32]) ? 0 : 1);
+
+    if(x)
+        return false;
+
+    // name, remove the [*] part and the trailing blanks
+    for(i=0; (namelen < 0 || i < namelen) && name[i] != '\0' && name[i] != '['; i++) ;
+    if(i > TLE_NAMELEN)
+        i = TLE_NAMELEN;
+    while(i > 0 && (name[i-1] == ' ' || name[i-1] == '\t' || name[i-1] == '\r' || name[i-1] == '\n'))
+        i--;
+    if(i == 0)
+        return false;
+
+    memset(rec, 0, sizeof(TTLERecord));
+    memcpy(rec->name, name, i);
+    rec->name[i] = '\0';
+
+    memcpy(rec->line1, l1, TLE_LINELEN);
+    memcpy(rec->line2, l2, TLE_LINELEN);
+    rec->line1[TLE_LINELEN] = '\0';
+    rec->line2[TLE_LINELEN] = '\0';
+
+    for(i=9, x=0; i<=16; i++)
+        if(l1[i] != ' ')
+            rec->designator[x++] = l1[i];
+    rec->designator[x] = '\0';
+
+    rec->catnum   = (qint32) tp_number(l1, 2, 6);
+    rec->year     = (qint32) tp_number(l1, 18, 19);
+    rec->refepoch = tp_number(l1, 20, 31);
+    tempnum       = 1.0e-5*tp_number(l1, 44, 49);
+    rec->nddot6   = tempnum/TP_EXP10(l1[51]);
+    tempnum       = 1.0e-5*tp_number(l1, 53, 58);
+    rec->bstar    = tempnum/TP_EXP10(l1[60]);
+    rec->setnum   = (qint32) tp_number(l1, 64, 67);
+    rec->incl     = tp_number(l2, 8, 15);
+    rec->raan     = tp_number(l2, 17, 24);
+    rec->eccn     = 1.0e-07*tp_number(l2, 26, 32);
+    rec->argper   = tp_number(l2, 34, 41);
+    rec->meanan   = tp_number(l2, 43, 50);
+    rec->meanmo   = tp_number(l2, 52, 62);
+    rec->drag     = tp_number(l1, 33, 42);
+    rec->orbitnum = (qint32) tp_number(l2, 63, 67);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+int TTLEParser::read(const QString &filename, const QString &cachepath)
+{
+ QFile   file(filename);
+ QString cachefile;
+ const char *data;
+ char    *buf = NULL;
+ qint64  size;
+ quint64 h;
+
+    clear();
+
+    if(!file.open(QIODevice::ReadOnly)) {
+        qDebug("Failed to open %s [%s:%d]", filename.toStdString().c_str(), __FILE__, __LINE__);
+        return 0;
+    }
+
+    size = file.size();
+    if(size <= 0)
+        return 0;
+
+    data = (const char *) file.map(0, size);
+    if(data == NULL) {
+        buf = (char *) malloc(size);
+        if(buf == NULL || file.read(buf, size) != size) {
+            qDebug("Failed to read %s [%s:%d]", filename.toStdString().c_str(), __FILE__, __LINE__);
+            if(buf)
+                free(buf);
+            return 0;
+        }
+
+        data = buf;
+    }
+
+    h = hash(data, size);
+
+    if(!cachepath.isEmpty()) {
+        cachefile = cachepath + "/" + QFileInfo(filename).fileName() + TP_CACHE_EXT;
+        cached = readCache(cachefile, h, size);
+    }
+
+    if(!cached && parseData(data, size) > 0 && !cachefile.isEmpty())
+        writeCache(cachefile, h, size);
+
+    if(buf)
+        free(buf);
+    else
+        file.unmap((uchar *) data);
+
+    return rec_count;
+}
+
+//---------------------------------------------------------------------------
+int TTLEParser::parseData(const char *data, qint64 size)
+{
+ TTLEText    *text = NULL, *t;
+ const char  *line[3], *p, *end;
+ quint8      *ok;
+ TTLEParseWorker **workers;
+ int         len[3], count = 0, capacity = 0, lines = 0;
+ int         i, j, num_threads;
+
+    // find the name, 1 and 2 line triplets
+    p   = data;
+    end = data + size;
+
+    while(p < end) {
+        line[lines] = p;
+        while(p < end && *p != '\n')
+            p++;
+
+        len[lines] = p - line[lines];
+        if(len[lines] > 0 && line[lines][len[lines] - 1] == '\r')
+            len[lines]--;
+
+        if(p < end)
+            p++;
+
+        if(lines == 0) {
+            if(len[0] > 0 && *line[0] != '#')
+                lines++;
+            continue;
+        }
+
+        if(*line[lines] != (lines == 1 ? '1':'2') || len[lines] < TLE_LINELEN) {
+            // a name line or junk, restart from it
+            line[0] = line[lines];
+            len[0]  = len[lines];
+            lines   = len[0] > 0 && *line[0] != '#' ? 1:0;
+            continue;
+        }
+
+        if(lines++ < 2)
+            continue;
+
+        if(count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            t = (TTLEText *) realloc(text, capacity * sizeof(TTLEText));
+            if(t == NULL) {
+                qDebug("Out of memory [%s:%d]", __FILE__, __LINE__);
+                break;
+            }
+            text = t;
+        }
+
+        t = &text[count++];
+        t->name    = line[0];
+        t->namelen = len[0];
+        t->line1   = line[1];
+        t->line2   = line[2];
+
+        lines = 0;
+    }
+
+    if(count == 0) {
+        if(text)
+            free(text);
+        return 0;
+    }
+
+    records = (TTLERecord *) malloc(count * sizeof(TTLERecord));
+    ok      = (quint8 *) malloc(count);
+
+    if(records == NULL || ok == NULL) {
+        qDebug("Out of memory [%s:%d]", __FILE__, __LINE__);
+        free(text);
+        if(ok)
+            free(ok);
+        clear();
+        return 0;
+    }
+
+    num_threads = qMin(QThread::idealThreadCount(), count / TP_THREAD_RECORDS);
+
+    if(num_threads > 1) {
+        workers = (TTLEParseWorker **) malloc(num_threads * sizeof(TTLEParseWorker *));
+        for(i=0; i<num_threads; i++) {
+            workers[i] = new TTLEParseWorker(text, records, ok,
+                                             (qint64) count * i / num_threads,
+                                             (qint64) count * (i + 1) / num_threads);
+            workers[i]->start();
+        }
+
+        for(i=0; i<num_threads; i++) {
+            workers[i]->wait();
+            delete workers[i];
+        }
+
+        free(workers);
+    }
+    else
+        for(i=0; i<count; i++)
+            ok[i] = parse(text[i].name, text[i].namelen, text[i].line1, text[i].line2, &records[i]);
+
+    for(i=0, j=0; i<count; i++)
+        if(ok[i]) {
+            if(i != j)
+                records[j] = records[i];
+            j++;
+        }
+
+    rec_count = j;
+
+    free(text);
+    free(ok);
+
+    return rec_count;
+}
+
+//---------------------------------------------------------------------------
+bool TTLEParser::readCache(const QString &file, quint64 hash_, qint64 size)
+{
+ TTLECacheHeader hdr;
+ FILE *fp;
+
+    if(!(fp = fopen(file.toStdString().c_str(), "rb")))
+        return false;
+
+    if(fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+       hdr.magic != TP_CACHE_MAGIC || hdr.version != TP_CACHE_VERSION ||
+       hdr.recsize != sizeof(TTLERecord) || hdr.hash != hash_ || hdr.size != size ||
+       hdr.count == 0)
+    {
+        fclose(fp);
+        return false;
+    }
+
+    records = (TTLERecord *) malloc(hdr.count * sizeof(TTLERecord));
+    if(records == NULL || fread(records, sizeof(TTLERecord), hdr.count, fp) != hdr.count) {
+        qDebug("Failed to read %s [%s:%d]", file.toStdString().c_str(), __FILE__, __LINE__);
+        fclose(fp);
+        clear();
+        return false;
+    }
+
+    fclose(fp);
+
+    rec_count = hdr.count;
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TTLEParser::writeCache(const QString &file, quint64 hash_, qint64 size)
+{
+ TTLECacheHeader hdr;
+ FILE *fp;
+ bool rc;
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic   = TP_CACHE_MAGIC;
+    hdr.version = TP_CACHE_VERSION;
+    hdr.recsize = sizeof(TTLERecord);
+    hdr.count   = rec_count;
+    hdr.hash    = hash_;
+    hdr.size    = size;
+
+    if(!(fp = fopen(file.toStdString().c_str(), "wb"))) {
+        qDebug("Failed to create %s [%s:%d]", file.toStdString().c_str(), __FILE__, __LINE__);
+        return false;
+    }
+
+    rc = fwrite(&hdr, sizeof(hdr), 1, fp) == 1 &&
+         fwrite(records, sizeof(TTLERecord), rec_count, fp) == (size_t) rec_count;
+
+    fclose(fp);
+
+    if(!rc) {
+        qDebug("Failed to write %s [%s:%d]", file.toStdString().c_str(), __FILE__, __LINE__);
+        remove(file.toStdString().c_str());
+    }
+
+    return rc;
+}
+
+//---------------------------------------------------------------------------
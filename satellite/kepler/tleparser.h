@@ -0,0 +1,96 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef TLEPARSER_H
+#define TLEPARSER_H
+
+#include <QtGlobal>
+#include <QString>
+
+#include "Satellite.h"
+
+//---------------------------------------------------------------------------
+#define TP_CACHE_MAGIC      0x43454c54 // "TLEC"
+#define TP_CACHE_VERSION    1
+#define TP_CACHE_EXT        ".cache"
+#define TP_THREAD_RECORDS   2048       // min element sets per parser thread
+
+//---------------------------------------------------------------------------
+// one parsed element set, stored as is in the binary cache
+struct TTLERecord
+{
+    char   name[TLE_NAMELEN+1], line1[TLE_LINELEN+1], line2[TLE_LINELEN+1],
+           designator[10];
+
+    double refepoch, incl, raan, eccn, argper, meanan,
+           meanmo, drag, nddot6, bstar;
+    qint32 catnum, setnum, orbitnum, year;
+};
+
+//---------------------------------------------------------------------------
+struct TTLECacheHeader
+{
+    quint32 magic, version, recsize, count;
+    quint64 hash;
+    qint64  size;
+};
+
+//---------------------------------------------------------------------------
+// bulk 3-line element set reader, the file is mapped and every element set
+// is checksummed and parsed in place by fixed column without allocation,
+// large files are split over several threads.
+// the result is cached in cachepath/<file name>.cache and reused as long as
+// the hash and size of the source file match
+class TTLEParser
+{
+public:
+    TTLEParser(void);
+    ~TTLEParser(void);
+
+    void clear(void);
+
+    // returns the number of valid element sets, cachepath empty = no cache
+    int  read(const QString &filename, const QString &cachepath = QString());
+
+    int  count(void) { return rec_count; }
+    bool isCached(void) { return cached; }
+    const TTLERecord *record(int index) { return index >= 0 && index < rec_count ? &records[index] : NULL; }
+
+    // validates and parses one element set, name is cut at '[' and trimmed
+    static bool parse(const char *name, int namelen, const char *line1, const char *line2, TTLERecord *rec);
+
+    // PREDICT day number of the epoch, same as TSat DayNum(1, 0, year) + refepoch
+    static double epoch(int year, double refepoch);
+
+    static quint64 hash(const char *data, qint64 size);
+
+protected:
+    int  parseData(const char *data, qint64 size);
+    bool readCache(const QString &file, quint64 hash_, qint64 size);
+    bool writeCache(const QString &file, quint64 hash_, qint64 size);
+
+private:
+    TTLERecord *records;
+    int        rec_count;
+    bool       cached;
+};
+
+#endif // TLEPARSER_H
@@ -23,8 +23,11 @@
 #include "ui_orbitdialog.h"
 
 #include "Satellite.h"
+#include "satcalc.h"
 #include "satutil.h"
 #include "plist.h"
+#include "groundtrack.h"
+#include "simclock.h"
 
 
 //---------------------------------------------------------------------------
@@ -40,6 +43,9 @@ orbitdialog::orbitdialog(PList *_satList, QWidget *parent) :
 
     satList = _satList;
 
+    groundTrack = new TGroundTrack;
+    groundTrack->compute(satList, TSimClock::daynum(), TSimClock::daynum() + OD_TRACK_DAYS, OD_TRACK_STEP);
+
     for(i=0; i<satList->Count; i++) {
         sat = (TSat *) satList->ItemAt(i);
         m_ui->satListWidget->addItem(sat->name);
@@ -52,6 +58,7 @@ orbitdialog::orbitdialog(PList *_satList, QWidget *parent) :
 //---------------------------------------------------------------------------
 orbitdialog::~orbitdialog()
 {
+    delete groundTrack;
     delete m_ui;
 }
 
@@ -79,10 +86,62 @@ void orbitdialog::on_satListWidget_itemSelectionChanged()
         item = m_ui->satListWidget->item(i);
         if(item->isSelected()) {
             sat = getSat(satList, item->text());
-            if(sat)
+            if(sat) {
                 sat->Data2Grid(m_ui->tableWidget);
+                showCoverage(sat);
+            }
 
             break;
         }
     }
 }
+
+//---------------------------------------------------------------------------
+void orbitdialog::showCoverage(TSat *sat)
+{
+ QTableWidget *w = m_ui->coverageWidget;
+ const TTrackSet *t;
+ TCoverage *c;
+ TRegion region;
+ PList  list;
+ double lat, lon;
+ int    i, k, row, mid;
+
+    w->setRowCount(0);
+
+    k = groundTrack->find(sat->name);
+    t = groundTrack->track(k);
+    if(t == NULL)
+        return;
+
+    // the station is a region of one point
+    lat = sat->obs_geodetic.lat / deg2rad;
+    lon = sat->manipulate_lon(sat->obs_geodetic.lon / deg2rad);
+
+    region.lat_min = region.lat_max = lat;
+    region.lon_min = region.lon_max = lon;
+
+    groundTrack->coverage(&region, 0, &list);
+
+    for(i=0; i<list.Count; i++) {
+        c = (TCoverage *) list.ItemAt(i);
+
+        if(c->track == k) {
+            mid = (int) (((c->aos + c->los)/2.0 - t->from)/t->step + 0.5);
+            if(mid >= t->samples)
+                mid = t->samples - 1;
+
+            row = w->rowCount();
+            w->insertRow(row);
+
+            w->setItem(row, 0, new QTableWidgetItem(sat->Daynum2DateTime(c->aos).toString("yyyy-MM-dd hh:mm:ss")));
+            w->setItem(row, 1, new QTableWidgetItem(sat->Daynum2DateTime(c->los).toString("yyyy-MM-dd hh:mm:ss")));
+            w->setItem(row, 2, new QTableWidgetItem(QString::number((c->los - c->aos)*1440.0, 'f', 1)));
+            w->setItem(row, 3, new QTableWidgetItem(sat->get_lat_lon_str(t->lat[mid], t->lon[mid])));
+        }
+
+        delete c;
+    }
+
+    list.Flush();
+}
@@ -28,7 +28,12 @@ namespace Ui {
     class orbitdialog;
 }
 //---------------------------------------------------------------------------
+#define OD_TRACK_DAYS   1.0             // ground tracks computed ahead
+#define OD_TRACK_STEP   (30.0/86400.0)  // 30 seconds, days
+
 class PList;
+class TSat;
+class TGroundTrack;
 //---------------------------------------------------------------------------
 class orbitdialog : public QDialog {
     Q_OBJECT
@@ -39,9 +44,13 @@ public:
 protected:
     void changeEvent(QEvent *e);
 
+    // the station footprint passes of sat's ground track
+    void showCoverage(TSat *sat);
+
 private:
     Ui::orbitdialog *m_ui;
     PList *satList;
+    TGroundTrack *groundTrack;
 
 private slots:
     void on_satListWidget_itemSelectionChanged();
@@ -43,9 +43,16 @@
 #include "station.h"
 #include "satcalc.h"
 #include "utils.h"
+#include "simclock.h"
 #include "version.h"
 
 #include "Satellite.h"
+#include "passworker.h"
+#include "passephem.h"
+#include "tleparser.h"
+#include "plist.h"
+
+unsigned int TSat::renamed = 0;
 
 //---------------------------------------------------------------------------
 TSat::TSat(void)
@@ -56,6 +63,7 @@ TSat::TSat(void)
 
     sat_scripts = new TSatScript;
     sat_props = new TSatProp;
+    pass_ephem = new TPassEphem;
 
     Zero();
 }
@@ -69,6 +77,7 @@ TSat::TSat(TSat *src)
 
     sat_scripts = new TSatScript;
     sat_props = new TSatProp;
+    pass_ephem = new TPassEphem;
 
     Zero();
     Copy(src);
@@ -89,8 +98,13 @@ TSat& TSat::operator = (TSat *src)
 //---------------------------------------------------------------------------
 void TSat::Copy(TSat *src)
 {
+    if(name[0] && strcmp(name, src->name))
+        renamed++;
+
     strcpy(name, src->name);
 
+    pass_ephem->clear();
+
     *sat_scripts = *src->sat_scripts;
     *sat_props   = *src->sat_props;
 
@@ -136,6 +150,7 @@ void TSat::Zero(void)
   tcatime     = 0;
   sat_max_ele = 0;
   lostime     = 0;
+  ps_alt      = 0;
   rec_lostime = 0;
   sat_flags   = 0;
 
@@ -150,6 +165,7 @@ TSat::~TSat(void)
 
     delete sat_scripts;
     delete sat_props;
+    delete pass_ephem;
 }
 
 //---------------------------------------------------------------------------
@@ -199,68 +215,55 @@ bool TSat::TLEKepCheck(char *_name, char *_line1, char *_line2)
     a 0 if it does not.  If the data survives this torture test,
     it's a pretty safe bet we're looking at a valid 2-line
     element set and not just some random text that might pass
-    as orbital data based on a simple checksum calculation alone. */
+    as orbital data based on a simple checksum calculation alone.
 
- double   tempnum;
- unsigned sum1, sum2;
- int      x;
+    The test and the field parsing is done by TTLEParser::parse. */
 
-  if(!_name || !_line1 || !_line2)
-     return false;
+ TTLERecord rec;
+
+  // new elements, the cached pass is stale
+  pass_ephem->clear();
 
-  /* Compute checksum for each line */
-
-  for(x=0, sum1=0, sum2=0; x<=67; sum1+=chksum[(int)_line1[x]], sum2+=chksum[(int)_line2[x]], x++) ;
-
-  /* Perform a "torture test" on the data */
-
-  x=(chksum[(int)_line1[68]]^(sum1%10)) | (chksum[(int)_line2[68]]^(sum2%10)) |
-    (_line1[0]^'1')  | (_line1[1]^' ')  | (_line1[7]^'U')  |
-    (_line1[8]^' ')  | (_line1[17]^' ') | (_line1[23]^'.') |
-    (_line1[32]^' ') | (_line1[34]^'.') | (_line1[43]^' ') |
-    (_line1[52]^' ') | (_line1[61]^' ') | (_line1[62]^'0') |
-    (_line1[63]^' ') | (_line2[0]^'2')  | (_line2[1]^' ')  |
-    (_line2[7]^' ')  | (_line2[11]^'.') | (_line2[16]^' ') |
-    (_line2[20]^'.') | (_line2[25]^' ') | (_line2[33]^' ') |
-    (_line2[37]^'.') | (_line2[42]^' ') | (_line2[46]^'.') |
-    (_line2[51]^' ') | (_line2[54]^'.') | (_line1[2]^_line2[2]) |
-    (_line1[3]^_line2[3]) | (_line1[4]^_line2[4]) |
-    (_line1[5]^_line2[5]) | (_line1[6]^_line2[6]) |
-    (isdigit(_line1[68]) ? 0 : 1) | (isdigit(_line2[68]) ? 0 : 1) |
-    (isdigit(_line1[18]) ? 0 : 1) | (isdigit(_line1[19]) ? 0 : 1) |
-    (isdigit(_line2[31]) ? 0 : 1) | (isdigit(_line2[32]) ? 0 : 1);
-
-  if(x)
+  if(!TTLEParser::parse(_name, -1, _line1, _line2, &rec))
      return false;
 
-  // assign values
-  //strncpy(name,  _name,  TLE_NAMELEN);
-  FixName(_name);
-  strncpy(line1, _line1, TLE_LINELEN);
-  strncpy(line2, _line2, TLE_LINELEN);
-
-  strncpy(designator, SubString(line1, 9, 16), 8);
-  designator[9] = 0;
-  catnum   = atol(SubString(line1, 2, 6));
-  year     = atoi(SubString(line1, 18, 19));
-  refepoch = atof(SubString(line1, 20, 31));
-  tempnum  = 1.0e-5*atof(SubString(line1, 44, 49));
-  nddot6   = tempnum/pow(10.0, (line1[51]-'0'));
-  tempnum  = 1.0e-5*atof(SubString(line1, 53, 58));
-  bstar    = tempnum/pow(10.0, (line1[60]-'0'));
-  setnum   = atol(SubString(line1, 64, 67));
-  incl     = atof(SubString(line2, 8, 15));
-  raan     = atof(SubString(line2, 17, 24));
-  eccn     = 1.0e-07*atof(SubString(line2, 26, 32));
-  argper   = atof(SubString(line2, 34, 41));
-  meanan   = atof(SubString(line2, 43, 50));
-  meanmo   = atof(SubString(line2, 52, 62));
-  drag     = atof(SubString(line1, 33, 42));
-  orbitnum = atof(SubString(line2, 63, 67));
+  SetElements(&rec);
 
  return true;
 }
 
+//---------------------------------------------------------------------------
+void TSat::SetElements(const TTLERecord *rec)
+{
+  pass_ephem->clear();
+
+  if(name[0] && (strcmp(name, rec->name) || catnum != rec->catnum))
+     renamed++;
+
+  memcpy(name,  rec->name,  TLE_NAMELEN+1);
+  memcpy(line1, rec->line1, TLE_LINELEN+1);
+  memcpy(line2, rec->line2, TLE_LINELEN+1);
+  memcpy(designator, rec->designator, sizeof(designator));
+
+  catnum   = rec->catnum;
+  year     = rec->year;
+  refepoch = rec->refepoch;
+  nddot6   = rec->nddot6;
+  bstar    = rec->bstar;
+  setnum   = rec->setnum;
+  incl     = rec->incl;
+  raan     = rec->raan;
+  eccn     = rec->eccn;
+  argper   = rec->argper;
+  meanan   = rec->meanan;
+  meanmo   = rec->meanmo;
+  drag     = rec->drag;
+  orbitnum = rec->orbitnum;
+
+  // the next Calc does PreCalc with the new elements
+  ClearFlag(INITIALIZED_FLAG);
+}
+
 //---------------------------------------------------------------------------
 char *TSat::noradEvalue(double value)
 {
@@ -675,10 +678,11 @@ void TSat::AssignObsInfo(TStation *_qth)
   obs_geodetic.alt   = qth->alt() * 1.0e-3;
   obs_geodetic.theta = 0.0;
   station_name       = qth->name();
+
+  pass_ephem->clear();
 }
 
 //---------------------------------------------------------------------------
-// mode&1 = dont clear grid
 /*
   PassGrid->Cells[ 0][0] = "Spacecraft";
   PassGrid->Cells[ 1][0] = "Orbit";
@@ -693,23 +697,23 @@ void TSat::AssignObsInfo(TStation *_qth)
   PassGrid->Cells[10][0] = "Phase";
   PassGrid->Cells[11][0] = "Range";
 */
-void TSat::SatellitePasses(TRig *rig, QTableWidget *grid, QDateTime utc, int mode)
+// appends the passes on the date of utc to rows, returns the number of rows added
+// does not touch any widgets, see TPassWorker
+int TSat::SatellitePasses(TRig *rig, PList *rows, QDateTime utc)
 {
+    TPassRow  *prow;
     QDateTime local;
     double    dn_utc;
     int       row;
     bool      add;
 
-    if(!(mode & 1))
-        clearGrid(grid);
-
     dn_utc = GetStartTime(utc);
     local  = utc.toLocalTime();
 
     daynum = dn_utc;
     daynum = FindAOS();
     if(daynum == 0)
-        return;
+        return 0;
 
     row = 0;
     while(true) {
@@ -726,11 +730,11 @@ void TSat::SatellitePasses(TRig *rig, QTableWidget *grid, QDateTime utc, int mod
     }
 
    if(daynum == 0)
-       return;
+       return 0;
    if(!CalcAll(dn_utc))
-       return;
+       return 0;
 
-   row = grid->rowCount();
+   row = 0;
    do {
        add = true;
        daynum = tcatime;
@@ -740,11 +744,12 @@ void TSat::SatellitePasses(TRig *rig, QTableWidget *grid, QDateTime utc, int mod
            add = false;
 
        if(add) {
-           row = grid->rowCount() + 1;
-           grid->setRowCount(row);
+           prow = new TPassRow;
+           GetPassRow(rig, prow, Daynum2String(aostime, 2|16),
+                      sat_azi, sat_range, rv);
 
-           FillPassGrid(rig, grid, Daynum2String(aostime, 2|16),
-                        sat_azi, sat_lat, sat_lon, sat_range, rv);
+           rows->Add(prow);
+           row++;
        }
 
        /* Move to next orbit */
@@ -760,6 +765,7 @@ void TSat::SatellitePasses(TRig *rig, QTableWidget *grid, QDateTime utc, int mod
 
   } while(CanCalc(obs_geodetic.lat, daynum));
 
+ return row;
 }
 
 //---------------------------------------------------------------------------
@@ -800,6 +806,21 @@ bool TSat::CalcAll(double dn, int mode)
  return true;
 }
 
+//---------------------------------------------------------------------------
+// restores a pass predicted by CalcAll, e.g. from TPassTable
+void TSat::SetPass(double aos, double tca, double los, double max_ele, bool northbound)
+{
+  PreCalc();
+
+  aostime     = aos;
+  tcatime     = tca;
+  lostime     = los;
+  sat_max_ele = max_ele;
+  daynum      = los;
+
+  setDirection(northbound);
+}
+
 //---------------------------------------------------------------------------
 // CalcAll must have been called before this function to work properly
 bool TSat::CheckThresholds(TRig *rig)
@@ -926,24 +947,57 @@ bool TSat::IsUp(TStation *_qth, QDateTime dt, double min_sat_ele)
 //---------------------------------------------------------------------------
 void TSat::Track(void)
 {
-  daynum = GetStartTime(QDateTime::currentDateTime().toUTC());
+ TPassSample s;
+
+  daynum = TSimClock::daynum();
+
+  // inside the cached pass only the observed position is updated
+  if(pass_ephem->interpolate(daynum, &s)) {
+     sat_azi        = s.az;
+     sat_ele        = s.el;
+     sat_range      = s.range;
+     sat_range_rate = s.range_rate;
+     sat_lat        = s.lat;
+     sat_lon        = s.lon;
+     sat_alt        = s.alt;
+
+     return;
+  }
 
   Calc();
 }
 
 //---------------------------------------------------------------------------
+// samples the current pass, Track() interpolates between AOS and LOS
+bool TSat::CachePass(void)
+{
+  if(aostime <= 0 || lostime <= aostime)
+     return false;
+
+ return pass_ephem->build(this, aostime, lostime);
+}
+
+//---------------------------------------------------------------------------
+// rig == NULL returns the RF downlink frequency
 double TSat::getDownlinkFreq(TRig *rig)
 {
     QString dl = sat_scripts->downlink();
 
     if(dl == "0")
         return 0;
-    else if(sat_scripts->downconvert())
+    else if(sat_scripts->downconvert() && rig)
         return rig->dcFreq(atof(dl.toStdString().c_str()));
     else
         return atof(dl.toStdString().c_str());
 }
 
+//---------------------------------------------------------------------------
+// Doppler shift of freq at the current range rate, in the unit of freq
+double TSat::getDoppler(double freq)
+{
+    return -freq * ((sat_range_rate * 1000.0) / 299792458.0);
+}
+
 //---------------------------------------------------------------------------
 QString TSat::getDownlinkFreqStr(TRig *rig)
 {
@@ -975,7 +1029,7 @@ QString TSat::GetTrackStr(TRig *rig, int mode)
 {
  QString rc;
  QString str_status, str_doppler, str_pos, str_dl;
- double dl, doppler100, dopp;
+ double dl;
 
   sat_rx = -1;
 
@@ -1000,9 +1054,7 @@ QString TSat::GetTrackStr(TRig *rig, int mode)
 
   if(sat_ele >= 0.0) {
      if(dl != 0) {
-        doppler100 = -100.0e06*((sat_range_rate*1000.0)/299792458.0);
-        dopp = 1.0e-08*(doppler100*dl);
-        sat_rx = dl + dopp;
+        sat_rx = dl + getDoppler(dl);
         
         str_doppler.sprintf("@ RX:%f MHz", sat_rx);
      }
@@ -1182,15 +1234,12 @@ bool TSat::ReadPassinfo(QString hrptfile)
 }
 
 //---------------------------------------------------------------------------
-void TSat::FillPassGrid(TRig *rig, QTableWidget *g, QString datestr,
-                        double az, double /*lat*/, double /*lon*/, double range,
-                        long orbit)
+void TSat::GetPassRow(TRig *rig, TPassRow *row, QString datestr,
+                      double az, double range, long orbit)
 {
   QString str, durstr;
   double  dur_sec, high_elev, dn;
   int     imin, isec;
-  int     i = g->rowCount() - 1;
-  int     col = 0;
   bool    use_thresholds = false;
 
  /*
@@ -1232,26 +1281,19 @@ void TSat::FillPassGrid(TRig *rig, QTableWidget *g, QString datestr,
   daynum = tcatime;
   Calc();
 
-  g->setItem(i, col++, new QTableWidgetItem(str));
-  g->setItem(i, col++, new QTableWidgetItem(getDownlinkFreqStr(rig)));
-  g->setItem(i, col++, new QTableWidgetItem(datestr));
-  str.sprintf("%.2f", sat_max_ele);
-  g->setItem(i, col++, new QTableWidgetItem(str));
-  g->setItem(i, col++, new QTableWidgetItem(isNorthbound() ? "Northbound":"Southbound"));
-  g->setItem(i, col++, new QTableWidgetItem(durstr));
-  str.sprintf("%.2f", az);
-  g->setItem(i, col++, new QTableWidgetItem(str));
-  g->setItem(i, col++, new QTableWidgetItem(get_lat_str(sat_lat)));
-  g->setItem(i, col++, new QTableWidgetItem(get_lon_str(sat_lon)));
-  str.sprintf("%.0f", range);
-  g->setItem(i, col++, new QTableWidgetItem(str));
-  str.sprintf("%ld", orbit);
-  g->setItem(i, col++, new QTableWidgetItem(str));
-
-  if(!use_thresholds && sat_max_ele > high_elev) {
-      for(col=0; col<g->columnCount(); col++)
-         g->item(i, col)->setSelected(true);
-  }
+  row->aostime   = aostime;
+  row->name      = str;
+  row->downlink  = getDownlinkFreqStr(rig);
+  row->aos       = datestr;
+  row->max_ele.sprintf("%.2f", sat_max_ele);
+  row->direction = isNorthbound() ? "Northbound":"Southbound";
+  row->duration  = durstr;
+  row->azimuth.sprintf("%.2f", az);
+  row->lat       = get_lat_str(sat_lat);
+  row->lon       = get_lon_str(sat_lon);
+  row->range.sprintf("%.0f", range);
+  row->orbit.sprintf("%ld", orbit);
+  row->highlight = !use_thresholds && sat_max_ele > high_elev;
 
   daynum = dn;
 }
@@ -1373,19 +1415,46 @@ void TSat::Calc(void)
 //---------------------------------------------------------------------------
 double TSat::FindLOS(void)
 {
- lostime = 0.0;
+ /* This function finds and returns the time of LOS of the pass
+    in range at daynum, or of the pass that has just set. */
+ double t0 = 0, t1, e0 = 0, e1;
+ int    iter;
 
-  if(CanCalc(obs_geodetic.lat, daynum)) {
-     Calc();
+  lostime = 0.0;
 
-     do {
-     	daynum += sat_ele*sqrt(sat_alt)/502500.0;
-     	Calc();
+  if(!CanCalc(obs_geodetic.lat, daynum))
+     return 0.0;
 
-     	if(fabs(sat_ele) < 0.03)
-     	   lostime = daynum;
+  t1 = daynum;
+  e1 = CalcElevation(t1);
 
-     } while(lostime==0.0);
+  if(e1 < 0.0) {
+     // step back into the pass
+     while(e1 < 0.0 && daynum - t1 < PS_BACK_LIMIT) {
+        t0 = t1;
+        e0 = e1;
+        t1 -= PassStep();
+        e1 = CalcElevation(t1);
+     }
+
+     if(e1 >= 0.0)
+        lostime = SolveElevation(t1, e1, t0, e0, 0.0);
+  }
+  else {
+     for(iter=0; e1 >= 0.0 && iter<PS_MAX_STEPS; iter++) {
+        t0 = t1;
+        e0 = e1;
+        t1 += PassStep();
+        e1 = CalcElevation(t1);
+     }
+
+     if(e1 < 0.0)
+        lostime = SolveElevation(t0, e0, t1, e1, 0.0);
+  }
+
+  if(lostime > 0.0) {
+     daynum = lostime;
+     Calc();
   }
 
  return lostime;
@@ -1394,50 +1463,37 @@ double TSat::FindLOS(void)
 //---------------------------------------------------------------------------
 double TSat::FindLOS2(void)
 {
- /* This function steps through the pass to find LOS.
-    FindLOS() is called to "fine tune" and return the result. */
+ /* FindLOS() steps through the pass to bracket LOS
+    and refines it. */
 
   if(Flags&(DECAYED_FLAG | GEOSTAT_FLAG | NORISE_FLAG))
      return 0;
 
-  do {
-     daynum += cos((sat_ele-1.0)*deg2rad)*sqrt(sat_alt)/25000.0;
-     Calc();
-
-  } while(sat_ele >= 0.0);
-
  return FindLOS();
 }
 
 //---------------------------------------------------------------------------
 double TSat::FindLOSElevation(double elevation)
 {
- double step = 1.0/86400.0; // increment 1 sec
- double elev, _elevation;
- int    iter = 0;
+ double t;
 
-  if(elevation == 0.0)
+  if(elevation <= 0.0)
      return lostime;
 
-  daynum = lostime;
-  Calc();
-
-  _elevation = elevation-0.03;
+  if(tcatime <= aostime || tcatime >= lostime)
+     FindMaxElevation(aostime);
 
-  while(iter < 1800) { // iterate max 30 min
-     if(sat_ele >= _elevation)
-        return daynum;
+  if(sat_max_ele < elevation)
+     return 0;
 
-     daynum -= step;
-     iter++;
-     elev = sat_ele;
-     Calc();
+  t = SolveElevation(tcatime, sat_max_ele, lostime, CalcElevation(lostime), elevation);
+  if(t <= 0.0)
+     return 0;
 
-     if(sat_ele < elev)
-        break;
-  }
+  daynum = t;
+  Calc();
 
- return 0;
+ return daynum;
 }
 
 //---------------------------------------------------------------------------
@@ -1457,42 +1513,67 @@ double TSat::NextAOS(void)
 //---------------------------------------------------------------------------
 double TSat::FindAOS(void)
 {
- /* This function finds and returns the time of AOS (aostime). */
- int iter = 0;
- aostime = 0.0;
+ /* This function finds and returns the time of AOS (aostime).
+    The elevation is sampled until it crosses the horizon or until
+    a maximum between the samples peaks above it, the crossing is
+    then refined. */
+ double t0, t1, tp, e0, e1, ep, tm, em;
+ int    iter;
 
-  if(CanCalc(obs_geodetic.lat, daynum, 1)) {
-     Calc();
+  aostime = 0.0;
+
+  if(!CanCalc(obs_geodetic.lat, daynum, 1))
+     return 0.0;
+
+  t0 = t1 = daynum;
+  e0 = e1 = CalcElevation(t0);
+
+  if(e0 >= 0.0) {
+     // in range, step back to the rise of this pass
+     for(iter=0; e0 >= 0.0 && iter<PS_MAX_STEPS; iter++) {
+        t1 = t0;
+        e1 = e0;
+        t0 -= PassStep();
+        e0 = CalcElevation(t0);
+     }
 
-     /* Get the satellite in range */
-     while(sat_ele < -1.0 && iter++ < 10000) {
-        daynum -= 0.00035*(sat_ele*(((sat_alt/8400.0)+0.46))-2.0);
+     if(e0 < 0.0)
+        aostime = SolveElevation(t0, e0, t1, e1, 0.0);
+  }
+  else {
+     tp = t0;
+     ep = e0;
 
-	/* Technically, this should be:
+     for(iter=0; iter<PS_MAX_STEPS; iter++) {
+        t1 = t0 + CoarseStep(e0);
+        e1 = CalcElevation(t1);
+
+        if(e1 >= 0.0) {
+           aostime = SolveElevation(t0, e0, t1, e1, 0.0);
+           break;
+        }
 
-	   daynum-=0.0007*(sat_ele*(((sat_alt/8400.0)+0.46))-2.0);
+        // a grazing pass may peak above the horizon between the samples
+        if(e1 < e0 && e0 > ep && e0 > -PS_GRAZE) {
+           tm = SolveMaxElevation(tp, t1);
+           em = CalcElevation(tm);
 
-	   but it sometimes skipped passes for
-	   satellites in highly elliptical orbits. */
+           if(em >= 0.0) {
+              aostime = SolveElevation(tp, ep, tm, em, 0.0);
+              break;
+           }
+        }
 
-	Calc();
+        tp = t0;
+        ep = e0;
+        t0 = t1;
+        e0 = e1;
      }
+  }
 
-     if(sat_ele < -1.0)
-        return 0.0;
-     /* Find AOS */
-
-     /** Users using Keplerian data to track the Sun MAY find
-         this section goes into an infinite loop when tracking
-         the Sun if their QTH is below 30 deg N! **/
-
-     iter = 0;
-     while(aostime == 0.0 && iter++ < 10000)
-     	if(fabs(sat_ele) < 0.03)
-     	   aostime = daynum;
-     	else {
-     	   daynum -= sat_ele*sqrt(sat_alt)/530000.0;
-     	   Calc(); }
+  if(aostime > 0.0) {
+     daynum = aostime;
+     Calc();
   }
 
  return aostime;
@@ -1502,37 +1583,35 @@ double TSat::FindAOS(void)
 // returns the aostime when this elevation happens
 double TSat::FindAOSElevation(double elevation)
 {
- double step = 1.0/86400.0; // increment 1 sec
- double elev, _elevation;
- int    iter = 0;
+ double t;
 
   daynum = aostime;
   Calc();
 
-  if(elevation == 0.0)
+  if(elevation <= 0.0)
       return aostime;
 
-  _elevation = elevation-0.03;
-  while(iter < 1800) { // iterate max 30 min
-     if(sat_ele >= _elevation)
-        return daynum;
+  if(tcatime <= aostime || tcatime >= lostime)
+     FindMaxElevation(aostime);
 
-     daynum += step;
-     iter++;
-     elev = sat_ele;
-     Calc();
-     if(sat_ele < elev) // receding
-        break;
-  }
+  if(sat_max_ele < elevation)
+     return 0;
+
+  t = SolveElevation(aostime, CalcElevation(aostime), tcatime, sat_max_ele, elevation);
+  if(t <= 0.0)
+     return 0;
+
+  daynum = t;
+  Calc();
 
- return 0;
+ return daynum;
 }
 
 //---------------------------------------------------------------------------
 double TSat::FindMaxElevation(double aosdaynum)
 {
- double step = 1.0/86400.0; // increment 1 sec
- int    iter = 0;
+ double t0, t1, t2, e1, e2;
+ int    iter;
 
   daynum = aosdaynum;
   Calc();
@@ -1542,22 +1621,205 @@ double TSat::FindMaxElevation(double aosdaynum)
   if(Flags&(DECAYED_FLAG | GEOSTAT_FLAG | NORISE_FLAG))
      return sat_max_ele;
 
-  while(iter < 1800) {
-     daynum += step;
-     iter++;
-     Calc();
+  // step until the elevation decreases, the maximum is then within t0...t2
+  ps_alt = sat_alt;
+  t0 = t1 = t2 = aosdaynum;
+  e1 = sat_ele;
 
-     if(sat_ele > sat_max_ele)
-        sat_max_ele = sat_ele;
-     else
+  for(iter=0; iter<PS_MAX_STEPS; iter++) {
+     t2 = t1 + PassStep();
+     e2 = CalcElevation(t2);
+
+     if(e2 < e1)
         break;
+
+     t0 = t1;
+     t1 = t2;
+     e1 = e2;
   }
 
-  tcatime = daynum;
+  tcatime = SolveMaxElevation(t0, t2);
+
+  daynum = tcatime;
+  Calc();
+  sat_max_ele = sat_ele;
 
  return sat_max_ele > 0.0 ? sat_max_ele:0;
 }
 
+//---------------------------------------------------------------------------
+//
+//      Pass event solver
+//
+//      Horizon and threshold crossings are bracketed by coarse sampling and
+//      refined with Brent's method, maxima with a golden-section search.
+//      Only the position and look angles are propagated.
+//
+//---------------------------------------------------------------------------
+double TSat::CalcElevation(double dn)
+{
+ vector_t zero_vector = {0,0,0,0};
+ vector_t pos = zero_vector, vel = zero_vector, obs_set;
+ double   jul, t;
+
+  if(!isFlagSet(INITIALIZED_FLAG))
+     PreCalc();
+
+  jul = dn+2444238.5;
+  t   = (jul-Julian_Date_of_Epoch(tle.epoch))*xmnpda;
+
+  if(isFlagSet(DEEP_SPACE_EPHEM_FLAG))
+     SDP4(t, &tle, &pos, &vel);
+  else
+     SGP4(t, &tle, &pos, &vel);
+
+  Convert_Sat_State(&pos, &vel);
+  Calculate_Obs(jul, &pos, &vel, &obs_geodetic, &obs_set);
+
+  Magnitude(&pos);
+  ps_alt = pos.w-xkmper;
+
+ return Degrees(obs_set.y);
+}
+
+//---------------------------------------------------------------------------
+// sample step below the horizon, the further below the longer step
+double TSat::CoarseStep(double ele)
+{
+ double step = 0.00035*(-ele*((ps_alt/8400.0)+0.46)+2.0);
+
+  if(step < PS_MIN_STEP)
+     return PS_MIN_STEP;
+  if(step > PS_MAX_STEP)
+     return PS_MAX_STEP;
+
+ return step;
+}
+
+//---------------------------------------------------------------------------
+// sample step within a pass, about 100 seconds for a LEO satellite
+double TSat::PassStep(void)
+{
+ double step = sqrt(ps_alt > 0 ? ps_alt:0)/25000.0;
+
+ return step < PS_MIN_STEP ? PS_MIN_STEP:step;
+}
+
+//---------------------------------------------------------------------------
+// Brent's method, e0 and e1 must bracket elevation, returns 0 if they don't
+double TSat::SolveElevation(double t0, double e0, double t1, double e1, double elevation)
+{
+ double a = t0, b = t1, c, d, e, fa, fb, fc, p, q, r, s, tol, xm, min1, min2;
+ int    iter;
+
+  fa = e0 - elevation;
+  fb = e1 - elevation;
+
+  if((fa > 0.0 && fb > 0.0) || (fa < 0.0 && fb < 0.0))
+     return 0;
+
+  c  = b;
+  fc = fb;
+  d  = e = b - a;
+  tol = 0.5*PS_TOLERANCE;
+
+  for(iter=0; iter<PS_MAX_ITER; iter++) {
+     if((fb > 0.0 && fc > 0.0) || (fb < 0.0 && fc < 0.0)) {
+        c  = a;
+        fc = fa;
+        d  = e = b - a;
+     }
+
+     if(fabs(fc) < fabs(fb)) {
+        a = b;  b = c;  c = a;
+        fa = fb; fb = fc; fc = fa;
+     }
+
+     xm = 0.5*(c - b);
+     if(fabs(xm) <= tol || fb == 0.0)
+        break;
+
+     if(fabs(e) >= tol && fabs(fa) > fabs(fb)) {
+        // inverse quadratic interpolation
+        s = fb/fa;
+        if(a == c) {
+           p = 2.0*xm*s;
+           q = 1.0 - s;
+        }
+        else {
+           q = fa/fc;
+           r = fb/fc;
+           p = s*(2.0*xm*q*(q - r) - (b - a)*(r - 1.0));
+           q = (q - 1.0)*(r - 1.0)*(s - 1.0);
+        }
+
+        if(p > 0.0)
+           q = -q;
+        p = fabs(p);
+
+        min1 = 3.0*xm*q - fabs(tol*q);
+        min2 = fabs(e*q);
+
+        if(2.0*p < (min1 < min2 ? min1:min2)) {
+           e = d;
+           d = p/q;
+        }
+        else {
+           d = xm; // bisection
+           e = d;
+        }
+     }
+     else {
+        d = xm;
+        e = d;
+     }
+
+     a  = b;
+     fa = fb;
+
+     if(fabs(d) > tol)
+        b += d;
+     else
+        b += xm > 0.0 ? tol:-tol;
+
+     fb = CalcElevation(b) - elevation;
+  }
+
+ return b;
+}
+
+//---------------------------------------------------------------------------
+// golden-section search for the maximum elevation within t0...t1
+double TSat::SolveMaxElevation(double t0, double t1)
+{
+ const double g = 0.381966011250105; // 2 - golden ratio
+ double a = t0, b = t1, x1, x2, f1, f2;
+
+  x1 = a + g*(b - a);
+  x2 = b - g*(b - a);
+  f1 = CalcElevation(x1);
+  f2 = CalcElevation(x2);
+
+  while(b - a > PS_TOLERANCE) {
+     if(f1 > f2) {
+        b  = x2;
+        x2 = x1;
+        f2 = f1;
+        x1 = a + g*(b - a);
+        f1 = CalcElevation(x1);
+     }
+     else {
+        a  = x1;
+        x1 = x2;
+        f1 = f2;
+        x2 = b - g*(b - a);
+        f2 = CalcElevation(x2);
+     }
+  }
+
+ return 0.5*(a + b);
+}
+
 //---------------------------------------------------------------------------
 double TSat::CalcPathLoss(TRig *rig)
 {
@@ -3093,7 +3355,7 @@ double TSat::CurrentDaynum(double offset) // offset in hours
     of days since 31Dec79 00:00:00 UTC (daynum 0) */
    offset = offset;
 
- return GetStartTime(QDateTime::currentDateTime().toUTC());
+ return TSimClock::daynum();
 }
 
 //---------------------------------------------------------------------------
@@ -100,6 +100,15 @@ typedef struct
 #define SAT_DELETE         4
 #define SAT_IN_SUNLIGHT    8
 
+// pass event solver
+#define PS_TOLERANCE       (0.001/86400.0) // 1 ms
+#define PS_MIN_STEP        (20.0/86400.0)
+#define PS_MAX_STEP        0.02            // about 30 minutes
+#define PS_MAX_STEPS       20000           // coarse samples per search
+#define PS_MAX_ITER        100             // Brent iterations
+#define PS_BACK_LIMIT      0.014           // about 20 minutes
+#define PS_GRAZE           30.0            // maxima below this elevation are not refined
+
 //---------------------------------------------------------------------------
 class QString;
 class QDateTime;
@@ -107,10 +116,16 @@ class QTableWidget;
 class TSettings;
 class TStation;
 class TRig;
+class TPassRow;
+class PList;
+class TPassEphem;
+struct TTLERecord;
 
 //---------------------------------------------------------------------------
 class TSat
 {
+   friend class TSGP4Batch;
+
  public:
 
    TSat(void);
@@ -121,6 +136,10 @@ class TSat
 
    void Zero(void);
 
+   // bumped when a named satellite gets another name or catalog number,
+   // TSatCatalog rebuilds on a miss after it changed
+   static unsigned int renamed;
+
    bool isActive(void)     { return sat_scripts->active(); }
    void setActive(bool on) { sat_scripts->active(on); }
 
@@ -129,6 +148,7 @@ class TSat
 
 
    bool TLEKepCheck(char *_name, char *_line1, char *_line2);
+   void SetElements(const TTLERecord *rec);
    void Data2TLE(FILE *fp, char *_name, char *_line1, char *_line2, int mode=0);
    void Data2Grid(QTableWidget *g);
    bool alloc_tmp_tle_str(void);
@@ -138,6 +158,7 @@ class TSat
    void Calc(void);
    bool CalcAll(double dn, int mode=0);
    bool CheckThresholds(TRig *rig);
+   void SetPass(double aos, double tca, double los, double max_ele, bool northbound);
    bool CheckIsInSunLight(TSettings *setting);
    bool DoesRise(double lat);
    bool IsGeostationary(void);
@@ -184,12 +205,14 @@ class TSat
    bool   SavePassinfo(void);
    bool   ReadPassinfo(QString hrptfile);
 
-   void   SatellitePasses(TRig *rig, QTableWidget *grid, QDateTime utc, int mode=0);
+   int    SatellitePasses(TRig *rig, PList *rows, QDateTime utc);
 
    void    Track(void);
+   bool    CachePass(void);
    QString GetTrackStr(TRig *rig, int mode=0);
    double  getDownlinkFreq(TRig *rig);
    QString getDownlinkFreqStr(TRig *rig);
+   double  getDoppler(double freq);
 
    QString get_lon_str(double _lon);
    QString get_lat_str(double _lat);
@@ -227,6 +250,7 @@ class TSat
 
    TSatScript *sat_scripts;
    TSatProp *sat_props;
+   TPassEphem *pass_ephem;
 
    char *_str, *_line1, *_line2;
 
@@ -280,7 +304,8 @@ class TSat
 
    double tsince, jul_epoch, jul_utc, eclipse_depth,
 	  sat_vel, fk, age,
-	  ax, ay, az, rx, ry, rz;
+	  ax, ay, az, rx, ry, rz,
+	  ps_alt;
 
    int	  ma256, Flags;
    long	  rv;
@@ -314,9 +339,8 @@ class TSat
    void   ClearFlag(int flag);
 
 
-   void   FillPassGrid(TRig *rig, QTableWidget *g, QString datestr,
-                       double az, double lat, double lon, double range,
-                       long orbit);
+   void   GetPassRow(TRig *rig, TPassRow *row, QString datestr,
+                     double az, double range, long orbit);
 
 
    void   PreCalc(void);
@@ -329,6 +353,12 @@ class TSat
    double FindLOS2(void);
    double NextAOS(void);
 
+   double CalcElevation(double dn);
+   double CoarseStep(double ele);
+   double PassStep(void);
+   double SolveElevation(double t0, double e0, double t1, double e1, double elevation);
+   double SolveMaxElevation(double t0, double t1);
+
    void   SDP4(double tsince, tle_t *tle, vector_t *pos, vector_t *vel);
    void   SGP4(double tsince, tle_t *tle, vector_t *pos, vector_t *vel);
    double FixAngle(double x);
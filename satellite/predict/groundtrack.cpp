@@ -0,0 +1,450 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <QtGlobal>
+
+#include "groundtrack.h"
+#include "sgp4batch.h"
+#include "tleparser.h"
+#include "satcalc.h"
+#include "plist.h"
+
+//---------------------------------------------------------------------------
+static inline double fmod2p(double x)
+{
+    return x - twopi*floor(x/twopi);
+}
+
+//---------------------------------------------------------------------------
+// same as TSat::ThetaG_JD
+static inline double thetag_jd(double jd)
+{
+ double ut, tu, gmst;
+
+    ut   = jd + 0.5 - floor(jd + 0.5);
+    jd   = jd - ut;
+    tu   = (jd - 2451545.0)/36525;
+    gmst = 24110.54841 + tu*(8640184.812866 + tu*(0.093104 - tu*6.2E-6));
+    gmst = gmst + secday*omega_E*ut;
+    gmst = gmst - secday*floor(gmst/secday);
+
+ return twopi*gmst/secday;
+}
+
+//---------------------------------------------------------------------------
+// longitude difference in degrees, 0...180
+static inline double londiff(double a, double b)
+{
+ double d = fmod(fabs(a - b), 360.0);
+
+    return d > 180.0 ? 360.0 - d : d;
+}
+
+//---------------------------------------------------------------------------
+TGroundTrack::TGroundTrack(void)
+{
+    tracks     = NULL;
+    num_tracks = 0;
+}
+
+//---------------------------------------------------------------------------
+TGroundTrack::~TGroundTrack(void)
+{
+    clear();
+}
+
+//---------------------------------------------------------------------------
+void TGroundTrack::freeTrack(TTrackSet *t)
+{
+    if(t->lat)
+        free(t->lat);
+    if(t->lon)
+        free(t->lon);
+    if(t->alt)
+        free(t->alt);
+
+    t->lat = NULL;
+    t->lon = NULL;
+    t->alt = NULL;
+}
+
+//---------------------------------------------------------------------------
+void TGroundTrack::clear(void)
+{
+ int i;
+
+    for(i=0; i<num_tracks; i++)
+        freeTrack(&tracks[i]);
+
+    if(tracks)
+        free(tracks);
+
+    tracks     = NULL;
+    num_tracks = 0;
+}
+
+//---------------------------------------------------------------------------
+int TGroundTrack::find(const char *name)
+{
+ int i;
+
+    for(i=0; i<num_tracks; i++)
+        if(!strcmp(tracks[i].name, name))
+            return i;
+
+    return -1;
+}
+
+//---------------------------------------------------------------------------
+int TGroundTrack::compute(PList *sats, double from, double to, double step)
+{
+ TTrackSet  *newtracks, *t;
+ TSGP4Batch *batch;
+ TGroundTrackWorker **workers;
+ TSat   *sat;
+ double epoch;
+ int    i, k, n, samples, todo, num_threads;
+
+    if(sats == NULL || sats->Count == 0 || step <= 0 || to < from) {
+        clear();
+        return 0;
+    }
+
+    samples = (int) ((to - from)/step) + 1;
+    if(samples > GT_MAX_SAMPLES) {
+        qDebug("Ground track limited to %d samples [%s:%d]", GT_MAX_SAMPLES, __FILE__, __LINE__);
+        samples = GT_MAX_SAMPLES;
+    }
+
+    newtracks = (TTrackSet *) malloc(sats->Count * sizeof(TTrackSet));
+    if(newtracks == NULL) {
+        qDebug("Out of memory [%s:%d]", __FILE__, __LINE__);
+        return num_tracks;
+    }
+
+    batch = new TSGP4Batch;
+
+    for(i=0, n=0, todo=0; i<sats->Count; i++) {
+        sat   = (TSat *) sats->ItemAt(i);
+        epoch = TTLEParser::epoch(sat->year, sat->refepoch);
+        t     = &newtracks[n];
+
+        // the list order seldom changes
+        k = i < num_tracks && !strcmp(tracks[i].name, sat->name) ? i : find(sat->name);
+
+        if(k >= 0 && tracks[k].lat && tracks[k].epoch == epoch &&
+           tracks[k].from == from && tracks[k].step == step && tracks[k].samples == samples)
+        {
+            *t = tracks[k];
+            t->set = -1;
+
+            tracks[k].lat = NULL;
+            tracks[k].lon = NULL;
+            tracks[k].alt = NULL;
+
+            n++;
+            continue;
+        }
+
+        memset(t, 0, sizeof(TTrackSet));
+        memcpy(t->name, sat->name, TLE_NAMELEN+1);
+        t->epoch   = epoch;
+        t->from    = from;
+        t->step    = step;
+        t->samples = samples;
+
+        if((t->set = batch->add(sat)) < 0)
+            continue;
+
+        t->lat = (float *) malloc(samples * sizeof(float));
+        t->lon = (float *) malloc(samples * sizeof(float));
+        t->alt = (float *) malloc(samples * sizeof(float));
+
+        if(t->lat == NULL || t->lon == NULL || t->alt == NULL) {
+            qDebug("Out of memory [%s:%d]", __FILE__, __LINE__);
+            freeTrack(t);
+            continue;
+        }
+
+        todo++;
+        n++;
+    }
+
+    clear();
+
+    tracks     = newtracks;
+    num_tracks = n;
+
+    num_threads = qMin(QThread::idealThreadCount(), (int) ((qint64) todo * samples / GT_THREAD_SAMPLES));
+    num_threads = qMin(num_threads, todo);
+
+    if(num_threads > 1) {
+        workers = (TGroundTrackWorker **) malloc(num_threads * sizeof(TGroundTrackWorker *));
+        for(i=0; i<num_threads; i++) {
+            workers[i] = new TGroundTrackWorker(batch, tracks, num_tracks, i, num_threads);
+            workers[i]->start();
+        }
+
+        for(i=0; i<num_threads; i++) {
+            workers[i]->wait();
+            delete workers[i];
+        }
+
+        free(workers);
+    }
+    else if(todo > 0) {
+        TGroundTrackWorker worker(batch, tracks, num_tracks, 0, 1);
+        worker.run();
+    }
+
+    delete batch;
+
+    return num_tracks;
+}
+
+//---------------------------------------------------------------------------
+double TGroundTrack::footprintRadius(double alt, double min_elev)
+{
+ double e = min_elev*deg2rad, c;
+
+    c = xkmper*cos(e)/(xkmper + alt);
+    if(c >= 1.0)
+        return 0;
+
+    c = acos(c) - e;
+
+    return c > 0 ? c : 0;
+}
+
+//---------------------------------------------------------------------------
+int TGroundTrack::footprint(int index, int sample, double min_elev, int points, float *lat, float *lon)
+{
+ TTrackSet *t;
+ double lam, lat0, lon0, az, sin_lat, la, lo;
+ int    i;
+
+    if(index < 0 || index >= num_tracks || points <= 0)
+        return 0;
+
+    t = &tracks[index];
+    if(sample < 0 || sample >= t->samples)
+        return 0;
+
+    lam  = footprintRadius(t->alt[sample], min_elev);
+    lat0 = t->lat[sample]*deg2rad;
+    lon0 = t->lon[sample]*deg2rad;
+
+    for(i=0; i<points; i++) {
+        az = twopi*i/points;
+
+        sin_lat = sin(lat0)*cos(lam) + cos(lat0)*sin(lam)*cos(az);
+        la = asin(sin_lat);
+        lo = lon0 + atan2(sin(az)*sin(lam)*cos(lat0), cos(lam) - sin(lat0)*sin_lat);
+
+        lo = fmod2p(lo + pi) - pi;
+
+        lat[i] = la/deg2rad;
+        lon[i] = lo/deg2rad;
+    }
+
+    return points;
+}
+
+//---------------------------------------------------------------------------
+// great circle distance in radians, degrees in
+static inline double gcdist(double lat1, double lon1, double lat2, double lon2)
+{
+ double dlat, dlon, a;
+
+    dlat = (lat2 - lat1)*deg2rad;
+    dlon = londiff(lon1, lon2)*deg2rad;
+
+    // haversine
+    a = sin(dlat/2)*sin(dlat/2) + cos(lat1*deg2rad)*cos(lat2*deg2rad)*sin(dlon/2)*sin(dlon/2);
+
+    return 2.0*asin(sqrt(qMin(1.0, a)));
+}
+
+//---------------------------------------------------------------------------
+// distance in radians from lat, lon to the meridian lon_edge
+// between lat_min and lat_max
+static double meridianDistance(const TRegion *region, double lat, double lon, double lon_edge)
+{
+ double dlon, foot;
+
+    // nearest point on the meridian great circle, on the edge the
+    // nearest point is there or at either end
+    dlon = londiff(lon, lon_edge)*deg2rad;
+    foot = atan2(sin(lat*deg2rad), cos(lat*deg2rad)*cos(dlon))/deg2rad;
+
+    if(foot > region->lat_min && foot < region->lat_max)
+        return gcdist(lat, lon, foot, lon_edge);
+
+    return qMin(gcdist(lat, lon, region->lat_min, lon_edge),
+                gcdist(lat, lon, region->lat_max, lon_edge));
+}
+
+//---------------------------------------------------------------------------
+// great circle distance in radians from lat, lon to the nearest point of region
+double TGroundTrack::regionDistance(const TRegion *region, double lat, double lon)
+{
+ bool inside;
+
+    if(region->lon_min <= region->lon_max)
+        inside = lon >= region->lon_min && lon <= region->lon_max;
+    else
+        inside = lon >= region->lon_min || lon <= region->lon_max;
+
+    // straight north or south
+    if(inside) {
+        if(lat < region->lat_min)
+            return (region->lat_min - lat)*deg2rad;
+        if(lat > region->lat_max)
+            return (lat - region->lat_max)*deg2rad;
+
+        return 0;
+    }
+
+    return qMin(meridianDistance(region, lat, lon, region->lon_min),
+                meridianDistance(region, lat, lon, region->lon_max));
+}
+
+//---------------------------------------------------------------------------
+int TGroundTrack::coverage(const TRegion *region, double min_elev, PList *list)
+{
+ TTrackSet *t;
+ TCoverage *c;
+ double lam, gap;
+ int i, k, start, count = 0;
+ bool seen;
+
+    if(region == NULL || list == NULL)
+        return 0;
+
+    for(k=0; k<num_tracks; k++) {
+        t = &tracks[k];
+        start = -1;
+
+        for(i=0; i<=t->samples; i++) {
+            seen = false;
+
+            if(i < t->samples) {
+                lam = footprintRadius(t->alt[i], min_elev);
+
+                // the latitude gap is a lower bound of the distance
+                if(t->lat[i] < region->lat_min)
+                    gap = region->lat_min - t->lat[i];
+                else if(t->lat[i] > region->lat_max)
+                    gap = t->lat[i] - region->lat_max;
+                else
+                    gap = 0;
+
+                seen = gap*deg2rad <= lam && regionDistance(region, t->lat[i], t->lon[i]) <= lam;
+            }
+
+            if(seen && start < 0)
+                start = i;
+            else if(!seen && start >= 0) {
+                c = new TCoverage;
+                c->track = k;
+                c->aos   = t->from + start*t->step;
+                c->los   = t->from + (i - 1)*t->step;
+                list->Add(c);
+
+                start = -1;
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+//---------------------------------------------------------------------------
+TGroundTrackWorker::TGroundTrackWorker(TSGP4Batch *batch_, TTrackSet *tracks_, int count_, int first_, int stride_)
+{
+    batch  = batch_;
+    tracks = tracks_;
+    count  = count_;
+    first  = first_;
+    stride = stride_;
+}
+
+//---------------------------------------------------------------------------
+void TGroundTrackWorker::run()
+{
+ int    sets[SB_CHUNK];
+ double times[SB_CHUNK], x[SB_CHUNK], y[SB_CHUNK], z[SB_CHUNK];
+ double r, e2, ep2, b, h, c, lat, lon, sin_u, cos_u, sin_lat, cos_lat;
+ TTrackSet *t;
+ int    i, j, k, m;
+
+    e2  = flat*(2.0 - flat);
+    b   = xkmper*(1.0 - flat);
+    ep2 = e2/((1.0 - flat)*(1.0 - flat));
+
+    for(j=first; j<count; j+=stride) {
+        t = &tracks[j];
+        if(t->set < 0)
+            continue;
+
+        for(k=0; k<t->samples; k+=SB_CHUNK) {
+            m = t->samples - k < SB_CHUNK ? t->samples - k:SB_CHUNK;
+
+            for(i=0; i<m; i++) {
+                sets[i]  = t->set;
+                times[i] = t->from + (k + i)*t->step;
+            }
+
+            batch->propagate(sets, times, m, x, y, z);
+
+            // Bowring's closed form of TSat::Calculate_LatLonAlt,
+            // the difference is below 1E-6 degrees up to GEO altitudes
+            for(i=0; i<m; i++) {
+                lon = fmod2p(atan2(y[i], x[i]) - thetag_jd(times[i] + 2444238.5));
+                r   = sqrt(x[i]*x[i] + y[i]*y[i]);
+
+                // parametric latitude u
+                h     = sqrt(z[i]*xkmper*z[i]*xkmper + r*b*r*b);
+                sin_u = z[i]*xkmper/h;
+                cos_u = r*b/h;
+
+                sin_lat = z[i] + ep2*b*sin_u*sin_u*sin_u;
+                cos_lat = r - e2*xkmper*cos_u*cos_u*cos_u;
+                lat     = atan2(sin_lat, cos_lat);
+
+                h       = sqrt(sin_lat*sin_lat + cos_lat*cos_lat);
+                sin_lat = sin_lat/h;
+                cos_lat = cos_lat/h;
+                c       = 1.0/sqrt(1.0 - e2*sin_lat*sin_lat);
+
+                t->lat[k + i] = lat/deg2rad;
+                t->lon[k + i] = (lon > pi ? lon - twopi : lon)/deg2rad;
+                t->alt[k + i] = r/cos_lat - xkmper*c;
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
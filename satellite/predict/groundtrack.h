@@ -0,0 +1,122 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef GROUNDTRACK_H
+#define GROUNDTRACK_H
+
+#include <QtGlobal>
+#include <QThread>
+
+#include "Satellite.h"
+
+//---------------------------------------------------------------------------
+#define GT_FOOTPRINT_POINTS 72    // default footprint polygon vertices
+#define GT_THREAD_SAMPLES   8192  // min samples per worker thread
+#define GT_MAX_SAMPLES      100000
+
+class PList;
+class TSGP4Batch;
+
+//---------------------------------------------------------------------------
+// ground track of one satellite, sample i is at from + i*step
+struct TTrackSet
+{
+    char   name[TLE_NAMELEN+1];
+    double epoch;           // element set epoch, the cache key
+    double from, step;      // PREDICT day numbers
+    int    samples;
+    int    set;             // element set in the batch, -1 = cached
+
+    // sub-satellite points, degrees north, degrees east -180...180, km
+    float  *lat, *lon, *alt;
+};
+
+//---------------------------------------------------------------------------
+// lat/lon box in degrees, lon_min > lon_max crosses 180
+struct TRegion
+{
+    double lat_min, lat_max, lon_min, lon_max;
+};
+
+//---------------------------------------------------------------------------
+// a satellite footprint over a region from aos to los
+struct TCoverage
+{
+    int    track;
+    double aos, los;
+};
+
+//---------------------------------------------------------------------------
+// Ground tracks and footprints of many satellites over a time window.
+// The tracks are propagated by TSGP4Batch in worker threads and kept
+// per element set epoch, so a new window or new elements only recompute
+// the satellites that changed.
+class TGroundTrack
+{
+public:
+    TGroundTrack(void);
+    ~TGroundTrack(void);
+
+    void clear(void);
+
+    // returns number of tracks, step in days
+    int  compute(PList *sats, double from, double to, double step);
+
+    int  count(void) { return num_tracks; }
+    const TTrackSet *track(int index) { return index >= 0 && index < num_tracks ? &tracks[index] : NULL; }
+    int  find(const char *name);
+
+    // visibility circle around the sub-satellite point of sample,
+    // min_elev in degrees, returns number of points
+    int  footprint(int index, int sample, double min_elev, int points, float *lat, float *lon);
+
+    // earth central angle in radians seen above min_elev degrees from alt km
+    static double footprintRadius(double alt, double min_elev);
+
+    // appends a new TCoverage to list for every footprint over region,
+    // returns number of coverages found
+    int  coverage(const TRegion *region, double min_elev, PList *list);
+
+protected:
+    static void freeTrack(TTrackSet *t);
+    static double regionDistance(const TRegion *region, double lat, double lon);
+
+private:
+    TTrackSet *tracks;
+    int       num_tracks;
+};
+
+//---------------------------------------------------------------------------
+// computes the tracks first, first + stride, ... of tracks
+class TGroundTrackWorker : public QThread
+{
+public:
+    TGroundTrackWorker(TSGP4Batch *batch_, TTrackSet *tracks_, int count_, int first_, int stride_);
+
+    void run();
+
+private:
+    TSGP4Batch *batch;
+    TTrackSet  *tracks;
+    int        count, first, stride;
+};
+
+#endif // GROUNDTRACK_H
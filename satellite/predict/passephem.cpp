@@ -0,0 +1,219 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <stdlib.h>
+#include <math.h>
+#include <QtGlobal>
+
+#include "passephem.h"
+#include "Satellite.h"
+
+//---------------------------------------------------------------------------
+TPassEphem::TPassEphem(void)
+{
+    val   = NULL;
+    der   = NULL;
+    size  = 0;
+
+    clear();
+}
+
+//---------------------------------------------------------------------------
+TPassEphem::~TPassEphem(void)
+{
+    if(val)
+        free(val);
+    if(der)
+        free(der);
+}
+
+//---------------------------------------------------------------------------
+void TPassEphem::clear(void)
+{
+    count = 0;
+    t0 = t1 = 0;
+    b0 = b1 = 0;
+}
+
+//---------------------------------------------------------------------------
+bool TPassEphem::alloc(int n)
+{
+    if(n <= size)
+        return true;
+
+    if(val)
+        free(val);
+    if(der)
+        free(der);
+
+    val = (TPassSample *) malloc(n * sizeof(TPassSample));
+    der = (TPassSample *) malloc(n * sizeof(TPassSample));
+
+    if(val == NULL || der == NULL) {
+        qDebug("Error: failed to allocate %d pass samples [%s:%d]", n, __FILE__, __LINE__);
+
+        if(val)
+            free(val);
+        if(der)
+            free(der);
+
+        val  = NULL;
+        der  = NULL;
+        size = 0;
+
+        return false;
+    }
+
+    size = n;
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TPassEphem::build(TSat *sat, double start, double end)
+{
+    TPassSample *s;
+    double      d;
+    int         i, n;
+
+    if(isBuilt(start, end))
+        return true;
+
+    clear();
+
+    if(start <= 0 || end <= start || end - start > PE_MAX_LENGTH)
+        return false;
+
+    n = (int) ceil((end - start + 2 * PE_MARGIN) / PE_STEP) + 1;
+    if(!alloc(n))
+        return false;
+
+    // the tracked satellite keeps its state
+    TSat tmp(sat);
+
+    t0 = start - PE_MARGIN;
+
+    for(i=0; i<n; i++) {
+        tmp.daynum = t0 + i * PE_STEP;
+        tmp.Calc();
+
+        s = &val[i];
+        s->az         = tmp.sat_azi;
+        s->el         = tmp.sat_ele;
+        s->range      = tmp.sat_range;
+        s->range_rate = tmp.sat_range_rate;
+        s->lat        = tmp.sat_lat;
+        s->lon        = tmp.sat_lon;
+        s->alt        = tmp.sat_alt;
+
+        // unwrap so the interpolation never crosses 0/360
+        if(i > 0) {
+            d = s->az - val[i - 1].az;
+            s->az -= 360.0 * floor((d + 180.0) / 360.0);
+
+            d = s->lon - val[i - 1].lon;
+            s->lon -= 360.0 * floor((d + 180.0) / 360.0);
+        }
+    }
+
+    count = n;
+    t1 = t0 + (n - 1) * PE_STEP;
+    b0 = start;
+    b1 = end;
+
+    slopes();
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// central differences, one sided at the ends
+// the range slope is known exactly from the range rate
+void TPassEphem::slopes(void)
+{
+    double *v, *d, *p, *q;
+    int    i, k;
+
+    for(i=0; i<count; i++) {
+        v = (double *) &val[i];
+        d = (double *) &der[i];
+
+        if(i == 0) {
+            p = v;
+            q = (double *) &val[i + 1];
+        }
+        else if(i == count - 1) {
+            p = (double *) &val[i - 1];
+            q = v;
+        }
+        else {
+            p = (double *) &val[i - 1];
+            q = (double *) &val[i + 1];
+        }
+
+        for(k=0; k<PE_VALUES; k++)
+            d[k] = (q[k] - p[k]) / ((i == 0 || i == count - 1) ? 1.0:2.0);
+
+        der[i].range = val[i].range_rate * PE_STEP * 86400.0;
+    }
+}
+
+//---------------------------------------------------------------------------
+bool TPassEphem::interpolate(double daynum, TPassSample *s)
+{
+    double *p0, *p1, *m0, *m1, *o;
+    double u, u2, u3, h00, h10, h01, h11;
+    int    i, k;
+
+    if(!contains(daynum))
+        return false;
+
+    u = (daynum - t0) / PE_STEP;
+    i = (int) u;
+    if(i >= count - 1)
+        i = count - 2;
+    u -= i;
+
+    u2 = u * u;
+    u3 = u2 * u;
+
+    h00 =  2 * u3 - 3 * u2 + 1;
+    h10 =      u3 - 2 * u2 + u;
+    h01 = -2 * u3 + 3 * u2;
+    h11 =      u3 -     u2;
+
+    p0 = (double *) &val[i];
+    p1 = (double *) &val[i + 1];
+    m0 = (double *) &der[i];
+    m1 = (double *) &der[i + 1];
+    o  = (double *) s;
+
+    for(k=0; k<PE_VALUES; k++)
+        o[k] = h00 * p0[k] + h10 * m0[k] + h01 * p1[k] + h11 * m1[k];
+
+    // back to 0...360 as from TSat::Calc
+    s->az  -= 360.0 * floor(s->az / 360.0);
+    s->lon -= 360.0 * floor(s->lon / 360.0);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,74 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef PASSEPHEM_H
+#define PASSEPHEM_H
+
+//---------------------------------------------------------------------------
+#define PE_STEP         (4.0 / 86400.0)   // days between samples
+#define PE_MARGIN       (120.0 / 86400.0) // sampled before AOS and after LOS
+#define PE_MAX_LENGTH   0.5               // days, longest cached span
+
+class TSat;
+
+//---------------------------------------------------------------------------
+typedef struct TPassSample_t {
+    double az, el;          // degrees, az is unwrapped in the table
+    double range;           // km
+    double range_rate;      // km/s
+    double lat, lon;        // degrees, lon is unwrapped in the table
+    double alt;             // km
+} TPassSample;
+
+#define PE_VALUES       7   // doubles in TPassSample
+
+//---------------------------------------------------------------------------
+// sampled topocentric ephemeris of one pass, evaluated with cubic Hermite
+// interpolation so the tracking loop does not have to run SGP4
+class TPassEphem
+{
+public:
+    TPassEphem(void);
+    ~TPassEphem(void);
+
+    void clear(void);
+
+    // samples sat from start to end, the satellite itself is not modified
+    bool build(TSat *sat, double start, double end);
+
+    bool isValid(void) { return count > 1; }
+    bool contains(double daynum) { return count > 1 && daynum >= t0 && daynum <= t1; }
+    bool isBuilt(double start, double end) { return count > 1 && start == b0 && end == b1; }
+
+    // returns false if daynum is outside the sampled span
+    bool interpolate(double daynum, TPassSample *s);
+
+protected:
+    bool alloc(int n);
+    void slopes(void);
+
+private:
+    TPassSample *val, *der; // der is the slope times PE_STEP
+    double t0, t1, b0, b1;
+    int    count, size;
+};
+
+#endif // PASSEPHEM_H
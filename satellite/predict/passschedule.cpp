@@ -0,0 +1,262 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include <QtGlobal>
+
+#include "passschedule.h"
+#include "rotor.h"
+
+//---------------------------------------------------------------------------
+TPassSchedule::TPassSchedule(void)
+{
+    items = NULL;
+    pmax  = NULL;
+    parg  = NULL;
+    chain = NULL;
+    size  = 0;
+    rotor = NULL;
+    max_slew = 0;
+
+    clear();
+}
+
+//---------------------------------------------------------------------------
+TPassSchedule::~TPassSchedule(void)
+{
+    if(items)
+        free(items);
+    if(pmax)
+        free(pmax);
+    if(parg)
+        free(parg);
+    if(chain)
+        free(chain);
+}
+
+//---------------------------------------------------------------------------
+void TPassSchedule::clear(void)
+{
+    count     = 0;
+    num_chain = 0;
+    total     = 0;
+}
+
+//---------------------------------------------------------------------------
+// NULL if the antenna does not move, every pass is then compatible
+// with the one that ended before it
+bool TPassSchedule::setRotor(TRotor *rotor_)
+{
+    double t;
+    bool   changed;
+
+    t = 0;
+    if(rotor_)
+        t = rotor_->getRotationTime(rotor_->az_min, rotor_->el_min,
+                                    rotor_->az_max, rotor_->el_max) / 86400000.0;
+
+    changed = (rotor_ != rotor || t != max_slew) ? true:false;
+    if(changed)
+        clear();
+
+    rotor    = rotor_;
+    max_slew = t;
+
+    return changed;
+}
+
+//---------------------------------------------------------------------------
+bool TPassSchedule::alloc(int n)
+{
+    TSchedItem *ti;
+    double     *td;
+    int        *tp, *tc;
+
+    if(n <= size)
+        return true;
+
+    n += 64;
+
+    ti = (TSchedItem *) realloc(items, n * sizeof(TSchedItem));
+    if(ti)
+        items = ti;
+    td = (double *) realloc(pmax, n * sizeof(double));
+    if(td)
+        pmax = td;
+    tp = (int *) realloc(parg, n * sizeof(int));
+    if(tp)
+        parg = tp;
+    tc = (int *) realloc(chain, n * sizeof(int));
+    if(tc)
+        chain = tc;
+
+    if(ti == NULL || td == NULL || tp == NULL || tc == NULL) {
+        qDebug("Error: failed to allocate %d scheduled passes [%s:%d]", n, __FILE__, __LINE__);
+        return false;
+    }
+
+    size = n;
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool TPassSchedule::same(const TSchedItem *a, const TSchedItem *b)
+{
+    return a->start == b->start && a->end == b->end &&
+           a->start_az == b->start_az && a->start_el == b->start_el &&
+           a->end_az == b->end_az && a->end_el == b->end_el &&
+           a->weight == b->weight && a->aostime == b->aostime &&
+           a->index == b->index && a->generation == b->generation;
+}
+
+//---------------------------------------------------------------------------
+double TPassSchedule::slew(const TSchedItem *a, const TSchedItem *b)
+{
+    if(rotor == NULL)
+        return 0;
+
+    return rotor->getRotationTime(a->end_az, a->end_el, b->start_az, b->start_el) / 86400000.0;
+}
+
+//---------------------------------------------------------------------------
+// last item below index below ending at or before t, -1 if none
+int TPassSchedule::lastEndingBy(double t, int below)
+{
+    int lo = 0, hi = below - 1, mid, r = -1;
+
+    while(lo <= hi) {
+        mid = (lo + hi) / 2;
+
+        if(items[mid].end <= t) {
+            r = mid;
+            lo = mid + 1;
+        }
+        else
+            hi = mid - 1;
+    }
+
+    return r;
+}
+
+//---------------------------------------------------------------------------
+bool TPassSchedule::update(const TSchedItem *src, int n)
+{
+    int i, d;
+
+    if(!alloc(n)) {
+        clear();
+        return false;
+    }
+
+    // items before the first change keep their result
+    for(d=0; d<n && d<count; d++)
+        if(!same(&src[d], &items[d]))
+            break;
+
+    for(i=d; i<n; i++)
+        items[i] = src[i];
+    for(i=0; i<n; i++)
+        items[i].ref = src[i].ref;
+
+    count = n;
+
+    solve(d);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// best(i) = weight(i) + max(0, best(j)) over every j the antenna can leave
+// in time to reach i. Items ending max_slew before i starts are always
+// compatible and taken from the running maximum, only the rest is checked.
+void TPassSchedule::solve(int from)
+{
+    TSchedItem *it;
+    double     v;
+    int        i, j, k;
+
+    for(i=from; i<count; i++) {
+        it = &items[i];
+
+        it->best = it->weight;
+        it->prev = -1;
+
+        k = lastEndingBy(it->start - max_slew, i);
+        if(k >= 0 && pmax[k] > 0) {
+            it->best = it->weight + pmax[k];
+            it->prev = parg[k];
+        }
+
+        for(j=k+1; j<i; j++) {
+            if(items[j].end > it->start || items[j].best <= 0)
+                continue;
+
+            v = it->weight + items[j].best;
+            if(v > it->best && items[j].end + slew(&items[j], it) <= it->start) {
+                it->best = v;
+                it->prev = j;
+            }
+        }
+
+        if(i == 0 || it->best > pmax[i - 1]) {
+            pmax[i] = it->best;
+            parg[i] = i;
+        }
+        else {
+            pmax[i] = pmax[i - 1];
+            parg[i] = parg[i - 1];
+        }
+    }
+
+    num_chain = 0;
+    total     = 0;
+
+    if(count == 0 || pmax[count - 1] <= 0)
+        return;
+
+    total = pmax[count - 1];
+
+    for(i=parg[count - 1]; i>=0; i=items[i].prev)
+        chain[num_chain++] = i;
+
+    // back to time order
+    for(i=0, j=num_chain-1; i<j; i++, j--) {
+        k = chain[i];
+        chain[i] = chain[j];
+        chain[j] = k;
+    }
+}
+
+//---------------------------------------------------------------------------
+int TPassSchedule::first(double daynum)
+{
+    int i;
+
+    for(i=0; i<num_chain; i++)
+        if(items[chain[i]].end > daynum)
+            return chain[i];
+
+    return -1;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,91 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef PASSSCHEDULE_H
+#define PASSSCHEDULE_H
+
+class TRotor;
+
+//---------------------------------------------------------------------------
+typedef struct TSchedItem_t
+{
+    // input, items are sorted by end
+    double start, end;          // recording window, daynum
+    double start_az, start_el;  // antenna position at start
+    double end_az, end_el;      // and at end
+    double weight;
+    double aostime;             // pass identity together with index and generation
+    int    index, generation;
+    int    ref;                 // caller's reference, not compared
+
+    // result
+    double best;                // best total weight of a schedule ending with this item
+    int    prev;                // previous item in that schedule, -1 if none
+} TSchedItem;
+
+//---------------------------------------------------------------------------
+// Weighted interval scheduling of passes on one antenna. An item can follow
+// another if the rotor can slew from the end of one to the start of the
+// other in between. Recomputes only from the first item that changed.
+class TPassSchedule
+{
+public:
+    TPassSchedule(void);
+    ~TPassSchedule(void);
+
+    void   clear(void);
+    // returns true if the rotor changed and the schedule is to be recomputed
+    bool   setRotor(TRotor *rotor_);
+
+    // items must be sorted by end, returns false if out of memory
+    bool   update(const TSchedItem *src, int n);
+
+    // first scheduled item ending after daynum, -1 if none
+    int    first(double daynum);
+
+    int    getCount(void) { return count; }
+    int    getScheduled(void) { return num_chain; }
+    int    scheduledItem(int i) { return chain[i]; }
+    double getWeight(void) { return total; }
+    const  TSchedItem *item(int i) { return &items[i]; }
+
+    // days needed to move the antenna from the end of a to the start of b
+    double slew(const TSchedItem *a, const TSchedItem *b);
+
+protected:
+    bool   alloc(int n);
+    bool   same(const TSchedItem *a, const TSchedItem *b);
+    void   solve(int from);
+    int    lastEndingBy(double t, int below);
+
+private:
+    TSchedItem *items;
+    double     *pmax;   // max best of items 0...i
+    int        *parg;   // and its index
+    int        *chain;  // optimal schedule in time order
+    int        count, size, num_chain;
+    double     total;
+
+    TRotor     *rotor;
+    double     max_slew;
+};
+
+#endif // PASSSCHEDULE_H
@@ -0,0 +1,683 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QDateTime>
+#include <QHash>
+#include <stdlib.h>
+#include <string.h>
+
+#include "passtable.h"
+#include "plist.h"
+#include "utils.h"
+#include "simclock.h"
+#include "rig.h"
+
+//---------------------------------------------------------------------------
+TPassTable::TPassTable(QObject *parent) : QThread(parent)
+{
+    int i;
+
+    passes = NULL;
+    count  = 0;
+    size   = 0;
+
+    recs     = NULL;
+    num_recs = 0;
+
+    memset(&thresholds, 0, sizeof(TPassWindow));
+    memset(claims, 0, sizeof(claims));
+    memset(enabled, 0, sizeof(enabled));
+    memset(cache, 0, sizeof(cache));
+
+    for(i=0; i<PT_MAX_ANTENNAS; i++)
+        cache[i].version = -1;
+
+    num_antennas = 1;
+
+    horizon = PT_HORIZON;
+    serial  = 0;
+    version = 0;
+    flags   = 0;
+}
+
+//---------------------------------------------------------------------------
+TPassTable::~TPassTable(void)
+{
+    int i;
+
+    stop();
+    wait();
+
+    clear();
+
+    for(i=0; i<PT_MAX_ANTENNAS; i++) {
+        if(cache[i].items)
+            free(cache[i].items);
+        if(cache[i].pass)
+            free(cache[i].pass);
+    }
+
+    if(passes)
+        free(passes);
+}
+
+//---------------------------------------------------------------------------
+void TPassTable::stop(void)
+{
+    mutex.lock();
+    if(isRunning())
+        flags |= PT_STOP;
+    wake.wakeAll();
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+void TPassTable::setHorizon(double days)
+{
+    if(days < PT_CHUNK)
+        days = PT_CHUNK;
+    else if(days > PT_MAX_HORIZON)
+        days = PT_MAX_HORIZON;
+
+    mutex.lock();
+    horizon = days;
+    wake.wakeAll();
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+void TPassTable::clear(void)
+{
+    int i;
+
+    mutex.lock();
+
+    for(i=0; i<num_recs; i++) {
+        if(recs[i]->sat)
+            delete recs[i]->sat;
+        free(recs[i]);
+    }
+
+    if(recs)
+        free(recs);
+
+    recs     = NULL;
+    num_recs = 0;
+    count    = 0;
+
+    version++;
+
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+uint TPassTable::satKey(TSat *sat)
+{
+    QString str;
+
+    str.sprintf("%s%s%.6f%.6f%.3f%d%d%d%d%d",
+                sat->line1, sat->line2,
+                sat->obs_geodetic.lat, sat->obs_geodetic.lon, sat->obs_geodetic.alt,
+                thresholds.enable ? 1:0, thresholds.type,
+                thresholds.pass_elev, thresholds.aos_elev, thresholds.los_elev);
+
+    return qHash(str);
+}
+
+//---------------------------------------------------------------------------
+int TPassTable::findRecord(const char *name)
+{
+    int i;
+
+    for(i=0; i<num_recs; i++)
+        if(strcmp(recs[i]->name, name) == 0)
+            return i;
+
+    return -1;
+}
+
+//---------------------------------------------------------------------------
+bool TPassTable::stale(const TPass *p)
+{
+    TPassSat *rec;
+
+    if(p->index < 0 || p->index >= num_recs)
+        return true;
+
+    rec = recs[p->index];
+
+    return (!rec->active || rec->generation != p->generation) ? true:false;
+}
+
+//---------------------------------------------------------------------------
+void TPassTable::update(PList *list, TRig *rig)
+{
+    TPassSat **tmp, *rec;
+    TSat     *sat;
+    TAntenna *a;
+    double   now;
+    uint     key;
+    int      i, r;
+    bool     *seen, changed;
+
+    now = TSimClock::daynum();
+
+    mutex.lock();
+
+    changed = false;
+
+    // mirrors TSat::CheckThresholds, a change invalidates every satellite
+    thresholds.enable    = rig->passthresholds() && rig->pass_elev >= 1;
+    thresholds.type      = rig->threshold;
+    thresholds.pass_elev = rig->pass_elev;
+    thresholds.aos_elev  = rig->aos_elev;
+    thresholds.los_elev  = rig->los_elev;
+
+    r = rig->antennas < PT_MAX_ANTENNAS ? rig->antennas:PT_MAX_ANTENNAS;
+    if(r != num_antennas)
+        changed = true;
+    num_antennas = r;
+
+    for(i=0; i<num_antennas; i++) {
+        a = rig->antenna[i];
+        if(enabled[i] != a->enable())
+            changed = true;
+
+        enabled[i] = a->enable();
+        if(schedule[i].setRotor((a->enable() && a->rotor->enable()) ? a->rotor:NULL))
+            changed = true;
+        shadow[i].setRotor((a->enable() && a->rotor->enable()) ? a->rotor:NULL);
+    }
+
+    seen = (bool *) calloc(num_recs + list->Count + 1, sizeof(bool));
+    if(seen == NULL) {
+        mutex.unlock();
+        return;
+    }
+
+    for(i=0; i<list->Count; i++) {
+        sat = (TSat *) list->ItemAt(i);
+        if(!sat->isActive())
+            continue;
+
+        r = findRecord(sat->name);
+        if(r < 0) {
+            tmp = (TPassSat **) realloc(recs, (num_recs + 1) * sizeof(TPassSat *));
+            if(tmp == NULL)
+                continue;
+            recs = tmp;
+
+            rec = (TPassSat *) calloc(1, sizeof(TPassSat));
+            if(rec == NULL)
+                continue;
+
+            strncpy(rec->name, sat->name, TLE_NAMELEN);
+            changed = true;
+
+            r = num_recs;
+            recs[num_recs++] = rec;
+        }
+
+        rec = recs[r];
+        seen[r] = true;
+        key = satKey(sat);
+
+        // only the schedule depends on it
+        if(rec->priority != sat->sat_props->priority())
+            changed = true;
+        rec->priority = sat->sat_props->priority();
+
+        // new, reactivated or changed TLE/station, passes already in the table go stale
+        if(rec->sat == NULL || !rec->active || rec->key != key) {
+            if(rec->sat)
+                delete rec->sat;
+
+            rec->sat        = new TSat(sat);
+            rec->key        = key;
+            rec->generation = ++serial;
+            rec->active     = true;
+            rec->until      = now;
+
+            changed = true;
+        }
+    }
+
+    for(i=0; i<num_recs; i++)
+        if(!seen[i] && recs[i]->active) {
+            recs[i]->active     = false;
+            recs[i]->generation = ++serial;
+
+            changed = true;
+        }
+
+    free(seen);
+
+    if(changed)
+        version++;
+
+    wake.wakeAll();
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+void TPassTable::run()
+{
+    TPass       *buf = NULL;
+    TSat        *work;
+    TPassWindow w;
+    double      target, from, to, until;
+    int      i, r, n, bufsize, gen;
+
+    bufsize = 0;
+
+    mutex.lock();
+    flags = 0;
+
+    while(!(flags & PT_STOP)) {
+        target = TSimClock::daynum() + horizon;
+
+        // extend the least predicted satellite first
+        for(i=0, r=-1; i<num_recs; i++)
+            if(recs[i]->active && recs[i]->until < target)
+                if(r < 0 || recs[i]->until < recs[r]->until)
+                    r = i;
+
+        if(r < 0) {
+            wake.wait(&mutex, PT_REFRESH);
+            continue;
+        }
+
+        work = new TSat(recs[r]->sat);
+        gen  = recs[r]->generation;
+        w    = thresholds;
+        from = recs[r]->until;
+
+        to = from + PT_CHUNK;
+        if(to > target)
+            to = target;
+
+        mutex.unlock();
+
+        n = predict(work, from, to, &w, &buf, &bufsize);
+        delete work;
+
+        mutex.lock();
+
+        // the satellite may have been invalidated while predicting
+        if(r >= num_recs || recs[r]->generation != gen)
+            continue;
+
+        until = to;
+        for(i=0; i<n; i++) {
+            buf[i].index      = r;
+            buf[i].generation = gen;
+            push(&buf[i]);
+
+            // continue after the last pass or it would be found again
+            if(buf[i].lostime + 1.0/1440.0 > until)
+                until = buf[i].lostime + 1.0/1440.0;
+        }
+
+        recs[r]->until = until;
+
+        // new passes or a longer cover
+        version++;
+    }
+
+    mutex.unlock();
+
+    if(buf)
+        free(buf);
+}
+
+//---------------------------------------------------------------------------
+// recording window and antenna positions of the pass sat is at
+void TPassTable::window(TSat *sat, const TPassWindow *w, TPass *p)
+{
+    double e0 = 0, e1 = 0, t0, t1;
+
+    p->start = p->end = sat->aostime;
+    p->start_az = p->end_az = 0;
+    p->start_el = p->end_el = 0;
+
+    if(w->enable) {
+        // never recorded, weight 0 in the schedule
+        if(sat->sat_max_ele < w->pass_elev)
+            return;
+
+        if(w->type == AOS_LOS) {
+            e0 = w->aos_elev;
+            e1 = w->los_elev;
+        }
+        else { // North/South definition
+            e0 = sat->isNorthbound() ? w->los_elev:w->aos_elev;
+            e1 = sat->isNorthbound() ? w->aos_elev:w->los_elev;
+        }
+    }
+
+    t0 = sat->FindAOSElevation(e0);
+    t1 = sat->FindLOSElevation(e1);
+    if(t0 <= 0 || t1 <= t0)
+        return;
+
+    p->start = t0;
+    p->end   = t1;
+
+    sat->daynum = p->start;
+    sat->Calc();
+    p->start_az = sat->sat_azi;
+    p->start_el = sat->sat_ele;
+
+    sat->daynum = p->end;
+    sat->Calc();
+    p->end_az = sat->sat_azi;
+    p->end_el = sat->sat_ele;
+}
+
+//---------------------------------------------------------------------------
+// passes starting before to, returns number of passes in p
+// TSat::FindAOS already steps by the elevation and most of the work is
+// refining AOS, TCA and LOS, screening the chunk with TSGP4Batch first
+// does not pay off for one satellite at a time
+int TPassTable::predict(TSat *sat, double from, double to, const TPassWindow *w, TPass **p, int *size)
+{
+    TPass  *tmp;
+    double t;
+    int    n;
+
+    for(t=from, n=0; t<to; ) {
+        if(!sat->CalcAll(t) || sat->aostime >= to)
+            break;
+
+        if(sat->lostime > from) {
+            if(n >= *size) {
+                tmp = (TPass *) realloc(*p, (*size + 16) * sizeof(TPass));
+                if(tmp == NULL)
+                    break;
+
+                *p = tmp;
+                *size += 16;
+            }
+
+            (*p)[n].aostime    = sat->aostime;
+            (*p)[n].tcatime    = sat->tcatime;
+            (*p)[n].lostime    = sat->lostime;
+            (*p)[n].max_ele    = sat->sat_max_ele;
+            (*p)[n].northbound = sat->isNorthbound();
+
+            window(sat, w, &(*p)[n]);
+            n++;
+        }
+
+        t = (sat->lostime > t ? sat->lostime:t) + 1.0/1440.0;
+    }
+
+    return n;
+}
+
+//---------------------------------------------------------------------------
+static int compareEnd(const void *a, const void *b)
+{
+    const TSchedItem *x = (const TSchedItem *) a;
+    const TSchedItem *y = (const TSchedItem *) b;
+
+    if(x->end != y->end)
+        return x->end < y->end ? -1:1;
+
+    if(x->aostime != y->aostime)
+        return x->aostime < y->aostime ? -1:1;
+
+    // the same order whatever order the passes were predicted in
+    return x->index < y->index ? -1:(x->index > y->index ? 1:0);
+}
+
+//---------------------------------------------------------------------------
+bool TPassTable::build(double daynum, double now, int antenna)
+{
+    TPassCache *c = &cache[antenna];
+    TSchedItem *it, *items;
+    TPass      *p, *tmp;
+    double     cover;
+    int        i, n, m;
+
+    c->version = -1;
+
+    for(i=0, cover=1e20; i<num_recs; i++)
+        if(recs[i]->active && recs[i]->until < cover)
+            cover = recs[i]->until;
+
+    // drop the stale passes and those over for good
+    for(i=0, n=0; i<count; i++)
+        if(!stale(&passes[i]) && passes[i].lostime > now)
+            passes[n++] = passes[i];
+    count = n;
+
+    if(count > c->size) {
+        items = (TSchedItem *) realloc(c->items, count * sizeof(TSchedItem));
+        if(items)
+            c->items = items;
+
+        tmp = (TPass *) realloc(c->pass, count * sizeof(TPass));
+        if(tmp)
+            c->pass = tmp;
+
+        if(items == NULL || tmp == NULL)
+            return false;
+
+        c->size = count;
+    }
+
+    c->expire = 1e20;
+
+    for(i=0, m=0; i<count; i++) {
+        p = &passes[i];
+
+        // over at daynum, up and receding or not predicted for every satellite yet
+        if(p->lostime <= daynum || (p->aostime < daynum && now >= p->tcatime) || p->aostime >= cover)
+            continue;
+
+        // the candidates change when the first of them reaches TCA
+        if(p->tcatime < c->expire)
+            c->expire = p->tcatime;
+
+        c->pass[m] = *p;
+
+        it = &c->items[m];
+        it->start      = p->start;
+        it->end        = p->end;
+        it->start_az   = p->start_az;
+        it->start_el   = p->start_el;
+        it->end_az     = p->end_az;
+        it->end_el     = p->end_el;
+        it->weight     = (p->end - p->start) * 1440.0 * recs[p->index]->priority;
+        it->aostime    = p->aostime;
+        it->index      = p->index;
+        it->generation = p->generation;
+        it->ref        = m++;
+    }
+
+    qsort(c->items, m, sizeof(TSchedItem), compareEnd);
+
+    m = exclude(c->items, m, antenna);
+
+    if(m > 0 && !schedule[antenna].update(c->items, m))
+        return false;
+
+    c->num     = m;
+    c->daynum  = daynum;
+    c->now     = now;
+    c->cover   = cover;
+    c->version = version;
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void TPassTable::claim(const TPass *p, int antenna)
+{
+    TPassClaim *c = &claims[antenna];
+    bool       own;
+
+    if(c->valid && c->aostime == p->aostime && c->index == p->index && c->generation == p->generation)
+        return;
+
+    c->valid      = true;
+    c->aostime    = p->aostime;
+    c->index      = p->index;
+    c->generation = p->generation;
+
+    // the other antennas schedule again, the own candidates do not depend on it
+    own = cache[antenna].version == version;
+    version++;
+    if(own)
+        cache[antenna].version = version;
+}
+
+//---------------------------------------------------------------------------
+bool TPassTable::next(double daynum, double now, TPass *pass, char *name, int antenna)
+{
+    TPassCache *c;
+    TSchedItem *items;
+    TPass      p;
+    int        i, first;
+    bool       found;
+
+    if(antenna < 0 || antenna >= PT_MAX_ANTENNAS)
+        return false;
+
+    mutex.lock();
+
+    c = &cache[antenna];
+
+    if(c->version != version || daynum < c->daynum || now < c->now ||
+       daynum >= c->expire || now >= c->expire)
+        build(daynum, now, antenna);
+
+    found = false;
+
+    if(c->version == version && c->num > 0) {
+        items = c->items;
+        first = schedule[antenna].first(daynum);
+
+        // nothing worth recording, track the next pass as before
+        if(first < 0)
+            for(i=0; i<c->num; i++)
+                if(first < 0 || items[i].aostime < items[first].aostime)
+                    first = i;
+
+        p = c->pass[items[first].ref];
+
+        // another satellite may still get an earlier pass
+        if(p.lostime <= c->cover) {
+            *pass = p;
+            strcpy(name, recs[p.index]->name);
+            found = true;
+
+            claim(&p, antenna);
+        }
+    }
+
+    mutex.unlock();
+
+    return found;
+}
+
+//---------------------------------------------------------------------------
+void TPassTable::release(int antenna)
+{
+    if(antenna < 0 || antenna >= PT_MAX_ANTENNAS)
+        return;
+
+    mutex.lock();
+    if(claims[antenna].valid) {
+        claims[antenna].valid = false;
+        version++;
+    }
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+bool TPassTable::claimed(const TSchedItem *it, int antenna)
+{
+    TPassClaim *c;
+    int        i;
+
+    for(i=0; i<num_antennas; i++) {
+        c = &claims[i];
+
+        if(i != antenna && c->valid && c->index == it->index &&
+           c->generation == it->generation && c->aostime == it->aostime)
+            return true;
+    }
+
+    return false;
+}
+
+//---------------------------------------------------------------------------
+// drops the passes claimed by the other antennas and those the antennas
+// before this one schedule, the order of the items is kept
+int TPassTable::exclude(TSchedItem *items, int n, int antenna)
+{
+    TPassSchedule *s;
+    int i, j, m;
+
+    for(i=0, m=0; i<n; i++)
+        if(!claimed(&items[i], antenna))
+            items[m++] = items[i];
+
+    for(j=0; j<antenna && j<num_antennas && m>0; j++) {
+        s = &shadow[j];
+        if(!enabled[j])
+            continue;
+        if(!s->update(items, m))
+            break;
+
+        for(i=0; i<s->getScheduled(); i++)
+            items[s->scheduledItem(i)].weight = -1;
+
+        for(i=0, n=m, m=0; i<n; i++)
+            if(items[i].weight >= 0)
+                items[m++] = items[i];
+    }
+
+    return m;
+}
+
+//---------------------------------------------------------------------------
+void TPassTable::push(const TPass *p)
+{
+    TPass *tmp;
+
+    if(count >= size) {
+        tmp = (TPass *) realloc(passes, (size + 256) * sizeof(TPass));
+        if(tmp == NULL) {
+            qDebug("[%s:%d] out of memory", __FILE__, __LINE__);
+            return;
+        }
+
+        passes = tmp;
+        size += 256;
+    }
+
+    passes[count++] = *p;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,169 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef PASSTABLE_H
+#define PASSTABLE_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include "Satellite.h"
+#include "passschedule.h"
+#include "antenna.h"
+
+//---------------------------------------------------------------------------
+#define PT_STOP             1
+
+#define PT_HORIZON          2.0     // days predicted ahead
+#define PT_MAX_HORIZON      14.0
+#define PT_CHUNK            0.25    // days predicted per satellite and lock
+#define PT_REFRESH          60000   // milliseconds between horizon extensions
+#define PT_MAX_OVERLAP      32      // passes checked for an overlap
+#define PT_MAX_ANTENNAS     AN_MAX
+
+class PList;
+class TRig;
+
+//---------------------------------------------------------------------------
+typedef struct TPass_t
+{
+    double aostime, tcatime, lostime;
+    double max_ele;
+    bool   northbound;
+    double start, end;  // recording window, the pass if thresholds are disabled
+    double start_az, start_el, end_az, end_el;
+    int    index;       // satellite record
+    int    generation;  // record generation the pass was predicted with
+} TPass;
+
+typedef struct TPassSat_t
+{
+    char   name[TLE_NAMELEN+1];
+    uint   key;         // TLE and station checksum
+    int    generation;
+    bool   active;
+    int    priority;
+    double until;       // daynum the passes are predicted up to
+    TSat   *sat;        // private copy, owned by the table
+} TPassSat;
+
+// the recording thresholds of TRig as used by TSat::CheckThresholds
+typedef struct TPassWindow_t
+{
+    bool   enable;
+    int    type;        // PassThresholdType_t
+    int    pass_elev, aos_elev, los_elev;
+} TPassWindow;
+
+// the pass an antenna got last, no other antenna gets it
+typedef struct TPassClaim_t
+{
+    bool   valid;
+    double aostime;
+    int    index, generation;
+} TPassClaim;
+
+// the candidates an antenna's schedule was solved for, valid while the
+// table version is the same and until the first candidate reaches TCA
+typedef struct TPassCache_t
+{
+    int        version;     // table version, -1 if not built
+    double     daynum, now; // built at
+    double     expire;      // first TCA of the candidates
+    double     cover;
+    TSchedItem *items;      // after exclude(), ref indexes pass
+    TPass      *pass;
+    int        num, size;
+} TPassCache;
+
+//---------------------------------------------------------------------------
+// Background predicted passes of all active satellites. Satellites are
+// invalidated only when their TLE, station or thresholds change, stale
+// passes are dropped lazily when a schedule is built. Overlapping passes
+// are resolved by TPassSchedule, one per antenna: an antenna schedules the
+// passes left over by the antennas before it and not claimed by any other.
+// The schedules are cached and built again only when the table version
+// changes or a candidate pass drops out.
+class TPassTable : public QThread
+{
+public:
+    TPassTable(QObject *parent = 0);
+    ~TPassTable(void);
+
+    void   run();
+    void   stop(void);
+
+    void   setHorizon(double days);
+    double getHorizon(void) { return horizon; }
+
+    // syncs the records with the satellites in list and the thresholds and
+    // rotor of rig, call it from the thread owning the list whenever TLE's,
+    // station, priorities or active state may have changed
+    void   update(PList *list, TRig *rig);
+    void   clear(void);
+
+    // the first pass of the antenna's schedule at daynum, false if the table does not cover it yet
+    // a pass that is up and past TCA at now is skipped as in MainWindow::searchNextSat
+    // the pass is claimed by the antenna until its next call or release()
+    bool   next(double daynum, double now, TPass *pass, char *name, int antenna = 0);
+    void   release(int antenna);
+
+    int    getCount(void) { return count; }
+
+protected:
+    uint   satKey(TSat *sat);
+    bool   stale(const TPass *p);
+    int    findRecord(const char *name);
+    int    predict(TSat *sat, double from, double to, const TPassWindow *w, TPass **p, int *size);
+    void   window(TSat *sat, const TPassWindow *w, TPass *p);
+    bool   claimed(const TSchedItem *it, int antenna);
+    int    exclude(TSchedItem *items, int n, int antenna);
+    bool   build(double daynum, double now, int antenna);
+    void   claim(const TPass *p, int antenna);
+
+    void   push(const TPass *p);
+
+private:
+    QMutex         mutex;
+    QWaitCondition wake;
+
+    TPass    *passes;
+    int      count, size;
+
+    TPassSat **recs;
+    int      num_recs;
+
+    TPassWindow   thresholds;
+    TPassSchedule schedule[PT_MAX_ANTENNAS];
+    TPassSchedule shadow[PT_MAX_ANTENNAS];  // what the antenna takes from the antennas after it
+    TPassCache    cache[PT_MAX_ANTENNAS];
+    TPassClaim    claims[PT_MAX_ANTENNAS];
+    bool          enabled[PT_MAX_ANTENNAS];
+    int           num_antennas;
+
+    double   horizon;
+    int      serial;      // last record generation handed out
+    int      version;     // passes, records, rotors or claims changed
+    int      flags;
+};
+
+#endif // PASSTABLE_H
@@ -0,0 +1,94 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QTableWidget>
+#include <QTableWidgetItem>
+
+#include "passworker.h"
+#include "Satellite.h"
+#include "plist.h"
+
+//---------------------------------------------------------------------------
+TPassRow::TPassRow(void)
+{
+    aostime   = 0;
+    highlight = false;
+}
+
+//---------------------------------------------------------------------------
+void TPassRow::fill(QTableWidget *g, int row)
+{
+ int col = 0;
+
+    g->setItem(row, col++, new QTableWidgetItem(name));
+    g->setItem(row, col++, new QTableWidgetItem(downlink));
+    g->setItem(row, col++, new QTableWidgetItem(aos));
+    g->setItem(row, col++, new QTableWidgetItem(max_ele));
+    g->setItem(row, col++, new QTableWidgetItem(direction));
+    g->setItem(row, col++, new QTableWidgetItem(duration));
+    g->setItem(row, col++, new QTableWidgetItem(azimuth));
+    g->setItem(row, col++, new QTableWidgetItem(lat));
+    g->setItem(row, col++, new QTableWidgetItem(lon));
+    g->setItem(row, col++, new QTableWidgetItem(range));
+    g->setItem(row, col++, new QTableWidgetItem(orbit));
+
+    if(highlight)
+        for(col=0; col<g->columnCount(); col++)
+            if(g->item(row, col))
+                g->item(row, col)->setSelected(true);
+}
+
+//---------------------------------------------------------------------------
+TPassWorker::TPassWorker(TSat **sats_, PList **rows_, int count_, int first_, int stride_,
+                         TRig *rig_, QDateTime utc_, int generation_, QObject *parent) :
+    QThread(parent)
+{
+    sats       = sats_;
+    rows       = rows_;
+    count      = count_;
+    first      = first_;
+    stride     = stride_;
+    rig        = rig_;
+    utc        = utc_;
+    generation = generation_;
+    flags      = 0;
+}
+
+//---------------------------------------------------------------------------
+void TPassWorker::stop(void)
+{
+    if(isRunning())
+        flags |= PW_STOP;
+}
+
+//---------------------------------------------------------------------------
+void TPassWorker::run()
+{
+ int i;
+
+    for(i=first; i<count && !(flags & PW_STOP); i+=stride) {
+        sats[i]->SatellitePasses(rig, rows[i], utc);
+
+        emit passesReady(generation, i);
+    }
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,78 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef PASSWORKER_H
+#define PASSWORKER_H
+
+#include <QThread>
+#include <QString>
+#include <QDateTime>
+
+//---------------------------------------------------------------------------
+#define PW_STOP     1
+
+class QTableWidget;
+class PList;
+class TSat;
+class TRig;
+
+//---------------------------------------------------------------------------
+// one row in the pass list, see TSat::GetPassRow
+class TPassRow
+{
+public:
+    TPassRow(void);
+
+    void fill(QTableWidget *g, int row);
+
+    double  aostime;
+    QString name, downlink, aos, max_ele, direction, duration,
+            azimuth, lat, lon, range, orbit;
+    bool    highlight;
+};
+
+//---------------------------------------------------------------------------
+// predicts the passes of every stride'th satellite from first,
+// rows[i] is filled before passesReady(generation, i) is emitted
+class TPassWorker : public QThread
+{
+    Q_OBJECT
+
+public:
+    TPassWorker(TSat **sats_, PList **rows_, int count_, int first_, int stride_,
+                TRig *rig_, QDateTime utc_, int generation_, QObject *parent = 0);
+
+    void run();
+    void stop(void);
+
+signals:
+    void passesReady(int generation, int index);
+
+private:
+    TSat      **sats;
+    PList     **rows;
+    TRig      *rig;
+    QDateTime utc;
+    int       count, first, stride, generation;
+    int       flags;
+};
+
+#endif // PASSWORKER_H
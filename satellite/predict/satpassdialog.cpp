@@ -23,6 +23,7 @@
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QDate>
+#include <stdlib.h>
 
 #include "satpassdialog.h"
 #include "ui_satpassdialog.h"
@@ -34,6 +35,7 @@
 #include "utils.h"
 #include "rig.h"
 #include "station.h"
+#include "passworker.h"
 
 #define AOS_COL_NR 2
 
@@ -52,6 +54,14 @@ satpassdialog::satpassdialog(PList *_satList, QWidget *parent) :
     mw = (MainWindow *) parent;
     satList = _satList;
 
+    workers    = NULL;
+    predSats   = NULL;
+    predRows   = NULL;
+    numWorkers = 0;
+    predCount  = 0;
+    pending    = 0;
+    generation = 0;
+
     flags = 0;
     for(i=0; i<satList->Count; i++) {
         sat = (TSat *) satList->ItemAt(i);
@@ -80,6 +90,8 @@ satpassdialog::satpassdialog(PList *_satList, QWidget *parent) :
 //---------------------------------------------------------------------------
 satpassdialog::~satpassdialog()
 {
+    stopPrediction();
+
     delete m_ui;
 }
 
@@ -99,26 +111,19 @@ void satpassdialog::changeEvent(QEvent *e)
 //---------------------------------------------------------------------------
 void satpassdialog::on_activeSatBtn_clicked()
 {
-    QDateTime      utc  = getSelectedUTC();
-    TRig           *rig = mw->getRig();
-    TSat           *sat;
-    int            i;
-
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-
-    m_ui->tableWidget->setSortingEnabled(false);
-    clearGrid(m_ui->tableWidget);
+    PList sats;
+    TSat  *sat;
+    int   i;
 
     for(i=0; i<satList->Count; i++) {
         sat = (TSat *) satList->ItemAt(i);
         if(sat->isActive())
-            sat->SatellitePasses(rig, m_ui->tableWidget, utc, 1);
+            sats.Add(sat);
     }
 
-    m_ui->tableWidget->setSortingEnabled(true);
-    m_ui->tableWidget->sortItems(AOS_COL_NR);
+    startPrediction(&sats);
 
-    QApplication::restoreOverrideCursor();
+    sats.Flush();
 }
 
 //---------------------------------------------------------------------------
@@ -166,14 +171,160 @@ void satpassdialog::on_satListWidget_currentItemChanged(QListWidgetItem* current
     if(sat == NULL)
         return;
 
-    QApplication::setOverrideCursor(Qt::WaitCursor);
+    PList sats;
+
+    sats.Add(sat);
+    startPrediction(&sats);
+    sats.Flush();
+}
+
+//---------------------------------------------------------------------------
+// predicts the passes of sats on the selected date in worker threads,
+// the table is filled in AOS order as each satellite completes
+void satpassdialog::startPrediction(PList *sats)
+{
+ QDateTime utc  = getSelectedUTC();
+ TRig      *rig = mw->getRig();
+ int       i;
+
+    stopPrediction();
 
     m_ui->tableWidget->setSortingEnabled(false);
-    sat->SatellitePasses(mw->getRig(), m_ui->tableWidget, getSelectedUTC());
-    m_ui->tableWidget->setSortingEnabled(true);
-    m_ui->tableWidget->sortItems(AOS_COL_NR);
+    clearGrid(m_ui->tableWidget);
 
-    QApplication::restoreOverrideCursor();
+    if(sats->Count == 0)
+        return;
+
+    predCount = sats->Count;
+    predSats  = (TSat **) malloc(predCount * sizeof(TSat *));
+    predRows  = (PList **) malloc(predCount * sizeof(PList *));
+
+    // workers get private copies, the main window keeps tracking on the originals
+    for(i=0; i<predCount; i++) {
+        predSats[i] = new TSat((TSat *) sats->ItemAt(i));
+        predRows[i] = new PList;
+    }
+
+    numWorkers = QThread::idealThreadCount();
+    if(numWorkers < 1)
+        numWorkers = 1;
+    if(numWorkers > predCount)
+        numWorkers = predCount;
+
+    generation++;
+    pending = predCount;
+
+    workers = (TPassWorker **) malloc(numWorkers * sizeof(TPassWorker *));
+    for(i=0; i<numWorkers; i++) {
+        workers[i] = new TPassWorker(predSats, predRows, predCount, i, numWorkers,
+                                     rig, utc, generation);
+
+        connect(workers[i], SIGNAL(passesReady(int, int)),
+                this, SLOT(passesReady(int, int)), Qt::QueuedConnection);
+
+        workers[i]->start();
+    }
+
+    m_ui->tableWidget->setCursor(Qt::BusyCursor);
+}
+
+//---------------------------------------------------------------------------
+void satpassdialog::passesReady(int gen, int index)
+{
+ QTableWidget *g = m_ui->tableWidget;
+ TPassRow     *row;
+ PList        *rows;
+ int          i, r;
+
+    // a late signal from a stopped prediction or rows already merged
+    if(gen != generation || index < 0 || index >= predCount || predRows[index] == NULL)
+        return;
+
+    rows = predRows[index];
+    predRows[index] = NULL;
+
+    g->setSortingEnabled(false);
+
+    for(i=0; i<rows->Count; i++) {
+        row = (TPassRow *) rows->ItemAt(i);
+
+        r = g->rowCount();
+        g->setRowCount(r + 1);
+        row->fill(g, r);
+
+        delete row;
+    }
+
+    g->setSortingEnabled(true);
+    g->sortItems(AOS_COL_NR);
+
+    rows->Flush();
+    delete rows;
+
+    if(--pending == 0)
+        g->unsetCursor();
+}
+
+//---------------------------------------------------------------------------
+// blocks until all workers are done and their rows are in the table
+void satpassdialog::waitPrediction(void)
+{
+ int i;
+
+    if(pending == 0)
+        return;
+
+    for(i=0; i<numWorkers; i++)
+        workers[i]->wait();
+
+    for(i=0; i<predCount; i++)
+        passesReady(generation, i);
+}
+
+//---------------------------------------------------------------------------
+void satpassdialog::stopPrediction(void)
+{
+ PList *rows;
+ int   i, j;
+
+    for(i=0; i<numWorkers; i++)
+        workers[i]->stop();
+
+    for(i=0; i<numWorkers; i++) {
+        workers[i]->wait();
+        delete workers[i];
+    }
+
+    for(i=0; i<predCount; i++) {
+        rows = predRows[i];
+        if(rows) {
+            for(j=0; j<rows->Count; j++)
+                delete (TPassRow *) rows->ItemAt(j);
+
+            rows->Flush();
+            delete rows;
+        }
+
+        delete predSats[i];
+    }
+
+    if(workers)
+        free(workers);
+    if(predSats)
+        free(predSats);
+    if(predRows)
+        free(predRows);
+
+    workers    = NULL;
+    predSats   = NULL;
+    predRows   = NULL;
+    numWorkers = 0;
+    predCount  = 0;
+
+    if(pending)
+        m_ui->tableWidget->unsetCursor();
+
+    pending = 0;
 }
 
 //---------------------------------------------------------------------------
@@ -203,6 +354,11 @@ void satpassdialog::on_saveButton_clicked()
    if(fileName.isEmpty())
        return;
 
+   // the list is saved from the table, let the prediction complete first
+   QApplication::setOverrideCursor(Qt::WaitCursor);
+   waitPrediction();
+   QApplication::restoreOverrideCursor();
+
    fp = fopen(fileName.toStdString().c_str(), "w");
    if(fp == NULL) {
        QMessageBox::critical(this, "Error: Failed to write to file!", fileName);
@@ -46,6 +46,8 @@ class QListWidgetItem;
 class QDateTime;
 class MainWindow;
 class PList;
+class TSat;
+class TPassWorker;
 
 //---------------------------------------------------------------------------
 class satpassdialog : public QDialog {
@@ -59,13 +61,23 @@ protected:
 
     QDateTime getSelectedUTC(void);
 
+    void startPrediction(PList *sats);
+    void stopPrediction(void);
+    void waitPrediction(void);
 
 private:
     Ui::satpassdialog *m_ui;
     PList *satList;
     MainWindow *mw;
 
+    // background pass prediction, one job per satellite
+    TPassWorker **workers;
+    TSat  **predSats;
+    PList **predRows;
+    int   numWorkers, predCount, pending, generation;
+
 private slots:
+    void passesReady(int gen, int index);
     void on_satListWidget_itemClicked(QListWidgetItem* item);
     void on_dateEdit_dateChanged(QDate date);
     void on_timecheckBox_clicked();
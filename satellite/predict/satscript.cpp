@@ -23,6 +23,9 @@
 #include <QSettings>
 #include <QFileInfo>
 #include <QDir>
+#include <QList>
+#include <QSet>
+#include <QMutex>
 #include <stdlib.h>
 
 #include "satscript.h"
@@ -31,10 +34,11 @@
 // these CAN NOT have embedded items
 #define SS_INDEX_SATFREQ            0   // {SATFREQ}
 #define SS_INDEX_SATNAME            1   // {SATNAME}
+#define SS_INDEX_RECEIVER           2   // {RECEIVER}, receiver of the tracking antenna
 
 // these CAN have embedded items or parameters inside brackets
-#define SS_INDEX_DATETIME           2   // {DATETIME:yyyy-MM-dd}
-#define SS_INDEX_DIR                3   // {DIR:/path/to/directory}
+#define SS_INDEX_DATETIME           3   // {DATETIME:yyyy-MM-dd}
+#define SS_INDEX_DIR                4   // {DIR:/path/to/directory}
 
 #define SS_TMPSTR_SIZE              512
 
@@ -45,6 +49,37 @@
 #define SS_CMD_FRAMES_DIR           3   // frames-dir
 #define SS_CMD_FRAMES_EXT           4   // frames-file-ext
 
+// compiled argument tokens, the rest are SS_INDEX_XX
+#define SS_TOKEN_TEXT              -1
+#define SS_TOKEN_DIR_END           -2   // closing bracket of {DIR:
+
+//---------------------------------------------------------------------------
+struct TScriptToken
+{
+    int     type;
+    QString text;                       // SS_TOKEN_TEXT or the DATETIME format
+};
+
+struct TScriptArg
+{
+    QString             source;         // home directory expanded
+    QList<TScriptToken> tokens;
+    int                 command;        // SS_CMD_XX, -1 if none
+    int                 skip;           // length of the command and a space
+    bool                legacy;         // parsed by parse_argument at launch
+};
+
+struct TScriptProgram
+{
+    QString           script;
+    QList<TScriptArg> args;
+    int               legacy;           // number of legacy arguments
+};
+
+// directories known to exist, shared by all satellites and trackers
+static QSet<QString> ss_paths;
+static QMutex        ss_paths_mutex;
+
 //---------------------------------------------------------------------------
 TSatScript::TSatScript(void)
 {
@@ -58,6 +93,9 @@ TSatScript::TSatScript(void)
     constants = NULL;
     commands  = NULL;
     tmpstr = NULL;
+
+    rx_program = NULL;
+    postproc_program = NULL;
 }
 
 //---------------------------------------------------------------------------
@@ -76,6 +114,10 @@ TSatScript::TSatScript(const TSatScript& src)
     constants = NULL;
     commands  = NULL;
     tmpstr = NULL;
+
+    // the tracker works on a copy, keep it compiled
+    rx_program = src.rx_program ? new TScriptProgram(*src.rx_program):NULL;
+    postproc_program = src.postproc_program ? new TScriptProgram(*src.postproc_program):NULL;
 }
 
 //---------------------------------------------------------------------------
@@ -85,6 +127,7 @@ TSatScript::~TSatScript(void)
     delete _postproc_script_args;
 
     free_private();
+    invalidate();
 }
 
 //---------------------------------------------------------------------------
@@ -124,6 +167,12 @@ TSatScript& TSatScript::operator = (const TSatScript& src)
     _flags = src.flags();    
 
     free_private();
+    invalidate();
+
+    if(src.rx_program)
+        rx_program = new TScriptProgram(*src.rx_program);
+    if(src.postproc_program)
+        postproc_program = new TScriptProgram(*src.postproc_program);
 
     return *this;
 }
@@ -137,6 +186,7 @@ void TSatScript::assign_constants(void)
        // add here constants that CAN NOT be embedded or DON'T HAVE parameters ie {CONSTANT}
        constants->append("{SATFREQ}");
        constants->append("{SATNAME}");
+       constants->append("{RECEIVER}");
 
        // add here constants that CAN be be embedded or HAVE parameters {CONSTANT_NAME:param1, param2, etc
        constants->append("{DATETIME:");
@@ -175,6 +225,7 @@ void TSatScript::zero(void)
     _flags = 0;
 
     free_private();
+    invalidate();
 }
 
 //---------------------------------------------------------------------------
@@ -232,6 +283,8 @@ void TSatScript::readSettings(QSettings *reg, int modes)
     }
 
     reg->endGroup();
+
+    compile();
 }
 
 //---------------------------------------------------------------------------
@@ -352,10 +405,16 @@ QString TSatScript::get_rx_command(const QString& satname, const double frequenc
 
     now = QDateTime::currentDateTime();
 
+    // frequency in Hz
+    _freqstr.sprintf("%.0f", _frequency * 1.0e6);
+
     _frames_filename   = "";
     _baseband_filename = "";
 
-    rc = getcommand(_rx_script, _rx_script_args, error, mode);
+    if(!rx_program)
+        compile();
+
+    rc = getcommand(rx_program, error, mode);
 
     if(!*error) {
         if(postproc_srcrip_enable() && _baseband_filename.isEmpty()) {
@@ -384,15 +443,303 @@ QString TSatScript::get_postproc_command(bool *error, int mode)
     if(_baseband_filename.isEmpty())
         return "Error: Baseband file is empty or not defined in the RX script! Run the RX script first!";
 
-    rc = getcommand(_postproc_script, _postproc_script_args, error, mode);
+    if(!postproc_program)
+        compile();
+
+    rc = getcommand(postproc_program, error, mode);
+
+    return rc;
+}
+
+//---------------------------------------------------------------------------
+void TSatScript::prepare(const QString& satname, const double frequency, const QDateTime& dt)
+{
+    TScriptProgram *program[2];
+    bool           error;
+    int            i, j;
+
+    if(!rx_program || !postproc_program)
+        compile();
+
+    _satname = satname;
+    _satname.replace(" ", "-");
+    _frequency = frequency;
+    _freqstr.sprintf("%.0f", _frequency * 1.0e6);
+
+    now = dt;
+
+    program[0] = rx_srcrip_enable() ? rx_program:NULL;
+    program[1] = postproc_srcrip_enable() ? postproc_program:NULL;
+
+    for(j=0; j<2; j++) {
+        if(program[j] == NULL)
+            continue;
+
+        for(i=0; i<program[j]->args.count(); i++) {
+            if(program[j]->args.at(i).legacy)
+                continue;
+
+            error = false;
+            run_argument(&program[j]->args.at(i), &error, 2);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+void TSatScript::invalidate(void)
+{
+    if(rx_program)
+        delete rx_program;
+    if(postproc_program)
+        delete postproc_program;
+
+    rx_program = NULL;
+    postproc_program = NULL;
+}
+
+//---------------------------------------------------------------------------
+// the arguments are split into tokens once, at launch only the satellite,
+// frequency, receiver and time are filled in
+void TSatScript::compile(void)
+{
+    invalidate();
+
+    assign_constants();
+
+    rx_program = compile_program(_rx_script, _rx_script_args);
+    postproc_program = compile_program(_postproc_script, _postproc_script_args);
+
+    free_private();
+}
+
+//---------------------------------------------------------------------------
+TScriptProgram *TSatScript::compile_program(const QString& script, QStringList *args)
+{
+    TScriptProgram *program;
+    TScriptArg     a;
+    QString        arg, text;
+    int            i, j;
+
+    program = new TScriptProgram;
+    program->script = script;
+    program->legacy = 0;
+
+    for(i=0; i<args->count(); i++) {
+        arg = args->at(i);
+
+        if(arg.contains("~"))
+            arg.replace("~", QDir::homePath());
+
+        a.source = arg;
+        a.tokens.clear();
+        a.command = -1;
+        a.skip = 0;
+        a.legacy = !compile_argument(arg, &a);
+
+        if(a.legacy) {
+            a.tokens.clear();
+            program->legacy++;
+        }
+        else {
+            // the command is a literal, eg. "frames-dir {DIR:...}"
+            text = "";
+            for(j=0; j<a.tokens.count(); j++)
+                if(a.tokens.at(j).type == SS_TOKEN_TEXT)
+                    text += a.tokens.at(j).text;
+
+            a.command = getcommand_index(text);
+            if(a.command >= 0)
+                a.skip = commands->at(a.command).length() + 1;
+        }
+
+        program->args.append(a);
+    }
+
+    return program;
+}
+
+//---------------------------------------------------------------------------
+// returns false if the argument is bogus or parse_argument would evaluate
+// it differently, ie. constants nested in {DATETIME: or several {DIR:
+bool TSatScript::compile_argument(const QString& arg, TScriptArg *a)
+{
+    TScriptToken t;
+    QString      text, constant;
+    int          i, k, end, dirs, dir_tokens, dir_len;
+    bool         in_dir;
+
+    in_dir = false;
+    dirs = dir_tokens = dir_len = 0;
+
+    for(i=0; i<arg.length(); ) {
+        if(arg.at(i) == '{') {
+            for(k=0; k<constants->count(); k++)
+                if(arg.indexOf(constants->at(k), i) == i)
+                    break;
+
+            if(k < constants->count()) {
+                constant = constants->at(k);
+
+                if(!text.isEmpty()) {
+                    t.type = SS_TOKEN_TEXT;
+                    t.text = text;
+                    a->tokens.append(t);
+                    text = "";
+                }
+
+                t.type = k;
+                t.text = "";
+
+                switch(k)
+                {
+                case SS_INDEX_DATETIME:
+                    {
+                        end = arg.indexOf('}', i + constant.length());
+                        if(end < 0)
+                            return false;
+
+                        t.text = arg.mid(i + constant.length(), end - i - constant.length());
+                        if(t.text.length() <= 1 || t.text.contains('{'))
+                            return false;
+
+                        i = end + 1;
+                        break;
+                    }
+
+                case SS_INDEX_DIR:
+                    {
+                        if(dirs++)
+                            return false;
+
+                        in_dir = true;
+                        i += constant.length();
+                        break;
+                    }
+
+                default:
+                    i += constant.length();
+                    break;
+                }
+
+                if(in_dir && k != SS_INDEX_DIR)
+                    dir_tokens++;
+
+                a->tokens.append(t);
+                continue;
+            }
+        }
+        else if(arg.at(i) == '}' && in_dir) {
+            // a directory shorter than 2 characters is an error
+            if(dir_tokens == 0 && dir_len + text.length() <= 1)
+                return false;
+
+            if(!text.isEmpty()) {
+                t.type = SS_TOKEN_TEXT;
+                t.text = text;
+                a->tokens.append(t);
+                text = "";
+            }
+
+            t.type = SS_TOKEN_DIR_END;
+            t.text = "";
+            a->tokens.append(t);
+
+            in_dir = false;
+            i++;
+            continue;
+        }
+
+        text += arg.at(i++);
+        if(in_dir)
+            dir_len++;
+    }
+
+    // unterminated {DIR:
+    if(in_dir)
+        return false;
+
+    if(!text.isEmpty()) {
+        t.type = SS_TOKEN_TEXT;
+        t.text = text;
+        a->tokens.append(t);
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// mode&1 = testing, mode&2 = create the directories even if they are cached
+QString TSatScript::run_argument(const TScriptArg *a, bool *error, int mode)
+{
+    const TScriptToken *t;
+    QString            arg, path;
+    int                i, dir_pos;
+
+    dir_pos = 0;
+
+    for(i=0; i<a->tokens.count(); i++) {
+        t = &a->tokens.at(i);
+
+        switch(t->type)
+        {
+        case SS_TOKEN_TEXT:     arg += t->text; break;
+        case SS_INDEX_SATFREQ:  arg += _freqstr; break;
+        case SS_INDEX_SATNAME:  arg += _satname; break;
+        case SS_INDEX_RECEIVER: arg += _receiver; break;
+        case SS_INDEX_DATETIME: arg += now.toString(t->text); break;
+        case SS_INDEX_DIR:      dir_pos = arg.length(); break;
+
+        case SS_TOKEN_DIR_END:
+            {
+                path = arg.mid(dir_pos);
+
+                if(path.length() <= 1) {
+                    *error = true;
+                    return a->source + "\nBogus parameter, too short!";
+                }
+
+                if(!(mode & 1) && !findpath(path, (mode & 2) ? true:false)) {
+                    *error = true;
+                    return a->source + "\nFailed to create directory: " + path;
+                }
+
+                break;
+            }
+
+        default:
+            break;
+        }
+    }
+
+    return arg;
+}
+
+//---------------------------------------------------------------------------
+// the first recording of the day creates the directories, prepare() does it
+// before AOS so the launch does not touch the file system
+bool TSatScript::findpath(const QString& path, bool verify)
+{
+    bool rc;
+
+    ss_paths_mutex.lock();
+
+    rc = !verify && ss_paths.contains(path);
+    if(!rc) {
+        rc = checkdirectory(path);
+        if(rc)
+            ss_paths.insert(path);
+    }
+
+    ss_paths_mutex.unlock();
 
     return rc;
 }
 
 //---------------------------------------------------------------------------
 // mode & 1 = test only, don't create dirs
-QString TSatScript::getcommand(QString script, QStringList *args, bool *error, int mode)
+QString TSatScript::getcommand(TScriptProgram *program, bool *error, int mode)
 {
+    const TScriptArg *a;
     QString rc, arg;
     QString out_file, frames_dir, frames_ext;
     QString baseband_dir, baseband_ext;
@@ -400,29 +747,32 @@ QString TSatScript::getcommand(QString script, QStringList *args, bool *error, i
 
     *error = true;
 
-    if(script.isEmpty())
+    if(program->script.isEmpty())
         return "Error: No script file!";
 #if 0
-    QFileInfo fi(script);
+    QFileInfo fi(program->script);
     if(!fi.exists())
-        return "Error: File not found: " + script;
+        return "Error: File not found: " + program->script;
 #endif
 
-    if(!args->count())
-        return "Error: No arguments: " + script;
+    if(!program->args.count())
+        return "Error: No arguments: " + program->script;
 
     *error = false;
-    rc = script;
+    rc = program->script;
 
-    assign_constants();
+    // only the arguments the compiler did not understand are parsed here
+    if(program->legacy)
+        assign_constants();
 
-    for(i=0; i<args->count(); i++) {
-        arg = args->at(i);
+    for(i=0; i<program->args.count(); i++) {
+        a = &program->args.at(i);
 
-        if(arg.contains("~"))
-            arg.replace("~", QDir::homePath());
+        if(a->legacy)
+            arg = parse_argument(a->source, error, mode);
+        else
+            arg = run_argument(a, error, mode);
 
-        arg = parse_argument(arg, error, mode);
         arg = arg.trimmed();
 
         if(arg.isEmpty())
@@ -435,13 +785,13 @@ QString TSatScript::getcommand(QString script, QStringList *args, bool *error, i
             return rc;
         }
 
-        index = getcommand_index(arg);
+        index = a->legacy ? getcommand_index(arg):a->command;
         if(index < 0) {
             rc += " " + arg;
             continue;
         }
 
-        len = commands->at(index).length() + 1;
+        len = a->legacy ? commands->at(index).length() + 1:a->skip;
 
         // qDebug("\narg: %s, [%s:%d]\n", arg.toStdString().c_str(), __FILE__, __LINE__);
 
@@ -497,7 +847,8 @@ QString TSatScript::getcommand(QString script, QStringList *args, bool *error, i
         }
     }
 
-    free_private();
+    if(program->legacy)
+        free_private();
 
 #if 0
     // TODO: add no-outfile option
@@ -561,6 +912,7 @@ QString TSatScript::parse_argument(QString arg, bool *error, int mode)
         // check first arguments that can not be embedded, ie {CONSTANT_NAME}
     case SS_INDEX_SATNAME:
     case SS_INDEX_SATFREQ:
+    case SS_INDEX_RECEIVER:
         {
             switch(index)
             {
@@ -575,6 +927,12 @@ QString TSatScript::parse_argument(QString arg, bool *error, int mode)
                 {
                     str.sprintf("%s", _satname.toStdString().c_str());
 
+                    break;
+                }
+            case SS_INDEX_RECEIVER:
+                {
+                    str = _receiver;
+
                     break;
                 }
 
@@ -37,6 +37,8 @@
 
 //---------------------------------------------------------------------------
 class QSettings;
+struct TScriptProgram;
+struct TScriptArg;
 
 
 //---------------------------------------------------------------------------
@@ -62,21 +64,27 @@ public:
     bool         rx_srcrip_enable(void)                  { return flag(SS_ENABLE_REC_SCRIPT); }
     void         rx_srcrip_enable(bool enable)           { flag(SS_ENABLE_REC_SCRIPT, enable); }
     QString      rx_script(void) const                   { return _rx_script; }
-    void         rx_script(const QString& script)        { _rx_script = script; }
+    void         rx_script(const QString& script)        { _rx_script = script; invalidate(); }
     QStringList& rx_script_args(void) const              { return *_rx_script_args; }
-    void         rx_script_args(const QStringList& args) { *_rx_script_args = args; }
+    void         rx_script_args(const QStringList& args) { *_rx_script_args = args; invalidate(); }
     QStringList  rx_default_script_args(void) const;
     QString      get_rx_command(const QString& satname, const double frequency, bool *error, int mode=0);
+    QString      receiver(void) const                    { return _receiver; }
+    void         receiver(const QString& r)              { _receiver = r; }
 
     bool         postproc_srcrip_enable(void)                  { return flag(SS_ENABLE_POSTPROC_SCRIPT); }
     void         postproc_srcrip_enable(bool enable)           { flag(SS_ENABLE_POSTPROC_SCRIPT, enable); }
     QString      postproc_script(void) const                   { return _postproc_script; }
-    void         postproc_script(const QString& script)        { _postproc_script = script; }
-    void         postproc_script_args(const QStringList& args) { *_postproc_script_args = args; }
+    void         postproc_script(const QString& script)        { _postproc_script = script; invalidate(); }
+    void         postproc_script_args(const QStringList& args) { *_postproc_script_args = args; invalidate(); }
     QStringList& postproc_script_args(void) const              { return *_postproc_script_args; }
     QStringList  postproc_default_script_args(void) const;
     QString      get_postproc_command(bool *error, int mode=0);
 
+    // compiles the scripts and creates the directories of a recording
+    // starting at dt, get_rx_command then only fills in the names and times
+    void         prepare(const QString& satname, const double frequency, const QDateTime& dt);
+
     QString      frames_filename(void) const { return _frames_filename; }
     QString      baseband_filename(void) const { return _baseband_filename; }
 
@@ -86,6 +94,8 @@ public:
     void readSettings(QSettings *reg, int modes=0);
     void writeSettings(QSettings *reg, int modes=0);
 
+    void compile(void);
+
 protected:
     void flag(int flag_, bool on);
     bool flag(int flag_);
@@ -97,7 +107,13 @@ protected:
     void free_private(void);
     int  get_list_index(QString arg, QStringList *sl);
 
-    QString getcommand(QString script, QStringList *args, bool *error, int mode);
+    void invalidate(void);
+    TScriptProgram *compile_program(const QString& script, QStringList *args);
+    bool    compile_argument(const QString& arg, TScriptArg *a);
+    QString run_argument(const TScriptArg *a, bool *error, int mode);
+    bool    findpath(const QString& path, bool verify);
+
+    QString getcommand(TScriptProgram *program, bool *error, int mode);
 
     QString parse_argument(QString arg, bool *error, int mode);
     int     getconstant_index(QString arg);
@@ -118,9 +134,12 @@ private:
 
     QString     _frames_filename, _baseband_filename;
     QStringList *constants, *commands;
-    QString     _satname;
+    QString     _satname, _receiver, _freqstr;
     double      _frequency;
 
+    // compiled scripts, NULL until compile()
+    TScriptProgram *rx_program, *postproc_program;
+
     QDateTime  now;
     char       *tmpstr;
 
@@ -0,0 +1,726 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <QtGlobal>
+
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#endif
+
+#include "sgp4batch.h"
+#include "satcalc.h"
+
+//---------------------------------------------------------------------------
+/*
+  The propagation is TSat::SGP4 without the velocity. The terms SGP4
+  drops for the "simple" (perigee < 220 km) element sets are zeroed in
+  the tables, so all near earth element sets share the same equations and
+  can be propagated side by side in the SIMD lanes.
+*/
+//---------------------------------------------------------------------------
+static inline double fmod2p(double x)
+{
+    return x - twopi*floor(x/twopi);
+}
+
+//---------------------------------------------------------------------------
+static inline double thetag_jd(double jd)
+{
+ double ut, tu, gmst;
+
+    ut   = jd + 0.5 - floor(jd + 0.5);
+    jd   = jd - ut;
+    tu   = (jd - 2451545.0)/36525;
+    gmst = 24110.54841 + tu*(8640184.812866 + tu*(0.093104 - tu*6.2E-6));
+    gmst = gmst + secday*omega_E*ut;
+    gmst = gmst - secday*floor(gmst/secday);
+
+ return twopi*gmst/secday;
+}
+
+//---------------------------------------------------------------------------
+TSGP4Batch::TSGP4Batch(void)
+{
+ double **tab[SB_TABLES];
+ int    i, n;
+
+    num   = 0;
+    size  = 0;
+    flags = NULL;
+    deep  = NULL;
+
+    n = tables(tab);
+    for(i=0; i<n; i++)
+        *tab[i] = NULL;
+}
+
+//---------------------------------------------------------------------------
+TSGP4Batch::~TSGP4Batch(void)
+{
+ double **tab[SB_TABLES];
+ int    i, n;
+
+    clear();
+
+    n = tables(tab);
+    for(i=0; i<n; i++)
+        if(*tab[i])
+            free(*tab[i]);
+
+    if(flags)
+        free(flags);
+    if(deep)
+        free(deep);
+}
+
+//---------------------------------------------------------------------------
+int TSGP4Batch::tables(double ***tab)
+{
+    double **t[] = { &epoch, &xmo, &omegao, &xnodeo, &eo, &xincl, &bstar,
+                     &aodp, &xnodp, &xmdot, &omgdot, &xnodot, &xnodcf,
+                     &c1, &c4, &c5, &d2, &d3, &d4, &t2cof, &t3cof, &t4cof, &t5cof,
+                     &omgcof, &xmcof, &eta, &delmo, &sinmo, &xlcof, &aycof,
+                     &cosio, &sinio, &x3thm1, &x1mth2, &x7thm1 };
+
+    memcpy(tab, t, sizeof(t));
+
+ return sizeof(t) / sizeof(t[0]);
+}
+
+//---------------------------------------------------------------------------
+void TSGP4Batch::clear(void)
+{
+ int i;
+
+    for(i=0; i<num; i++)
+        if(deep[i])
+            delete deep[i];
+
+    num = 0;
+}
+
+//---------------------------------------------------------------------------
+bool TSGP4Batch::alloc(int n)
+{
+ double **tab[SB_TABLES];
+ void   *tmp;
+ int    i, k;
+
+    if(n <= size)
+        return true;
+
+    k = tables(tab);
+    for(i=0; i<k; i++) {
+        tmp = realloc(*tab[i], n * sizeof(double));
+        if(tmp == NULL)
+            return false;
+        *tab[i] = (double *) tmp;
+    }
+
+    tmp = realloc(flags, n * sizeof(int));
+    if(tmp == NULL)
+        return false;
+    flags = (int *) tmp;
+
+    tmp = realloc(deep, n * sizeof(TSat *));
+    if(tmp == NULL)
+        return false;
+    deep = (TSat **) tmp;
+
+    size = n;
+
+ return true;
+}
+
+//---------------------------------------------------------------------------
+int TSGP4Batch::add(TSat *sat)
+{
+ double   **tab[SB_TABLES];
+ vector_t pos, vel;
+ TSat     *s;
+ int      i, k, n;
+
+    if(num >= size && !alloc(size + 64)) {
+        qDebug("[%s:%d] out of memory", __FILE__, __LINE__);
+        return -1;
+    }
+
+    s = new TSat(sat);
+    if(!s->isFlagSet(INITIALIZED_FLAG)) {
+        delete s;
+        return -1;
+    }
+
+    i = num;
+    n = tables(tab);
+    for(k=0; k<n; k++)
+        (*tab[k])[i] = 0;
+
+    epoch[i] = s->Julian_Date_of_Epoch(s->tle.epoch);
+
+    if(s->isFlagSet(DEEP_SPACE_EPHEM_FLAG)) {
+        flags[i] = SB_DEEP;
+        deep[i]  = s;
+
+        return num++;
+    }
+
+    // initializes the SGP4 constants
+    s->SGP4(0, &s->tle, &pos, &vel);
+
+    xmo[i]    = s->tle.xmo;
+    omegao[i] = s->tle.omegao;
+    xnodeo[i] = s->tle.xnodeo;
+    eo[i]     = s->tle.eo;
+    xincl[i]  = s->tle.xincl;
+    bstar[i]  = s->tle.bstar;
+
+    aodp[i]   = s->aodp;
+    xnodp[i]  = s->xnodp;
+    xmdot[i]  = s->xmdot;
+    omgdot[i] = s->omgdot;
+    xnodot[i] = s->xnodot;
+    xnodcf[i] = s->xnodcf;
+    c1[i]     = s->c1;
+    c4[i]     = s->c4;
+    t2cof[i]  = s->t2cof;
+    delmo[i]  = s->delmo;
+    sinmo[i]  = s->sinmo;
+    eta[i]    = s->eta;
+    xlcof[i]  = s->xlcof;
+    aycof[i]  = s->aycof;
+    cosio[i]  = s->cosio;
+    sinio[i]  = s->sinio;
+    x3thm1[i] = s->x3thm1;
+    x1mth2[i] = s->x1mth2;
+    x7thm1[i] = s->x7thm1;
+
+    if(!s->isFlagSet(SIMPLE_FLAG)) {
+        c5[i]     = s->c5;
+        d2[i]     = s->d2;
+        d3[i]     = s->d3;
+        d4[i]     = s->d4;
+        t3cof[i]  = s->t3cof;
+        t4cof[i]  = s->t4cof;
+        t5cof[i]  = s->t5cof;
+        omgcof[i] = s->omgcof;
+        xmcof[i]  = s->xmcof;
+    }
+
+    flags[i] = 0;
+    deep[i]  = NULL;
+
+    delete s;
+
+ return num++;
+}
+
+//---------------------------------------------------------------------------
+void TSGP4Batch::propagate(const int *set, const double *daynum, int n, double *x, double *y, double *z)
+{
+ int i, s;
+
+#if defined(__AVX2__)
+
+ int    lane[SB_LANES], lset[SB_LANES], k, l;
+ double ldn[SB_LANES], lx[SB_LANES], ly[SB_LANES], lz[SB_LANES];
+
+    // one more round after the last pair flushes the lanes still filled
+    for(i=0, l=0; i<n || l>0; i++) {
+        if(i < n) {
+            s = set[i];
+            if(flags[s] & SB_DEEP) {
+                propagate1(s, daynum[i], &x[i], &y[i], &z[i]);
+                continue;
+            }
+
+            lane[l] = i;
+            lset[l] = s;
+            ldn[l]  = daynum[i];
+
+            if(++l < SB_LANES)
+                continue;
+        }
+
+        // pad the last block with the first lane
+        for(k=l; k<SB_LANES; k++) {
+            lset[k] = lset[0];
+            ldn[k]  = ldn[0];
+        }
+
+        propagate4(lset, ldn, lx, ly, lz);
+
+        for(k=0; k<l; k++) {
+            x[lane[k]] = lx[k];
+            y[lane[k]] = ly[k];
+            z[lane[k]] = lz[k];
+        }
+
+        l = 0;
+    }
+
+#else
+
+    for(i=0; i<n; i++) {
+        s = set[i];
+        propagate1(s, daynum[i], &x[i], &y[i], &z[i]);
+    }
+
+#endif
+}
+
+//---------------------------------------------------------------------------
+void TSGP4Batch::propagate1(int s, double daynum, double *x, double *y, double *z)
+{
+ double tsince, xmdf, omgadf, xnoddf, tsq, tcube, tfour, xnode, delm, temp,
+        xmp, omega, tempa, tempe, templ, a, e, xl, beta, axn, xll, aynl, xlt,
+        ayn, capu, temp1, temp2, temp3, temp4, temp5, temp6, sinepw, cosepw,
+        epw, ecose, esine, elsq, pl, r, betal, cosu, sinu, u, sin2u, cos2u,
+        rk, uk, xnodek, xinck, sinuk, cosuk, sinik, cosik, sinnok, cosnok,
+        xmx, xmy;
+ vector_t pos, vel;
+ int      i;
+
+    tsince = (daynum + 2444238.5 - epoch[s])*xmnpda;
+
+    if(flags[s] & SB_DEEP) {
+        deep[s]->SDP4(tsince, &deep[s]->tle, &pos, &vel);
+        deep[s]->Convert_Sat_State(&pos, &vel);
+
+        *x = pos.x;
+        *y = pos.y;
+        *z = pos.z;
+
+        return;
+    }
+
+    /* Update for secular gravity and atmospheric drag. */
+    xmdf   = xmo[s] + xmdot[s]*tsince;
+    omgadf = omegao[s] + omgdot[s]*tsince;
+    xnoddf = xnodeo[s] + xnodot[s]*tsince;
+    tsq    = tsince*tsince;
+    tcube  = tsq*tsince;
+    tfour  = tsince*tcube;
+    xnode  = xnoddf + xnodcf[s]*tsq;
+
+    temp   = 1.0 + eta[s]*cos(xmdf);
+    delm   = xmcof[s]*(temp*temp*temp - delmo[s]);
+    temp   = omgcof[s]*tsince + delm;
+    xmp    = xmdf + temp;
+    omega  = omgadf - temp;
+    tempa  = 1.0 - c1[s]*tsince - d2[s]*tsq - d3[s]*tcube - d4[s]*tfour;
+    tempe  = bstar[s]*c4[s]*tsince + bstar[s]*c5[s]*(sin(xmp) - sinmo[s]);
+    templ  = t2cof[s]*tsq + t3cof[s]*tcube + tfour*(t4cof[s] + tsince*t5cof[s]);
+
+    a    = aodp[s]*tempa*tempa;
+    e    = eo[s] - tempe;
+    xl   = xmp + omega + xnode + xnodp[s]*templ;
+    beta = sqrt(1.0 - e*e);
+
+    /* Long period periodics */
+    axn  = e*cos(omega);
+    temp = 1.0/(a*beta*beta);
+    xll  = temp*xlcof[s]*axn;
+    aynl = temp*aycof[s];
+    xlt  = xl + xll;
+    ayn  = e*sin(omega) + aynl;
+
+    /* Solve Kepler's Equation */
+    capu  = fmod2p(xlt - xnode);
+    temp2 = capu;
+    i = 0;
+    do {
+        sinepw = sin(temp2);
+        cosepw = cos(temp2);
+        temp3  = axn*sinepw;
+        temp4  = ayn*cosepw;
+        temp5  = axn*cosepw;
+        temp6  = ayn*sinepw;
+        epw    = (capu - temp4 + temp3 - temp2)/(1.0 - temp5 - temp6) + temp2;
+
+        if(fabs(epw - temp2) <= e6a)
+            break;
+
+        temp2 = epw;
+
+    } while(i++ < 10);
+
+    /* Short period preliminary quantities */
+    ecose = temp5 + temp6;
+    esine = temp3 - temp4;
+    elsq  = axn*axn + ayn*ayn;
+    temp  = 1.0 - elsq;
+    pl    = a*temp;
+    r     = a*(1.0 - ecose);
+    temp1 = 1.0/r;
+    temp2 = a*temp1;
+    betal = sqrt(temp);
+    temp3 = 1.0/(1.0 + betal);
+    cosu  = temp2*(cosepw - axn + ayn*esine*temp3);
+    sinu  = temp2*(sinepw - ayn - axn*esine*temp3);
+    u     = atan2(sinu, cosu);
+    sin2u = 2.0*sinu*cosu;
+    cos2u = 2.0*cosu*cosu - 1.0;
+    temp  = 1.0/pl;
+    temp1 = ck2*temp;
+    temp2 = temp1*temp;
+
+    /* Update for short periodics */
+    rk     = r*(1.0 - 1.5*temp2*betal*x3thm1[s]) + 0.5*temp1*x1mth2[s]*cos2u;
+    uk     = u - 0.25*temp2*x7thm1[s]*sin2u;
+    xnodek = xnode + 1.5*temp2*cosio[s]*sin2u;
+    xinck  = xincl[s] + 1.5*temp2*cosio[s]*sinio[s]*cos2u;
+
+    /* Orientation vectors */
+    sinuk  = sin(uk);
+    cosuk  = cos(uk);
+    sinik  = sin(xinck);
+    cosik  = cos(xinck);
+    sinnok = sin(xnodek);
+    cosnok = cos(xnodek);
+    xmx    = -sinnok*cosik;
+    xmy    = cosnok*cosik;
+
+    rk *= xkmper;
+
+    *x = rk*(xmx*sinuk + cosnok*cosuk);
+    *y = rk*(xmy*sinuk + sinnok*cosuk);
+    *z = rk*sinik*sinuk;
+}
+
+#if defined(__AVX2__)
+
+//---------------------------------------------------------------------------
+//
+//      AVX2 lanes
+//
+//---------------------------------------------------------------------------
+typedef __m256d v4d;
+
+static inline v4d vset(double a)       { return _mm256_set1_pd(a); }
+static inline v4d vadd(v4d a, v4d b)   { return _mm256_add_pd(a, b); }
+static inline v4d vsub(v4d a, v4d b)   { return _mm256_sub_pd(a, b); }
+static inline v4d vmul(v4d a, v4d b)   { return _mm256_mul_pd(a, b); }
+static inline v4d vdiv(v4d a, v4d b)   { return _mm256_div_pd(a, b); }
+static inline v4d vsqrt(v4d a)         { return _mm256_sqrt_pd(a); }
+static inline v4d vabs(v4d a)          { return _mm256_andnot_pd(vset(-0.0), a); }
+static inline v4d vfloor(v4d a)        { return _mm256_floor_pd(a); }
+static inline v4d vsel(v4d m, v4d a, v4d b) { return _mm256_blendv_pd(b, a, m); }
+static inline v4d vcmp_lt(v4d a, v4d b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+static inline v4d vcmp_le(v4d a, v4d b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+static inline v4d vcmp_eq(v4d a, v4d b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+
+//---------------------------------------------------------------------------
+// sine and cosine, Cody-Waite reduction by pi/2 and the fdlibm kernels
+static inline void vsincos(v4d x, v4d *s, v4d *c)
+{
+ v4d n, r, z, ps, pc, q, swap, t;
+
+    n = _mm256_round_pd(vmul(x, vset(2.0/M_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+
+    r = vsub(x, vmul(n, vset(1.57079632673412561417e+00)));
+    r = vsub(r, vmul(n, vset(6.07710050630396597660e-11)));
+    r = vsub(r, vmul(n, vset(2.02226624879595063154e-21)));
+    z = vmul(r, r);
+
+    ps = vadd(vset(-2.50507602534068634195e-08), vmul(z, vset(1.58969099521155010221e-10)));
+    ps = vadd(vset( 2.75573137070700676789e-06), vmul(z, ps));
+    ps = vadd(vset(-1.98412698298579493134e-04), vmul(z, ps));
+    ps = vadd(vset( 8.33333333332248946124e-03), vmul(z, ps));
+    ps = vadd(vset(-1.66666666666666324348e-01), vmul(z, ps));
+    ps = vadd(r, vmul(vmul(r, z), ps));
+
+    pc = vadd(vset( 2.08757232129817482790e-09), vmul(z, vset(-1.13596475577881948265e-11)));
+    pc = vadd(vset(-2.75573143513906633035e-07), vmul(z, pc));
+    pc = vadd(vset( 2.48015872894767294178e-05), vmul(z, pc));
+    pc = vadd(vset(-1.38888888888741095749e-03), vmul(z, pc));
+    pc = vadd(vset( 4.16666666666666019037e-02), vmul(z, pc));
+    pc = vadd(vsub(vset(1.0), vmul(vset(0.5), z)), vmul(vmul(z, z), pc));
+
+    // quadrant 0...3
+    q = vsub(n, vmul(vset(4.0), vfloor(vmul(n, vset(0.25)))));
+
+    swap = _mm256_or_pd(vcmp_eq(q, vset(1.0)), vcmp_eq(q, vset(3.0)));
+    t    = vsel(swap, pc, ps);
+    pc   = vsel(swap, ps, pc);
+    ps   = t;
+
+    *s = vsel(vcmp_le(vset(2.0), q), vsub(vset(0.0), ps), ps);
+    *c = vsel(_mm256_or_pd(vcmp_eq(q, vset(1.0)), vcmp_eq(q, vset(2.0))), vsub(vset(0.0), pc), pc);
+}
+
+//---------------------------------------------------------------------------
+// arc tangent, cephes atan
+static inline v4d vatan(v4d x)
+{
+ v4d sign, y, z, p, q, m1, m2, more;
+
+    sign = _mm256_and_pd(x, vset(-0.0));
+    x    = vabs(x);
+
+    m1 = vcmp_lt(vset(2.41421356237309504880), x);  // tan(3pi/8)
+    m2 = _mm256_andnot_pd(m1, vcmp_lt(vset(0.66), x));
+
+    y    = vsel(m1, vset(M_PI_2), vsel(m2, vset(M_PI_4), vset(0.0)));
+    more = vsel(m1, vset(6.123233995736765886130E-17), vsel(m2, vset(3.061616997868382943065E-17), vset(0.0)));
+    x    = vsel(m1, vdiv(vset(-1.0), x), vsel(m2, vdiv(vsub(x, vset(1.0)), vadd(x, vset(1.0))), x));
+
+    z = vmul(x, x);
+
+    p = vadd(vmul(z, vset(-8.750608600031904122785E-1)), vset(-1.615753718733365076637E1));
+    p = vadd(vmul(z, p), vset(-7.500855792314704667340E1));
+    p = vadd(vmul(z, p), vset(-1.228866684490136173410E2));
+    p = vadd(vmul(z, p), vset(-6.485021904942025371773E1));
+
+    q = vadd(z, vset(2.485846490142306297962E1));
+    q = vadd(vmul(z, q), vset(1.650270098316988542046E2));
+    q = vadd(vmul(z, q), vset(4.328810604912902668951E2));
+    q = vadd(vmul(z, q), vset(4.853903996359136964868E2));
+    q = vadd(vmul(z, q), vset(1.945506571482613964425E2));
+
+    z = vadd(vmul(x, vdiv(vmul(z, p), q)), x);
+    y = vadd(y, vadd(z, more));
+
+ return _mm256_or_pd(y, sign);
+}
+
+//---------------------------------------------------------------------------
+#define VLOAD(t)    _mm256_i32gather_pd(t, idx, 8)
+
+void TSGP4Batch::propagate4(const int *set, const double *daynum, double *x, double *y, double *z)
+{
+ __m128i idx = _mm_loadu_si128((const __m128i *) set);
+ v4d tsince, xmdf, omgadf, xnoddf, tsq, tcube, tfour, xnode, delm, temp,
+     xmp, omega, tempa, tempe, templ, a, e, xl, beta, axn, xll, aynl, xlt,
+     ayn, capu, temp1, temp2, temp3, temp4, temp5, temp6, sinepw, cosepw,
+     epw, ecose, esine, elsq, pl, r, betal, cosu, sinu, u, sin2u, cos2u,
+     rk, uk, xnodek, xinck, sinuk, cosuk, sinik, cosik, sinnok, cosnok,
+     xmx, xmy, sn, cs, t3, t4, t5, t6, done, conv, one, s_bstar;
+ int i;
+
+    one = vset(1.0);
+
+    tsince = vmul(vsub(vadd(_mm256_loadu_pd(daynum), vset(2444238.5)), VLOAD(epoch)), vset(xmnpda));
+
+    /* Update for secular gravity and atmospheric drag. */
+    xmdf   = vadd(VLOAD(xmo), vmul(VLOAD(xmdot), tsince));
+    omgadf = vadd(VLOAD(omegao), vmul(VLOAD(omgdot), tsince));
+    xnoddf = vadd(VLOAD(xnodeo), vmul(VLOAD(xnodot), tsince));
+    tsq    = vmul(tsince, tsince);
+    tcube  = vmul(tsq, tsince);
+    tfour  = vmul(tsince, tcube);
+    xnode  = vadd(xnoddf, vmul(VLOAD(xnodcf), tsq));
+
+    vsincos(xmdf, &sn, &cs);
+    temp   = vadd(one, vmul(VLOAD(eta), cs));
+    delm   = vmul(VLOAD(xmcof), vsub(vmul(vmul(temp, temp), temp), VLOAD(delmo)));
+    temp   = vadd(vmul(VLOAD(omgcof), tsince), delm);
+    xmp    = vadd(xmdf, temp);
+    omega  = vsub(omgadf, temp);
+
+    tempa  = vsub(one, vmul(VLOAD(c1), tsince));
+    tempa  = vsub(tempa, vmul(VLOAD(d2), tsq));
+    tempa  = vsub(tempa, vmul(VLOAD(d3), tcube));
+    tempa  = vsub(tempa, vmul(VLOAD(d4), tfour));
+
+    vsincos(xmp, &sn, &cs);
+    s_bstar = VLOAD(bstar);
+    tempe  = vadd(vmul(vmul(s_bstar, VLOAD(c4)), tsince),
+                  vmul(vmul(s_bstar, VLOAD(c5)), vsub(sn, VLOAD(sinmo))));
+
+    templ  = vadd(vmul(VLOAD(t2cof), tsq), vmul(VLOAD(t3cof), tcube));
+    templ  = vadd(templ, vmul(tfour, vadd(VLOAD(t4cof), vmul(tsince, VLOAD(t5cof)))));
+
+    a    = vmul(VLOAD(aodp), vmul(tempa, tempa));
+    e    = vsub(VLOAD(eo), tempe);
+    xl   = vadd(vadd(vadd(xmp, omega), xnode), vmul(VLOAD(xnodp), templ));
+    beta = vsqrt(vsub(one, vmul(e, e)));
+
+    /* Long period periodics */
+    vsincos(omega, &sn, &cs);
+    axn  = vmul(e, cs);
+    temp = vdiv(one, vmul(a, vmul(beta, beta)));
+    xll  = vmul(vmul(temp, VLOAD(xlcof)), axn);
+    aynl = vmul(temp, VLOAD(aycof));
+    xlt  = vadd(xl, xll);
+    ayn  = vadd(vmul(e, sn), aynl);
+
+    /* Solve Kepler's Equation, converged lanes keep their values */
+    capu  = vsub(xlt, xnode);
+    capu  = vsub(capu, vmul(vset(twopi), vfloor(vdiv(capu, vset(twopi)))));
+    temp2 = capu;
+    done  = _mm256_setzero_pd();
+    sinepw = cosepw = temp3 = temp4 = temp5 = temp6 = done;
+
+    for(i=0; i<=10; i++) {
+        vsincos(temp2, &sn, &cs);
+        t3  = vmul(axn, sn);
+        t4  = vmul(ayn, cs);
+        t5  = vmul(axn, cs);
+        t6  = vmul(ayn, sn);
+        epw = vadd(vdiv(vadd(vsub(capu, t4), vsub(t3, temp2)), vsub(vsub(one, t5), t6)), temp2);
+
+        sinepw = vsel(done, sinepw, sn);
+        cosepw = vsel(done, cosepw, cs);
+        temp3  = vsel(done, temp3, t3);
+        temp4  = vsel(done, temp4, t4);
+        temp5  = vsel(done, temp5, t5);
+        temp6  = vsel(done, temp6, t6);
+
+        conv  = vcmp_le(vabs(vsub(epw, temp2)), vset(e6a));
+        temp2 = vsel(_mm256_or_pd(done, conv), temp2, epw);
+        done  = _mm256_or_pd(done, conv);
+
+        if(_mm256_movemask_pd(done) == 0xf)
+            break;
+    }
+
+    /* Short period preliminary quantities */
+    ecose = vadd(temp5, temp6);
+    esine = vsub(temp3, temp4);
+    elsq  = vadd(vmul(axn, axn), vmul(ayn, ayn));
+    temp  = vsub(one, elsq);
+    pl    = vmul(a, temp);
+    r     = vmul(a, vsub(one, ecose));
+    temp1 = vdiv(one, r);
+    temp2 = vmul(a, temp1);
+    betal = vsqrt(temp);
+    temp3 = vdiv(one, vadd(one, betal));
+    cosu  = vmul(temp2, vadd(vsub(cosepw, axn), vmul(vmul(ayn, esine), temp3)));
+    sinu  = vmul(temp2, vsub(vsub(sinepw, ayn), vmul(vmul(axn, esine), temp3)));
+
+    // atan2 modulo 2pi is enough here, u is only used through sin and cos
+    u     = vatan(vdiv(sinu, cosu));
+    u     = vadd(u, vsel(vcmp_lt(cosu, vset(0.0)), vset(pi), vset(0.0)));
+    sin2u = vmul(vset(2.0), vmul(sinu, cosu));
+    cos2u = vsub(vmul(vset(2.0), vmul(cosu, cosu)), one);
+    temp  = vdiv(one, pl);
+    temp1 = vmul(vset(ck2), temp);
+    temp2 = vmul(temp1, temp);
+
+    /* Update for short periodics */
+    rk     = vmul(r, vsub(one, vmul(vmul(vset(1.5), temp2), vmul(betal, VLOAD(x3thm1)))));
+    rk     = vadd(rk, vmul(vmul(vset(0.5), temp1), vmul(VLOAD(x1mth2), cos2u)));
+    uk     = vsub(u, vmul(vmul(vset(0.25), temp2), vmul(VLOAD(x7thm1), sin2u)));
+    xnodek = vadd(xnode, vmul(vmul(vset(1.5), temp2), vmul(VLOAD(cosio), sin2u)));
+    xinck  = vadd(VLOAD(xincl), vmul(vmul(vset(1.5), temp2), vmul(vmul(VLOAD(cosio), VLOAD(sinio)), cos2u)));
+
+    /* Orientation vectors */
+    vsincos(uk, &sinuk, &cosuk);
+    vsincos(xinck, &sinik, &cosik);
+    vsincos(xnodek, &sinnok, &cosnok);
+    xmx = vmul(vsub(vset(0.0), sinnok), cosik);
+    xmy = vmul(cosnok, cosik);
+
+    rk = vmul(rk, vset(xkmper));
+
+    _mm256_storeu_pd(x, vmul(rk, vadd(vmul(xmx, sinuk), vmul(cosnok, cosuk))));
+    _mm256_storeu_pd(y, vmul(rk, vadd(vmul(xmy, sinuk), vmul(sinnok, cosuk))));
+    _mm256_storeu_pd(z, vmul(rk, vmul(sinik, sinuk)));
+}
+
+#undef VLOAD
+
+#endif // __AVX2__
+
+//---------------------------------------------------------------------------
+void TSGP4Batch::elevation(const int *set, const double *daynum, int n, const geodetic_t *obs, double *ele)
+{
+ double px[SB_CHUNK], py[SB_CHUNK], pz[SB_CHUNK];
+ double sin_lat, cos_lat, sin_theta, cos_theta, c, sq, achcp, ozz,
+        theta, rx, ry, rz, rw, top_z;
+ int    i, k, m;
+
+    sin_lat = sin(obs->lat);
+    cos_lat = cos(obs->lat);
+
+    // observer, see TSat::Calculate_User_PosVel
+    c     = 1.0/sqrt(1.0 + flat*(flat - 2.0)*sin_lat*sin_lat);
+    sq    = (1.0 - flat)*(1.0 - flat)*c;
+    achcp = (xkmper*c + obs->alt)*cos_lat;
+    ozz   = (xkmper*sq + obs->alt)*sin_lat;
+
+    for(k=0; k<n; k+=SB_CHUNK) {
+        m = n - k < SB_CHUNK ? n - k:SB_CHUNK;
+
+        propagate(set + k, daynum + k, m, px, py, pz);
+
+        for(i=0; i<m; i++) {
+            theta     = fmod2p(thetag_jd(daynum[k + i] + 2444238.5) + obs->lon);
+            sin_theta = sin(theta);
+            cos_theta = cos(theta);
+
+            rx = px[i] - achcp*cos_theta;
+            ry = py[i] - achcp*sin_theta;
+            rz = pz[i] - ozz;
+            rw = sqrt(rx*rx + ry*ry + rz*rz);
+
+            top_z = cos_lat*cos_theta*rx + cos_lat*sin_theta*ry + sin_lat*rz;
+
+            ele[k + i] = asin(top_z/rw)/deg2rad;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+int TSGP4Batch::screen(const geodetic_t *obs, double from, double to, double step, bool *visible)
+{
+ int    sets[SB_CHUNK];
+ double times[SB_CHUNK], ele[SB_CHUNK];
+ int    s, i, k, m, samples, count;
+
+    if(step <= 0 || to < from)
+        return 0;
+
+    samples = (int) ((to - from)/step) + 1;
+    count = 0;
+
+    for(s=0; s<num; s++) {
+        visible[s] = false;
+
+        for(k=0; k<samples && !visible[s]; k+=SB_CHUNK) {
+            m = samples - k < SB_CHUNK ? samples - k:SB_CHUNK;
+
+            for(i=0; i<m; i++) {
+                sets[i]  = s;
+                times[i] = from + (k + i)*step;
+            }
+
+            elevation(sets, times, m, obs, ele);
+
+            for(i=0; i<m; i++)
+                if(ele[i] >= 0.0) {
+                    visible[s] = true;
+                    break;
+                }
+        }
+
+        if(visible[s])
+            count++;
+    }
+
+ return count;
+}
+
+//---------------------------------------------------------------------------
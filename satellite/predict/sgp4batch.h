@@ -0,0 +1,83 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef SGP4BATCH_H
+#define SGP4BATCH_H
+
+#include "Satellite.h"
+
+//---------------------------------------------------------------------------
+#define SB_DEEP         1       // SDP4 element set, propagated by a TSat copy
+
+#define SB_LANES        4       // doubles per AVX2 register
+#define SB_CHUNK        1024    // pairs propagated per block in elevation()
+#define SB_TABLES       35      // element set tables
+
+//---------------------------------------------------------------------------
+// Batch SGP4 propagator. The initialized element sets of many satellites
+// are kept as structure of arrays and (element set, time) pairs are
+// propagated SB_LANES at a time when built with AVX2.
+// Deep space (SDP4) element sets fall back to TSat::SDP4.
+class TSGP4Batch
+{
+public:
+    TSGP4Batch(void);
+    ~TSGP4Batch(void);
+
+    void clear(void);
+
+    // adds the element set of sat, returns its index or -1 on failure
+    int  add(TSat *sat);
+    int  count(void) { return num; }
+    bool isDeep(int set) { return (flags[set] & SB_DEEP) ? true:false; }
+
+    // ECI positions in km of n (element set, daynum) pairs
+    void propagate(const int *set, const double *daynum, int n, double *x, double *y, double *z);
+
+    // elevations in degrees seen from obs, geodetic in radians and km as TSat::obs_geodetic
+    void elevation(const int *set, const double *daynum, int n, const geodetic_t *obs, double *ele);
+
+    // flags the element sets above the horizon at any sample from...to, step in days
+    // returns number of visible element sets
+    int  screen(const geodetic_t *obs, double from, double to, double step, bool *visible);
+
+protected:
+    bool alloc(int n);
+    int  tables(double ***tab);
+    void propagate1(int s, double daynum, double *x, double *y, double *z);
+#if defined(__AVX2__)
+    void propagate4(const int *set, const double *daynum, double *x, double *y, double *z);
+#endif
+
+private:
+    int    num, size;
+    int    *flags;
+    TSat   **deep;
+
+    // SGP4 element sets and initialized constants, one entry per element set
+    double *epoch, *xmo, *omegao, *xnodeo, *eo, *xincl, *bstar,
+           *aodp, *xnodp, *xmdot, *omgdot, *xnodot, *xnodcf,
+           *c1, *c4, *c5, *d2, *d3, *d4, *t2cof, *t3cof, *t4cof, *t5cof,
+           *omgcof, *xmcof, *eta, *delmo, *sinmo, *xlcof, *aycof,
+           *cosio, *sinio, *x3thm1, *x1mth2, *x7thm1;
+};
+
+#endif // SGP4BATCH_H
@@ -35,6 +35,10 @@ TSatProp::TSatProp(void)
     evilist = new PList;
 
     _decoderFlags = 0;
+    _iqRate = 0;
+    _iqFormat = 0;
+    _syncErrors = 3;
+    _priority = 1;
 }
 
 //---------------------------------------------------------------------------
@@ -65,6 +69,10 @@ TSatProp& TSatProp::operator = (TSatProp& src)
         evilist->Add(new TEVI(*((TEVI *) src.evilist->ItemAt(i))));
 
     _decoderFlags = src.decoderFlags();
+    _iqRate = src.iqRate();
+    _iqFormat = src.iqFormat();
+    _syncErrors = src.syncErrors();
+    _priority = src.priority();
 
     return *this;
 }
@@ -201,9 +209,16 @@ void TSatProp::readSettings(QSettings *reg)
 
     str = reg->value("Flags", "0").toString();
     _decoderFlags = str.toUInt();
+    _iqRate = reg->value("IQ-Rate", 0).toDouble();
+    _iqFormat = reg->value("IQ-Format", 0).toInt();
+    _syncErrors = reg->value("Sync-Errors", 3).toInt();
 
     reg->endGroup(); // Decoder
 
+    reg->beginGroup("Schedule");
+    priority(reg->value("Priority", 1).toInt());
+    reg->endGroup(); // Schedule
+
     rc = new TRGBConf;
     i = 0;
     reg->beginGroup("RGB-Conf");
@@ -266,9 +281,16 @@ void TSatProp::writeSettings(QSettings *reg)
     reg->beginGroup("Decoder");
 
     reg->setValue("Flags", decoderFlags());
+    reg->setValue("IQ-Rate", iqRate());
+    reg->setValue("IQ-Format", iqFormat());
+    reg->setValue("Sync-Errors", syncErrors());
 
     reg->endGroup(); // Decoder
 
+    reg->beginGroup("Schedule");
+    reg->setValue("Priority", priority());
+    reg->endGroup(); // Schedule
+
     reg->beginGroup("RGB-Conf");
 
     for(i=0; i<rgblist->Count; i++) {
@@ -465,6 +487,42 @@ bool TSatProp::syncCheck(void)
     return flagState(&_decoderFlags, DF_SYNCCHECK);
 }
 
+//---------------------------------------------------------------------------
+void TSatProp::viterbi(bool yes)
+{
+    flagState(&_decoderFlags, DF_VITERBI, yes);
+}
+
+//---------------------------------------------------------------------------
+bool TSatProp::viterbi(void)
+{
+    return flagState(&_decoderFlags, DF_VITERBI);
+}
+
+//---------------------------------------------------------------------------
+void TSatProp::deinterleave(bool yes)
+{
+    flagState(&_decoderFlags, DF_DEINTERLEAVE, yes);
+}
+
+//---------------------------------------------------------------------------
+bool TSatProp::deinterleave(void)
+{
+    return flagState(&_decoderFlags, DF_DEINTERLEAVE);
+}
+
+//---------------------------------------------------------------------------
+void TSatProp::demodulate(bool yes)
+{
+    flagState(&_decoderFlags, DF_DEMODULATE, yes);
+}
+
+//---------------------------------------------------------------------------
+bool TSatProp::demodulate(void)
+{
+    return flagState(&_decoderFlags, DF_DEMODULATE);
+}
+
 //---------------------------------------------------------------------------
 void TSatProp::flagState(unsigned int *flag, unsigned int bitmap, bool on)
 {
@@ -31,6 +31,9 @@
 #define DF_DERANDOMIZE  1
 #define DF_RSDECODE     2
 #define DF_SYNCCHECK    4
+#define DF_VITERBI      8   // input is soft symbols
+#define DF_DEINTERLEAVE 16  // METEOR LRPT interleaved soft symbols
+#define DF_DEMODULATE   32  // input is an IQ recording
 
 
 class QSettings;
@@ -73,6 +76,26 @@ public:
     bool rs_decode(void);
     void syncCheck(bool yes);
     bool syncCheck(void);
+    void viterbi(bool yes);
+    bool viterbi(void);
+    void deinterleave(bool yes);
+    bool deinterleave(void);
+    void demodulate(bool yes);
+    bool demodulate(void);
+
+    // IQ recording
+    void   iqRate(double rate) { _iqRate = rate; }
+    double iqRate(void) { return _iqRate; }
+    void   iqFormat(int format) { _iqFormat = format; }
+    int    iqFormat(void) { return _iqFormat; }
+
+    // max bit errors in a frame sync word
+    void   syncErrors(int errors) { _syncErrors = errors; }
+    int    syncErrors(void) { return _syncErrors; }
+
+    // weight in the pass schedule, 1 is the lowest
+    void   priority(int prio) { _priority = prio < 1 ? 1:prio; }
+    int    priority(void) { return _priority; }
 
     // general functions
     void check(int max_ch);
@@ -95,6 +118,10 @@ protected:
 
 private:
     unsigned int _decoderFlags;
+    double       _iqRate; // samples per second
+    int          _iqFormat;
+    int          _syncErrors;
+    int          _priority;
 
 };
 
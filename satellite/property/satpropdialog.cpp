@@ -156,6 +156,13 @@ void SatPropDialog::on_satlistWidget_itemClicked(QListWidgetItem* item)
     ui->derandCb->setChecked(selsat->sat_props->derandomize());
     ui->rsdecodeCb->setChecked(selsat->sat_props->rs_decode());
     ui->syncCheckCb->setChecked(selsat->sat_props->syncCheck());
+    ui->viterbiCb->setChecked(selsat->sat_props->viterbi());
+    ui->deinterleaveCb->setChecked(selsat->sat_props->deinterleave());
+    ui->demodCb->setChecked(selsat->sat_props->demodulate());
+    ui->iqFormatCb->setCurrentIndex(selsat->sat_props->iqFormat());
+    ui->iqRateSb->setValue(selsat->sat_props->iqRate() / 1000.0);
+    ui->syncErrorsSb->setValue(selsat->sat_props->syncErrors());
+    ui->prioritySb->setValue(selsat->sat_props->priority());
 }
 //---------------------------------------------------------------------------
 //
@@ -510,6 +517,13 @@ void SatPropDialog::on_applyDecoderBtn_clicked()
         sat->sat_props->derandomize(ui->derandCb->isChecked());
         sat->sat_props->rs_decode(ui->rsdecodeCb->isChecked());
         sat->sat_props->syncCheck(ui->syncCheckCb->isChecked());
+        sat->sat_props->viterbi(ui->viterbiCb->isChecked());
+        sat->sat_props->deinterleave(ui->deinterleaveCb->isChecked());
+        sat->sat_props->demodulate(ui->demodCb->isChecked());
+        sat->sat_props->iqFormat(ui->iqFormatCb->currentIndex());
+        sat->sat_props->iqRate(ui->iqRateSb->value() * 1000.0);
+        sat->sat_props->syncErrors(ui->syncErrorsSb->value());
+        sat->sat_props->priority(ui->prioritySb->value());
     }
 }
 
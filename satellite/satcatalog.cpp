@@ -0,0 +1,166 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include "satcatalog.h"
+#include "Satellite.h"
+#include "plist.h"
+
+static QMutex attach_mutex;
+
+//---------------------------------------------------------------------------
+TSatCatalog::TSatCatalog(PList *list_)
+{
+    list    = list_;
+    serial  = 0;
+    renamed = 0;
+    indexed = 0;
+    built   = false;
+}
+
+//---------------------------------------------------------------------------
+// the catalog of list, created on first use and deleted with the list
+TSatCatalog *TSatCatalog::of(PList *list)
+{
+    TSatCatalog *cat;
+
+    attach_mutex.lock();
+
+    if(list->Index == NULL) {
+        list->Index     = new TSatCatalog(list);
+        list->FreeIndex = destroy;
+    }
+
+    cat = (TSatCatalog *) list->Index;
+
+    attach_mutex.unlock();
+
+    return cat;
+}
+
+//---------------------------------------------------------------------------
+void TSatCatalog::destroy(void *catalog)
+{
+    delete (TSatCatalog *) catalog;
+}
+
+//---------------------------------------------------------------------------
+void TSatCatalog::invalidate(void)
+{
+    mutex.lock();
+    built = false;
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+// call with the mutex locked
+void TSatCatalog::check(void)
+{
+    if(built && serial == list->Serial)
+        return;
+
+    // every Add bumps Serial and Count by one, any other change bumps
+    // Serial without adding to Count
+    if(built && list->Serial - serial == (unsigned int) (list->Count - indexed))
+        insert(indexed);
+    else
+        rebuild();
+
+    serial = list->Serial;
+}
+
+//---------------------------------------------------------------------------
+void TSatCatalog::rebuild(void)
+{
+    byName.clear();
+    byCatnum.clear();
+
+    byName.reserve(list->Count);
+    byCatnum.reserve(list->Count);
+
+    insert(0);
+
+    renamed = TSat::renamed;
+    built   = true;
+}
+
+//---------------------------------------------------------------------------
+void TSatCatalog::insert(int from)
+{
+    TSat    *sat;
+    QString name;
+    int     i;
+
+    for(i=from; i<list->Count; i++) {
+        sat  = (TSat *) list->ItemAt(i);
+        name = sat->name;
+
+        // the first of duplicates wins as with a linear search
+        if(!byName.contains(name))
+            byName.insert(name, sat);
+        if(!byCatnum.contains(sat->catnum))
+            byCatnum.insert(sat->catnum, sat);
+    }
+
+    indexed = list->Count;
+}
+
+//---------------------------------------------------------------------------
+TSat *TSatCatalog::find(const QString &name)
+{
+    TSat *sat;
+
+    mutex.lock();
+
+    check();
+    sat = byName.value(name, NULL);
+
+    // renamed in place, the list itself did not change
+    if((sat && name != sat->name) || (sat == NULL && renamed != TSat::renamed)) {
+        rebuild();
+        sat = byName.value(name, NULL);
+    }
+
+    mutex.unlock();
+
+    return sat;
+}
+
+//---------------------------------------------------------------------------
+TSat *TSatCatalog::findCatnum(long catnum)
+{
+    TSat *sat;
+
+    mutex.lock();
+
+    check();
+    sat = byCatnum.value(catnum, NULL);
+
+    if((sat && sat->catnum != catnum) || (sat == NULL && renamed != TSat::renamed)) {
+        rebuild();
+        sat = byCatnum.value(catnum, NULL);
+    }
+
+    mutex.unlock();
+
+    return sat;
+}
+
+//---------------------------------------------------------------------------
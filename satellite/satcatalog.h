@@ -0,0 +1,71 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef SATCATALOG_H
+#define SATCATALOG_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+class PList;
+class TSat;
+
+//---------------------------------------------------------------------------
+// Name and NORAD number index over a satellite list, attached to the list
+// with of(). The TSat pointers are the handles, they stay valid while the
+// satellite is in the list. PList::Serial tells when the list changed,
+// appended satellites are indexed incrementally, anything else rebuilds.
+// Satellites renamed in place are caught by TSat::renamed on a miss and
+// by a name check on a hit.
+class TSatCatalog
+{
+public:
+    TSatCatalog(PList *list_);
+
+    static TSatCatalog *of(PList *list);
+
+    TSat  *find(const QString &name);
+    TSat  *findCatnum(long catnum);
+
+    void  invalidate(void);
+
+protected:
+    void  check(void);
+    void  rebuild(void);
+    void  insert(int from);
+
+    static void destroy(void *catalog);
+
+private:
+    PList *list;
+    QMutex mutex;
+
+    QHash<QString, TSat *> byName;
+    QHash<long, TSat *>    byCatnum;
+
+    unsigned int serial;
+    unsigned int renamed; // TSat::renamed at the last rebuild
+    int          indexed; // list items in the hashes
+    bool         built;
+};
+
+#endif // SATCATALOG_H
@@ -21,82 +21,91 @@
 //---------------------------------------------------------------------------
 #include <QString>
 #include <QDateTime>
+#include <QSettings>
 #include <stdlib.h>
+#include <math.h>
 
 #include "Satellite.h"
 #include "satutil.h"
 #include "plist.h"
+#include "satcatalog.h"
+#include "tleparser.h"
+#include "tlearchive.h"
+#include "passtable.h"
+#include "station.h"
+#include "simclock.h"
+#include "utils.h"
+#include "rig.h"
 
 //---------------------------------------------------------------------------
-int ReadTLE(FILE *fp, PList *list)
+// reads every element set in filename, a satellite already in list is
+// updated if the new elements are more recent
+int ReadTLE(const QString &filename, PList *list, const QString &cachepath)
 {
- TSat *tmpsat, *sat;
- char *name, *line1, *line2;
- int  count = 0;
+ TTLEParser parser;
+ const TTLERecord *rec;
+ TSat *sat;
+ int  i, count;
 
-  if(fp == NULL || list == NULL)
+  if(list == NULL)
       return 0;
 
-  name  = (char *) malloc(TLE_STRLEN + 1);
-  line1 = (char *) malloc(TLE_STRLEN + 1);
-  line2 = (char *) malloc(TLE_STRLEN + 1);
-
-  tmpsat = new TSat;
+  count = parser.read(filename, cachepath);
 
-  while(!feof(fp)) {
-     name[0]  = '\0';
-     line1[0] = '\0';
-     line2[0] = '\0';
+  for(i=0; i<count; i++) {
+     rec = parser.record(i);
 
-     tmpsat->Zero();
+     sat = getSat(list, rec->name);
+     if(sat) {
+         if(TTLEParser::epoch(rec->year, rec->refepoch) > TTLEParser::epoch(sat->year, sat->refepoch))
+             sat->SetElements(rec);
+     }
+     else {
+         sat = new TSat;
+         sat->SetElements(rec);
+         list->Add(sat);
+     }
+  }
 
-     if(!fgets(name, TLE_STRLEN, fp) || *name == '#' || strlen(name) < 2)
-         continue;
+ return count;
+}
 
-     if(!fgets(line1, TLE_STRLEN, fp))
-        break;
-     if(*line1 != '1')
-        continue;
-     if(!fgets(line2, TLE_STRLEN, fp) || *line2 != '2')
-        break;
-     if(!tmpsat->TLEKepCheck(name, line1, line2))
-        continue;
+//---------------------------------------------------------------------------
+// replaces the elements of sat with the archived element set nearest to
+// daynum, if it is closer to daynum than the current one
+bool ReadArchivedTLE(TSat *sat, double daynum, const QString &path)
+{
+ TTLEArchive arc(path);
+ TTLERecord  rec;
 
-     sat = getSat(list, tmpsat->name);
-     if(sat) {
-         if(tmpsat->GetKeplerIssuedDateTime() > sat->GetKeplerIssuedDateTime())
-           sat->TLEKepCheck(tmpsat->name, tmpsat->line1, tmpsat->line2);
-     }
-     else
-        list->Add(new TSat(tmpsat));
+  if(sat == NULL || !arc.open(sat->name) || !arc.nearest(daynum, &rec))
+      return false;
 
-     count++;
-  }
+  if(fabs(TTLEParser::epoch(rec.year, rec.refepoch) - daynum) >=
+     fabs(TTLEParser::epoch(sat->year, sat->refepoch) - daynum))
+      return false;
 
-  free(name);
-  free(line1);
-  free(line2);
-  delete tmpsat;
+  sat->SetElements(&rec);
 
- return count;
+ return true;
 }
 
 //---------------------------------------------------------------------------
 TSat *getSat(PList *list, const QString &name)
 {
- TSat *sat, *rc = NULL;
- int i;
-
  if(list == NULL || name.isEmpty())
      return NULL;
 
- for(i=0; i<list->Count && rc == NULL; i++) {
-    sat = (TSat *) list->ItemAt(i);
-    if(sat->name == name)
-        rc = sat;
- }
+ return TSatCatalog::of(list)->find(name);
+}
 
- return rc;
+//---------------------------------------------------------------------------
+TSat *getSatByCatnum(PList *list, long catnum)
+{
+ if(list == NULL)
+     return NULL;
+
+ return TSatCatalog::of(list)->findCatnum(catnum);
 }
 
 //---------------------------------------------------------------------------
@@ -118,3 +127,272 @@ void clearSatList(PList *list, int flags)
       list = NULL;
   }
 }
+//---------------------------------------------------------------------------
+// returns the number of satellites added, a satellite already in list is kept
+int ReadSatelliteIni(const QString &ini, PList *list, TStation *qth)
+{
+ QString   str, name, line1, line2;
+ int       i, count;
+ TSat      *sat;
+
+   QSettings reg(ini, QSettings::IniFormat);
+   sat = new TSat;
+
+   i = 1;
+   count = 0;
+   while(true) {
+      sat->Zero();
+      str.sprintf("Spacecraft_%d", i++);
+
+      reg.beginGroup(str);
+         name  = reg.value("Name",  "").toString();
+         line1 = reg.value("TLE_1", "").toString();
+         line2 = reg.value("TLE_2", "").toString();
+
+         if(name.isEmpty() || line1.isEmpty() || line2.isEmpty()) {
+             reg.endGroup();
+             break;
+         }
+
+      if(getSat(list, name)) {
+          reg.endGroup();
+          continue;
+      }
+
+      if(sat->TLEKepCheck((char *)name.toStdString().c_str(),
+                          (char *)line1.toStdString().c_str(),
+                          (char *)line2.toStdString().c_str()))
+      {
+          sat->AssignObsInfo(qth);
+          sat->sat_scripts->readSettings(&reg);
+          sat->sat_props->readSettings(&reg);
+          list->Add(new TSat(sat));
+          count++;
+      }
+
+      reg.endGroup();
+   }
+
+ delete sat;
+
+ return count;
+}
+
+//---------------------------------------------------------------------------
+// the next pass is the first one of the background pass table schedule,
+// the satellites are searched directly only until the table covers daynum_
+TSat *findNextSat(PList *satList, TPassTable *passTable, TRig *rig, double daynum_, int antenna)
+{
+ TSat   *sat;
+ TPass  pass;
+ char   name[TLE_NAMELEN+1];
+ double utc_daynum, now_utc_daynum;
+
+    if(satList == NULL || satList->Count == 0)
+        return NULL;
+
+    now_utc_daynum = TSimClock::daynum();
+    utc_daynum = daynum_ != 0 ? daynum_:now_utc_daynum;
+
+    passTable->update(satList, rig);
+
+    if(passTable->next(utc_daynum, now_utc_daynum, &pass, name, antenna)) {
+        sat = getSat(satList, name);
+        if(sat) {
+            sat->SetPass(pass.aostime, pass.tcatime, pass.lostime, pass.max_ele, pass.northbound);
+            sat->CheckThresholds(rig);
+
+            return sat;
+        }
+    }
+
+ return searchNextSat(satList, rig, daynum_);
+}
+
+//---------------------------------------------------------------------------
+TSat *searchNextSat(PList *satList, TRig *rig, double daynum_)
+{
+ TSat   *sat;
+ PList  *list;
+ double utc_daynum, now_utc_daynum, daynum;
+ TSat   *nextsat = NULL;
+ int    i, flags, ii, max_ii;
+
+    if(satList == NULL || satList->Count == 0)
+        return NULL;
+
+    QDateTime utc(TSimClock::utc());
+    now_utc_daynum = GetStartTime(utc);
+
+    if(daynum_ != 0)
+        utc_daynum = daynum_;
+    else
+        utc_daynum = now_utc_daynum;
+
+    list = new PList;
+    ii = 0;
+    max_ii = 144; // search 24 x 6 hours (6 days) forward
+
+    while(ii < max_ii) {
+        // get one satellite pass from each active satellite
+        for(i=0; i<satList->Count; i++) {
+            sat = (TSat *)satList->ItemAt(i);
+            if(!sat->isActive() || !sat->CalcAll(utc_daynum))
+                continue;
+
+#if 1
+            flags = 0;
+            // is it currently above qth?
+            if(sat->aostime < utc_daynum && sat->lostime > utc_daynum) {
+                sat->daynum = now_utc_daynum;
+                sat->Calc();
+
+                // is it approaching?
+                if(sat->get_range_rate() < 0)
+                    list->Add(sat);
+                else
+                    flags |= 1;
+            }
+            else if(sat->aostime >= utc_daynum)
+                list->Add(sat);
+
+
+            if(flags & 1) {
+                // find next orbit pass
+                while(sat->GetNextRiseTime(utc, 1) > 0) {
+                    if(!sat->CalcAll(sat->aostime))
+                        break;
+                    if(sat->aostime >= utc_daynum) {
+                        list->Add(sat);
+                        break;
+                    }
+                }
+            }
+#else
+            // is it currently above qth?
+            if(sat->aostime < utc_daynum && sat->lostime > utc_daynum)
+                list->Add(sat);
+            else if(sat->aostime >= utc_daynum)
+                list->Add(sat);
+            else {
+                // find next orbit pass
+                while(sat->GetNextRiseTime(utc, 1) > 0) {
+                    if(!sat->CalcAll(sat->aostime))
+                        break;
+                    if(sat->aostime >= utc_daynum) {
+                        list->Add(sat);
+                        break;
+                    }
+                }
+            }
+#endif
+        }
+
+        if(list->Count)
+            break;
+        else {
+            utc = utc.addSecs(60);
+            utc_daynum = GetStartTime(utc);
+            ii++;
+        }
+    }
+
+    // find the satellite that is closest to qth
+    daynum = 1e20;
+    nextsat = NULL;
+    for(i=0; i<list->Count; i++) {
+        sat = (TSat *) list->ItemAt(i);
+        if(sat->aostime < daynum) {
+            nextsat = sat;
+            daynum = sat->aostime;
+        }
+    }
+
+    // check if there is an overlap.
+    // if so select the satellite with higher elevation
+    if(nextsat) {
+        for(i=0; i<list->Count; i++) {
+            sat = (TSat *) list->ItemAt(i);
+            if(sat == nextsat)
+                continue;
+
+            if(sat->sat_max_ele > nextsat->sat_max_ele) {
+                // overlap check
+                flags = 0;
+                if(sat->aostime < nextsat->aostime) {
+                    // partial (happens before) || full overlap
+                    if(sat->lostime > nextsat->aostime || sat->lostime > nextsat->lostime)
+                        flags |= 1;
+                }
+                else if(sat->aostime < nextsat->lostime && sat->lostime > nextsat->lostime) {
+                    // partial overlap happens after
+                    flags |= 1;
+                }
+
+                if(flags & 1)
+                    nextsat = sat;
+            }
+        }
+
+        nextsat->CheckThresholds(rig);
+    }
+
+    delete list;
+
+    return nextsat;
+}
+
+//---------------------------------------------------------------------------
+// no need to check pass thresholds here, this toggled by the user
+TSat *findNextSatByName(PList *satList, const QString &name, double daynum_)
+{
+ TSat   *sat;
+ double utc_daynum, now_utc_daynum;
+ int    flags;
+
+    if(satList == NULL || satList->Count == 0 || name.isEmpty())
+        return NULL;
+
+    sat = getSat(satList, name);
+    if(sat == NULL)
+        return NULL;
+
+    QDateTime utc(TSimClock::utc());
+    now_utc_daynum = GetStartTime(utc);
+
+    if(daynum_ != 0)
+        utc_daynum = daynum_;
+    else
+        utc_daynum = now_utc_daynum;
+
+    if(!sat->CalcAll(utc_daynum))
+       return NULL;
+
+    flags = 0;
+    if(sat->aostime >= utc_daynum)
+        return sat;
+    // is it currently above my horizon?
+    if(sat->aostime <= utc_daynum && sat->lostime > utc_daynum) {
+        sat->daynum = now_utc_daynum;
+        sat->Calc();
+
+        // is it approaching?
+        if(sat->get_range_rate() < 0)
+            return sat;
+        else
+            flags |= 1;
+    }
+    else
+        flags |= 1;
+
+    if(flags & 1) {
+        while(sat->GetNextRiseTime(utc, 1) > 0) {
+           if(!sat->CalcAll(sat->aostime))
+              return NULL;
+           if(sat->aostime >= utc_daynum)
+              return sat;
+        }
+    }
+
+ return NULL;
+}
@@ -26,10 +26,24 @@
 
 class QString;
 class PList;
+class TSat;
+class TRig;
+class TStation;
+class TPassTable;
 
-int  ReadTLE(FILE *fp, PList *list);
+int  ReadTLE(const QString &filename, PList *list, const QString &cachepath);
+bool ReadArchivedTLE(TSat *sat, double daynum, const QString &path);
 TSat *getSat(PList *list, const QString &name);
+TSat *getSatByCatnum(PList *list, long catnum);
 
 void clearSatList(PList *list, int flags=0);
 
+// reads the satellites, scripts and properties of a conf/satellites.ini file
+int  ReadSatelliteIni(const QString &ini, PList *list, TStation *qth);
+
+// next pass of the active satellites in list after daynum_, 0 = now
+TSat *findNextSat(PList *satList, TPassTable *passTable, TRig *rig, double daynum_ = 0, int antenna = 0);
+TSat *searchNextSat(PList *satList, TRig *rig, double daynum_ = 0);
+TSat *findNextSatByName(PList *satList, const QString &name, double daynum_ = 0);
+
 #endif // SATUTIL_H
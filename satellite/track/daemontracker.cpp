@@ -0,0 +1,123 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QString>
+
+#include "daemontracker.h"
+#include "trackdaemon.h"
+#include "trackthread.h"
+#include "Satellite.h"
+#include "rig.h"
+
+//---------------------------------------------------------------------------
+TDaemonTracker::TDaemonTracker(TTrackDaemon *daemon_, int antenna_)
+{
+    daemon  = daemon_;
+    antenna = antenna_;
+    sat     = NULL;
+
+    thread = new TrackThread(this);
+}
+
+//---------------------------------------------------------------------------
+TDaemonTracker::~TDaemonTracker(void)
+{
+    stop();
+
+    delete thread;
+}
+
+//---------------------------------------------------------------------------
+bool TDaemonTracker::start(void)
+{
+    stop();
+
+    if(!getNextSatellite()) {
+        daemon->event(antenna, "error", "no active satellites found to track");
+        return false;
+    }
+
+    thread->start(QThread::IdlePriority);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void TDaemonTracker::stop(void)
+{
+    if(thread->isRunning()) {
+        thread->stop();
+        thread->wait();
+    }
+
+    if(sat)
+        delete sat;
+    sat = NULL;
+
+    daemon->releasePass(antenna);
+}
+
+//---------------------------------------------------------------------------
+bool TDaemonTracker::isRunning(void)
+{
+    return thread->isRunning();
+}
+
+//---------------------------------------------------------------------------
+TRig *TDaemonTracker::getRig(void)
+{
+    return daemon->getRig();
+}
+
+//---------------------------------------------------------------------------
+TSat *TDaemonTracker::getSatellite(void)
+{
+    if(sat)
+        sat->CheckThresholds(daemon->getRig());
+
+    return sat;
+}
+
+//---------------------------------------------------------------------------
+TSat *TDaemonTracker::getNextSatellite(void)
+{
+    TSat *next;
+
+    next = daemon->nextPass(sat ? sat->lostime:0, antenna);
+    if(next == NULL)
+        return NULL;
+
+    if(sat)
+        delete sat;
+    sat = next;
+
+    daemon->setPass(antenna, sat);
+
+    return sat;
+}
+
+//---------------------------------------------------------------------------
+void TDaemonTracker::trackEvent(const char *event, const QString &text)
+{
+    daemon->event(antenna, event, text);
+}
+
+//---------------------------------------------------------------------------
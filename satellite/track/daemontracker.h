@@ -0,0 +1,57 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef DAEMONTRACKER_H
+#define DAEMONTRACKER_H
+
+#include "trackhost.h"
+
+class TTrackDaemon;
+class TrackThread;
+
+//---------------------------------------------------------------------------
+// the track widget of one antenna without the widget, always tracks the
+// next pass of the antenna's schedule
+class TDaemonTracker : public TTrackHost
+{
+public:
+    TDaemonTracker(TTrackDaemon *daemon_, int antenna_);
+    ~TDaemonTracker(void);
+
+    bool start(void);
+    void stop(void);
+    bool isRunning(void);
+
+    TRig *getRig(void);
+    TSat *getSatellite(void);
+    TSat *getNextSatellite(void);
+    int  trackIndex(void) { return 0; }
+    int  antennaIndex(void) { return antenna; }
+    void trackEvent(const char *event, const QString &text);
+
+private:
+    TTrackDaemon *daemon;
+    TrackThread  *thread;
+    TSat         *sat;
+    int          antenna;
+};
+
+#endif // DAEMONTRACKER_H
@@ -0,0 +1,439 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QCoreApplication>
+#include <QSettings>
+#include <QFile>
+#include <QDir>
+#include <signal.h>
+#include <string.h>
+
+#ifdef Q_OS_UNIX
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#endif
+
+#include "trackdaemon.h"
+#include "daemontracker.h"
+#include "satutil.h"
+#include "passtable.h"
+#include "station.h"
+#include "simclock.h"
+#include "Satellite.h"
+#include "rig.h"
+#include "plist.h"
+#include "config.h"
+#include "version.h"
+
+static volatile sig_atomic_t td_signal = 0;
+
+//---------------------------------------------------------------------------
+static void td_sighandler(int sig)
+{
+    td_signal = sig;
+}
+
+//---------------------------------------------------------------------------
+TTrackDaemon::TTrackDaemon(void) : QThread(0)
+{
+ int i;
+
+    qth       = new TStation;
+    rig       = new TRig;
+    satList   = new PList;
+    passTable = new TPassTable;
+
+    for(i=0; i<AN_MAX; i++)
+        tracker[i] = NULL;
+
+    num_events = 0;
+    event_pos  = 0;
+    log        = NULL;
+    sockfd     = -1;
+    flags      = 0;
+}
+
+//---------------------------------------------------------------------------
+TTrackDaemon::~TTrackDaemon(void)
+{
+    close();
+
+    delete passTable;
+    clearSatList(satList, 1);
+    delete rig;
+    delete qth;
+}
+
+//---------------------------------------------------------------------------
+bool TTrackDaemon::open(void)
+{
+ QSettings reg(VER_COMPANYNAME_STR, VER_SWNAME_STR);
+ QString   path, ini;
+ int       i;
+
+    close();
+
+    path = QCoreApplication::applicationDirPath();
+
+    // same order as MainWindow::readSettings
+    qth->readSettings(&reg);
+
+    ini = path + "/" + PATH_CONF + "/" + FILE_SAT_INI;
+    if(!QFile::exists(ini))
+        ini = path + "/" + PATH_CONF + "/default-" + FILE_SAT_INI;
+    if(QFile::exists(ini))
+        ReadSatelliteIni(ini, satList, qth);
+
+    rig->readSettings(&reg);
+
+    reg.beginGroup("PassTable");
+      passTable->setHorizon(reg.value("Horizon", PT_HORIZON).toDouble());
+    reg.endGroup();
+
+    reg.beginGroup("Daemon");
+      socket_name = reg.value("Socket", TD_SOCKET).toString();
+      log_name    = reg.value("Log", path + "/daemon.log").toString();
+    reg.endGroup();
+
+    log = fopen(log_name.toStdString().c_str(), "a");
+    if(log == NULL) {
+        qDebug("Error: failed to open the log %s [%s:%d]",
+               log_name.toStdString().c_str(), __FILE__, __LINE__);
+        return false;
+    }
+
+    td_signal = 0;
+    signal(SIGINT, td_sighandler);
+    signal(SIGTERM, td_sighandler);
+#ifdef Q_OS_UNIX
+    // a status client closing early must not kill the daemon
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    event(0, "start", QString("%1 satellites, %2 antennas").arg(satList->Count).arg(rig->antennas));
+
+    passTable->update(satList, rig);
+    passTable->start(QThread::LowestPriority);
+
+    // the simulated clock and rotor belong to the first antenna, see TrackWidget::startThread
+    if(rig->simulate())
+        TSimClock::start(rig->sim_start.isValid() ? rig->sim_start:QDateTime::currentDateTime().toUTC(),
+                         rig->sim_speed);
+    else
+        TSimClock::stop();
+
+    for(i=0; i<rig->antennas; i++) {
+        if(i > 0 && (rig->simulate() || !rig->antenna[i]->enable()))
+            continue;
+
+        tracker[i] = new TDaemonTracker(this, i);
+        tracker[i]->start();
+    }
+
+    openSocket();
+
+    flags &= ~TD_STOP;
+    start(QThread::LowPriority);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void TTrackDaemon::close(void)
+{
+ int i;
+
+    if(isRunning()) {
+        stop();
+        wait();
+    }
+
+    for(i=0; i<AN_MAX; i++)
+        if(tracker[i]) {
+            delete tracker[i];
+            tracker[i] = NULL;
+        }
+
+    if(passTable->isRunning()) {
+        passTable->stop();
+        passTable->wait();
+    }
+
+    closeSocket();
+
+    if(log) {
+        event(0, "stop", "");
+
+        fclose(log);
+        log = NULL;
+    }
+
+    TSimClock::stop();
+}
+
+//---------------------------------------------------------------------------
+TSat *TTrackDaemon::nextPass(double daynum_, int antenna)
+{
+ TSat *sat;
+
+    mutex.lock();
+
+    sat = findNextSat(satList, passTable, rig, daynum_, antenna);
+    if(sat) {
+        sat = new TSat(sat);
+        sat->CheckThresholds(rig);
+    }
+
+    mutex.unlock();
+
+    return sat;
+}
+
+//---------------------------------------------------------------------------
+void TTrackDaemon::releasePass(int antenna)
+{
+    passTable->release(antenna);
+
+    mutex.lock();
+    state[antenna].sat = "";
+    state[antenna].aos = "";
+    state[antenna].los = "";
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+void TTrackDaemon::setPass(int antenna, TSat *sat)
+{
+    mutex.lock();
+    state[antenna].sat = QString(sat->name).trimmed();
+    state[antenna].aos = sat->Daynum2String(sat->aostime);
+    state[antenna].los = sat->Daynum2String(sat->lostime);
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+// one JSON object per line
+void TTrackDaemon::event(int antenna, const char *type, const QString &text)
+{
+ TDaemonEvent *e;
+ QString      line;
+
+    mutex.lock();
+
+    e = &events[event_pos];
+    event_pos = (event_pos + 1) % TD_EVENTS;
+    if(num_events < TD_EVENTS)
+        num_events++;
+
+    e->time    = TSimClock::utc().toString(Qt::ISODate) + "Z";
+    e->antenna = antenna + 1;
+    e->event   = type;
+    e->text    = text;
+
+    if(antenna >= 0 && antenna < AN_MAX)
+        state[antenna].event = e->event;
+
+    if(log) {
+        line = QString("{\"time\":\"%1\",\"antenna\":%2,\"event\":\"%3\",\"text\":\"%4\"}\n")
+                  .arg(e->time).arg(e->antenna).arg(e->event).arg(escape(e->text));
+
+        fputs(line.toUtf8().constData(), log);
+        fflush(log);
+    }
+
+    mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+QString TTrackDaemon::escape(const QString &str)
+{
+ QString s = str;
+
+    s.replace("\\", "\\\\");
+    s.replace("\"", "\\\"");
+    s.replace("\n", "\\n");
+    s.replace("\r", "\\r");
+    s.replace("\t", "\\t");
+
+    return s;
+}
+
+//---------------------------------------------------------------------------
+void TTrackDaemon::run(void)
+{
+#ifdef Q_OS_UNIX
+ int fd;
+#endif
+
+    while(!(flags & TD_STOP)) {
+        if(td_signal) {
+            td_signal = 0;
+            event(0, "signal", "shutting down");
+
+            QMetaObject::invokeMethod(QCoreApplication::instance(), "quit", Qt::QueuedConnection);
+            break;
+        }
+
+#ifdef Q_OS_UNIX
+        // the listening socket is non blocking
+        while(sockfd >= 0 && (fd = accept(sockfd, NULL, NULL)) >= 0) {
+            struct timeval tv;
+
+            tv.tv_sec = TD_SEND_MS / 1000;
+            tv.tv_usec = (TD_SEND_MS % 1000) * 1000;
+            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+            writeStatus(fd);
+            ::close(fd);
+        }
+#endif
+
+        msleep(TD_POLL_MS);
+    }
+}
+
+//---------------------------------------------------------------------------
+bool TTrackDaemon::openSocket(void)
+{
+#ifdef Q_OS_UNIX
+ struct sockaddr_un addr;
+ QByteArray         name = QFile::encodeName(socket_name);
+
+    closeSocket();
+
+    if(name.isEmpty())
+        return false;
+
+    if((size_t) name.size() >= sizeof(addr.sun_path)) {
+        qDebug("Error: socket name is too long %s [%s:%d]", name.constData(), __FILE__, __LINE__);
+        return false;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, name.constData());
+
+    // a stale socket of a previous run
+    unlink(addr.sun_path);
+
+    sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(sockfd < 0) {
+        qDebug("Error: socket failed, %s [%s:%d]", strerror(errno), __FILE__, __LINE__);
+        return false;
+    }
+
+    if(bind(sockfd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(sockfd, 4) < 0) {
+        qDebug("Error: failed to listen %s, %s [%s:%d]", addr.sun_path, strerror(errno), __FILE__, __LINE__);
+        closeSocket();
+        return false;
+    }
+
+    fcntl(sockfd, F_SETFL, fcntl(sockfd, F_GETFL) | O_NONBLOCK);
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+//---------------------------------------------------------------------------
+void TTrackDaemon::closeSocket(void)
+{
+#ifdef Q_OS_UNIX
+    if(sockfd >= 0) {
+        ::close(sockfd);
+        unlink(QFile::encodeName(socket_name).constData());
+    }
+#endif
+
+    sockfd = -1;
+}
+
+//---------------------------------------------------------------------------
+// status snapshot as one JSON object
+void TTrackDaemon::writeStatus(int fd)
+{
+#ifdef Q_OS_UNIX
+ TDaemonEvent *e;
+ QByteArray   buf;
+ QString      str;
+ int          i, n, len;
+ bool         running;
+
+    mutex.lock();
+
+    str = QString("{\"time\":\"%1Z\",\"satellites\":%2,\"passes\":%3,\"simulate\":%4,"
+                  "\"jobs\":{\"running\":%5,\"queued\":%6},\"antennas\":[")
+             .arg(TSimClock::utc().toString(Qt::ISODate))
+             .arg(satList->Count)
+             .arg(passTable->getCount())
+             .arg(rig->simulate() ? "true":"false")
+             .arg(rig->jobs->running())
+             .arg(rig->jobs->queued());
+
+    for(i=0; i<rig->antennas; i++) {
+        running = tracker[i] && tracker[i]->isRunning();
+
+        str += QString("%1{\"antenna\":%2,\"name\":\"%3\",\"running\":%4,\"event\":\"%5\",\"sat\":\"%6\",\"aos\":\"%7\",\"los\":\"%8\"}")
+                  .arg(i ? ",":"")
+                  .arg(i + 1)
+                  .arg(escape(rig->antenna[i]->name))
+                  .arg(running ? "true":"false")
+                  .arg(state[i].event)
+                  .arg(escape(state[i].sat))
+                  .arg(state[i].aos)
+                  .arg(state[i].los);
+    }
+
+    str += "],\"events\":[";
+
+    // oldest first
+    for(n=0; n<num_events; n++) {
+        e = &events[(event_pos - num_events + n + TD_EVENTS) % TD_EVENTS];
+
+        str += QString("%1{\"time\":\"%2\",\"antenna\":%3,\"event\":\"%4\",\"text\":\"%5\"}")
+                  .arg(n ? ",":"")
+                  .arg(e->time)
+                  .arg(e->antenna)
+                  .arg(e->event)
+                  .arg(escape(e->text));
+    }
+
+    str += "]}\n";
+
+    mutex.unlock();
+
+    buf = str.toUtf8();
+    for(i=0; i<buf.size(); i += len) {
+        len = ::write(fd, buf.constData() + i, buf.size() - i);
+        if(len <= 0)
+            break;
+    }
+#else
+    (void) fd;
+#endif
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,114 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef TRACKDAEMON_H
+#define TRACKDAEMON_H
+
+#include <QThread>
+#include <QMutex>
+#include <QString>
+#include <stdio.h>
+
+#include "antenna.h"
+
+//---------------------------------------------------------------------------
+#define TD_STOP             1
+#define TD_EVENTS           64      // events kept for the status
+#define TD_POLL_MS          500     // socket and signal poll interval
+#define TD_SEND_MS          1000    // status write timeout, a stalled client can not block the thread
+#define TD_SOCKET           "/tmp/poes-usrp.sock"
+
+class TRig;
+class TSat;
+class TStation;
+class TPassTable;
+class TDaemonTracker;
+class PList;
+
+//---------------------------------------------------------------------------
+struct TDaemonEvent
+{
+    QString time;
+    int     antenna;
+    QString event;
+    QString text;
+};
+
+struct TDaemonAntenna
+{
+    QString sat, aos, los;
+    QString event;
+};
+
+//---------------------------------------------------------------------------
+// Headless station, predicts, schedules and tracks the passes of all
+// enabled antennas like the main window does, without any widgets.
+// Settings are the ones of the GUI and conf/. The events are written as
+// JSON lines to the log and a status snapshot is written to every client
+// connecting the local socket, eg. "socat - UNIX-CONNECT:/tmp/poes-usrp.sock"
+class TTrackDaemon : public QThread
+{
+public:
+    TTrackDaemon(void);
+    ~TTrackDaemon(void);
+
+    bool open(void);
+    void close(void);
+
+    TRig *getRig(void) { return rig; }
+
+    // a copy of the next pass of the antenna, owned by the caller
+    TSat *nextPass(double daynum_, int antenna);
+    void releasePass(int antenna);
+    void setPass(int antenna, TSat *sat);
+
+    void event(int antenna, const char *type, const QString &text);
+
+protected:
+    void run(void);
+    void stop(void) { flags |= TD_STOP; }
+
+    bool openSocket(void);
+    void closeSocket(void);
+    void writeStatus(int fd);
+
+    static QString escape(const QString &str);
+
+private:
+    TRig       *rig;
+    TStation   *qth;
+    TPassTable *passTable;
+    PList      *satList;
+
+    TDaemonTracker *tracker[AN_MAX];
+    TDaemonAntenna state[AN_MAX];
+
+    TDaemonEvent events[TD_EVENTS];
+    int     num_events, event_pos;
+
+    QMutex  mutex;
+    QString socket_name, log_name;
+    FILE    *log;
+    int     sockfd;
+    int     flags;
+};
+
+#endif // TRACKDAEMON_H
@@ -20,6 +20,7 @@
 */
 //---------------------------------------------------------------------------
 #include <QSettings>
+#include <QMutex>
 #include "trackwidget.h"
 #include "ui_trackwidget.h"
 
@@ -29,18 +30,45 @@
 #include "Satellite.h"
 #include "settings.h"
 #include "plist.h"
+#include "simclock.h"
+#include "rig.h"
+
+// the trackers of all antennas search the shared satellite list
+static QMutex next_mutex;
 
 //---------------------------------------------------------------------------
-TrackWidget::TrackWidget(QWidget *parent) :
+TrackWidget::TrackWidget(QWidget *parent, int antenna_) :
     QDockWidget(parent),
     m_ui(new Ui::TrackWidget)
 {
+ TRig *rig;
+
     m_ui->setupUi(this);
 
     mw  = (MainWindow *) parent;
     sat = NULL;
-
-    thread = new TrackThread(this);
+    antenna = antenna_;
+
+    rig = mw->getRig();
+    if(rig->antennas > 1)
+        setWindowTitle(windowTitle() + " - " + rig->antenna[antenna]->name);
+
+    thread = new TrackThread(this, this);
+
+    connect(thread, SIGNAL(setSatLabelColor(const QString &)),
+            m_ui->satLabel, SLOT(setStyleSheet(const QString &)));
+    connect(thread, SIGNAL(setSatLabelText(const QString &)),
+            m_ui->satLabel, SLOT(setText(const QString &)));
+    connect(thread, SIGNAL(setTimeLabelText(const QString &)),
+            m_ui->timeLabel, SLOT(setText(const QString &)));
+    connect(thread, SIGNAL(setSunLabelColor(const QString &)),
+            m_ui->sunLabel, SLOT(setStyleSheet(const QString &)));
+    connect(thread, SIGNAL(setSunLabelText(const QString &)),
+            m_ui->sunLabel, SLOT(setText(const QString &)));
+    connect(thread, SIGNAL(setMoonLabelColor(const QString &)),
+            m_ui->moonLabel, SLOT(setStyleSheet(const QString &)));
+    connect(thread, SIGNAL(setMoonLabelText(const QString &)),
+            m_ui->moonLabel, SLOT(setText(const QString &)));
 
     connect(this, SIGNAL(visibilityChanged(bool)), this, SLOT(visibilityChanged(bool)));
 }
@@ -77,6 +105,12 @@ void TrackWidget::changeEvent(QEvent *e)
     }
 }
 
+//---------------------------------------------------------------------------
+TRig *TrackWidget::getRig(void)
+{
+    return mw->getRig();
+}
+
 //---------------------------------------------------------------------------
 TSat *TrackWidget::getSatellite(void)
 {
@@ -125,22 +159,27 @@ TSat *TrackWidget::getNextSatellite(void)
     // 0 = Next
     // 1 = Sun
     // 2 = Moon
-    if(m_ui->satcomboBox->currentIndex() <= 2)
-       _sat = mw->getNextSat(sat ? sat->lostime:0);
-    else {
-       if(sat && sat->name == m_ui->satcomboBox->currentText())
-           return sat;
+    if(m_ui->satcomboBox->currentIndex() > 2 && sat && sat->name == m_ui->satcomboBox->currentText())
+        return sat;
 
+    next_mutex.lock();
+
+    if(m_ui->satcomboBox->currentIndex() <= 2)
+       _sat = mw->getNextSat(sat ? sat->lostime:0, antenna);
+    else
        _sat = mw->getNextSatByName(m_ui->satcomboBox->currentText());
-    }
 
-    if(!_sat)
+    if(!_sat) {
+        next_mutex.unlock();
         return NULL;
+    }
 
     deleteSat();
     sat = new TSat(_sat);
     sat->CheckThresholds(mw->getRig());
 
+    next_mutex.unlock();
+
     str.sprintf("TLE Issued Date: %s", sat->GetKeplerAge().toStdString().c_str());
     m_ui->tleageLabel->setText(str);
 
@@ -170,8 +209,24 @@ void TrackWidget::restartThread(void)
 //---------------------------------------------------------------------------
 void TrackWidget::startThread(void)
 {
+ TRig *rig = mw->getRig();
+
      stopThread();
 
+     // the clock and the simulated rotor belong to the first antenna
+     if(antenna > 0) {
+        if(rig->simulate() || !rig->antenna[antenna]->enable())
+           return;
+     }
+     // the first pass is searched on the simulated clock
+     else if(rig->simulate()) {
+        deleteSat();
+        TSimClock::start(rig->sim_start.isValid() ? rig->sim_start:QDateTime::currentDateTime().toUTC(),
+                         rig->sim_speed);
+     }
+     else
+        TSimClock::stop();
+
      if(isVisible())
         if(getNextSatellite())
            thread->start(QThread::IdlePriority);
@@ -187,6 +242,8 @@ void TrackWidget::stopThread(void)
         thread->wait();
         deleteSat();
 
+        mw->releasePass(antenna);
+
         QApplication::restoreOverrideCursor();
    }
 }
@@ -24,6 +24,8 @@
 
 #include <QtGui/QDockWidget>
 #include <QDateTimeEdit>
+
+#include "trackhost.h"
 namespace Ui {
     class TrackWidget;
 }
@@ -34,12 +36,13 @@ class MainWindow;
 class TrackThread;
 
 //---------------------------------------------------------------------------
-class TrackWidget : public QDockWidget {
+class TrackWidget : public QDockWidget, public TTrackHost {
     Q_OBJECT
 public:
-    TrackWidget(QWidget *parent = 0);
+    TrackWidget(QWidget *parent = 0, int antenna_ = 0);
     ~TrackWidget();
 
+    TRig   *getRig(void);
     TSat   *getNextSatellite(void);
     TSat   *getSatellite(void);
     QLabel *getSatLabel(void);
@@ -47,6 +50,7 @@ public:
     QLabel *getSunLabel(void);
     QLabel *getMoonLabel(void);
     int    trackIndex(void);
+    int    antennaIndex(void) { return antenna; }
 
     void updateSatCb(void);
     void restartThread(void);
@@ -64,6 +68,7 @@ private:
     TSat *sat;
     MainWindow *mw;
     TrackThread *thread;
+    int  antenna;
 
 private slots:
     void on_satcomboBox_currentIndexChanged(int index);
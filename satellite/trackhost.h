@@ -0,0 +1,52 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef TRACKHOST_H
+#define TRACKHOST_H
+
+class QString;
+class TRig;
+class TSat;
+
+//---------------------------------------------------------------------------
+// What TrackThread needs from its owner, the track widget of the GUI or a
+// tracker of TTrackDaemon. One host per antenna.
+class TTrackHost
+{
+public:
+    virtual ~TTrackHost(void) {}
+
+    virtual TRig *getRig(void) = 0;
+
+    // current pass, a private copy owned by the host
+    virtual TSat *getSatellite(void) = 0;
+    // replaces it with the next pass of the antenna, NULL if none
+    virtual TSat *getNextSatellite(void) = 0;
+
+    // 0 = next pass, 1 = sun, 2 = moon, else a satellite by name
+    virtual int  trackIndex(void) = 0;
+    virtual int  antennaIndex(void) = 0;
+
+    // tracker events as aos, los, rx, postrx, park, error
+    virtual void trackEvent(const char *event, const QString &text) { (void) event; (void) text; }
+};
+
+#endif // TRACKHOST_H
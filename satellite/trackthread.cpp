@@ -19,78 +19,68 @@
     Web: <http://www.poes-weather.com>
 */
 //---------------------------------------------------------------------------
-#include <QLabel>
-#include <QWidget>
 #include <QProcess>
 #include <QDateTime>
 #include <math.h>
 #include <stdio.h>
+#include <stdarg.h>
 
 #include "trackthread.h"
-#include "trackwidget.h"
+#include "trackhost.h"
 
-#include "mainwindow.h"
 #include "Satellite.h"
 #include "rig.h"
+#include "rotorplan.h"
+#include "rotoremulator.h"
+#include "telemetry.h"
+#include "simclock.h"
+#include "utils.h"
 
 //#define _DEBUG_FP_ /* todo: remove this when not debugging */
 const int  TRACKER_SPEED = 500; // milliseconds
 
+// simulation
+const int  TS_LABEL_MS  = 200;   // real milliseconds between label updates
+const int  TS_IDLE_LEAD = 120;   // seconds before AOS the idle steps stop
+const int  TS_IDLE_STEP = 30000; // simulated milliseconds per idle step
+
 //---------------------------------------------------------------------------
-TrackThread::TrackThread(QObject *parent) : QThread(parent)
+TrackThread::TrackThread(TTrackHost *host_, QObject *parent) : QThread(parent)
 {
-    tw  = (TrackWidget *) parent;
-    mw  = (MainWindow *) tw->parent();
-    rig = mw->getRig();
+    host = host_;
+    rig  = host->getRig();
+
+    antenna = rig->antenna[host->antennaIndex()];
+    rotor   = antenna->rotor;
 
     sat = NULL;
     debug_fp = NULL;
+    timeline_fp = NULL;
 
-    rx_proc      = new QProcess(this);
-    post_rx_proc = new QProcess(this);
-    proc_que     = new QStringList;
-
-    satLabel = tw->getSatLabel();
-    connect(this, SIGNAL(setSatLabelColor(const QString &)),
-            satLabel, SLOT(setStyleSheet(const QString &)));
-    connect(this, SIGNAL(setSatLabelText(const QString &)),
-            satLabel, SLOT(setText(const QString &)));
-
-    timeLabel = tw->getTimeLabel();
-    connect(this, SIGNAL(setTimeLabelText(const QString &)),
-            timeLabel, SLOT(setText(const QString &)));
+    rotor_plan = new TRotorPlan;
 
-    sunLabel = tw->getSunLabel();
-    connect(this, SIGNAL(setSunLabelColor(const QString &)),
-            sunLabel, SLOT(setStyleSheet(const QString &)));
-    connect(this, SIGNAL(setSunLabelText(const QString &)),
-            sunLabel, SLOT(setText(const QString &)));
-
-    moonLabel = tw->getMoonLabel();
-    connect(this, SIGNAL(setMoonLabelColor(const QString &)),
-            moonLabel, SLOT(setStyleSheet(const QString &)));
-    connect(this, SIGNAL(setMoonLabelText(const QString &)),
-            moonLabel, SLOT(setText(const QString &)));
+    rx_proc = new QProcess(this);
 
     prev_el = 0;
     prev_az = 0;
-    speed_dt = QDateTime::currentDateTime();
+    speed_dt = TSimClock::utc();
 }
 
 //---------------------------------------------------------------------------
 TrackThread::~TrackThread()
 {
     stopProcess(rx_proc);
-    stopProcess(post_rx_proc);
 
     delete rx_proc;
-    delete post_rx_proc;
-    delete proc_que;
+    delete rotor_plan;
 
     if(debug_fp)
         fclose(debug_fp);
 
     debug_fp = NULL;
+
+    if(timeline_fp)
+        fclose(timeline_fp);
 }
 
 //---------------------------------------------------------------------------
@@ -104,8 +94,10 @@ void TrackThread::stop(void)
 void TrackThread::run()
 {
     int          sat_state; // 0 = init, 1 = tracking, 2 = LOS, 3 = idle, 4 = reinit
-    int          rotor_state;
-    unsigned int rig_modes, loop_index;
+    int          rotor_state, prev_state;
+    unsigned int rig_modes, prev_modes, loop_index;
+    unsigned long step;
+    qint64       label_ms;
     double       r_az, r_el;
 
     /*
@@ -137,25 +129,36 @@ void TrackThread::run()
     QString    cl_down = "color:rgb(0, 170, 255);";
     QString    cl_up   = "color:yellow;";
     QString    cl_style, proc_cmd, dt_str;
-    bool       script_error;
+    bool       script_error, labels;
     // long       l1, l2;
-    double     v1, v2, post_proc_start_time;
+    double     v1, v2, v3;
     int        trackIndex;
 
     flags = 0;
     sat_state = 0;
     rotor_state = 0;
     loop_index = 0;
-    post_proc_start_time = 0;
+    label_ms = 0;
+
+    sat_style  = "";
+    sun_style  = "";
+    moon_style = "";
+
+    // the widget has started the clock and searched the first pass
+    if(TSimClock::isSimulated())
+        beginSimulation();
 
     // init rig & rotor static modes
     rig_modes = 0;
 
-    rig_modes |= (rig->rotor->enable() && rig->rotor->openPort()) ? 1:0;
-    rig_modes |= rig->rotor->parkingEnabled() ? 2:0;
+    rig_modes |= (rotor->enable() && rotor->openPort()) ? 1:0;
+    rig_modes |= rotor->parkingEnabled() ? 2:0;
     rig_modes |= rig->autorecord() ? 4:0;
     rig_modes |= rig->passthresholds() ? 8:0;
 
+    if((rig_modes & 1) && rotor->recordTelemetry())
+        rotor->telemetry->open(rotor->telemetry_file);
+
 #ifdef _DEBUG_FP_
 
     if(debug_fp)
@@ -171,43 +174,61 @@ void TrackThread::run()
 
 #endif
 
-    sat = tw->getSatellite();
-    trackIndex = tw->trackIndex();
+    sat = host->getSatellite();
+    trackIndex = host->trackIndex();
 
     if(sat && debug_fp)
         fprintf(debug_fp,"%s max elevation:%.2f\n\n", sat->name, sat->sat_max_ele);
 
+    if(sat)
+        event("pass", "%s AOS %s LOS %s max El:%.1f", sat->name,
+              sat->Daynum2String(sat->aostime, 4|8).toStdString().c_str(),
+              sat->Daynum2String(sat->lostime, 4|8).toStdString().c_str(),
+              sat->sat_max_ele);
+
+    if(flags & TF_SIMULATE)
+        timeline("rig modes 0x%x, first pass %s AOS %s", rig_modes,
+                 sat ? sat->name:"none",
+                 sat ? sat->Daynum2String(sat->aostime, 4|8).toStdString().c_str():"");
+
+    prev_state = sat_state;
+    prev_modes = rig_modes;
+
     while(!(flags & TF_STOP)) {
 
-        now = QDateTime::currentDateTime();                
+        now = TSimClock::utc().toLocalTime();
         dt_str = now.toString("dddd, d MMMM yyyy, hh:mm:ss");
-        emit(setTimeLabelText(dt_str));
 
-        if(!sat) {
-            if(!(sat = tw->getNextSatellite())) {
-                emit(setSatLabelText("No active satellites found to track @ " + dt_str + ", terminating!"));
+        // the labels can not follow a simulation, update them now and then
+        labels = true;
+        if(flags & TF_SIMULATE) {
+            if(QDateTime::currentMSecsSinceEpoch() - label_ms < TS_LABEL_MS)
+                labels = false;
+            else
+                label_ms = QDateTime::currentMSecsSinceEpoch();
 
+            if(TSimClock::daynum() >= sim_end) {
+                timeline("simulation end");
                 break;
             }
         }
 
-        sat->Track();
-
-        // check every now and then if the post rx process can be stopped and deque
-        if((loop_index % 20) == 0 && procRunning(post_rx_proc)) {
-            v1 = (sat->daynum - post_proc_start_time) * 1440;
-            if(v1 > 20) // it has been running over 20 mins, stop it!
-                stopProcess(post_rx_proc);
+        if(labels)
+            emit(setTimeLabelText(dt_str));
 
-            if(proc_que->count() && !procRunning(post_rx_proc)) {
-                proc_cmd = proc_que->first();
-                proc_que->removeFirst();
+        if(!sat) {
+            if(!(sat = host->getNextSatellite())) {
+                emit(setSatLabelText("No active satellites found to track @ " + dt_str + ", terminating!"));
+                event("error", "no active satellites found to track");
 
-                post_rx_proc->start(proc_cmd);
-                post_proc_start_time = sat->daynum;
+                break;
             }
         }
 
+        // sampled once per pass, Track() then interpolates
+        sat->CachePass();
+        sat->Track();
+
         if(rig_modes & 1) {
             // tracking the sun or moon
             if(trackIndex == 1 || trackIndex == 2) {
@@ -217,6 +238,7 @@ void TrackThread::run()
                 }
                 else {
                     if(trackIndex == 1) { // sun
+                        sat->FindSun(sat->daynum);
                         r_az = sat->sun_azi;
                         r_el = sat->sun_ele;
                     }
@@ -235,9 +257,19 @@ void TrackThread::run()
         case 0: // init state, loop here until satellite is at AOS
             {
                 // check if it can be recorded, 128 | 4
-                if((rig_modes & 4) && !(rig_modes & 128) && sat->CanRecord())
+                if((rig_modes & 4) && !(rig_modes & 128) && sat->CanRecord()) {
                     rig_modes |= 128;
 
+                    // compile the scripts and create the directories now, not at AOS
+                    if(!(flags & TF_SIMULATE)) {
+                        v1 = (rig_modes & 8) ? sat->rec_aostime:sat->aostime;
+
+                        sat->sat_scripts->receiver(antenna->receiver);
+                        sat->sat_scripts->prepare(sat->name, sat->getDownlinkFreq(rig),
+                                                  QDateTime::currentDateTime().addSecs(qint64((v1 - sat->daynum) * 86400.0)));
+                    }
+                }
+
                 // init rotor
                 if((rig_modes & 1) && !(rig_modes & 32)) {
                     v1 = (rig_modes & 8) ? sat->rec_aostime:sat->aostime;
@@ -247,8 +279,15 @@ void TrackThread::run()
                         v2 = (v1 - sat->daynum) * 1440;
                         if(v2 > 15) {
                             if(!(rig_modes & 64)) {
-                                rig->rotor->park();
+                                rotor->park();
                                 rig_modes |= 64;
+
+                                event("park", "AOS in %.1f min", v2);
+
+                                if(flags & TF_SIMULATE) {
+                                    timeline("park rotor, AOS in %.1f min", v2);
+                                    sim_parks++;
+                                }
                             }
                         }
                         else {
@@ -262,7 +301,7 @@ void TrackThread::run()
 
                     if(rig_modes & 32) {
                         initRotor(rig, sat);
-                        r_init_dt = QDateTime::currentDateTime();
+                        r_init_dt = TSimClock::utc();
                         rotor_state = 1; // assume it is moving now to its new position
                     }
                 }
@@ -270,9 +309,12 @@ void TrackThread::run()
                 // everything should now be inited, wait for it to rise
                 sat_state = sat->sat_ele > 0 ? 1:0;
 
+                if(sat_state == 1)
+                    event("aos", "%s Az:%.1f", sat->name, sat->sat_azi);
+
                 prev_el = sat->sat_ele;
                 prev_az = sat->sat_azi;
-                speed_dt = QDateTime::currentDateTime();
+                speed_dt = TSimClock::utc();
 
                 // power off motors if we have to wait long for next AOS
                 if(sat_state == 0 && (rig_modes & 32) && rotor_state == 1) {
@@ -280,8 +322,11 @@ void TrackThread::run()
 
                     // power off motors ?
                     if(v2 > 1 && now.secsTo(r_init_dt) <= -60) {
-                        rig->rotor->stopMotor();
+                        rotor->stopMotor();
                         rotor_state = 0;
+
+                        if(flags & TF_SIMULATE)
+                            timeline("motors off, AOS in %.1f min", v2);
                     }
                 }
 
@@ -297,31 +342,51 @@ void TrackThread::run()
 
                 // swing the antenna
                 if(rig_modes & 1) {
-                    if(rig->rotor->isZenithPass()) {
-                        // turn elevation >90 degrees on zenith pass
-                        if(v1 >= 0.0) { // receding
-                            r_el = 180.0 - sat->sat_ele;
-                            r_az = sat->sat_azi - 180.0;
+                    if(rotor_plan->isValid()) {
+                        // planned trajectory, lead the satellite by the look-ahead time
+                        rotor_plan->position(sat->daynum + rotor->lookahead / 86400.0, &r_az, &r_el);
+                        rotor->moveToAxis(r_az, r_el);
+                    }
+                    else {
+                        if(rotor->isZenithPass()) {
+                            // turn elevation >90 degrees on zenith pass
+                            if(v1 >= 0.0) { // receding
+                                r_el = 180.0 - sat->sat_ele;
+                                r_az = sat->sat_azi - 180.0;
 
-                            if(r_az < 0)
-                                r_az += 360.0;
+                                if(r_az < 0)
+                                    r_az += 360.0;
 
-                            if(r_az > 360)
-                                r_az -= 360.0;
+                                if(r_az > 360)
+                                    r_az -= 360.0;
+                            }
                         }
+
+                        moveTo(r_az, r_el);
                     }
 
-                    moveTo(r_az, r_el);
+                    if(rotor->emulate())
+                        rotor->emulator->track(sat->sat_azi, sat->sat_ele);
+
+                    if(rotor->telemetry->isOpen()) {
+                        if(!rotor->getReportedAzEl(&v2, &v3))
+                            v2 = v3 = NAN;
+
+                        rotor->telemetry->track(r_az, r_el, v2, v3,
+                                                sat->sat_azi, sat->sat_ele, v1);
+                    }
                 }
 
                 // start the rx script
                 if((rig_modes & 128) && !(rig_modes & 512) && sat->CanStartRecording(rig)) {
 
                     stopProcess(rx_proc); // kill it if it is alive!
+                    sat->sat_scripts->receiver(antenna->receiver);
                     proc_cmd = sat->sat_scripts->get_rx_command(sat->name, sat->getDownlinkFreq(rig), &script_error);
                     if(!script_error) {
-                        rx_proc->start(proc_cmd);
-                        sat->SavePassinfo();
+                        startProcess(rx_proc, proc_cmd);
+                        if(!(flags & TF_SIMULATE))
+                            sat->SavePassinfo();
                         rig_modes |= 256;
                     }
                     else {
@@ -333,6 +398,9 @@ void TrackThread::run()
                         qDebug("Error: rx script %s had fatal errors, disabling scripts! %s:%d",
                                sat->sat_scripts->rx_script().toStdString().c_str(),
                                __FILE__, __LINE__);
+
+                        event("error", "%s rx script %s failed, scripts disabled", sat->name,
+                              sat->sat_scripts->rx_script().toStdString().c_str());
                     }
 
                     rig_modes |= 512;
@@ -345,8 +413,12 @@ void TrackThread::run()
                         sat_state = 2;
 
                     v2 = 0;
-                    if(rig_modes & 1)
-                        v2 = (rig->rotor->isCCW() || rig->rotor->isZenithPass()) ? (180.0 - rig->rotor->el_max):rig->rotor->el_min;
+                    if(rig_modes & 1) {
+                        if(rotor_plan->isValid())
+                            v2 = rotor_plan->losElevation();
+                        else
+                            v2 = (rotor->isCCW() || rotor->isZenithPass()) ? (180.0 - rotor->el_max):rotor->el_min;
+                    }
 
                     if(sat->sat_ele <= v2)
                         sat_state = 2;
@@ -357,7 +429,19 @@ void TrackThread::run()
 
         case 2: // satellite receded below LOS, post RX process and start to deinitialize
             {
-                rig->rotor->stopMotor();
+                rotor->stopMotor();
+
+                event("los", "%s Az:%.1f", sat->name, sat->sat_azi);
+
+                if((rig_modes & 1) && rotor->emulate()) {
+                    rotor->emulator->report(sat->name);
+                    rotor->emulator->resetStats();
+                }
+
+                if(flags & TF_SIMULATE) {
+                    timeline("LOS %s El:%.2f", sat->name, sat->sat_ele);
+                    sim_passes++;
+                }
 
                 if(rig_modes & 256) {
                     stopProcess(rx_proc); // dont check its pid, user might have killed it...
@@ -366,14 +450,17 @@ void TrackThread::run()
                         proc_cmd = sat->sat_scripts->get_postproc_command(&script_error);
 
                         if(!script_error) {
-                            if(!procRunning(post_rx_proc)) {
-                                post_rx_proc->start(proc_cmd);
-                                post_proc_start_time = sat->daynum;
-                            }
-                            else {
-                                qDebug("Queuing: %s", sat->GetImageText(256).toStdString().c_str());
+                            // the scheduler runs it, higher passes first
+                            rig->jobs->submit(sat->name, proc_cmd, sat->sat_max_ele);
+
+                            event("postrx", "%s", proc_cmd.toStdString().c_str());
+                            event("queued", "%s post rx script, %d waiting", sat->name, rig->jobs->queued());
 
-                                proc_que->append(proc_cmd);
+                            if(flags & TF_SIMULATE) {
+                                timeline("post rx script: %s", proc_cmd.toStdString().c_str());
+                                timeline("post rx script queued, %d waiting", rig->jobs->queued(true));
+                                sim_queued = MAX(sim_queued, rig->jobs->queued(true));
+                                sim_post++;
                             }
                         }
                         else {
@@ -385,6 +472,9 @@ void TrackThread::run()
                             qDebug("Error: post rx script %s had fatal errors, disabling scripts! %s:%d",
                                    sat->sat_scripts->postproc_script().toStdString().c_str(),
                                    __FILE__, __LINE__);
+
+                            event("error", "%s post rx script %s failed, scripts disabled", sat->name,
+                                  sat->sat_scripts->postproc_script().toStdString().c_str());
                         }
                     }
                 }
@@ -396,7 +486,7 @@ void TrackThread::run()
                 l1 = sat->catnum;
                 l2 = sat->orbitnum;
 
-                if((sat = tw->getNextSatellite())) {
+                if((sat = host->getNextSatellite())) {
                     sat->Track();
 
                     // check if it is the same satellite
@@ -416,8 +506,12 @@ void TrackThread::run()
             {
                 v1 = 0;
 
-                if(rig_modes & 1)
-                    v1 = (rig->rotor->isCCW() || rig->rotor->isZenithPass()) ? (180.0 - rig->rotor->el_max):rig->rotor->el_min;
+                if(rig_modes & 1) {
+                    if(rotor_plan->isValid())
+                        v1 = rotor_plan->losElevation();
+                    else
+                        v1 = (rotor->isCCW() || rotor->isZenithPass()) ? (180.0 - rotor->el_max):rotor->el_min;
+                }
 
                 sat_state = sat->sat_ele > v1 ? 3:4;
             }
@@ -425,10 +519,18 @@ void TrackThread::run()
 
         case 4: // start from the beginning
             {
+                rotor_plan->clear();
 
-                if((sat = tw->getNextSatellite()))
+
+                if((sat = host->getNextSatellite())) {
                     sat->Track();
 
+                    event("pass", "%s AOS %s LOS %s max El:%.1f", sat->name,
+                          sat->Daynum2String(sat->aostime, 4|8).toStdString().c_str(),
+                          sat->Daynum2String(sat->lostime, 4|8).toStdString().c_str(),
+                          sat->sat_max_ele);
+                }
+
                 sat_state = 0;
 
                 // delete all bits except the static ones (1 | 2 | 4 | 8)
@@ -445,42 +547,71 @@ void TrackThread::run()
             break;
         }
 
+        if((flags & TF_SIMULATE) && (sat_state != prev_state || rig_modes != prev_modes)) {
+            timeline("state %d -> %d, rig modes 0x%x -> 0x%x, %s El:%.2f",
+                     prev_state, sat_state, prev_modes, rig_modes,
+                     sat ? sat->name:"none", sat ? sat->sat_ele:0.0);
+
+            prev_state = sat_state;
+            prev_modes = rig_modes;
+        }
+
         if(!sat) { // fatal error
             qDebug("Error: No more active satellites found @ %s, terminating! %s:%d",
                    dt_str.toStdString().c_str(),
                    __FILE__, __LINE__);
 
             emit(setSatLabelText("No more active satellites found to track @ " + dt_str + ", terminating!"));
+            event("error", "no more active satellites found to track");
 
             break;
         }
 
         // satellite label
-        cl_style = sat->sat_ele > 0 ? cl_up:cl_down;
-        if(satLabel->styleSheet() != cl_style)
-            emit(setSatLabelColor(cl_style));
-        emit(setSatLabelText(sat->GetTrackStr(rig, rx_proc->pid() ? 1:0)));
+        if(labels) {
+            cl_style = sat->sat_ele > 0 ? cl_up:cl_down;
+            if(sat_style != cl_style) {
+                sat_style = cl_style;
+                emit(setSatLabelColor(cl_style));
+            }
+            emit(setSatLabelText(sat->GetTrackStr(rig, procRunning(rx_proc) ? 1:0)));
+        }
 
 
         // update sun- and moon position every 10 sec
-        if((loop_index % 20) == 0) {
+        if(labels && ((loop_index % 20) == 0 || (flags & TF_SIMULATE))) {
             // sun label
             // use dusk elevation as up threshold
+            sat->FindSun(sat->daynum);
             cl_style = sat->sun_ele >= -6 ? cl_up:cl_down;
-            if(sunLabel->styleSheet() != cl_style)
+            if(sun_style != cl_style) {
+                sun_style = cl_style;
                 emit(setSunLabelColor(cl_style));
+            }
             emit(setSunLabelText(sat->GetSunPos()));
 
             // moon label
             sat->FindMoon(sat->daynum);
             cl_style = sat->moon_ele > 0 ? cl_up:cl_down;
-            if(moonLabel->styleSheet() != cl_style)
+            if(moon_style != cl_style) {
+                moon_style = cl_style;
                 emit(setMoonLabelColor(cl_style));
+            }
             emit(setMoonLabelText(sat->GetMoonPos()));
         }
 
+        // a simulation skips ahead while waiting for a distant AOS
+        step = TRACKER_SPEED;
+        if((flags & TF_SIMULATE) && sat_state == 0 && rig->jobs->running(true) == 0 && rig->jobs->queued(true) == 0) {
+            v1 = (rig_modes & 8) ? sat->rec_aostime:sat->aostime;
+            v2 = (v1 - TSimClock::daynum()) * 86400.0 - TS_IDLE_LEAD; // seconds
+
+            if(v2 * 1000.0 > TRACKER_SPEED)
+                step = (unsigned long) MIN(v2 * 1000.0, (double) TS_IDLE_STEP);
+        }
+
         loop_index++;
-        msleep(TRACKER_SPEED);
+        TSimClock::sleep(step);
     }
 
     flags |= TF_STOP;
@@ -489,6 +620,11 @@ void TrackThread::run()
     // let the post rx script run
     stopProcess(rx_proc);
 
+    rotor->telemetry->close();
+
+    if(flags & TF_SIMULATE)
+        endSimulation();
+
     if(debug_fp)
         fclose(debug_fp);
 
@@ -497,9 +633,47 @@ void TrackThread::run()
   exit();
 }
 
+//---------------------------------------------------------------------------
+// a simulation only logs the command, the stub rx script runs until it is
+// stopped, the post rx scripts are run by rig->jobs
+void TrackThread::startProcess(QProcess *proc, const QString &cmd)
+{
+    event("rx", "%s", cmd.toStdString().c_str());
+
+    // throttle the post rx jobs while receiving
+    if(!(flags & TF_RECEIVING)) {
+        flags |= TF_RECEIVING;
+        rig->jobs->reception(true);
+    }
+
+    if(!(flags & TF_SIMULATE)) {
+        proc->start(cmd);
+        return;
+    }
+
+    sim_rx_until = 1e20;
+    sim_rx++;
+
+    timeline("rx script: %s", cmd.toStdString().c_str());
+}
+
 //---------------------------------------------------------------------------
 void TrackThread::stopProcess(QProcess *proc)
 {
+    if(flags & TF_RECEIVING) {
+        flags &= ~TF_RECEIVING;
+        rig->jobs->reception(false);
+    }
+
+    if(flags & TF_SIMULATE) {
+        if(sim_rx_until > TSimClock::daynum())
+            timeline("rx script stopped");
+
+        sim_rx_until = 0;
+
+        return;
+    }
+
     if(proc->pid()) {
         proc->kill();
         proc->waitForFinished();
@@ -516,9 +690,92 @@ void TrackThread::stopProcess(QProcess *proc)
 // notice: it can also be in error state
 bool TrackThread::procRunning(QProcess *proc)
 {
+    if(flags & TF_SIMULATE)
+        return TSimClock::daynum() < sim_rx_until;
+
     return proc->pid() ? true:false;
 }
 
+//---------------------------------------------------------------------------
+void TrackThread::beginSimulation(void)
+{
+    flags |= TF_SIMULATE;
+    flags |= rotor->emulate() ? TF_EMULATE:0;
+
+    sim_end = TSimClock::daynum() + rig->sim_days;
+    rig->jobs->simulate(true, rig->sim_post_rx);
+    sim_rx_until = 0;
+    sim_passes = sim_rx = sim_post = sim_queued = sim_parks = 0;
+
+    if(timeline_fp)
+        fclose(timeline_fp);
+
+    timeline_fp = fopen(rig->sim_timeline.toStdString().c_str(), "w");
+    if(!timeline_fp)
+        qDebug("Error: failed to create timeline %s [%s:%d]",
+               rig->sim_timeline.toStdString().c_str(),
+               __FILE__, __LINE__);
+
+    // never swing the real antenna at simulation speed
+    rotor->closePort();
+    rotor->emulate(true);
+
+    timeline("simulation start, %g x real time, %g days", TSimClock::speed(), rig->sim_days);
+}
+
+//---------------------------------------------------------------------------
+void TrackThread::endSimulation(void)
+{
+    timeline("%d passes, %d rx scripts, %d post rx scripts, %d parks, %d queued at most",
+             sim_passes, sim_rx, sim_post, sim_parks, sim_queued);
+
+    rotor->closePort();
+    rotor->emulate((flags & TF_EMULATE) ? true:false);
+
+    if(timeline_fp)
+        fclose(timeline_fp);
+    timeline_fp = NULL;
+
+    flags &= ~(TF_SIMULATE | TF_EMULATE);
+
+    rig->jobs->simulate(false, 0);
+    TSimClock::stop();
+}
+
+//---------------------------------------------------------------------------
+// simulated time stamped line in the timeline log
+void TrackThread::timeline(const char *fmt, ...)
+{
+    char    buf[512];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+
+    if(timeline_fp) {
+        fprintf(timeline_fp, "%s  %s\n",
+                TSimClock::utc().toString("yyyy-MM-dd hh:mm:ss").toStdString().c_str(), buf);
+        fflush(timeline_fp);
+    }
+    else
+        qDebug("%s", buf);
+}
+
+//---------------------------------------------------------------------------
+// reported to the host, the daemon logs them
+void TrackThread::event(const char *type, const char *fmt, ...)
+{
+    char    buf[512];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+
+    host->trackEvent(type, QString(buf));
+}
+
 //---------------------------------------------------------------------------
 void TrackThread::initRotor(TRig *rig, TSat *sat)
 {
@@ -527,17 +784,22 @@ void TrackThread::initRotor(TRig *rig, TSat *sat)
 
     qDebug("init rotor: %s", sat->name);
 
-    rig->rotor->flags &= ~(R_ROTOR_CCW | R_ROTOR_ZENITH_PASS);
+    if(flags & TF_SIMULATE)
+        timeline("init rotor %s, AOS %s", sat->name,
+                 sat->Daynum2String(rig->passthresholds() ? sat->rec_aostime:sat->aostime, 4|8).toStdString().c_str());
+
+    rotor->flags &= ~(R_ROTOR_CCW | R_ROTOR_ZENITH_PASS);
+    rotor_plan->clear();
 
     // current satellite position
     sat_az = sat->sat_azi;
     sat_el = sat->sat_ele;
 
     // TODO: rotor status should be checked here, is the connection still valid, USB disconnected, etc?
-    if(rig->rotor->rotor_type == RotorType_JRK)
-       rig->rotor->jrk->check_and_reinit();
+    if(rotor->rotor_type == RotorType_JRK)
+       rotor->jrk->check_and_reinit();
 
-    int i = tw->trackIndex();
+    int i = host->trackIndex();
 
     if(i == 1 || i == 2) { // tracking the sun or moon
         if(i == 1) {
@@ -551,12 +813,12 @@ void TrackThread::initRotor(TRig *rig, TSat *sat)
             sat_el = sat->moon_ele;
         }
 
-        rig->rotor->moveTo(sat_az, sat_el);
+        rotor->moveTo(sat_az, sat_el);
         return;
     }
 
 
-    rig->rotor->readPosition();
+    rotor->readPosition();
 
     // AOS satellite position
     sat->daynum = rig->passthresholds() ? sat->rec_aostime:sat->aostime;
@@ -574,18 +836,40 @@ void TrackThread::initRotor(TRig *rig, TSat *sat)
 
     v = sat->get_range_rate();
     if(sat_el > 0  && v > 0 && rig->passthresholds()) {
-        if(sat_el <= rig->rotor->el_min)
+        if(sat_el <= rotor->el_min)
             return; // wait for next pass, it will happen soon
     }
 
-    rig->rotor->setCCWFlag(aos_az, los_az, sat->sat_max_ele);
+    // plan the whole pass, the CCW and zenith flags are the fallback
+    if(sat->CachePass() && rotor_plan->build(rotor, sat->pass_ephem, sat->aostime, sat->lostime)) {
+        event("plan", "%s mode %d wrap %.0f max pointing error %.2f deg", sat->name,
+              rotor_plan->mode(), rotor_plan->wrap(), rotor_plan->maxError());
+
+        if(flags & TF_SIMULATE)
+            timeline("rotor plan %s, mode %d wrap %.0f max pointing error %.2f deg", sat->name,
+                     rotor_plan->mode(), rotor_plan->wrap(), rotor_plan->maxError());
+
+        if(rotor->rotor_type == RotorType_JRK)
+            rotor->jrk->start();
+
+        rotor_plan->position(rig->passthresholds() ? sat->rec_aostime:sat->aostime, &sat_az, &el);
+        qDebug("init rotor: planned move to Az: %.3f El: %.03f", sat_az, el);
+
+        rotor->moveToAxis(sat_az, el);
+
+        sat->Track();
+
+        return;
+    }
+
+    rotor->setCCWFlag(aos_az, los_az, sat->sat_max_ele);
 
     // try to prevent Jrk from latching error: Maximum current exceeded, when moving a long distance
-    if(rig->rotor->rotor_type == RotorType_JRK)
-        rig->rotor->jrk->start();
+    if(rotor->rotor_type == RotorType_JRK)
+        rotor->jrk->start();
 
     // calculate AOS satellite position at rotor limit
-    el = rig->rotor->isCCW() ? (180.0 - rig->rotor->el_max):rig->rotor->el_min;
+    el = rotor->isCCW() ? (180.0 - rotor->el_max):rotor->el_min;
 
     if(sat_el < el) {
         if(sat->FindAOSElevation(el)) {
@@ -596,7 +880,7 @@ void TrackThread::initRotor(TRig *rig, TSat *sat)
 
     qDebug("init rotor: move to Az: %.3f El: %.03f", sat_az, sat_el);
 
-    rig->rotor->moveTo(sat_az, sat_el);
+    rotor->moveTo(sat_az, sat_el);
 
     sat->Track();
 }
@@ -605,7 +889,7 @@ void TrackThread::initRotor(TRig *rig, TSat *sat)
 void TrackThread::moveTo(double az, double el)
 {
 #if 1 // todo: enable this when not debugging
-    if(!rig->rotor->moveTo(az, el))
+    if(!rotor->moveTo(az, el))
         return;
 #endif
 
@@ -614,7 +898,7 @@ void TrackThread::moveTo(double az, double el)
         return;
 
     // calculate azimuth and elevation angular speed
-    QDateTime dt = QDateTime::currentDateTime();
+    QDateTime dt = TSimClock::utc();
     double del = fabs(el - prev_el);
     double daz = fabs(az - prev_az);
     double dtime = fabs(speed_dt.time().msecsTo(dt.time()));
@@ -23,19 +23,23 @@
 #define TRACKTHREAD_H
 
 #include <QThread>
-#include <QDateTimeEdit>
+#include <QDateTime>
+#include <QString>
 #include <stdio.h>
 //---------------------------------------------------------------------------
 #define     TF_STOP     1
+#define     TF_SIMULATE 2   // running on the simulated clock
+#define     TF_EMULATE  4   // rotor emulation was on before the simulation
+#define     TF_RECEIVING 8  // the rx script is running, the post rx jobs are throttled
 
-class QLabel;
 class QProcess;
 class QDateTime;
-class QStringList;
-class MainWindow;
 class TSat;
 class TRig;
-class TrackWidget;
+class TRotor;
+class TAntenna;
+class TRotorPlan;
+class TTrackHost;
 
 //---------------------------------------------------------------------------
 class TrackThread : public QThread
@@ -43,7 +47,7 @@ class TrackThread : public QThread
     Q_OBJECT
 
 public:
-    TrackThread(QObject *parent);
+    TrackThread(TTrackHost *host_, QObject *parent = 0);
     ~TrackThread();
 
     void run();
@@ -59,26 +63,39 @@ signals:
     void setMoonLabelText(const QString &cl);
 
 protected:
+    void startProcess(QProcess *proc, const QString &cmd);
     void stopProcess(QProcess *proc);
     bool procRunning(QProcess *proc);
 
+    void beginSimulation(void);
+    void endSimulation(void);
+    void timeline(const char *fmt, ...);
+    void event(const char *type, const char *fmt, ...);
+
     void initRotor(TRig *rig, TSat *sat);
     void moveTo(double az, double el);
 
 private:
-    TrackWidget *tw;
-    MainWindow  *mw;
+    TTrackHost  *host;
     TRig        *rig;
+    TAntenna    *antenna;
+    TRotor      *rotor;
     TSat        *sat;
-    QProcess    *rx_proc, *post_rx_proc;
-    QStringList *proc_que;
+    TRotorPlan  *rotor_plan;
+    QProcess    *rx_proc;
 
-    QLabel *satLabel, *timeLabel, *sunLabel, *moonLabel;
+    // style sheets last emitted
+    QString sat_style, sun_style, moon_style;
 
     QDateTime speed_dt;
     double prev_el, prev_az, sat_aos_azi;
     FILE *debug_fp;
 
+    // simulation, the stub rx script runs until the given daynum
+    FILE   *timeline_fp;
+    double sim_end, sim_rx_until;
+    int    sim_passes, sim_rx, sim_post, sim_queued, sim_parks;
+
     int flags;
 
 };
@@ -34,6 +34,7 @@
 #define GPS_F_CLOSE     2
 
 #include "gps.h"
+#include "gpsemulator.h"
 #include "gauge.h"
 #include "utils.h"
 
@@ -43,6 +44,7 @@
 TGPS::TGPS(QWidget *gaugeWidget) : QWidget(gaugeWidget)
 {
     gps_timer = NULL;
+    emulator  = new TGPSEmulator;
 
 #ifdef Q_OS_WIN32
     // the QextSerialPort-win32 code is too buggy, use polling and a timer
@@ -87,6 +89,7 @@ TGPS::~TGPS(void)
 {
     close();
     delete port;
+    delete emulator;
 
     if(gps_timer)
         delete gps_timer;
@@ -127,8 +130,9 @@ bool TGPS::deviceName(const QString& devicename)
     if(devicename.isEmpty())
         return false;
 
-    if(devicename != port->portName()) {
+    if(devicename != deviceName()) {
         close();
+        emulator->close();
         port->setPortName(devicename);
     }
 
@@ -138,7 +142,7 @@ bool TGPS::deviceName(const QString& devicename)
 //---------------------------------------------------------------------------
 QString TGPS::deviceName(void) const
 {
-    return port->portName();
+    return emulator->isOpen() ? QString(GPS_EMULATOR):port->portName();
 }
 
 //---------------------------------------------------------------------------
@@ -200,6 +204,14 @@ bool TGPS::open(void)
     else {
         reset();
 
+        // NMEA source on a pseudo-terminal
+        if(port->portName() == GPS_EMULATOR) {
+            if(!emulator->open())
+                return false;
+
+            port->setPortName(emulator->deviceName());
+        }
+
         rc = port->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
 
         if(rc && gps_timer)
@@ -37,6 +37,7 @@ class QTime;
 class QTimer;
 class QextSerialPort;
 class TGauge;
+class TGPSEmulator;
 
 //---------------------------------------------------------------------------
 class TGPS : public QWidget
@@ -109,6 +110,8 @@ private:
     TGauge *gauge;
     QTimer *gps_timer;
 
+    TGPSEmulator *emulator; // device name GPS_EMULATOR
+
     // parsed NMEA data
     QDateTime rxtime_utc;
     QTime     gps_time;
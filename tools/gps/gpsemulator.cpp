@@ -0,0 +1,140 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QDateTime>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "gpsemulator.h"
+#include "simclock.h"
+
+//---------------------------------------------------------------------------
+TGPSEmulator::TGPSEmulator(void)
+{
+    lat = lon = alt = 0;
+    flags = 0;
+    count = 0;
+}
+
+//---------------------------------------------------------------------------
+TGPSEmulator::~TGPSEmulator(void)
+{
+    close();
+}
+
+//---------------------------------------------------------------------------
+bool TGPSEmulator::open(void)
+{
+    if(isOpen())
+        return true;
+
+    if(!pty.open())
+        return false;
+
+    flags = 0;
+    count = 0;
+
+    qDebug("GPS emulator on %s", pty.slaveName().toStdString().c_str());
+
+    start();
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void TGPSEmulator::close(void)
+{
+    if(isRunning()) {
+        flags |= GPS_EMU_STOP;
+        wait();
+    }
+
+    pty.close();
+}
+
+//---------------------------------------------------------------------------
+void TGPSEmulator::setPosition(double lat_, double lon_, double alt_)
+{
+    lat = lat_;
+    lon = lon_;
+    alt = alt_;
+}
+
+//---------------------------------------------------------------------------
+// ddmm.mmmm,N or dddmm.mmmm,E
+void TGPSEmulator::coordinate(char *buf, double deg, bool latitude)
+{
+    double a = fabs(deg);
+    int    d = (int) a;
+
+    sprintf(buf, latitude ? "%02d%07.4f,%c":"%03d%07.4f,%c",
+            d, (a - d) * 60.0,
+            latitude ? (deg < 0 ? 'S':'N'):(deg < 0 ? 'W':'E'));
+}
+
+//---------------------------------------------------------------------------
+// $body*checksum, returns the length
+int TGPSEmulator::sentence(char *buf, const char *body)
+{
+    unsigned char sum = 0;
+    const char *p;
+
+    for(p=body; *p; p++)
+        sum ^= (unsigned char) *p;
+
+    return sprintf(buf, "$%s*%02X\r\n", body, sum);
+}
+
+//---------------------------------------------------------------------------
+void TGPSEmulator::run()
+{
+    char body[160], buf[200], la[24], lo[24];
+    QDateTime utc;
+    QString   t, d;
+    int       n;
+
+    while(!(flags & GPS_EMU_STOP)) {
+        utc = TSimClock::utc();
+        t = utc.toString("hhmmss.zzz");
+        d = utc.toString("ddMMyy");
+
+        coordinate(la, lat, true);
+        coordinate(lo, lon, false);
+
+        // fix quality 1, 8 satellites, hdop 0.9, geoid separation 0
+        sprintf(body, "GPGGA,%s,%s,%s,1,08,0.9,%.1f,M,0.0,M,,",
+                t.toStdString().c_str(), la, lo, alt);
+        n = sentence(buf, body);
+        pty.write(buf, n);
+
+        sprintf(body, "GPRMC,%s,A,%s,%s,0.0,0.0,%s,,",
+                t.toStdString().c_str(), la, lo, d.toStdString().c_str());
+        n = sentence(buf, body);
+        pty.write(buf, n);
+
+        count += 2;
+
+        msleep(GPS_EMU_INTERVAL);
+    }
+}
+
+//---------------------------------------------------------------------------
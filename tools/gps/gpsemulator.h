@@ -0,0 +1,65 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef GPSEMULATOR_H
+#define GPSEMULATOR_H
+
+#include <QThread>
+
+#include "ptydevice.h"
+
+//---------------------------------------------------------------------------
+#define GPS_EMULATOR        "emulator"  // TGPS device name of the emulator
+#define GPS_EMU_STOP        1
+#define GPS_EMU_INTERVAL    1000        // ms between fixes
+
+//---------------------------------------------------------------------------
+// NMEA 0183 source on a pseudo-terminal, sends GGA and RMC sentences of
+// a fixed position with the system time once per second
+class TGPSEmulator : public QThread
+{
+public:
+    TGPSEmulator(void);
+    ~TGPSEmulator(void);
+
+    bool open(void);
+    void close(void);
+    bool isOpen(void) { return pty.isOpen(); }
+    QString deviceName(void) const { return pty.slaveName(); }
+
+    void run();
+
+    // degrees north and east, meters above mean sea level
+    void setPosition(double lat_, double lon_, double alt_);
+
+    int  sentences(void) { return count; }
+
+protected:
+    int  sentence(char *buf, const char *body);
+    void coordinate(char *buf, double deg, bool latitude);
+
+private:
+    TPtyDevice pty;
+    double     lat, lon, alt;
+    int        flags, count;
+};
+
+#endif // GPSEMULATOR_H
@@ -21,155 +21,117 @@
 //---------------------------------------------------------------------------
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "plist.h"
 
-//---------------------------------------------------------------------------
-
-DUMMY::DUMMY()
-{
- Owner=NULL;
- next=NULL;
- Obj=NULL;
-}
-
-//---------------------------------------------------------------------------
-DUMMY::~DUMMY()
-{
-}
-
-//---------------------------------------------------------------------------
-DUMMY::DUMMY(void *owner, void *obj)
-{
-  Owner=(PList *)owner;
-  next=NULL;
-  if(Owner->Items) next=Owner->Items;
-  Obj=obj;
-  Owner->Items=this;
-  Owner->Count+=1;
-}
-//---------------------------------------------------------------------------
-//---------------------------------------------------------------------------
-//---------------------------------------------------------------------------
-//---------------------------------------------------------------------------
-//---------------------------------------------------------------------------
-//---------------------------------------------------------------------------
-//---------------------------------------------------------------------------
-//---------------------------------------------------------------------------
-//---------------------------------------------------------------------------
 //---------------------------------------------------------------------------
 PList::PList()
 {
   Count=0;
+  Capacity=0;
   Items=NULL;
+  Serial=0;
+  Index=NULL;
+  FreeIndex=NULL;
 }
 
 //---------------------------------------------------------------------------
 PList::~PList()
 {
   Flush();
+
+  if(Index && FreeIndex)
+     FreeIndex(Index);
+}
+
+//---------------------------------------------------------------------------
+bool PList::Grow(void)
+{
+ void **tmp;
+ int  n = Capacity ? Capacity*2:16;
+
+  tmp=(void **) realloc(Items, n*sizeof(void *));
+  if(!tmp)
+     return false;
+
+  Items=tmp;
+  Capacity=n;
+
+ return true;
 }
 
 //---------------------------------------------------------------------------
 int PList::Add(void *item, int mode)
 {
    mode = mode;
-   new DUMMY(this, item);
+
+   if(Count==Capacity && !Grow())
+      return Count;
+
+   Items[Count++]=item;
+   Serial++;
 
  return Count;
 }
 
 //---------------------------------------------------------------------------
+// returns the count before the item was removed, -1 if not found
 int PList::Delete(void *item)
 {
- DUMMY *c, *prev;
- int   i=-1;
-
-  c=prev=Items;
-  while(c) {
-     if(c->Obj==item) {
-        if(c==Items) Items=c->next;
-        else         prev->next=c->next; 
-        delete c;
-        i=Count--;
-        break; }
-     prev=c;
-     c=c->next; }
-
- if(!Count || !Items)
-    Items=NULL;
-
- return i;
+ return Delete(IndexOf(item));
 }
 
 //---------------------------------------------------------------------------
 void PList::Flush(void)
 {
- DUMMY *c, *c2;
-
-  c=Items;
-  while(c) {
-     c2=c->next;
-     Delete(c->Obj);
-     c=c2; }
+  if(Items)
+     free(Items);
 
   Count=0;
+  Capacity=0;
   Items=NULL;
+  Serial++;
 }
 
 //---------------------------------------------------------------------------
 int PList::Delete(int index)
 {
- DUMMY *c;
- int i=Count-1;
+ int i=Count;
 
-  if(!Count || index<0 || index>i)
+  if(!Count || index<0 || index>=Count)
      return -1;
 
-  for(c=Items; c; c=c->next, i--)
-     if(i==index)
-        return(Delete(c->Obj));
+  memmove(&Items[index], &Items[index+1], (Count-index-1)*sizeof(void *));
+  Count--;
+  Serial++;
 
- return(-1);
+ return i;
 }
 
 //---------------------------------------------------------------------------
+// searched from the last added, removing items from the end stays O(1)
 int PList::IndexOf(void *item)
 {
- DUMMY *c;
- int index=Count-1;
+ int i;
 
-  for(c=Items; c; c=c->next, index--)
-     if(c->Obj==item)
-        return index;
+  for(i=Count-1; i>=0; i--)
+     if(Items[i]==item)
+        return i;
 
  return(-1);
 }
 
 //---------------------------------------------------------------------------
-void *PList::ItemAt(int index)
+void *PList::SetItem(void *item, int index) // zero based
 {
- DUMMY *c;
- int i=Count-1;
-
-  if(!Count || index<0 || index>i)
+  if(index<0 || index>=Count)
      return NULL;
 
-  for(c=Items; c; c=c->next, i--)
-     if(i==index)
-        return c->Obj;
+  Items[index]=item;
+  Serial++;
 
- return NULL;
-}
-
-//---------------------------------------------------------------------------
-void *PList::SetItem(void *item, int index) // zero based
-{
- void *c = ItemAt(index);
-
-  if(c)
-     c = item;
-     
- return c;
+ return item;
 }
 
 //---------------------------------------------------------------------------
@@ -186,4 +148,3 @@ void *PList::Last(void)
   else
      return ItemAt(Count-1);
 }
-
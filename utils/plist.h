@@ -23,18 +23,8 @@
 #define PListH
 
 //---------------------------------------------------------------------------
-class DUMMY {
-   public:
-      DUMMY();
-      ~DUMMY();
-      DUMMY(void *owner, void *obj);
-
-      class PList *Owner;
-      DUMMY *next;
-      void  *Obj;
-};
-
-//---------------------------------------------------------------------------
+// list of pointers in insertion order, stored contiguously so ItemAt is O(1)
+// the items are not owned, Delete and Flush only remove the pointers
 class PList {
    public:
       PList();
@@ -46,14 +36,24 @@ class PList {
       void   Flush(void);
 
       int    IndexOf(void *item);
-      void   *ItemAt(int index);
+      void   *ItemAt(int index) { return (index >= 0 && index < Count) ? Items[index]:NULL; }
       void   *First(void);
       void   *Last(void);
 
-      class  DUMMY *Items;
+      void   **Items;
       int    Count;
 
+      // bumped once per Add and at least once per other change, lets an
+      // index over the list detect it is stale or was only appended to
+      unsigned int Serial;
+
+      // optional index attached by the user of the items, freed with the list
+      void   *Index;
+      void   (*FreeIndex)(void *index);
+
    protected:
+      bool   Grow(void);
 
+      int    Capacity;
 };
 #endif
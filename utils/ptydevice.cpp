@@ -0,0 +1,158 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QtGlobal>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(Q_OS_UNIX)
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <termios.h>
+#   include <sys/select.h>
+#endif
+
+#include "ptydevice.h"
+
+//---------------------------------------------------------------------------
+TPtyDevice::TPtyDevice(void)
+{
+    master = -1;
+    slave  = -1;
+}
+
+//---------------------------------------------------------------------------
+TPtyDevice::~TPtyDevice(void)
+{
+    close();
+}
+
+//---------------------------------------------------------------------------
+bool TPtyDevice::open(void)
+{
+#if defined(Q_OS_UNIX)
+    struct termios tio;
+    char *s;
+
+    if(isOpen())
+        return true;
+
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if(master < 0) {
+        qDebug("Error: failed to open a pseudo-terminal [%s:%d]", __FILE__, __LINE__);
+        return false;
+    }
+
+    // nobody may be reading, a full terminal must not block the emulator
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    if(grantpt(master) || unlockpt(master) || !(s = ptsname(master))) {
+        qDebug("Error: failed to unlock a pseudo-terminal [%s:%d]", __FILE__, __LINE__);
+        close();
+        return false;
+    }
+
+    name = QString(s);
+
+    // keep the slave open and raw, the master would see EIO and echoed
+    // bytes between the sessions of the serial port
+    slave = ::open(s, O_RDWR | O_NOCTTY);
+    if(slave < 0 || tcgetattr(slave, &tio)) {
+        qDebug("Error: failed to open %s [%s:%d]", s, __FILE__, __LINE__);
+        close();
+        return false;
+    }
+
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    return true;
+#else
+    qDebug("Error: pseudo-terminals are not supported on this platform [%s:%d]", __FILE__, __LINE__);
+    return false;
+#endif
+}
+
+//---------------------------------------------------------------------------
+void TPtyDevice::close(void)
+{
+#if defined(Q_OS_UNIX)
+    if(slave >= 0)
+        ::close(slave);
+    if(master >= 0)
+        ::close(master);
+#endif
+
+    slave = master = -1;
+    name.clear();
+}
+
+//---------------------------------------------------------------------------
+int TPtyDevice::read(char *buf, int max, int timeout_ms)
+{
+#if defined(Q_OS_UNIX)
+    struct timeval tv;
+    fd_set rd;
+    int    rc;
+
+    if(!isOpen())
+        return -1;
+
+    FD_ZERO(&rd);
+    FD_SET(master, &rd);
+
+    tv.tv_sec  = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+
+    rc = select(master + 1, &rd, NULL, NULL, &tv);
+    if(rc <= 0)
+        return rc;
+
+    return (int) ::read(master, buf, max);
+#else
+    Q_UNUSED(buf); Q_UNUSED(max); Q_UNUSED(timeout_ms);
+    return -1;
+#endif
+}
+
+//---------------------------------------------------------------------------
+bool TPtyDevice::write(const char *buf, int len)
+{
+#if defined(Q_OS_UNIX)
+    int n;
+
+    while(isOpen() && len > 0) {
+        n = (int) ::write(master, buf, len);
+        if(n <= 0)
+            return false;
+
+        buf += n;
+        len -= n;
+    }
+
+    return len == 0;
+#else
+    Q_UNUSED(buf); Q_UNUSED(len);
+    return false;
+#endif
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,54 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef PTYDEVICE_H
+#define PTYDEVICE_H
+
+#include <QtGlobal>
+#include <QString>
+
+//---------------------------------------------------------------------------
+// Master side of a pseudo-terminal, the slave name is opened as a serial
+// device by QextSerialPort. Used by the rotor and GPS emulators.
+class TPtyDevice
+{
+public:
+    TPtyDevice(void);
+    ~TPtyDevice(void);
+
+    bool open(void);
+    void close(void);
+    bool isOpen(void) { return master >= 0; }
+
+    // e.g. /dev/pts/3
+    QString slaveName(void) const { return name; }
+
+    // waits up to timeout_ms for data, returns bytes read, 0 on timeout, -1 on error
+    int  read(char *buf, int max, int timeout_ms);
+    // false if the terminal is full or closed
+    bool write(const char *buf, int len);
+
+private:
+    int     master, slave;
+    QString name;
+};
+
+#endif // PTYDEVICE_H
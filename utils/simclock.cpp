@@ -0,0 +1,179 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+
+#include "simclock.h"
+#include "utils.h"
+
+//---------------------------------------------------------------------------
+static QMutex  sc_mutex;
+static bool    sc_simulated = false;
+static double  sc_speed = 1;
+static qint64  sc_msecs = 0;  // simulated time
+static double  sc_debt = 0;   // real milliseconds not yet slept
+static QThread *sc_owner = NULL; // the only thread advancing the time in sleep()
+static QWaitCondition sc_wake;
+
+//---------------------------------------------------------------------------
+void TSimClock::start(QDateTime utc, double speed)
+{
+    QMutexLocker lock(&sc_mutex);
+
+    sc_simulated = true;
+    sc_speed = speed < 1 ? 1:speed;
+    sc_msecs = utc.toUTC().toMSecsSinceEpoch();
+    sc_debt  = 0;
+    sc_owner = NULL;
+
+    sc_wake.wakeAll();
+}
+
+//---------------------------------------------------------------------------
+void TSimClock::stop(void)
+{
+    QMutexLocker lock(&sc_mutex);
+
+    sc_simulated = false;
+    sc_speed = 1;
+    sc_owner = NULL;
+
+    sc_wake.wakeAll();
+}
+
+//---------------------------------------------------------------------------
+bool TSimClock::isSimulated(void)
+{
+    QMutexLocker lock(&sc_mutex);
+
+    return sc_simulated;
+}
+
+//---------------------------------------------------------------------------
+double TSimClock::speed(void)
+{
+    QMutexLocker lock(&sc_mutex);
+
+    return sc_speed;
+}
+
+//---------------------------------------------------------------------------
+qint64 TSimClock::msecs(void)
+{
+    QMutexLocker lock(&sc_mutex);
+
+    return sc_simulated ? sc_msecs:QDateTime::currentMSecsSinceEpoch();
+}
+
+//---------------------------------------------------------------------------
+QDateTime TSimClock::utc(void)
+{
+    QMutexLocker lock(&sc_mutex);
+
+    if(!sc_simulated)
+        return QDateTime::currentDateTime().toUTC();
+
+    return QDateTime::fromMSecsSinceEpoch(sc_msecs).toUTC();
+}
+
+//---------------------------------------------------------------------------
+double TSimClock::daynum(void)
+{
+    return GetStartTime(utc());
+}
+
+//---------------------------------------------------------------------------
+void TSimClock::advance(qint64 ms)
+{
+    QMutexLocker lock(&sc_mutex);
+
+    if(sc_simulated) {
+        sc_msecs += ms;
+        sc_wake.wakeAll();
+    }
+}
+
+//---------------------------------------------------------------------------
+// the real wait is accumulated until it is at least a millisecond,
+// a loop sleeping 500 ms at 1000x then waits 1 ms every other round
+void TSimClock::sleep(unsigned long ms)
+{
+    unsigned int wait;
+    qint64       target, now;
+
+    sc_mutex.lock();
+
+    if(!sc_simulated) {
+        sc_mutex.unlock();
+        delay(ms);
+
+        return;
+    }
+
+    if(sc_owner == NULL)
+        sc_owner = QThread::currentThread();
+
+    // the others follow the owner, or N sleepers would run the time N times too fast
+    if(sc_owner != QThread::currentThread()) {
+        target = sc_msecs + ms;
+
+        while(sc_simulated && sc_owner && sc_msecs < target) {
+            now = sc_msecs;
+            if(!sc_wake.wait(&sc_mutex, (unsigned long) (ms / sc_speed) + SC_TAKEOVER) && now == sc_msecs) {
+                sc_owner = NULL;
+                break;
+            }
+        }
+
+        if(sc_owner || !sc_simulated || sc_msecs >= target) {
+            sc_mutex.unlock();
+            return;
+        }
+
+        // the owner stopped sleeping, sleep the rest as the new owner
+        sc_owner = QThread::currentThread();
+        ms = (unsigned long) (target - sc_msecs);
+    }
+
+    sc_debt += ms / sc_speed;
+
+    wait = (unsigned int) sc_debt;
+    sc_debt -= wait;
+
+    sc_mutex.unlock();
+
+    if(wait > 0)
+        delay(wait);
+
+    // the time moves when the wait is over
+    sc_mutex.lock();
+
+    if(sc_simulated && sc_owner == QThread::currentThread()) {
+        sc_msecs += ms;
+        sc_wake.wakeAll();
+    }
+
+    sc_mutex.unlock();
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,53 @@
+/*
+    POES-USRP, a software for recording and decoding POES high resolution weather satellite images.
+    Copyright (C) 2009-2012 Free Software Foundation, Inc.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: <postmaster@poes-weather.com>
+    Web: <http://www.poes-weather.com>
+*/
+//---------------------------------------------------------------------------
+#ifndef SIMCLOCK_H
+#define SIMCLOCK_H
+
+#include <QtGlobal>
+#include <QDateTime>
+
+#define SC_TAKEOVER     2000    // real ms without progress, the owner is gone
+
+//---------------------------------------------------------------------------
+// Time source of the tracker. In real time it is the system clock, in
+// simulation the time starts at a given UTC and advances only by sleep()
+// and advance(). The first thread sleeping after start() owns the clock,
+// its sleep(ms) advances the time and waits ms / speed milliseconds. Any
+// other thread's sleep(ms) waits until the owner got ms further, or takes
+// the clock over if the time stood still for SC_TAKEOVER real ms.
+class TSimClock
+{
+public:
+    static void start(QDateTime utc, double speed);
+    static void stop(void);
+    static bool isSimulated(void);
+    static double speed(void);
+
+    static QDateTime utc(void);
+    static double daynum(void);  // days since 31Dec79 00:00:00 UTC
+    static qint64 msecs(void);   // milliseconds since the epoch
+
+    static void sleep(unsigned long ms);
+    static void advance(qint64 ms);
+};
+
+#endif // SIMCLOCK_H